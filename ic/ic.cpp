@@ -176,14 +176,8 @@ int doList(const Container::FileContainer::DirectoryMap& directory) {
 }
 
 
-int doInitialize(Container::FileContainer::DirectoryMap& directory) {
-    Container::Status status;
-
-    Container::FileContainer::DirectoryMap::iterator it = directory.begin();
-    while (!status && it != directory.end()) {
-        std::shared_ptr<Container::VirtualFile> file = it->second;
-        status = file->erase();
-    }
+int doInitialize(Container::FileContainer& container, Container::FileContainer::DirectoryMap& directory) {
+    Container::Status status = container.clear();
 
     int exitStatus;
 
@@ -424,7 +418,7 @@ int main(int argumentCount, char* argumentValues[]) {
                     if (switchArgument == "-l" || switchArgument == "--list") {
                         exitStatus = doList(directory);
                     } else if (switchArgument == "-I" || switchArgument == "--initialize") {
-                        exitStatus = doInitialize(directory);
+                        exitStatus = doInitialize(container, directory);
                     } else if (switchArgument == "-X" || switchArgument == "--export") {
                         exitStatus = doExport(directory);
                     } else {
@@ -26,9 +26,11 @@
 #define CONTAINER_CONTAINER_H
 
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "container_status_base.h"
 
@@ -52,15 +54,77 @@ namespace Container {
              */
             typedef std::pair<std::string, std::shared_ptr<VirtualFile>> DirectoryMapPair;
 
+            /**
+             * Type used for functions that visit directory entries.  The function receives the virtual file name and
+             * the virtual file.  The function should return true to continue visiting entries or false to stop.
+             */
+            typedef std::function<bool(const std::string&, const std::shared_ptr<VirtualFile>&)> FileVisitor;
+
+            /**
+             * Enumeration of supported data chunk CRC verification policies.  The policy controls when the CRC of a
+             * data chunk is checked as the chunk is read from the container.
+             */
+            enum class CrcVerification {
+                /**
+                 * Indicates that data chunk CRCs should not be checked.
+                 */
+                OFF,
+
+                /**
+                 * Indicates that the CRC should be checked on one of every N data chunk reads.
+                 */
+                SAMPLED,
+
+                /**
+                 * Indicates that the CRC should be checked every time a data chunk is read.
+                 */
+                ALWAYS,
+
+                /**
+                 * Indicates that the CRC should be checked the first time a data chunk is read after the container
+                 * is opened.  Chunks that pass are not checked again.
+                 */
+                FIRST_TOUCH
+            };
+
+            /**
+             * Enumeration of supported data chunk checksums.
+             */
+            enum class ChunkChecksum {
+                /**
+                 * Indicates that data chunks are protected only by the 16-bit CRC in the chunk header.
+                 */
+                CRC16,
+
+                /**
+                 * Indicates that data chunk payloads are protected by a 64-bit CRC held in the chunk header.  The
+                 * 16-bit CRC then only protects the chunk header.  Requires container minor version 2 or later.
+                 */
+                CRC64
+            };
+
+            /**
+             * The default sampling interval used by the \ref Container::Container::CrcVerification::SAMPLED policy.
+             */
+            static constexpr unsigned defaultCrcSampleInterval = 16;
+
+            /**
+             * The default container-wide write buffer budget, in bytes.
+             */
+            static constexpr unsigned long long defaultWriteBufferBudget = 16 * 1024 * 1024;
+
             /**
              * The container major version code.
              */
             static constexpr std::uint8_t containerMajorVersion = 1;
 
             /**
-             * The latest container minor version code.
+             * The latest container minor version code.  Minor version 1 adds support for extended data chunks.  Minor
+             * version 2 adds support for 64-bit payload checksums.  Minor version 3 adds support for compressed
+             * extents.  Minor version 4 adds support for shared chunks used by deduplication.  Minor version 5 adds
+             * support for small virtual files held inline in the stream start chunk.
              */
-            static constexpr std::uint8_t containerMinorVersion = 0;
+            static constexpr std::uint8_t containerMinorVersion = 5;
 
             /**
              * Constructor
@@ -91,21 +155,232 @@ namespace Container {
             std::uint8_t minorVersion() const;
 
             /**
-             * Returns a directory of all the streams in the container.
+             * Method you can use to select how data chunk CRCs are verified when data is read from the container.
+             * CRCs are verified by default.  A \ref Container::ChunkCrcError is reported if a chunk fails
+             * verification.
+             *
+             * \param[in] policy         The new verification policy.
+             *
+             * \param[in] sampleInterval The number of chunk reads per verified chunk.  The value is only used by the
+             *                           \ref Container::Container::CrcVerification::SAMPLED policy.
+             */
+            void setCrcVerification(CrcVerification policy, unsigned sampleInterval = defaultCrcSampleInterval);
+
+            /**
+             * Method you can use to determine the current data chunk CRC verification policy.
+             *
+             * \return Returns the current verification policy.
+             */
+            CrcVerification crcVerification() const;
+
+            /**
+             * Method you can use to enable or disable padding-free chunk writes.  By default, the unused space at the
+             * end of every chunk is explicitly written with zeros.  When padding-free writes are enabled, unused space
+             * that already exists in the container is left untouched and only unused space that extends the container
+             * is written.  Note that, when enabled, unused space may retain data from chunks that were previously
+             * released.
+             *
+             * \param[in] enabled If true, padding-free chunk writes will be used.  If false, unused space will always
+             *                    be written.
+             */
+            void setPaddingFreeWrites(bool enabled = true);
+
+            /**
+             * Method you can use to determine if padding-free chunk writes are enabled.
+             *
+             * \return Returns true if padding-free chunk writes are enabled.
+             */
+            bool paddingFreeWrites() const;
+
+            /**
+             * Method you can use to enable or disable chunk deduplication.  When enabled, full extents written to
+             * virtual files are stored in shared chunks.  Identical extents, in any virtual file, are stored once and
+             * referenced from each virtual file.  Deduplication is disabled by default and requires container minor
+             * version 4 or later.  The setting can be changed at any time and only affects data written after the
+             * change.
+             *
+             * \param[in] enabled If true, chunk deduplication will be used.
+             */
+            void setDeduplication(bool enabled = true);
+
+            /**
+             * Method you can use to determine if chunk deduplication is enabled.
+             *
+             * \return Returns true if chunk deduplication is enabled.
+             */
+            bool deduplication() const;
+
+            /**
+             * Method you can use to limit the amount of data that all virtual files in this container may hold in
+             * memory, pending write.  Each virtual file buffers appended and modified data up to its write cache size.
+             * When the total exceeds the budget, the virtual files holding the most data are written to the container
+             * until half the budget is in use.  The write is performed by the call that exceeded the budget so
+             * producers are slowed to the rate the container can accept data.  The default budget is 16 MiBytes.
+             *
+             * \param[in] newBudget The new budget, in bytes.  A value of 0 removes the limit.
+             *
+             * \return Returns the status from the operation.  Buffered data is written if it exceeds the new budget.
+             */
+            Status setWriteBufferBudget(unsigned long long newBudget);
+
+            /**
+             * Method you can use to determine the container-wide write buffer budget.
+             *
+             * \return Returns the write buffer budget, in bytes.
+             */
+            unsigned long long writeBufferBudget() const;
+
+            /**
+             * Method you can use to determine the amount of data all virtual files in this container hold in memory,
+             * pending write.  Producers can use this value to pace themselves.
+             *
+             * \return Returns the number of buffered bytes.
+             */
+            unsigned long long bufferedBytes() const;
+
+            /**
+             * Method you can use to select the checksum used to protect data chunks when a new container is created.
+             * The value must be set before the container is opened.  Existing containers always use the checksum
+             * selected when they were created.
+             *
+             * \param[in] checksum The checksum to use for new containers.
+             */
+            void setChunkChecksum(ChunkChecksum checksum);
+
+            /**
+             * Method you can use to determine the checksum used to protect data chunks in the open container.
+             *
+             * \return Returns the checksum used by the container.
+             */
+            ChunkChecksum chunkChecksum() const;
+
+            /**
+             * Returns a directory of all the streams in the container.  Note that virtual file instances are normally
+             * created only when a file is first accessed.  This method creates an instance for every file in the
+             * container.  Consider using \ref Container::Container::forEachFile or
+             * \ref Container::Container::virtualFile for containers holding large numbers of files.
              *
              * \return Returns a map, keyed by the stream name, of streams in the container.
              */
             DirectoryMap directory();
 
+            /**
+             * Method you can use to visit entries in the directory without copying the directory.  Entries are visited
+             * in name order.
+             *
+             * The visitor can safely rename or erase the visited file, or any other file, during the visit.  Files
+             * that are erased before they are reached will not be visited.  Files that are created or renamed to a
+             * name that sorts after the visited file will be visited.
+             *
+             * \param[in] visitor The function to call for each visited entry.
+             *
+             * \param[in] prefix  An optional name prefix.  Only entries whose name starts with the prefix will be
+             *                    visited.
+             *
+             * \return Returns the status from the operation.
+             */
+            Status forEachFile(const FileVisitor& visitor, const std::string& prefix = std::string());
+
+            /**
+             * Method you can use to locate a single virtual file by name without copying the directory.
+             *
+             * \param[in] virtualFileName The name of the virtual file to locate.
+             *
+             * \return Returns the requested virtual file.  A null pointer is returned if the file does not exist.
+             */
+            std::shared_ptr<VirtualFile> virtualFile(const std::string& virtualFileName);
+
             /**
              * Method you can call to create a new virtual file in the container.  The newly created file will be
              * added to the directory.
              *
              * \param[in] newVirtualFileName The new name to assign to this file.
              *
+             * \param[in] expectedSize       An optional hint indicating the expected size of the file, in bytes.  If
+             *                               non-zero, space for the file is reserved using
+             *                               \ref Container::VirtualFile::reserve.
+             *
              * \return Returns the newly created virtual file.  A null pointer is returned on error.
              */
-            std::shared_ptr<VirtualFile> newVirtualFile(const std::string& newVirtualFileName);
+            std::shared_ptr<VirtualFile> newVirtualFile(
+                const std::string& newVirtualFileName,
+                unsigned long long expectedSize = 0
+            );
+
+            /**
+             * Method you can use to erase a group of virtual files.  Space released by the files is merged before it
+             * is marked as unused on the media so the container is updated once rather than once per file.  Names
+             * that do not match a virtual file are ignored.
+             *
+             * \param[in] virtualFileNames The names of the virtual files to erase.
+             *
+             * \param[in] verify           If true, each chunk is read back and checked before its space is released.
+             *                             See \ref Container::VirtualFile::erase.
+             *
+             * \return Returns the status from the operation.
+             */
+            Status eraseFiles(const std::vector<std::string>& virtualFileNames, bool verify = false);
+
+            /**
+             * Method you can use to erase every virtual file in the container.  The container is cut back to the
+             * file header so the cost does not depend on the amount of data held in the container.  Virtual files
+             * obtained before this call are no longer valid and any data they hold, pending write, is discarded.
+             *
+             * \return Returns the status from the operation.
+             */
+            Status clear();
+
+            /**
+             * Method you can use to start a bulk ingest session.  A session lets you add very many virtual files
+             * quickly.  Files are appended sequentially at the end of the container and written in large blocks.  The
+             * files are added to the directory when the session is committed.
+             *
+             * \return Returns the status from the operation.  An \ref Container::IngestSessionError is reported if a
+             *         session is already active.
+             */
+            Status beginIngest();
+
+            /**
+             * Method you can use to add a virtual file during a bulk ingest session.  Data is stored uncompressed and
+             * is not deduplicated.  The file can not be accessed until the session is committed.
+             *
+             * \param[in] virtualFileName The name of the new virtual file.  The name must not already be in use.
+             *
+             * \param[in] data            The file contents.
+             *
+             * \param[in] fileSize        The size of the file contents, in bytes.
+             *
+             * \return Returns the status from the operation.  An \ref Container::IngestSessionError is reported if no
+             *         session is active or if an earlier write in the session failed.
+             */
+            Status ingestFile(
+                const std::string&  virtualFileName,
+                const std::uint8_t* data,
+                unsigned long long  fileSize
+            );
+
+            /**
+             * Method you can use to end a bulk ingest session and add the ingested files to the directory.  If the
+             * session can not be committed, the files added during the session are discarded.  Closing the container
+             * commits an active session.
+             *
+             * \return Returns the status from the operation.
+             */
+            Status commitIngest();
+
+            /**
+             * Method you can use to end a bulk ingest session and discard the files added during the session.
+             *
+             * \return Returns the status from the operation.
+             */
+            Status abortIngest();
+
+            /**
+             * Method you can use to determine if a bulk ingest session is active.
+             *
+             * \return Returns true if a session is active.  Returns false if no session is active.
+             */
+            bool ingestActive() const;
 
             /**
              * Method you can call to perform a sequential read across the container.
@@ -249,6 +524,28 @@ namespace Container {
              */
             virtual Status flush() = 0;
 
+            /**
+             * Method you can overload to indicate whether the derived class can provide direct access to the
+             * underlying data store through \ref Container::Container::pin.
+             *
+             * \return Returns true if pinning is supported.  The default implementation returns false.
+             */
+            virtual bool supportsPinning() const;
+
+            /**
+             * Method you can overload to provide direct, read-only access to a region of the underlying data store.
+             * The method is used by \ref Container::VirtualFile::readView to hand out data without copying it.
+             *
+             * \param[in] offset The offset of the first byte of the region.
+             *
+             * \param[in] count  The number of bytes in the region.
+             *
+             * \return Returns a pointer to the first byte of the region.  The region must remain readable until the
+             *         last copy of the returned pointer is released.  A null pointer should be returned if the region
+             *         can not be accessed directly.  The default implementation returns a null pointer.
+             */
+            virtual std::shared_ptr<const std::uint8_t> pin(unsigned long long offset, unsigned count);
+
         private:
             /**
              * Implementation class.
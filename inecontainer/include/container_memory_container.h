@@ -168,6 +168,28 @@ namespace Container {
              */
             Status flush() final;
 
+            /**
+             * Method that indicates that memory containers support pinning.
+             *
+             * \return Returns true.
+             */
+            bool supportsPinning() const final;
+
+            /**
+             * Method that provides direct, read-only access to a region of the memory buffer.  The returned pointer
+             * holds a reference to the memory buffer so the buffer remains allocated while the region is pinned.
+             * Writes that grow the container can reallocate the buffer so regions should be released before the
+             * container is extended.
+             *
+             * \param[in] offset The offset of the first byte of the region.
+             *
+             * \param[in] count  The number of bytes in the region.
+             *
+             * \return Returns a pointer to the first byte of the region.  A null pointer is returned if the region
+             *         extends past the end of the buffer.
+             */
+            std::shared_ptr<const std::uint8_t> pin(unsigned long long offset, unsigned count) final;
+
         private:
             /**
              * Implementation class.
@@ -75,6 +75,16 @@ namespace Container {
              */
             explicit InternalError(PimplBase* pimpl);
 
+            /**
+             * Constructor used to create derived instances sharing a statically allocated pimpl.  Instances created
+             * this way do not allocate memory.
+             *
+             * \param[in] pimpl The shared pimpl instance.
+             *
+             * \param[in] value An optional value stored with the instance.
+             */
+            explicit InternalError(PimplBase& pimpl, unsigned long long value = 0);
+
             /**
              * Copy constructor.
              *
@@ -170,6 +180,16 @@ namespace Container {
              */
             explicit FormatError(PimplBase* pimpl);
 
+            /**
+             * Constructor used to create derived instances sharing a statically allocated pimpl.  Instances created
+             * this way do not allocate memory.
+             *
+             * \param[in] pimpl The shared pimpl instance.
+             *
+             * \param[in] value An optional value stored with the instance.
+             */
+            explicit FormatError(PimplBase& pimpl, unsigned long long value = 0);
+
             /**
              * Copy constructor.
              *
@@ -210,6 +230,16 @@ namespace Container {
              */
             explicit HeaderError(PimplBase* pimpl);
 
+            /**
+             * Constructor used to create derived instances sharing a statically allocated pimpl.  Instances created
+             * this way do not allocate memory.
+             *
+             * \param[in] pimpl The shared pimpl instance.
+             *
+             * \param[in] value An optional value stored with the instance.
+             */
+            explicit HeaderError(PimplBase& pimpl, unsigned long long value = 0);
+
             /**
              * Copy constructor.
              *
@@ -250,6 +280,16 @@ namespace Container {
              */
             explicit FilesystemStatus(PimplBase* pimpl);
 
+            /**
+             * Constructor used to create derived instances sharing a statically allocated pimpl.  Instances created
+             * this way do not allocate memory.
+             *
+             * \param[in] pimpl The shared pimpl instance.
+             *
+             * \param[in] value An optional value stored with the instance.
+             */
+            explicit FilesystemStatus(PimplBase& pimpl, unsigned long long value = 0);
+
             /**
              * Copy constructor.
              *
@@ -290,6 +330,16 @@ namespace Container {
              */
             explicit FilesystemError(PimplBase* pimpl);
 
+            /**
+             * Constructor used to create derived instances sharing a statically allocated pimpl.  Instances created
+             * this way do not allocate memory.
+             *
+             * \param[in] pimpl The shared pimpl instance.
+             *
+             * \param[in] value An optional value stored with the instance.
+             */
+            explicit FilesystemError(PimplBase& pimpl, unsigned long long value = 0);
+
             /**
              * Copy constructor.
              *
@@ -360,6 +410,24 @@ namespace Container {
              * \param[in] pimpl The pimpl class used to create functional error instances.
              */
             explicit StreamingReadError(PimplBase* pimpl);
+
+            /**
+             * Constructor used to create derived instances sharing a statically allocated pimpl.  Instances created
+             * this way do not allocate memory.
+             *
+             * \param[in] pimpl The shared pimpl instance.
+             *
+             * \param[in] value An optional value stored with the instance.
+             */
+            explicit StreamingReadError(PimplBase& pimpl, unsigned long long value = 0);
+
+        private:
+            /**
+             * Method that returns the pimpl shared by all default constructed instances.
+             *
+             * \return Returns a reference to the shared pimpl instance.
+             */
+            static PimplBase& defaultPimpl();
     };
 
     /**
@@ -1299,6 +1367,68 @@ namespace Container {
         private:
             class Pimpl;
     };
+
+    /**
+     * Class that reports a data chunk whose contents do not match the chunk's CRC.
+     */
+    class ChunkCrcError:public FormatError {
+        public:
+            /**
+             * The error code used to report chunk CRC errors.
+             */
+            static constexpr int reportedErrorCode = 23;
+
+            /**
+             * Constructor
+             *
+             * \param[in] filePosition The file position of the chunk that failed verification.
+             */
+            ChunkCrcError(unsigned long long filePosition);
+
+            /**
+             * Copy constructor
+             *
+             * \param[in] other The instance to be copied.
+             */
+            ChunkCrcError(const Status& other);
+
+            ~ChunkCrcError();
+
+            /**
+             * Method that returns the file position of the chunk that failed verification.
+             *
+             * \return Returns the file position of the chunk.
+             */
+            unsigned long long filePosition() const;
+
+        private:
+            class Pimpl;
+    };
+
+    /**
+     * Class that reports a bulk ingest call made while the container was not in the required ingest state.
+     */
+    class IngestSessionError:public InternalError {
+        public:
+            /**
+             * The error code used to report ingest session errors.
+             */
+            static constexpr int reportedErrorCode = 24;
+
+            IngestSessionError();
+
+            /**
+             * Copy constructor
+             *
+             * \param[in] other The instance to be copied.
+             */
+            IngestSessionError(const Status& other);
+
+            ~IngestSessionError();
+
+        private:
+            class Pimpl;
+    };
 };
 
 #endif
@@ -288,6 +288,17 @@ namespace Container {
                      */
                     virtual std::string description() const = 0;
 
+                    /**
+                     * Method you can overload to report a textual description of the status condition when this pimpl
+                     * is shared between status instances that each carry their own value.
+                     *
+                     * \param[in] value The value stored with the status instance.
+                     *
+                     * \return Returns a textual description of the error condition.  The default implementation returns
+                     *         the value reported by \ref Container::Status::PimplBase::description.
+                     */
+                    virtual std::string valueDescription(unsigned long long value) const;
+
                     /**
                      * Method you should overload to indicates if this status condition has additional details.
                      *
@@ -350,6 +361,18 @@ namespace Container {
              */
             Status(PimplBase* pimpl);
 
+            /**
+             * Constructor used to create derived status instances that share a single, statically allocated, pimpl.
+             * Instances created this way never allocate memory, making them suitable for status conditions reported
+             * on every read or write.  Any per-instance information must fit in the supplied value.
+             *
+             * \param[in] pimpl The shared pimpl instance.  The pimpl must outlive every status instance using it.
+             *
+             * \param[in] value An optional value stored with this status instance.  Use
+             *                  \ref Container::Status::inlineValue to obtain the value.
+             */
+            explicit Status(PimplBase& pimpl, unsigned long long value = 0);
+
             /**
              * Method you can use to gain access to the underlying pimpl.
              *
@@ -364,11 +387,24 @@ namespace Container {
              */
             std::shared_ptr<PimplBase> pimpl() const;
 
+            /**
+             * Method you can use to obtain the value stored with this status instance.
+             *
+             * \return Returns the value supplied to \ref Container::Status::Status(PimplBase&, unsigned long long).
+             *         A value of 0 is returned for status instances with an allocated pimpl.
+             */
+            unsigned long long inlineValue() const;
+
         private:
             /**
              * Pimpl.
              */
             std::shared_ptr<PimplBase> impl;
+
+            /**
+             * Value stored with status instances that share a statically allocated pimpl.
+             */
+            unsigned long long currentValue;
     };
 };
 
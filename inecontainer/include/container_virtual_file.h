@@ -27,9 +27,13 @@
 
 #include <cstdint>
 #include <memory>
+#include <vector>
+#include <utility>
 
 #include "container_status.h"
 
+class VirtualFileImpl;
+
 namespace Container {
     class Container;
 
@@ -45,9 +49,18 @@ namespace Container {
      *         - \ref Container::VirtualFile::setPositionLast
      *         - \ref Container::VirtualFile::position
      *         - \ref Container::VirtualFile::read
+     *         - \ref Container::VirtualFile::readView
+     *         - \ref Container::VirtualFile::readAt
      *         - \ref Container::VirtualFile::write
+     *         - \ref Container::VirtualFile::readv
+     *         - \ref Container::VirtualFile::writev
+     *         - \ref Container::VirtualFile::writeAt
+     *         - \ref Container::VirtualFile::reserve
      *         - \ref Container::VirtualFile::truncate
      *         - \ref Container::VirtualFile::flush
+     *         - \ref Container::VirtualFile::setCompression
+     *         - \ref Container::VirtualFile::setWriteCacheSize
+     *         - \ref Container::VirtualFile::setReadCacheSize
      *
      *     * You can also use this class to provide a streaming API to write data to a newly created container.  For
      *       the write streaming API, you should use the methods:
@@ -82,6 +95,136 @@ namespace Container {
             VirtualFile(const std::string& newName, Container* container);
 
         public:
+            /**
+             * Enumeration of supported compression settings.  Compressed files are stored as independently compressed
+             * extents of up to 64 KiBytes so random access remains possible.  Extents that do not compress well are
+             * stored uncompressed.
+             */
+            enum class Compression {
+                /**
+                 * Indicates data is stored uncompressed.
+                 */
+                NONE,
+
+                /**
+                 * Indicates data is compressed using a fast LZ compressor.
+                 */
+                FAST,
+
+                /**
+                 * Indicates data is compressed using a slower compressor that searches harder for matches.
+                 */
+                HIGH_RATIO
+            };
+
+            /**
+             * Type used to describe a buffer used by \ref Container::VirtualFile::readv.  The first member points to
+             * the buffer and the second member holds the buffer size, in bytes.
+             */
+            typedef std::pair<std::uint8_t*, unsigned> ReadBuffer;
+
+            /**
+             * Type used to describe a buffer used by \ref Container::VirtualFile::writev.  The first member points to
+             * the buffer and the second member holds the buffer size, in bytes.
+             */
+            typedef std::pair<const std::uint8_t*, unsigned> WriteBuffer;
+
+            /**
+             * Class that holds a read-only view of a range of a virtual file.  The view is made up of one or more
+             * spans.  Where the container supports pinning, spans reference the container's data store directly.
+             * Other data is copied into memory owned by the view.
+             *
+             * Spans remain valid until the view is released or destroyed.  Copies of a view share the same spans.
+             * Writing to the container while a view is held may change or invalidate spans that reference the
+             * container's data store directly.
+             */
+            class View {
+                friend class ::VirtualFileImpl;
+
+                public:
+                    View();
+
+                    /**
+                     * Copy constructor.
+                     *
+                     * \param[in] other The instance to be copied.
+                     */
+                    View(const View& other);
+
+                    ~View();
+
+                    /**
+                     * Method that returns the number of spans in the view.
+                     *
+                     * \return Returns the number of spans.
+                     */
+                    unsigned numberSpans() const;
+
+                    /**
+                     * Method that returns a pointer to the data held in a span.
+                     *
+                     * \param[in] index The zero based index of the span.
+                     *
+                     * \return Returns a pointer to the span data.  A null pointer is returned if the index is invalid.
+                     */
+                    const std::uint8_t* spanData(unsigned index) const;
+
+                    /**
+                     * Method that returns the length of a span.
+                     *
+                     * \param[in] index The zero based index of the span.
+                     *
+                     * \return Returns the span length, in bytes.  A value of 0 is returned if the index is invalid.
+                     */
+                    unsigned spanLength(unsigned index) const;
+
+                    /**
+                     * Method that returns the total number of bytes in the view.
+                     *
+                     * \return Returns the number of bytes covered by all spans.
+                     */
+                    unsigned long long size() const;
+
+                    /**
+                     * Method that releases all spans, unpinning any data held by the view.
+                     */
+                    void release();
+
+                    /**
+                     * Assignment operator.
+                     *
+                     * \param[in] other The instance to be copied.
+                     *
+                     * \return Returns a reference to this object.
+                     */
+                    View& operator=(const View& other);
+
+                private:
+                    /**
+                     * Method that appends a span to the view.
+                     *
+                     * \param[in] data   Pointer to the first byte of the span.  The pointer keeps the span pinned.
+                     *
+                     * \param[in] length The length of the span, in bytes.
+                     */
+                    void append(std::shared_ptr<const std::uint8_t> data, unsigned length);
+
+                    /**
+                     * The pinned span data.
+                     */
+                    std::vector<std::shared_ptr<const std::uint8_t>> spans;
+
+                    /**
+                     * The span lengths.
+                     */
+                    std::vector<unsigned> lengths;
+
+                    /**
+                     * The total number of bytes in the view.
+                     */
+                    unsigned long long totalBytes;
+            };
+
             /**
              * Copy constructor.  Note that copies of this virtual file will operate on the same underlying file and
              * will remain in sync with each other.
@@ -152,6 +295,38 @@ namespace Container {
              */
             Status read(std::uint8_t* buffer, unsigned desiredCount);
 
+            /**
+             * Method that reads a specified number of bytes of data from the container, if available, without copying
+             * the data into a caller supplied buffer.  Data that can be accessed in place is returned as spans
+             * referencing the container's data store.  The file position is advanced as it would be by
+             * \ref Container::VirtualFile::read.
+             *
+             * \param[in]     desiredCount The number of bytes that should be read, if possible.
+             *
+             * \param[in,out] view         The view to receive the data.  Any spans already held by the view are
+             *                             released.
+             *
+             * \return Returns the status from the read operation.  On success an instance of
+             *         \ref Container::ReadSuccessful is returned.
+             */
+            Status readView(unsigned desiredCount, View& view);
+
+            /**
+             * Method that reads data from a specified offset without using or changing the file position.  You can use
+             * this method to interleave reads of different ranges of the file without calling
+             * \ref Container::VirtualFile::setPosition.
+             *
+             * \param[in] offset       The offset of the first byte to be read.
+             *
+             * \param[in] buffer       The buffer to receive the data.
+             *
+             * \param[in] desiredCount The number of bytes that should be read, if possible.
+             *
+             * \return Returns the status from the read operation.  On success an instance of
+             *         \ref Container::ReadSuccessful is returned.
+             */
+            Status readAt(unsigned long long offset, std::uint8_t* buffer, unsigned desiredCount);
+
             /**
              * Method that writes a specified number of bytes of data.  You can use this method either during
              * random access or when streaming data to a virtual file in a container.
@@ -165,6 +340,21 @@ namespace Container {
              */
             Status write(const std::uint8_t* buffer, unsigned count);
 
+            /**
+             * Method that writes data at a specified offset without using or changing the file position.
+             *
+             * \param[in] offset The offset of the first byte to be written.  The offset can not be past the end of the
+             *                   file.
+             *
+             * \param[in] buffer The buffer holding the data to write.
+             *
+             * \param[in] count  The number of bytes to be written.
+             *
+             * \return Returns the status from the write operation.  On success an instance of
+             *         \ref Container::WriteSuccessful is returned.
+             */
+            Status writeAt(unsigned long long offset, const std::uint8_t* buffer, unsigned count);
+
             /**
              * Method that appends a specified number of bytes of data to the end of the virtual file.  Calling this
              * method is the same as calling \ref Container::VirtualFile::setPositionLast followed by
@@ -179,13 +369,73 @@ namespace Container {
              */
             Status append(const std::uint8_t* buffer, unsigned count);
 
+            /**
+             * Method that reads data into a list of buffers.  Buffers are filled in order and reading stops at the
+             * end of the file.
+             *
+             * \param[in] buffers       The buffers to receive the data.
+             *
+             * \param[in] numberBuffers The number of buffers.
+             *
+             * \return Returns the status from the read operation.  On success an instance of
+             *         \ref Container::ReadSuccessful is returned holding the total number of bytes read.
+             */
+            Status readv(const ReadBuffer* buffers, unsigned numberBuffers);
+
+            /**
+             * Method that writes data held in a list of buffers as a single operation.  Data written past the end of
+             * the file is gathered directly from the buffers into the container.
+             *
+             * \param[in] buffers       The buffers holding the data to write.
+             *
+             * \param[in] numberBuffers The number of buffers.
+             *
+             * \return Returns the status from the write operation.  On success an instance of
+             *         \ref Container::WriteSuccessful is returned holding the total number of bytes written.
+             */
+            Status writev(const WriteBuffer* buffers, unsigned numberBuffers);
+
+            /**
+             * Method that writes data held in a buffer, taking ownership of the buffer.  Files that stage data for
+             * compression or deduplication adopt the buffer rather than copy it when appending.
+             *
+             * \param[in] buffer The buffer holding the data to write.  The buffer is left empty.
+             *
+             * \return Returns the status from the write operation.  On success an instance of
+             *         \ref Container::WriteSuccessful is returned.
+             */
+            Status write(std::vector<std::uint8_t>&& buffer);
+
+            /**
+             * Method that reserves a contiguous area of the container for data to be appended to this file.  Appended
+             * data is placed in the reserved area so files written at the same time are not interleaved in the
+             * container.  Unused space is released when the file is flushed or the container is closed.
+             *
+             * \param[in] expectedSize The expected number of bytes to be appended.  A value of 0 releases any current
+             *                         reservation.
+             *
+             * \return Returns the status from the operation.
+             */
+            Status reserve(unsigned long long expectedSize);
+
+            /**
+             * Method that returns the unused space remaining in this file's reserved area.
+             *
+             * \return Returns the remaining reserved space, in bytes.
+             */
+            unsigned long long bytesReserved() const;
+
             /**
              * Method that truncates the file at the current position.  All data after the current position will be
-             * discarded.
+             * discarded.  By default the space used by the discarded data is released using the locations already
+             * known to the virtual file so the cost depends on the number of extents rather than the amount of data.
+             *
+             * \param[in] verify If true, each discarded chunk is read back and checked against the expected stream
+             *                   and offset before its space is released.
              *
              * \return Returns the status from the truncation operation.
              */
-            Status truncate();
+            Status truncate(bool verify = false);
 
             /**
              * Method that flushes any pending write data to the media.
@@ -196,11 +446,17 @@ namespace Container {
 
             /**
              * Method that deletes this file.  This virtual file object will no longer be valid after calling this
-             * method.
+             * method.  By default the file's space is released using the locations already known to the virtual
+             * file and the released space is marked on the media when the container is closed.  The cost of an
+             * erase therefore depends on the number of extents rather than the size of the file.
+             *
+             * \param[in] verify If true, each chunk is read back and checked against the expected stream and offset
+             *                   before its space is released and the released space is marked on the media
+             *                   immediately.
              *
              * \return Returns the status from the erase operation.
              */
-            Status erase();
+            Status erase(bool verify = false);
 
             /**
              * Method that renames this file.
@@ -211,6 +467,78 @@ namespace Container {
              */
             Status rename(const std::string& newName);
 
+            /**
+             * Method that selects how data written to this file is compressed.  The setting applies to data written
+             * after the call and is not stored in the container.  Compression requires container minor version 3 or
+             * later.  Data written to older containers is always stored uncompressed.
+             *
+             * \param[in] newCompression The new compression setting.
+             *
+             * \return Returns the status from the operation.  Pending data is flushed when the setting changes.
+             */
+            Status setCompression(Compression newCompression);
+
+            /**
+             * Method that returns the current compression setting.
+             *
+             * \return Returns the current compression setting.
+             */
+            Compression compression() const;
+
+            /**
+             * Method that sets the amount of modified data this file may hold in memory.  Chunks modified by random
+             * writes are held in a write-back cache and written to the container, in container order, when the file is
+             * flushed or when the cache fills.  By default up to 256 KiBytes are cached.  A value of 0 causes modified
+             * chunks to be written as soon as the file moves to another chunk.
+             *
+             * Appended data is held up to the same limit and is only assigned space in the container when it is
+             * written.  Each run of appended data is placed in a single free region so files appended to at the same
+             * time are not interleaved.  Appended data is written in 4 KiByte chunks as it arrives if the write cache
+             * is smaller than 4 KiBytes.
+             *
+             * \param[in] newSize The new write cache size, in bytes.
+             *
+             * \return Returns the status from the operation.  Cached data is flushed if it no longer fits in the cache.
+             */
+            Status setWriteCacheSize(unsigned long long newSize);
+
+            /**
+             * Method that returns the current write cache size.
+             *
+             * \return Returns the write cache size, in bytes.
+             */
+            unsigned long long writeCacheSize() const;
+
+            /**
+             * Method that sets the number of decoded chunks this file keeps in memory for reads.  Recently used chunks
+             * are kept so reads that alternate between a few regions of the file do not reload the same chunks.  By
+             * default up to 4 chunks are cached.  A value of 0 disables the read cache.
+             *
+             * \param[in] numberChunks The new read cache size, in chunks.
+             */
+            void setReadCacheSize(unsigned numberChunks);
+
+            /**
+             * Method that returns the current read cache size.
+             *
+             * \return Returns the read cache size, in chunks.
+             */
+            unsigned readCacheSize() const;
+
+            /**
+             * Method that returns the number of chunk loads satisfied by the read cache.
+             *
+             * \return Returns the number of read cache hits.
+             */
+            unsigned long long readCacheHits() const;
+
+            /**
+             * Method that returns the number of chunk loads that required access to the container.
+             *
+             * \return Returns the number of read cache misses.
+             */
+            unsigned long long readCacheMisses() const;
+
             /**
              * Method that can be used to make a shallow copy of this virtual file.  Like the copy constructor, copies
              * of this virtual file will operate on the same underlying file and will remain in sync with each other.
@@ -57,7 +57,11 @@ SOURCES = source/container_status_base.cpp \
           source/free_space.cpp \
           source/free_space_tracker.cpp \
           source/chunk_map_data.cpp \
+          source/shared_chunk_data.cpp \
+          source/directory_record.cpp \
           source/scatter_gather_list_segment.cpp \
+          source/crc_engine.cpp \
+          source/compression_engine.cpp \
           source/chunk_header.cpp \
           source/chunk.cpp \
           source/file_header_chunk.cpp \
@@ -83,7 +87,11 @@ PRIVATE_HEADERS = source/container_impl.h \
                   source/free_space_tracker.h \
                   source/ring_buffer.h \
                   source/chunk_map_data.h \
+                  source/shared_chunk_data.h \
+                  source/directory_record.h \
                   source/scatter_gather_list_segment.h \
+                  source/crc_engine.h \
+                  source/compression_engine.h \
                   source/chunk_header.h \
                   source/chunk.h \
                   source/file_header_chunk.h \
@@ -30,23 +30,23 @@
 #include "chunk_header.h"
 #include "chunk.h"
 
-std::uint32_t Chunk::randomSeed = 0;
+const std::uint8_t Chunk::zeroPage[Chunk::zeroPageSizeBytes] = { 0 };
 
 Chunk::Chunk(
-        std::weak_ptr<ContainerImpl> container,
+        ContainerImpl&               container,
         ChunkHeader::FileIndex       fileIndex,
         unsigned                     additionalChunkHeaderSizeBytes
     ):ChunkHeader(
         additionalChunkHeaderSizeBytes
     ) {
-    currentContainer  = container;
+    currentContainer  = &container;
     currentFileIndex  = fileIndex;
     numberLoadedBytes = 0;
 }
 
 
 Chunk::Chunk(
-        std::weak_ptr<ContainerImpl> container,
+        ContainerImpl&               container,
         ChunkHeader::FileIndex       fileIndex,
         std::uint8_t                 commonHeader[Chunk::minimumChunkHeaderSizeBytes],
         unsigned                     additionalHeaderBytes
@@ -54,20 +54,20 @@ Chunk::Chunk(
         commonHeader,
         additionalHeaderBytes
     ) {
-    currentContainer  = container;
+    currentContainer  = &container;
     currentFileIndex  = fileIndex;
     numberLoadedBytes = 0;
 }
 
 
 Chunk::Chunk(
-        std::weak_ptr<ContainerImpl> container,
+        ContainerImpl&               container,
         ChunkHeader::FileIndex       fileIndex,
         std::uint8_t                 commonHeader[Chunk::minimumChunkHeaderSizeBytes]
     ):ChunkHeader(
         commonHeader
     ) {
-    currentContainer  = container;
+    currentContainer  = &container;
     currentFileIndex  = fileIndex;
     numberLoadedBytes = 0;
 }
@@ -86,8 +86,8 @@ ChunkHeader::FileIndex Chunk::fileIndex() const {
 }
 
 
-std::weak_ptr<ContainerImpl> Chunk::container() const {
-    return currentContainer;
+ContainerImpl& Chunk::container() const {
+    return *currentContainer;
 }
 
 
@@ -98,23 +98,39 @@ Container::Status Chunk::load(bool includeCommonHeader) {
     unsigned           bytesToLoad;
     std::uint8_t*      basePointer;
 
-    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
-    assert(container);
+    ContainerImpl& container = *currentContainer;
 
     if (includeCommonHeader) {
+        // We don't know the chunk layout until the common header is read so we start by assuming a standard chunk
+        // and then pick up the remaining bytes if the chunk turns out to be an extended chunk.
+
+        resizeCommonHeader(minimumChunkHeaderSizeBytes, false);
+
         offset      = toPosition(currentFileIndex);
         bytesToLoad = fullHeaderSizeBytes();
         basePointer = fullHeader();
     } else {
         offset      = toPosition(currentFileIndex) + minimumChunkHeaderSizeBytes;
-        bytesToLoad = additionalHeaderSizeBytes();
-        basePointer = additionalHeader();
+        bytesToLoad = fullHeaderSizeBytes() - minimumChunkHeaderSizeBytes;
+        basePointer = fullHeader() + minimumChunkHeaderSizeBytes;
     }
 
-    status = container->setPosition(offset);
+    status = container.setPosition(offset);
 
     if (!status) {
-        status = container->read(basePointer, bytesToLoad);
+        status = container.read(basePointer, bytesToLoad);
+        if (status.success() && Container::ReadSuccessful(status).bytesRead() == bytesToLoad) {
+            status = Container::NoStatus();
+        }
+    }
+
+    if (!status && includeCommonHeader && isExtended()) {
+        resizeCommonHeader(minimumChunkHeaderSizeBytes + extendedChunkHeaderSizeBytes, false);
+
+        bytesToLoad = extendedChunkHeaderSizeBytes;
+        basePointer = fullHeader() + fullHeaderSizeBytes() - extendedChunkHeaderSizeBytes;
+
+        status = container.read(basePointer, bytesToLoad);
         if (status.success() && Container::ReadSuccessful(status).bytesRead() == bytesToLoad) {
             status = Container::NoStatus();
         }
@@ -127,15 +143,15 @@ Container::Status Chunk::load(bool includeCommonHeader) {
 Container::Status Chunk::save(bool padToChunkSize) {
     Container::Status status;
 
-    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
-    assert(container);
+    ContainerImpl& container = *currentContainer;
 
-    status = container->setPosition(toPosition(currentFileIndex));
+    container.forgetVerifiedChunks(currentFileIndex);
+    status = container.setPosition(toPosition(currentFileIndex));
 
     if (!status) {
         updateCrc();
 
-        status = container->write(fullHeader(), fullHeaderSizeBytes());
+        status = container.write(fullHeader(), fullHeaderSizeBytes());
         if (status.success() && Container::WriteSuccessful(status).bytesWritten() == fullHeaderSizeBytes()) {
             status = Container::NoStatus();
         }
@@ -149,6 +165,19 @@ Container::Status Chunk::save(bool padToChunkSize) {
 }
 
 
+unsigned Chunk::render(std::uint8_t* buffer) {
+    updateCrc();
+
+    unsigned headerSize = fullHeaderSizeBytes();
+    unsigned totalSize  = chunkSize();
+
+    std::memcpy(buffer, fullHeader(), headerSize);
+    std::memset(buffer + headerSize, 0, totalSize - headerSize);
+
+    return totalSize;
+}
+
+
 bool Chunk::checkCrc() const {
     return crc() == initializeCrc();
 }
@@ -162,38 +191,42 @@ void Chunk::updateCrc() {
 Container::Status Chunk::writeTail(unsigned additionalBytes) {
     Container::Status status;
 
-    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
-    assert(container);
+    ContainerImpl& container = *currentContainer;
+
+    unsigned long long currentPosition = container.position();
 
     if (additionalBytes == 0) {
-        unsigned long long currentPosition = container->position();
-        unsigned long long chunkEnd        = ChunkHeader::toPosition(currentFileIndex) + chunkSize();
+        unsigned long long chunkEnd = ChunkHeader::toPosition(currentFileIndex) + chunkSize();
 
         assert(currentPosition <= chunkEnd);
         assert(chunkEnd - currentPosition <= static_cast<unsigned>(-1));
         additionalBytes = static_cast<unsigned>(chunkEnd - currentPosition);
     }
 
-    if (additionalBytes > 0) {
-        unsigned       writeBuffer32Size = (additionalBytes + 3) / 4;
-        std::uint32_t* writeBuffer32     = new std::uint32_t[writeBuffer32Size];
+    if (additionalBytes > 0 && container.paddingFreeWrites()) {
+        // The contents of the tail are never read so we only need to write the portion of the tail that extends the
+        // container.  Space already in the container is left as-is.
 
-        for (unsigned i=0 ; i<writeBuffer32Size ; ++i) {
-            randomSeed = (kla * randomSeed) + klc; // Knuth-Lewis PRNG -- Extremely fast and good enough.
-            writeBuffer32[i] = randomSeed;
-        }
+        unsigned long long containerSize = static_cast<unsigned long long>(container.size());
+        unsigned long long tailEnd       = currentPosition + additionalBytes;
 
-        std::shared_ptr<ContainerImpl> container = currentContainer.lock();
-        assert(container);
+        if (tailEnd <= containerSize) {
+            additionalBytes = 0;
+        } else if (currentPosition < containerSize) {
+            status          = container.setPosition(containerSize);
+            additionalBytes = static_cast<unsigned>(tailEnd - containerSize);
+        }
+    }
 
-        std::uint8_t* writeBuffer = reinterpret_cast<std::uint8_t*>(writeBuffer32);
+    while (!status && additionalBytes > 0) {
+        unsigned bytesToWrite = additionalBytes < zeroPageSizeBytes ? additionalBytes : zeroPageSizeBytes;
 
-        status = container->write(writeBuffer, additionalBytes);
-        if (status.success() && Container::WriteSuccessful(status).bytesWritten() == additionalBytes) {
+        status = container.write(zeroPage, bytesToWrite);
+        if (status.success() && Container::WriteSuccessful(status).bytesWritten() == bytesToWrite) {
             status = Container::NoStatus();
         }
 
-        delete[] writeBuffer32;
+        additionalBytes -= bytesToWrite;
     }
 
     return status;
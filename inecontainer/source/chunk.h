@@ -47,7 +47,7 @@ class Chunk:public ChunkHeader {
          *
          * \param[in] additionalChunkHeaderSizeBytes The number of additional bytes in the chunk header.
          */
-        Chunk(std::weak_ptr<ContainerImpl> container, FileIndex fileIndex, unsigned additionalChunkHeaderSizeBytes = 0);
+        Chunk(ContainerImpl& container, FileIndex fileIndex, unsigned additionalChunkHeaderSizeBytes = 0);
 
         /**
          * Constructor.
@@ -61,7 +61,7 @@ class Chunk:public ChunkHeader {
          * \param[in] additionalHeaderBytes The number of additional bytes in the chunk header.
          */
         Chunk(
-            std::weak_ptr<ContainerImpl> container,
+            ContainerImpl&               container,
             FileIndex                    fileIndex,
             std::uint8_t                 commonHeader[Chunk::minimumChunkHeaderSizeBytes],
             unsigned                     additionalHeaderBytes
@@ -77,7 +77,7 @@ class Chunk:public ChunkHeader {
          * \param[in] commonHeader Array holding header data common to all chunk types.
          */
         Chunk(
-            std::weak_ptr<ContainerImpl> container,
+            ContainerImpl&               container,
             FileIndex                    fileIndex,
             std::uint8_t                 commonHeader[Chunk::minimumChunkHeaderSizeBytes]
         );
@@ -101,9 +101,9 @@ class Chunk:public ChunkHeader {
         /**
          * Method that returns the container where this chunk resides.
          *
-         * \return Returns a pointer to the container associated with this chunk.
+         * \return Returns a reference to the container associated with this chunk.
          */
-        std::weak_ptr<ContainerImpl> container() const;
+        ContainerImpl& container() const;
 
         /**
          * Method that loads a chunk into memory from the container.  The default implementation loads the additional
@@ -133,6 +133,17 @@ class Chunk:public ChunkHeader {
          */
         virtual Container::Status save(bool padToChunkSize = true);
 
+        /**
+         * Method that places the chunk into a memory buffer rather than writing it to the container.  The buffer
+         * receives the same bytes that \ref Chunk::save would write, including the padding at the end of the chunk.
+         * The default implementation assumes all valid data is contained in the header.
+         *
+         * \param[in] buffer The buffer to receive the chunk.  The buffer must be able to hold \ref chunkSize bytes.
+         *
+         * \return Returns the number of bytes placed into the buffer.
+         */
+        virtual unsigned render(std::uint8_t* buffer);
+
         /**
          * Method that checks if the CRC is valid.  This version assumes that the entire chunk contents are contained
          * within the additional header data.
@@ -148,7 +159,8 @@ class Chunk:public ChunkHeader {
 
         /**
          * Method that can be called by the \ref Chunk::save method and overloaded versions of that method to write
-         * random data at the end of the chunk to fill the chunk out to full size.
+         * zeros at the end of the chunk to fill the chunk out to full size.  If the container has padding-free writes
+         * enabled, only the portion of the tail that extends the container is written.
          *
          * \param[in] additionalBytes The number of additional bytes to write.  A value of 0, the default, will cause
          *                            this method to calculate the number of bytes that must be written.
@@ -159,19 +171,14 @@ class Chunk:public ChunkHeader {
 
     private:
         /**
-         * Knuth-Lewis PRNG multiplier
-         */
-        static constexpr std::uint32_t kla = 1664525;
-
-        /**
-         * Knuth-Lewis PRNG offset.
+         * The size of the page of zeros used to pad chunk tails.
          */
-        static constexpr std::uint32_t klc = 1013904223;
+        static constexpr unsigned zeroPageSizeBytes = 4096;
 
         /**
-         * Seed used to generate random data for chunk tails.
+         * Page of zeros used to pad chunk tails.
          */
-        static std::uint32_t randomSeed;
+        static const std::uint8_t zeroPage[zeroPageSizeBytes];
 
         /**
          * The file idnex where the chunk begins.
@@ -179,9 +186,10 @@ class Chunk:public ChunkHeader {
         FileIndex currentFileIndex;
 
         /**
-         * Container used for file access.
+         * Container used for file access.  Chunks are transient objects used while the caller holds the container so
+         * no ownership is taken.
          */
-        std::weak_ptr<ContainerImpl> currentContainer;
+        ContainerImpl* currentContainer;
 
         /**
          * The number of bytes of the chunk that are currently loaded.
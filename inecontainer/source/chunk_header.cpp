@@ -24,6 +24,7 @@
 #include <cstring>
 #include <cassert>
 
+#include "crc_engine.h"
 #include "chunk_header.h"
 
 const unsigned char ChunkHeader::mulDeBruijnBitTable[32] = {
@@ -32,47 +33,10 @@ const unsigned char ChunkHeader::mulDeBruijnBitTable[32] = {
     8, 12, 20, 28, 15, 17, 24,  7, 19, 27, 23,  6, 26,  5,  4, 31  // +16
 };
 
-const std::uint16_t ChunkHeader::crcTable[256] = {
-//    +0      +1      +2      +3      +4      +5      +6      +7
-//  ------  ------  ------  ------  ------  ------  ------  ------
-    0x0000, 0x8005, 0x800F, 0x000A, 0x801B, 0x001E, 0x0014, 0x8011, //   +0
-    0x8033, 0x0036, 0x003C, 0x8039, 0x0028, 0x802D, 0x8027, 0x0022, //   +8
-    0x8063, 0x0066, 0x006C, 0x8069, 0x0078, 0x807D, 0x8077, 0x0072, //  +16
-    0x0050, 0x8055, 0x805F, 0x005A, 0x804B, 0x004E, 0x0044, 0x8041, //  +24
-    0x80C3, 0x00C6, 0x00CC, 0x80C9, 0x00D8, 0x80DD, 0x80D7, 0x00D2, //  +32
-    0x00F0, 0x80F5, 0x80FF, 0x00FA, 0x80EB, 0x00EE, 0x00E4, 0x80E1, //  +40
-    0x00A0, 0x80A5, 0x80AF, 0x00AA, 0x80BB, 0x00BE, 0x00B4, 0x80B1, //  +48
-    0x8093, 0x0096, 0x009C, 0x8099, 0x0088, 0x808D, 0x8087, 0x0082, //  +56
-    0x8183, 0x0186, 0x018C, 0x8189, 0x0198, 0x819D, 0x8197, 0x0192, //  +64
-    0x01B0, 0x81B5, 0x81BF, 0x01BA, 0x81AB, 0x01AE, 0x01A4, 0x81A1, //  +72
-    0x01E0, 0x81E5, 0x81EF, 0x01EA, 0x81FB, 0x01FE, 0x01F4, 0x81F1, //  +80
-    0x81D3, 0x01D6, 0x01DC, 0x81D9, 0x01C8, 0x81CD, 0x81C7, 0x01C2, //  +88
-    0x0140, 0x8145, 0x814F, 0x014A, 0x815B, 0x015E, 0x0154, 0x8151, //  +96
-    0x8173, 0x0176, 0x017C, 0x8179, 0x0168, 0x816D, 0x8167, 0x0162, // +104
-    0x8123, 0x0126, 0x012C, 0x8129, 0x0138, 0x813D, 0x8137, 0x0132, // +112
-    0x0110, 0x8115, 0x811F, 0x011A, 0x810B, 0x010E, 0x0104, 0x8101, // +120
-    0x8303, 0x0306, 0x030C, 0x8309, 0x0318, 0x831D, 0x8317, 0x0312, // +128
-    0x0330, 0x8335, 0x833F, 0x033A, 0x832B, 0x032E, 0x0324, 0x8321, // +136
-    0x0360, 0x8365, 0x836F, 0x036A, 0x837B, 0x037E, 0x0374, 0x8371, // +144
-    0x8353, 0x0356, 0x035C, 0x8359, 0x0348, 0x834D, 0x8347, 0x0342, // +152
-    0x03C0, 0x83C5, 0x83CF, 0x03CA, 0x83DB, 0x03DE, 0x03D4, 0x83D1, // +160
-    0x83F3, 0x03F6, 0x03FC, 0x83F9, 0x03E8, 0x83ED, 0x83E7, 0x03E2, // +168
-    0x83A3, 0x03A6, 0x03AC, 0x83A9, 0x03B8, 0x83BD, 0x83B7, 0x03B2, // +176
-    0x0390, 0x8395, 0x839F, 0x039A, 0x838B, 0x038E, 0x0384, 0x8381, // +184
-    0x0280, 0x8285, 0x828F, 0x028A, 0x829B, 0x029E, 0x0294, 0x8291, // +192
-    0x82B3, 0x02B6, 0x02BC, 0x82B9, 0x02A8, 0x82AD, 0x82A7, 0x02A2, // +200
-    0x82E3, 0x02E6, 0x02EC, 0x82E9, 0x02F8, 0x82FD, 0x82F7, 0x02F2, // +208
-    0x02D0, 0x82D5, 0x82DF, 0x02DA, 0x82CB, 0x02CE, 0x02C4, 0x82C1, // +216
-    0x8243, 0x0246, 0x024C, 0x8249, 0x0258, 0x825D, 0x8257, 0x0252, // +224
-    0x0270, 0x8275, 0x827F, 0x027A, 0x826B, 0x026E, 0x0264, 0x8261, // +232
-    0x0220, 0x8225, 0x822F, 0x022A, 0x823B, 0x023E, 0x0234, 0x8231, // +240
-    0x8213, 0x0216, 0x021C, 0x8219, 0x0208, 0x820D, 0x8207, 0x0202  // +248
-};
-
-
 ChunkHeader::ChunkHeader(unsigned additionalChunkHeaderSizeBytes) {
-    headerSize = minimumChunkHeaderSizeBytes + additionalChunkHeaderSizeBytes;
-    header = new std::uint8_t[headerSize];
+    commonHeaderSize = minimumChunkHeaderSizeBytes;
+    headerSize       = minimumChunkHeaderSizeBytes + additionalChunkHeaderSizeBytes;
+    header           = allocateHeader(headerSize);
 
     header[0] = 0x80;
     header[1] = 0x03;
@@ -87,33 +51,53 @@ ChunkHeader::ChunkHeader(
         std::uint8_t commonHeader[ChunkHeader::minimumChunkHeaderSizeBytes],
         unsigned     additionalHeaderBytes
     ) {
-    headerSize = additionalHeaderBytes + minimumChunkHeaderSizeBytes;
-    header = new std::uint8_t[headerSize];
+    if (isExtendedHeader(commonHeader)) {
+        commonHeaderSize = minimumChunkHeaderSizeBytes + extendedChunkHeaderSizeBytes;
+    } else {
+        commonHeaderSize = minimumChunkHeaderSizeBytes;
+    }
+
+    headerSize = additionalHeaderBytes + commonHeaderSize;
+    header     = allocateHeader(headerSize);
+
     memcpy(header, commonHeader, minimumChunkHeaderSizeBytes);
+    memset(header + minimumChunkHeaderSizeBytes, 0, headerSize - minimumChunkHeaderSizeBytes);
 }
 
 
 ChunkHeader::ChunkHeader(std::uint8_t commonHeader[ChunkHeader::minimumChunkHeaderSizeBytes]) {
-    unsigned sp2                = (commonHeader[0] >> 2) & 0x07;
-    unsigned numberInvalidBytes = (static_cast<unsigned>(commonHeader[1]) << 3) | ((commonHeader[0] >> 5) & 0x07);
-    unsigned chunkSize          = 1 << (sp2 + 5);
+    if (isExtendedHeader(commonHeader)) {
+        // The valid byte count of an extended chunk is not known until the extended header is loaded.  We only track
+        // the common header for these chunks.
 
-    headerSize = chunkSize - numberInvalidBytes;
-    header = new std::uint8_t[headerSize];
+        commonHeaderSize = minimumChunkHeaderSizeBytes + extendedChunkHeaderSizeBytes;
+        headerSize       = commonHeaderSize;
+    } else {
+        unsigned sp2                = (commonHeader[0] >> 2) & 0x07;
+        unsigned numberInvalidBytes = (static_cast<unsigned>(commonHeader[1]) << 3) | ((commonHeader[0] >> 5) & 0x07);
+        unsigned chunkSize          = 1 << (sp2 + 5);
+
+        commonHeaderSize = minimumChunkHeaderSizeBytes;
+        headerSize       = chunkSize - numberInvalidBytes;
+    }
+
+    header = allocateHeader(headerSize);
 
     memcpy(header, commonHeader, minimumChunkHeaderSizeBytes);
+    memset(header + minimumChunkHeaderSizeBytes, 0, headerSize - minimumChunkHeaderSizeBytes);
 }
 
 
 ChunkHeader::ChunkHeader(const ChunkHeader& other) {
-    headerSize = other.headerSize;
-    header = new std::uint8_t[headerSize];
+    commonHeaderSize = other.commonHeaderSize;
+    headerSize       = other.headerSize;
+    header           = allocateHeader(headerSize);
     memcpy(header, other.header, headerSize);
 }
 
 
 ChunkHeader::~ChunkHeader() {
-    delete[] header;
+    releaseHeader(header);
 }
 
 
@@ -123,17 +107,28 @@ ChunkHeader::Type ChunkHeader::type() const {
 
 
 unsigned ChunkHeader::numberValidBytes() const {
-    unsigned numberInvalidBytes = (static_cast<unsigned>(header[1]) << 3) | ((header[0] >> 5) & 0x07);
-    return chunkSize() - numberInvalidBytes - minimumChunkHeaderSizeBytes;
+    return chunkSize() - numberInvalidBytes() - commonHeaderSize;
 }
 
 
 unsigned ChunkHeader::chunkSize() const {
-    unsigned sp2 = (header[0] >> 2) & 0x07;
+    unsigned sp2;
+
+    if (isExtendedHeader(header)) {
+        sp2 = ((static_cast<unsigned>(header[1]) << 3) | ((header[0] >> 5) & 0x07)) & 0x1F;
+    } else {
+        sp2 = (header[0] >> 2) & 0x07;
+    }
+
     return 1 << (sp2 + 5);
 }
 
 
+bool ChunkHeader::isExtended() const {
+    return isExtendedHeader(header);
+}
+
+
 void ChunkHeader::setCrc(RunningCrc newCrcValue) {
     header[2] = static_cast<std::uint8_t>(newCrcValue     );
     header[3] = static_cast<std::uint8_t>(newCrcValue >> 8);
@@ -198,12 +193,12 @@ unsigned ChunkHeader::fullHeaderSizeBytes() const {
 
 
 std::uint8_t* ChunkHeader::additionalHeader() const {
-    return header + minimumChunkHeaderSizeBytes;
+    return header + commonHeaderSize;
 }
 
 
 unsigned ChunkHeader::additionalHeaderSizeBytes() const {
-    return headerSize - minimumChunkHeaderSizeBytes;
+    return headerSize - commonHeaderSize;
 }
 
 
@@ -225,10 +220,10 @@ unsigned ChunkHeader::setNumberValidBytes(
     unsigned maximumPayloadSize;
     unsigned currentChunkSize = chunkSize();
 
-    if (canGrowChunkSize) {
+    if (canGrowChunkSize && currentChunkSize < maximumChunkSize) {
         maximumPayloadSize = maximumChunkSize - minimumChunkHeaderSizeBytes;
     } else {
-        maximumPayloadSize = currentChunkSize - minimumChunkHeaderSizeBytes;
+        maximumPayloadSize = currentChunkSize - commonHeaderSize;
     }
 
     if (newValidByteCount > maximumPayloadSize) {
@@ -241,19 +236,41 @@ unsigned ChunkHeader::setNumberValidBytes(
         requiredBits = 5;
     }
 
-    assert(requiredBits <= 5 + 7);
+    unsigned typeCode = header[0] & 0x03;
+    unsigned newChunkSize;
+
+    if (requiredBits <= 5 + 7) {
+        // Standard chunk.
+
+        resizeCommonHeader(minimumChunkHeaderSizeBytes);
 
-    unsigned newChunkSize = 1 << requiredBits;
+        newChunkSize = 1 << requiredBits;
+        assert(newChunkSize >= newValidByteCount + minimumChunkHeaderSizeBytes);
 
-    assert(newChunkSize >= newValidByteCount + minimumChunkHeaderSizeBytes);
+        unsigned      numberInvalidBytes = newChunkSize - newValidByteCount - minimumChunkHeaderSizeBytes;
+        std::uint16_t hdr                = typeCode | ((requiredBits - 5) << 2)  | (numberInvalidBytes << 5);
+
+        header[0] = static_cast<std::uint8_t>(hdr);
+        header[1] = static_cast<std::uint8_t>(hdr >> 8);
+    } else {
+        // Extended chunk.  The extended header may push us into the next larger chunk size.
 
-    unsigned numberInvalidBytes = newChunkSize - newValidByteCount - minimumChunkHeaderSizeBytes;
+        resizeCommonHeader(minimumChunkHeaderSizeBytes + extendedChunkHeaderSizeBytes);
 
-    unsigned      typeCode = header[0] & 0x03;
-    std::uint16_t hdr      = typeCode | ((requiredBits - 5) << 2)  | (numberInvalidBytes << 5);
+        requiredBits = log2(newValidByteCount + commonHeaderSize - 1) + 1;
+        newChunkSize = 1 << requiredBits;
+        assert(newChunkSize <= currentChunkSize);
 
-    header[0] = static_cast<std::uint8_t>(hdr);
-    header[1] = static_cast<std::uint8_t>(hdr >> 8);
+        std::uint32_t numberInvalidBytes = newChunkSize - newValidByteCount - commonHeaderSize;
+        std::uint16_t hdr                = typeCode | ((0x400 | (requiredBits - 5)) << 5);
+
+        header[0] = static_cast<std::uint8_t>(hdr);
+        header[1] = static_cast<std::uint8_t>(hdr >> 8);
+        header[4] = static_cast<std::uint8_t>(numberInvalidBytes      );
+        header[5] = static_cast<std::uint8_t>(numberInvalidBytes >>  8);
+        header[6] = static_cast<std::uint8_t>(numberInvalidBytes >> 16);
+        header[7] = static_cast<std::uint8_t>(numberInvalidBytes >> 24);
+    }
 
     if (chunkSizeChanged != nullptr) {
         *chunkSizeChanged = (newChunkSize != currentChunkSize);
@@ -263,37 +280,64 @@ unsigned ChunkHeader::setNumberValidBytes(
 }
 
 
-unsigned ChunkHeader::setBestFitSize(unsigned availableSpace) {
+unsigned ChunkHeader::setBestFitSize(unsigned availableSpace, bool allowExtended) {
     unsigned bestFitSize;
-    unsigned chunkP2;
+    unsigned requiredBits;
+
     if (availableSpace < minimumChunkSize) {
-        bestFitSize = 0;
-        chunkP2     = 0;
+        bestFitSize  = 0;
+        requiredBits = 5;
     } else {
-        unsigned requiredBits = log2(availableSpace);
-        if (requiredBits > 7 + 5) {
-            requiredBits = 7 + 5;
+        unsigned maximumBits = log2(allowExtended ? maximumExtendedChunkSize : maximumChunkSize);
+
+        requiredBits = log2(availableSpace);
+        if (requiredBits > maximumBits) {
+            requiredBits = maximumBits;
         }
 
         bestFitSize = 1 << requiredBits;
-        chunkP2     = requiredBits - 5;
     }
 
-    header[0] = (header[0] & 0xE3) | (chunkP2 << 2);
+    if (requiredBits <= 5 + 7) {
+        resizeCommonHeader(minimumChunkHeaderSizeBytes);
+        header[0] = (header[0] & 0xE3) | ((requiredBits - 5) << 2);
+    } else {
+        resizeCommonHeader(minimumChunkHeaderSizeBytes + extendedChunkHeaderSizeBytes);
+
+        std::uint16_t hdr = (header[0] & 0x03) | ((0x400 | (requiredBits - 5)) << 5);
+
+        header[0] = static_cast<std::uint8_t>(hdr);
+        header[1] = static_cast<std::uint8_t>(hdr >> 8);
+
+        setAllBytesValid();
+    }
 
     return bestFitSize;
 }
 
 
 void ChunkHeader::setAllBytesValid() {
-    header[0] = header[0] & 0x1F;
-    header[1] = 0;
+    if (isExtendedHeader(header)) {
+        header[4] = 0;
+        header[5] = 0;
+        header[6] = 0;
+        header[7] = 0;
+    } else {
+        header[0] = header[0] & 0x1F;
+        header[1] = 0;
+    }
 }
 
 
 ChunkHeader::RunningCrc ChunkHeader::initializeCrc() const {
+    // The CRC covers everything but the CRC itself, including the extended header, if present.
+
     RunningCrc currentCrc = (static_cast<RunningCrc>(header[1]) << 8) | header[0];
-    return calculateCrc(currentCrc, additionalHeader(), additionalHeaderSizeBytes());
+    return calculateCrc(
+        currentCrc,
+        header + minimumChunkHeaderSizeBytes,
+        headerSize - minimumChunkHeaderSizeBytes
+    );
 }
 
 
@@ -302,15 +346,7 @@ ChunkHeader::RunningCrc ChunkHeader::calculateCrc(
         const std::uint8_t*     data,
         unsigned                dataLength
     ) {
-    const std::uint8_t* endingByte = data + dataLength;
-    while (data != endingByte) {
-        RunningCrc xorValue = crcTable[currentCrc >> 8];
-        currentCrc = ((currentCrc << 8) | *data) ^ xorValue;
-
-        ++data;
-    }
-
-    return currentCrc;
+    return CrcEngine::calculate(currentCrc, data, dataLength);
 }
 
 
@@ -326,3 +362,73 @@ unsigned ChunkHeader::log2(std::uint32_t x) {
     std::uint32_t mul = x * 0x07C4ACDDUL;
     return mulDeBruijnBitTable[mul >> 27];
 }
+
+
+void ChunkHeader::resizeCommonHeader(unsigned newCommonHeaderSize, bool moveAdditionalHeader) {
+    if (newCommonHeaderSize != commonHeaderSize) {
+        unsigned newHeaderSize = headerSize + newCommonHeaderSize - commonHeaderSize;
+
+        if (header == inlineHeader && newHeaderSize <= inlineHeaderCapacityBytes) {
+            if (moveAdditionalHeader) {
+                memmove(header + newCommonHeaderSize, header + commonHeaderSize, headerSize - commonHeaderSize);
+            }
+        } else {
+            std::uint8_t* newHeader = allocateHeader(newHeaderSize);
+
+            if (moveAdditionalHeader) {
+                memcpy(newHeader, header, minimumChunkHeaderSizeBytes);
+                memcpy(newHeader + newCommonHeaderSize, header + commonHeaderSize, headerSize - commonHeaderSize);
+            } else {
+                memcpy(newHeader, header, newHeaderSize < headerSize ? newHeaderSize : headerSize);
+            }
+
+            releaseHeader(header);
+            header = newHeader;
+        }
+
+        if (moveAdditionalHeader && newCommonHeaderSize > minimumChunkHeaderSizeBytes) {
+            memset(header + minimumChunkHeaderSizeBytes, 0, newCommonHeaderSize - minimumChunkHeaderSizeBytes);
+        }
+
+        headerSize       = static_cast<std::uint16_t>(newHeaderSize);
+        commonHeaderSize = static_cast<std::uint8_t>(newCommonHeaderSize);
+    }
+}
+
+
+bool ChunkHeader::isExtendedHeader(const std::uint8_t* commonHeader) {
+    // A standard 32 byte chunk can never have more than 28 invalid bytes so we use a 32 byte size code with the MSB of
+    // the invalid byte count set to mark extended chunks.
+
+    return (commonHeader[0] & 0x1C) == 0 && (commonHeader[1] & 0x80) != 0;
+}
+
+
+unsigned ChunkHeader::numberInvalidBytes() const {
+    unsigned result;
+
+    if (isExtendedHeader(header)) {
+        result = (
+              static_cast<unsigned>(header[4])
+            | (static_cast<unsigned>(header[5]) <<  8)
+            | (static_cast<unsigned>(header[6]) << 16)
+            | (static_cast<unsigned>(header[7]) << 24)
+        );
+    } else {
+        result = (static_cast<unsigned>(header[1]) << 3) | ((header[0] >> 5) & 0x07);
+    }
+
+    return result;
+}
+
+
+std::uint8_t* ChunkHeader::allocateHeader(unsigned newHeaderSize) {
+    return newHeaderSize <= inlineHeaderCapacityBytes ? inlineHeader : new std::uint8_t[newHeaderSize];
+}
+
+
+void ChunkHeader::releaseHeader(std::uint8_t* oldHeader) {
+    if (oldHeader != inlineHeader) {
+        delete[] oldHeader;
+    }
+}
@@ -87,11 +87,34 @@ class ChunkHeader {
          */
         static constexpr unsigned maximumChunkSize = 1 << (7 + 5);
 
+        /**
+         * Value indicating the number of additional common header bytes used by extended chunks.  Extended chunks
+         * store the number of invalid bytes in these bytes.
+         */
+        static constexpr unsigned extendedChunkHeaderSizeBytes = 4;
+
+        /**
+         * Value indicating the minimum size of an extended chunk, in bytes.  Value includes the header.
+         */
+        static constexpr unsigned minimumExtendedChunkSize = 2 * maximumChunkSize;
+
+        /**
+         * Value indicating the maximum size of an extended chunk, in bytes.  Value includes the header.
+         */
+        static constexpr unsigned maximumExtendedChunkSize = 1 << 20;
+
         /**
          * Value used to indicate an invalid file index.
          */
         static constexpr FileIndex invalidFileIndex = static_cast<FileIndex>(-1);
 
+        /**
+         * Value indicating the number of header bytes held within the chunk header object.  Larger headers, such as
+         * file header chunks with long identifiers, are placed on the heap.  The value is large enough to hold the
+         * header of every stream chunk.
+         */
+        static constexpr unsigned inlineHeaderCapacityBytes = 160;
+
         /**
          * Constructor.
          *
@@ -147,6 +170,15 @@ class ChunkHeader {
          */
         unsigned chunkSize() const;
 
+        /**
+         * Method that indicates if this chunk is an extended chunk.  Extended chunks are larger than
+         * \ref ChunkHeader::maximumChunkSize and are only supported by containers with a minor version of 1 or
+         * later.
+         *
+         * \return Returns true if the chunk is an extended chunk.  Returns false if the chunk is a standard chunk.
+         */
+        bool isExtended() const;
+
         /**
          * Method that can be used to update the CRC value.
          *
@@ -279,12 +311,15 @@ class ChunkHeader {
          *
          * \param[in] availableSpace The available space for the chunk, in bytes.
          *
+         * \param[in] allowExtended  If true, an extended chunk will be used if the available space allows for one.  If
+         *                           false, the chunk size will be limited to \ref ChunkHeader::maximumChunkSize.
+         *
          * \return Returns the largest chunk that can fit within the specified amount of space.  The value will always
          *         be greater or equal to the minimum chunk size (currently 32 bytes) and will be equal to or less than
          *         the available space in bytes.  If the available space is less than the minimum chunk size, a value of
          *         zero is returned.
          */
-        unsigned setBestFitSize(unsigned availableSpace);
+        unsigned setBestFitSize(unsigned availableSpace, bool allowExtended = false);
 
         /**
          * Method that indicates that all bytes in the chunk should be marked as valid.  This method will not adjust the
@@ -323,26 +358,78 @@ class ChunkHeader {
          */
         static unsigned log2(std::uint32_t x);
 
+        /**
+         * Method that changes the size of the common portion of the header, preserving the common header bytes.  The
+         * method is used to switch the header between the standard and extended layouts.
+         *
+         * \param[in] newCommonHeaderSize   The new size of the common header, in bytes.  The value must be either
+         *                                  \ref ChunkHeader::minimumChunkHeaderSizeBytes or that value plus
+         *                                  \ref ChunkHeader::extendedChunkHeaderSizeBytes.
+         *
+         * \param[in] moveAdditionalHeader If true, the additional header bytes will be moved so that they follow the
+         *                                  resized common header.  If false, the raw header bytes will remain in place
+         *                                  and the header will simply grow or shrink at the end.
+         */
+        void resizeCommonHeader(unsigned newCommonHeaderSize, bool moveAdditionalHeader = true);
+
     private:
+        /**
+         * Method that determines if a common header describes an extended chunk.
+         *
+         * \param[in] commonHeader The common header to check.
+         *
+         * \return Returns true if the common header describes an extended chunk.
+         */
+        static bool isExtendedHeader(const std::uint8_t* commonHeader);
+
+        /**
+         * Method that returns the number of invalid bytes in the chunk.
+         *
+         * \return Returns the number of invalid bytes.
+         */
+        unsigned numberInvalidBytes() const;
+
+        /**
+         * Method that allocates storage for the raw header data.  The inline header storage is used when it is large
+         * enough.
+         *
+         * \param[in] newHeaderSize The required header size, in bytes.
+         *
+         * \return Returns a pointer to the storage.
+         */
+        std::uint8_t* allocateHeader(unsigned newHeaderSize);
+
+        /**
+         * Method that releases storage obtained from \ref ChunkHeader::allocateHeader.
+         *
+         * \param[in] oldHeader The storage to be released.
+         */
+        void releaseHeader(std::uint8_t* oldHeader);
+
         /**
          * Table used to do fast log2 computations.
          */
         static const unsigned char mulDeBruijnBitTable[32];
 
         /**
-         * Table used to perform fast CRC computations.
+         * The raw header data.  Points to the inline header storage unless the header is too large to fit.
          */
-        static const std::uint16_t crcTable[256];
+        std::uint8_t* header;
 
         /**
-         * The raw header data.
+         * Inline storage for the raw header data.
          */
-        std::uint8_t* header;
+        std::uint8_t inlineHeader[inlineHeaderCapacityBytes];
 
         /**
          * The total allocated chunk header size.
          */
         std::uint16_t headerSize;
+
+        /**
+         * The size of the common portion of the header.
+         */
+        std::uint8_t commonHeaderSize;
 };
 
 #endif
@@ -23,15 +23,30 @@
 #include "chunk_header.h"
 #include "chunk_map_data.h"
 
-ChunkMapData::ChunkMapData(ChunkHeader::FileIndex startingIndex, unsigned payloadSize) {
+ChunkMapData::ChunkMapData(
+        ChunkHeader::FileIndex startingIndex,
+        ChunkHeader::FileIndex areaSize,
+        unsigned               payloadSize,
+        bool                   compressed,
+        ChunkHeader::FileIndex sharedIndex,
+        bool                   inlined
+    ) {
     currentStartingIndex = startingIndex;
+    currentAreaSize      = areaSize;
     currentPayloadSize   = payloadSize;
+    currentlyCompressed  = compressed;
+    currentSharedIndex   = sharedIndex;
+    currentlyInlined     = inlined;
 }
 
 
 ChunkMapData::ChunkMapData(const ChunkMapData& other) {
     currentStartingIndex = other.currentStartingIndex;
+    currentAreaSize      = other.currentAreaSize;
     currentPayloadSize   = other.currentPayloadSize;
+    currentlyCompressed  = other.currentlyCompressed;
+    currentSharedIndex   = other.currentSharedIndex;
+    currentlyInlined     = other.currentlyInlined;
 }
 
 
@@ -48,6 +63,16 @@ ChunkHeader::FileIndex ChunkMapData::startingIndex() const {
 }
 
 
+void ChunkMapData::setAreaSize(ChunkHeader::FileIndex newAreaSize) {
+    currentAreaSize = newAreaSize;
+}
+
+
+ChunkHeader::FileIndex ChunkMapData::areaSize() const {
+    return currentAreaSize;
+}
+
+
 void ChunkMapData::setPayloadSize(unsigned newPayloadSize) {
     currentPayloadSize = newPayloadSize;
 }
@@ -58,9 +83,48 @@ unsigned ChunkMapData::payloadSize() const {
 }
 
 
+void ChunkMapData::setCompressed(bool nowCompressed) {
+    currentlyCompressed = nowCompressed;
+}
+
+
+bool ChunkMapData::compressed() const {
+    return currentlyCompressed;
+}
+
+
+void ChunkMapData::setSharedIndex(ChunkHeader::FileIndex newSharedIndex) {
+    currentSharedIndex = newSharedIndex;
+}
+
+
+ChunkHeader::FileIndex ChunkMapData::sharedIndex() const {
+    return currentSharedIndex;
+}
+
+
+bool ChunkMapData::shared() const {
+    return currentSharedIndex != ChunkHeader::invalidFileIndex;
+}
+
+
+void ChunkMapData::setInlined(bool nowInlined) {
+    currentlyInlined = nowInlined;
+}
+
+
+bool ChunkMapData::inlined() const {
+    return currentlyInlined;
+}
+
+
 ChunkMapData& ChunkMapData::operator=(const ChunkMapData& other) {
     currentStartingIndex = other.currentStartingIndex;
+    currentAreaSize      = other.currentAreaSize;
     currentPayloadSize   = other.currentPayloadSize;
+    currentlyCompressed  = other.currentlyCompressed;
+    currentSharedIndex   = other.currentSharedIndex;
+    currentlyInlined     = other.currentlyInlined;
 
     return *this;
 }
@@ -37,9 +37,27 @@ class ChunkMapData {
          *
          * \param[in] startingIndex The zero based index to the chunk.
          *
-         * \param[in] payloadSize   The size of the chunk payload, in bytes.
+         * \param[in] areaSize      The size of the chunk in the container, in file index counts.
+         *
+         * \param[in] payloadSize   The size of the chunk payload, in bytes.  For compressed extents, this is the size
+         *                          of the payload after decompression.
+         *
+         * \param[in] compressed    If true, the chunk holds a compressed extent.
+         *
+         * \param[in] sharedIndex   The file index of the shared chunk holding the payload.  The value
+         *                          \ref ChunkHeader::invalidFileIndex indicates that the payload is held by the chunk
+         *                          itself.
+         *
+         * \param[in] inlined       If true, the payload is held inline in the stream start chunk.
          */
-        ChunkMapData(ChunkHeader::FileIndex startingIndex, unsigned payloadSize);
+        ChunkMapData(
+            ChunkHeader::FileIndex startingIndex,
+            ChunkHeader::FileIndex areaSize,
+            unsigned               payloadSize,
+            bool                   compressed = false,
+            ChunkHeader::FileIndex sharedIndex = ChunkHeader::invalidFileIndex,
+            bool                   inlined = false
+        );
 
         /**
          * Copy constructor.
@@ -64,6 +82,21 @@ class ChunkMapData {
          */
         ChunkHeader::FileIndex startingIndex() const;
 
+        /**
+         * Method that can be used to set the size of the chunk in the container.
+         *
+         * \param[in] newAreaSize The new size of the chunk, in file index counts.
+         */
+        void setAreaSize(ChunkHeader::FileIndex newAreaSize);
+
+        /**
+         * Method that can be used to obtain the size of the chunk in the container.  The value allows the space used
+         * by the chunk to be released without reading the chunk header.
+         *
+         * \return Returns the size of the chunk, in file index counts.
+         */
+        ChunkHeader::FileIndex areaSize() const;
+
         /**
          * Method that can be used to set the size of the payload.
          *
@@ -78,6 +111,58 @@ class ChunkMapData {
          */
         unsigned payloadSize() const;
 
+        /**
+         * Method that can be used to mark the chunk as holding a compressed extent.
+         *
+         * \param[in] nowCompressed If true, the chunk holds a compressed extent.
+         */
+        void setCompressed(bool nowCompressed);
+
+        /**
+         * Method that indicates if the chunk holds a compressed extent.
+         *
+         * \return Returns true if the chunk holds a compressed extent.
+         */
+        bool compressed() const;
+
+        /**
+         * Method that can be used to set the file index of the shared chunk holding the payload.
+         *
+         * \param[in] newSharedIndex The file index of the shared chunk.  The value
+         *                           \ref ChunkHeader::invalidFileIndex indicates that the payload is held by the chunk
+         *                           itself.
+         */
+        void setSharedIndex(ChunkHeader::FileIndex newSharedIndex);
+
+        /**
+         * Method that can be used to obtain the file index of the shared chunk holding the payload.
+         *
+         * \return Returns the file index of the shared chunk.  The value \ref ChunkHeader::invalidFileIndex is
+         *         returned if the payload is held by the chunk itself.
+         */
+        ChunkHeader::FileIndex sharedIndex() const;
+
+        /**
+         * Method that indicates if the chunk references a shared chunk rather than holding the payload.
+         *
+         * \return Returns true if the payload is held by a shared chunk.
+         */
+        bool shared() const;
+
+        /**
+         * Method that can be used to mark the payload as held inline in the stream start chunk.
+         *
+         * \param[in] nowInlined If true, the payload is held inline in the stream start chunk.
+         */
+        void setInlined(bool nowInlined);
+
+        /**
+         * Method that indicates if the payload is held inline in the stream start chunk rather than in a data chunk.
+         *
+         * \return Returns true if the payload is held inline.
+         */
+        bool inlined() const;
+
         /**
          * Assignment operator.
          *
@@ -93,10 +178,30 @@ class ChunkMapData {
          */
         ChunkHeader::FileIndex currentStartingIndex;
 
+        /**
+         * The size of this chunk, in file index counts.
+         */
+        ChunkHeader::FileIndex currentAreaSize;
+
         /**
          * The payload size, in bytes.
          */
         unsigned currentPayloadSize;
+
+        /**
+         * Flag indicating if the chunk holds a compressed extent.
+         */
+        bool currentlyCompressed;
+
+        /**
+         * The file index of the shared chunk holding the payload.
+         */
+        ChunkHeader::FileIndex currentSharedIndex;
+
+        /**
+         * Flag indicating if the payload is held inline in the stream start chunk.
+         */
+        bool currentlyInlined;
 };
 
 #endif
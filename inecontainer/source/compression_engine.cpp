@@ -0,0 +1,380 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref CompressionEngine class.
+***********************************************************************************************************************/
+
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+
+#include "compression_engine.h"
+
+CompressionEngine::CompressionEngine() {
+    hashTable  = new std::uint32_t[hashTableSize];
+    chainTable = new std::uint16_t[maximumBlockSize];
+}
+
+
+CompressionEngine::~CompressionEngine() {
+    delete[] hashTable;
+    delete[] chainTable;
+}
+
+
+unsigned CompressionEngine::compress(
+        CompressionEngine::Level level,
+        const std::uint8_t*      source,
+        unsigned                 sourceLength,
+        std::uint8_t*            destination,
+        unsigned                 destinationCapacity,
+        unsigned*                sourceConsumed
+    ) {
+    unsigned result   = 0;
+    unsigned consumed = 0;
+
+    assert(sourceLength <= maximumBlockSize);
+
+    if (destinationCapacity > blockHeaderSizeBytes) {
+        std::uint8_t* out    = destination + blockHeaderSizeBytes;
+        std::uint8_t* outEnd = destination + destinationCapacity;
+
+        for (unsigned i=0 ; i<hashTableSize ; ++i) {
+            hashTable[i] = noPosition;
+        }
+
+        // Matches can only start where the minimum match length can be read.
+        unsigned searchEnd = sourceLength >= minimumMatchLength ? sourceLength - minimumMatchLength + 1 : 0;
+        unsigned anchor    = 0;
+        unsigned position  = 0;
+        unsigned misses    = 0;
+        bool     full      = false;
+
+        while (!full && position < searchEnd) {
+            unsigned      bestLength = 0;
+            unsigned      bestOffset = 0;
+            std::uint32_t candidate  = insertPosition(source, position);
+            unsigned      depth      = 0;
+
+            while (candidate != noPosition                     &&
+                   position - candidate <= maximumMatchOffset &&
+                   depth < maximumSearchDepth                    ) {
+                unsigned length = matchLength(source, candidate, position, sourceLength);
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestOffset = position - candidate;
+                }
+
+                if (level == Level::HIGH_RATIO) {
+                    unsigned distance = chainTable[candidate];
+                    candidate = distance == 0 ? noPosition : candidate - distance;
+                    ++depth;
+                } else {
+                    candidate = noPosition;
+                }
+            }
+
+            if (bestLength >= minimumMatchLength) {
+                unsigned literalLength = position - anchor;
+
+                if (sequenceSize(literalLength, bestLength) > static_cast<unsigned>(outEnd - out)) {
+                    full = true;
+                } else {
+                    out = writeSequence(out, source + anchor, literalLength, bestOffset, bestLength);
+
+                    unsigned matchEnd = position + bestLength;
+                    if (level == Level::HIGH_RATIO) {
+                        for (unsigned i=position+1 ; i<matchEnd && i<searchEnd ; ++i) {
+                            insertPosition(source, i);
+                        }
+                    } else if (matchEnd - 2 < searchEnd) {
+                        insertPosition(source, matchEnd - 2);
+                    }
+
+                    position = matchEnd;
+                    anchor   = matchEnd;
+                    misses   = 0;
+                }
+            } else if (level == Level::HIGH_RATIO) {
+                ++position;
+            } else {
+                // Skip ahead faster as misses accumulate so that incompressible data is passed over quickly.
+                ++misses;
+                position += 1 + (misses >> 5);
+            }
+        }
+
+        // Finish with the remaining data as literals, keeping as many as will fit.
+
+        unsigned available     = static_cast<unsigned>(outEnd - out);
+        unsigned literalLength = sourceLength - anchor;
+
+        if (available == 0) {
+            literalLength = 0;
+        } else if (literalLength >= available) {
+            literalLength = available - 1;
+        }
+
+        while (literalLength > 0 && sequenceSize(literalLength, 0) > available) {
+            --literalLength;
+        }
+
+        if (literalLength > 0) {
+            out = writeSequence(out, source + anchor, literalLength, 0, 0);
+        }
+
+        consumed = anchor + literalLength;
+
+        destination[0] = static_cast<std::uint8_t>(consumed      );
+        destination[1] = static_cast<std::uint8_t>(consumed >>  8);
+        destination[2] = static_cast<std::uint8_t>(consumed >> 16);
+        destination[3] = static_cast<std::uint8_t>(consumed >> 24);
+
+        result = static_cast<unsigned>(out - destination);
+    }
+
+    if (sourceConsumed != nullptr) {
+        *sourceConsumed = consumed;
+    }
+
+    return result;
+}
+
+
+unsigned CompressionEngine::decompressedSize(const std::uint8_t* block, unsigned blockLength) {
+    unsigned result = 0;
+
+    if (blockLength >= blockHeaderSizeBytes) {
+        result = (
+               static_cast<unsigned>(block[0])
+            | (static_cast<unsigned>(block[1]) <<  8)
+            | (static_cast<unsigned>(block[2]) << 16)
+            | (static_cast<unsigned>(block[3]) << 24)
+        );
+    }
+
+    return result;
+}
+
+
+bool CompressionEngine::decompress(
+        const std::uint8_t* block,
+        unsigned            blockLength,
+        std::uint8_t*       destination,
+        unsigned            destinationCapacity
+    ) {
+    bool success = blockLength >= blockHeaderSizeBytes;
+
+    unsigned expectedLength = decompressedSize(block, blockLength);
+    if (expectedLength > destinationCapacity) {
+        success = false;
+    }
+
+    const std::uint8_t* in     = block + blockHeaderSizeBytes;
+    const std::uint8_t* inEnd  = block + blockLength;
+    unsigned            outPos = 0;
+
+    while (success && in < inEnd) {
+        unsigned token         = *in++;
+        unsigned literalLength = token >> 4;
+
+        if (literalLength == 15) {
+            unsigned extra;
+            do {
+                if (in < inEnd) {
+                    extra          = *in++;
+                    literalLength += extra;
+                } else {
+                    extra   = 0;
+                    success = false;
+                }
+            } while (success && extra == 255);
+        }
+
+        if (success) {
+            if (literalLength > static_cast<unsigned>(inEnd - in) || literalLength > expectedLength - outPos) {
+                success = false;
+            } else {
+                std::memcpy(destination + outPos, in, literalLength);
+                in     += literalLength;
+                outPos += literalLength;
+            }
+        }
+
+        if (success && in < inEnd) {
+            if (inEnd - in < 2) {
+                success = false;
+            } else {
+                unsigned offset = static_cast<unsigned>(in[0]) | (static_cast<unsigned>(in[1]) << 8);
+                in += 2;
+
+                unsigned length = (token & 0x0F) + minimumMatchLength;
+                if ((token & 0x0F) == 15) {
+                    unsigned extra;
+                    do {
+                        if (in < inEnd) {
+                            extra   = *in++;
+                            length += extra;
+                        } else {
+                            extra   = 0;
+                            success = false;
+                        }
+                    } while (success && extra == 255);
+                }
+
+                if (success && (offset == 0 || offset > outPos || length > expectedLength - outPos)) {
+                    success = false;
+                }
+
+                if (success) {
+                    // Matches can overlap the data they produce so the copy must proceed a byte at a time unless the
+                    // match is far enough back.
+                    std::uint8_t*       matchDestination = destination + outPos;
+                    const std::uint8_t* matchSource      = matchDestination - offset;
+
+                    if (offset >= length) {
+                        std::memcpy(matchDestination, matchSource, length);
+                    } else {
+                        for (unsigned i=0 ; i<length ; ++i) {
+                            matchDestination[i] = matchSource[i];
+                        }
+                    }
+
+                    outPos += length;
+                }
+            }
+        }
+    }
+
+    return success && outPos == expectedLength;
+}
+
+
+unsigned CompressionEngine::hash(const std::uint8_t* data) {
+    std::uint32_t value = (
+           static_cast<std::uint32_t>(data[0])
+        | (static_cast<std::uint32_t>(data[1]) <<  8)
+        | (static_cast<std::uint32_t>(data[2]) << 16)
+        | (static_cast<std::uint32_t>(data[3]) << 24)
+    );
+
+    return static_cast<unsigned>((value * 2654435761U) >> (32 - hashBits));
+}
+
+
+unsigned CompressionEngine::matchLength(
+        const std::uint8_t* source,
+        unsigned            candidate,
+        unsigned            position,
+        unsigned            sourceLength
+    ) {
+    unsigned length = 0;
+    unsigned limit  = sourceLength - position;
+
+    while (length < limit && source[candidate + length] == source[position + length]) {
+        ++length;
+    }
+
+    return length;
+}
+
+
+std::uint32_t CompressionEngine::insertPosition(const std::uint8_t* source, unsigned position) {
+    unsigned      index    = hash(source + position);
+    std::uint32_t previous = hashTable[index];
+
+    if (previous != noPosition && position - previous <= maximumMatchOffset) {
+        chainTable[position] = static_cast<std::uint16_t>(position - previous);
+    } else {
+        chainTable[position] = 0;
+    }
+
+    hashTable[index] = position;
+
+    return previous;
+}
+
+
+unsigned CompressionEngine::sequenceSize(unsigned literalLength, unsigned matchLength) {
+    unsigned result = 1 + literalLength;
+
+    if (literalLength >= 15) {
+        result += (literalLength - 15) / 255 + 1;
+    }
+
+    if (matchLength > 0) {
+        unsigned matchCode = matchLength - minimumMatchLength;
+
+        result += 2;
+        if (matchCode >= 15) {
+            result += (matchCode - 15) / 255 + 1;
+        }
+    }
+
+    return result;
+}
+
+
+std::uint8_t* CompressionEngine::writeSequence(
+        std::uint8_t*       destination,
+        const std::uint8_t* literals,
+        unsigned            literalLength,
+        unsigned            matchOffset,
+        unsigned            matchLength
+    ) {
+    std::uint8_t* token = destination++;
+    unsigned      code  = (literalLength < 15 ? literalLength : 15) << 4;
+
+    if (literalLength >= 15) {
+        unsigned remaining = literalLength - 15;
+        while (remaining >= 255) {
+            *destination++ = 255;
+            remaining -= 255;
+        }
+
+        *destination++ = static_cast<std::uint8_t>(remaining);
+    }
+
+    std::memcpy(destination, literals, literalLength);
+    destination += literalLength;
+
+    if (matchLength > 0) {
+        unsigned matchCode = matchLength - minimumMatchLength;
+
+        *destination++ = static_cast<std::uint8_t>(matchOffset);
+        *destination++ = static_cast<std::uint8_t>(matchOffset >> 8);
+
+        if (matchCode >= 15) {
+            unsigned remaining = matchCode - 15;
+            while (remaining >= 255) {
+                *destination++ = 255;
+                remaining -= 255;
+            }
+
+            *destination++ = static_cast<std::uint8_t>(remaining);
+            matchCode = 15;
+        }
+
+        code |= matchCode;
+    }
+
+    *token = static_cast<std::uint8_t>(code);
+
+    return destination;
+}
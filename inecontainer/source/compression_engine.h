@@ -0,0 +1,259 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This header defines the \ref CompressionEngine class.
+***********************************************************************************************************************/
+
+/* .. sphinx-project inecontainer */
+
+#ifndef COMPRESSION_ENGINE_H
+#define COMPRESSION_ENGINE_H
+
+#include <cstdint>
+
+/**
+ * Class that compresses and decompresses blocks of virtual file data.  The class implements a byte oriented LZ77
+ * codec, similar to LZ4, that favors decompression speed.  Two compression levels are supported, both producing the
+ * same block format.
+ *
+ * A block starts with a 32-bit little-endian count of the number of uncompressed bytes represented by the block.  The
+ * count is followed by one or more sequences.  Each sequence starts with a token byte.  The upper 4 bits of the token
+ * hold the number of literal bytes and the lower 4 bits hold the match length, less 4.  A value of 15 in either field
+ * indicates that additional length bytes follow, each byte adding to the length with a byte of 255 indicating that
+ * another length byte follows.  The literal length is followed by the literal bytes.  Unless the block ends with the
+ * literals, the literals are followed by a 16-bit little-endian match offset and any additional match length bytes.
+ *
+ * Instances hold the working tables used during compression so you should reuse instances where possible.
+ */
+class CompressionEngine {
+    public:
+        /**
+         * Enumeration of supported compression levels.
+         */
+        enum class Level {
+            /**
+             * Indicates a fast, single probe, search for matches.
+             */
+            FAST,
+
+            /**
+             * Indicates a slower search of prior matches that yields a higher compression ratio.
+             */
+            HIGH_RATIO
+        };
+
+        /**
+         * The maximum number of uncompressed bytes that can be represented by a single block.
+         */
+        static constexpr unsigned maximumBlockSize = 65536;
+
+        /**
+         * The size of the block header, in bytes.
+         */
+        static constexpr unsigned blockHeaderSizeBytes = 4;
+
+        CompressionEngine();
+
+        ~CompressionEngine();
+
+        /**
+         * Method that compresses data into a block.  Compression stops early if the block would exceed the available
+         * space so you can use the destination capacity to bound the compressed size.
+         *
+         * \param[in]  level               The compression level to use.
+         *
+         * \param[in]  source              The data to be compressed.
+         *
+         * \param[in]  sourceLength        The number of bytes to be compressed.  The value must not exceed
+         *                                 \ref CompressionEngine::maximumBlockSize.
+         *
+         * \param[in]  destination         The buffer to receive the block.
+         *
+         * \param[in]  destinationCapacity The size of the destination buffer, in bytes.
+         *
+         * \param[out] sourceConsumed      Pointer to a value that will hold the number of source bytes represented by
+         *                                 the block.  The value will be less than the source length if the destination
+         *                                 buffer filled before all the data could be compressed.
+         *
+         * \return Returns the size of the block, in bytes, including the block header.  A value of 0 is returned if
+         *         the destination is too small to hold any data.
+         */
+        unsigned compress(
+            Level               level,
+            const std::uint8_t* source,
+            unsigned            sourceLength,
+            std::uint8_t*       destination,
+            unsigned            destinationCapacity,
+            unsigned*           sourceConsumed
+        );
+
+        /**
+         * Method that determines the number of uncompressed bytes represented by a block.
+         *
+         * \param[in] block       The block to be checked.
+         *
+         * \param[in] blockLength The length of the block, in bytes.
+         *
+         * \return Returns the number of uncompressed bytes represented by the block.  A value of 0 is returned if the
+         *         block is too short to hold a block header.
+         */
+        static unsigned decompressedSize(const std::uint8_t* block, unsigned blockLength);
+
+        /**
+         * Method that decompresses a block.  The block is fully validated so damaged blocks will never cause data to
+         * be read or written outside of the supplied buffers.
+         *
+         * \param[in] block               The block to be decompressed.
+         *
+         * \param[in] blockLength         The length of the block, in bytes.
+         *
+         * \param[in] destination         The buffer to receive the decompressed data.
+         *
+         * \param[in] destinationCapacity The size of the destination buffer, in bytes.
+         *
+         * \return Returns true on success.  Returns false if the block is damaged or the decompressed data will not
+         *         fit in the destination buffer.
+         */
+        static bool decompress(
+            const std::uint8_t* block,
+            unsigned            blockLength,
+            std::uint8_t*       destination,
+            unsigned            destinationCapacity
+        );
+
+    private:
+        /**
+         * The minimum supported match length, in bytes.
+         */
+        static constexpr unsigned minimumMatchLength = 4;
+
+        /**
+         * The maximum supported match offset, in bytes.
+         */
+        static constexpr unsigned maximumMatchOffset = 65535;
+
+        /**
+         * The number of bits used for the hash table index.
+         */
+        static constexpr unsigned hashBits = 14;
+
+        /**
+         * The number of entries in the hash table.
+         */
+        static constexpr unsigned hashTableSize = 1 << hashBits;
+
+        /**
+         * The maximum number of prior matches examined by the \ref CompressionEngine::Level::HIGH_RATIO level.
+         */
+        static constexpr unsigned maximumSearchDepth = 64;
+
+        /**
+         * Value used to mark unused hash table entries.
+         */
+        static constexpr std::uint32_t noPosition = static_cast<std::uint32_t>(-1);
+
+        /**
+         * Method that calculates the hash of the 4 bytes at a given location.
+         *
+         * \param[in] data Pointer to the data to be hashed.
+         *
+         * \return Returns the hash table index.
+         */
+        static unsigned hash(const std::uint8_t* data);
+
+        /**
+         * Method that determines the number of matching bytes at two locations in the source data.
+         *
+         * \param[in] source       The source data.
+         *
+         * \param[in] candidate    The earlier location to be compared.
+         *
+         * \param[in] position     The current location.
+         *
+         * \param[in] sourceLength The length of the source data, in bytes.
+         *
+         * \return Returns the number of matching bytes.
+         */
+        static unsigned matchLength(
+            const std::uint8_t* source,
+            unsigned            candidate,
+            unsigned            position,
+            unsigned            sourceLength
+        );
+
+        /**
+         * Method that adds a location to the hash and chain tables.
+         *
+         * \param[in] source   The source data.
+         *
+         * \param[in] position The location to be added.
+         *
+         * \return Returns the most recent prior location with the same hash, if any.
+         */
+        std::uint32_t insertPosition(const std::uint8_t* source, unsigned position);
+
+        /**
+         * Method that determines the number of bytes needed to encode a sequence.
+         *
+         * \param[in] literalLength The number of literal bytes.
+         *
+         * \param[in] matchLength   The match length, in bytes.  A value of 0 indicates a sequence holding only
+         *                          literals.
+         *
+         * \return Returns the encoded size of the sequence, in bytes.
+         */
+        static unsigned sequenceSize(unsigned literalLength, unsigned matchLength);
+
+        /**
+         * Method that writes a sequence.
+         *
+         * \param[in] destination   The location to receive the sequence.
+         *
+         * \param[in] literals      The literal bytes.
+         *
+         * \param[in] literalLength The number of literal bytes.
+         *
+         * \param[in] matchOffset   The match offset.  Ignored if the match length is 0.
+         *
+         * \param[in] matchLength   The match length, in bytes.  A value of 0 indicates a sequence holding only
+         *                          literals.
+         *
+         * \return Returns a pointer just past the written sequence.
+         */
+        static std::uint8_t* writeSequence(
+            std::uint8_t*       destination,
+            const std::uint8_t* literals,
+            unsigned            literalLength,
+            unsigned            matchOffset,
+            unsigned            matchLength
+        );
+
+        /**
+         * Table holding the most recent position for each hash value.
+         */
+        std::uint32_t* hashTable;
+
+        /**
+         * Table holding, for each position, the distance to the prior position with the same hash.  Used by the
+         * \ref CompressionEngine::Level::HIGH_RATIO level.
+         */
+        std::uint16_t* chainTable;
+};
+
+#endif
@@ -24,6 +24,7 @@
 #include <set>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "container_status.h"
 #include "container_virtual_file.h"
@@ -51,11 +52,76 @@ namespace Container {
     }
 
 
+    void Container::setCrcVerification(Container::CrcVerification policy, unsigned sampleInterval) {
+        impl->setCrcVerification(policy, sampleInterval);
+    }
+
+
+    Container::CrcVerification Container::crcVerification() const {
+        return impl->crcVerification();
+    }
+
+
+    void Container::setPaddingFreeWrites(bool enabled) {
+        impl->setPaddingFreeWrites(enabled);
+    }
+
+
+    bool Container::paddingFreeWrites() const {
+        return impl->paddingFreeWrites();
+    }
+
+
+    void Container::setDeduplication(bool enabled) {
+        impl->setDeduplication(enabled);
+    }
+
+
+    bool Container::deduplication() const {
+        return impl->deduplication();
+    }
+
+
+    Status Container::setWriteBufferBudget(unsigned long long newBudget) {
+        return impl->setWriteBufferBudget(newBudget);
+    }
+
+
+    unsigned long long Container::writeBufferBudget() const {
+        return impl->writeBufferBudget();
+    }
+
+
+    unsigned long long Container::bufferedBytes() const {
+        return impl->bufferedBytes();
+    }
+
+
+    void Container::setChunkChecksum(Container::ChunkChecksum checksum) {
+        impl->setChunkChecksum(checksum);
+    }
+
+
+    Container::ChunkChecksum Container::chunkChecksum() const {
+        return impl->chunkChecksum();
+    }
+
+
     Container::DirectoryMap Container::directory() {
         return impl->directory();
     }
 
 
+    Status Container::forEachFile(const FileVisitor& visitor, const std::string& prefix) {
+        return impl->forEachFile(visitor, prefix);
+    }
+
+
+    std::shared_ptr<VirtualFile> Container::virtualFile(const std::string& virtualFileName) {
+        return impl->virtualFile(virtualFileName);
+    }
+
+
     Status Container::open() {
         return impl->open();
     }
@@ -66,13 +132,63 @@ namespace Container {
     }
 
 
-    std::shared_ptr<VirtualFile> Container::newVirtualFile(const std::string& newVirtualFileName) {
+    std::shared_ptr<VirtualFile> Container::newVirtualFile(
+            const std::string& newVirtualFileName,
+            unsigned long long expectedSize
+        ) {
         std::shared_ptr<VirtualFile> virtualFile = impl->newVirtualFile(newVirtualFileName);
-        impl->registerFileImplementation(virtualFile->impl);
+        if (virtualFile) {
+            impl->registerFileImplementation(virtualFile->impl);
+
+            if (expectedSize > 0) {
+                // The size is only a hint.  The file is still usable if space can not be reserved.
+                virtualFile->reserve(expectedSize);
+            }
+        }
+
         return virtualFile;
     }
 
 
+    Status Container::eraseFiles(const std::vector<std::string>& virtualFileNames, bool verify) {
+        return impl->eraseFiles(virtualFileNames, verify);
+    }
+
+
+    Status Container::clear() {
+        return impl->clear();
+    }
+
+
+    Status Container::beginIngest() {
+        return impl->beginIngest();
+    }
+
+
+    Status Container::ingestFile(
+            const std::string&  virtualFileName,
+            const std::uint8_t* data,
+            unsigned long long  fileSize
+        ) {
+        return impl->ingestFile(virtualFileName, data, fileSize);
+    }
+
+
+    Status Container::commitIngest() {
+        return impl->commitIngest();
+    }
+
+
+    Status Container::abortIngest() {
+        return impl->abortIngest();
+    }
+
+
+    bool Container::ingestActive() const {
+        return impl->ingestActive();
+    }
+
+
     Status Container::streamRead() {
         return impl->streamRead();
     }
@@ -81,4 +197,14 @@ namespace Container {
     VirtualFile* Container::createFile(const std::string& virtualFileName) {
         return new VirtualFile(virtualFileName, this);
     }
+
+
+    bool Container::supportsPinning() const {
+        return false;
+    }
+
+
+    std::shared_ptr<const std::uint8_t> Container::pin(unsigned long long, unsigned) {
+        return std::shared_ptr<const std::uint8_t>();
+    }
 }
@@ -101,4 +101,14 @@ namespace Container {
     Status Container::Private::flush() {
         return iface->flush();
     }
+
+
+    bool Container::Private::supportsPinning() const {
+        return iface->supportsPinning();
+    }
+
+
+    std::shared_ptr<const std::uint8_t> Container::Private::pin(unsigned long long offset, unsigned count) {
+        return iface->pin(offset, count);
+    }
 }
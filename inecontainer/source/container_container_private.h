@@ -165,6 +165,25 @@ namespace Container {
              */
             Status flush() final;
 
+            /**
+             * Method that indicates whether the underlying data store supports pinning.
+             *
+             * \return Returns true if pinning is supported.
+             */
+            bool supportsPinning() const final;
+
+            /**
+             * Method that provides direct, read-only access to a region of the underlying data store.
+             *
+             * \param[in] offset The offset of the first byte of the region.
+             *
+             * \param[in] count  The number of bytes in the region.
+             *
+             * \return Returns a pointer to the first byte of the region.  A null pointer is returned if the region can
+             *         not be accessed directly.
+             */
+            std::shared_ptr<const std::uint8_t> pin(unsigned long long offset, unsigned count) final;
+
         private:
             /**
              * Pointer to the interface class.
@@ -391,6 +391,10 @@ namespace Container {
                 }
 
             #endif
+
+            if (!status) {
+                currentFileSize = currentPosition;
+            }
         }
 
         return status;
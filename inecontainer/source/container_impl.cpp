@@ -24,7 +24,12 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cstring>
 #include <cassert>
 
 #include "container_status.h"
@@ -35,21 +40,56 @@
 #include "file_header_chunk.h"
 #include "fill_chunk.h"
 #include "stream_start_chunk.h"
+#include "directory_record.h"
+#include "stream_data_chunk.h"
+#include "crc_engine.h"
+#include "shared_chunk_data.h"
+#include "compression_engine.h"
 #include "container_virtual_file.h"
 #include "virtual_file_impl.h"
 #include "container_container.h"
 #include "container_impl.h"
 
 ContainerImpl::ContainerImpl(const std::string& fileIdentifier, bool ignoreIdentifier) {
-    ignoreIdentifierOnOpen = ignoreIdentifier;
-    currentFileIdentifier  = fileIdentifier;
-    fileMapsPopulated      = false;
-    currentMinorVersion    = static_cast<std::uint8_t>(-1);
-    startingFileIndex      = ChunkHeader::invalidFileIndex;
+    ignoreIdentifierOnOpen    = ignoreIdentifier;
+    currentFileIdentifier     = fileIdentifier;
+    fileMapsPopulated         = false;
+    currentMinorVersion       = static_cast<std::uint8_t>(-1);
+    startingFileIndex         = ChunkHeader::invalidFileIndex;
+    currentCrcVerification    = Container::Container::CrcVerification::ALWAYS;
+    crcSampleInterval         = Container::Container::defaultCrcSampleInterval;
+    crcSampleCount            = 0;
+    requestedChunkChecksum    = Container::Container::ChunkChecksum::CRC16;
+    currentChunkChecksum      = Container::Container::ChunkChecksum::CRC16;
+    paddingFreeWritesEnabled  = false;
+    currentCompressionEngine  = nullptr;
+    currentCompressionBuffer  = nullptr;
+    deduplicationEnabled      = false;
+    currentWriteBufferBudget  = Container::Container::defaultWriteBufferBudget;
+    totalBufferedBytes        = 0;
+    writeBufferBudgetEnforced = false;
+    ingestSessionActive       = false;
+    ingestBuffer              = nullptr;
+    ingestBufferCount         = 0;
+    ingestBufferIndex         = ChunkHeader::invalidFileIndex;
+    firstIngestIdentifier     = StreamChunk::invalidStreamIdentifier;
+    nextIngestIdentifier      = StreamChunk::invalidStreamIdentifier;
 }
 
 
-ContainerImpl::~ContainerImpl() {}
+ContainerImpl::~ContainerImpl() {
+    if (currentCompressionEngine != nullptr) {
+        delete currentCompressionEngine;
+    }
+
+    if (currentCompressionBuffer != nullptr) {
+        delete[] currentCompressionBuffer;
+    }
+
+    if (ingestBuffer != nullptr) {
+        delete[] ingestBuffer;
+    }
+}
 
 
 void ContainerImpl::setWeakThis(std::weak_ptr<ContainerImpl> newWeakPointer) {
@@ -57,134 +97,1004 @@ void ContainerImpl::setWeakThis(std::weak_ptr<ContainerImpl> newWeakPointer) {
 }
 
 
-void ContainerImpl::setLastStatus(const Container::Status& newStatus) {
-    lastReportedStatus = newStatus;
-}
+void ContainerImpl::setLastStatus(const Container::Status& newStatus) {
+    lastReportedStatus = newStatus;
+}
+
+
+Container::Status ContainerImpl::lastStatus() const {
+    return lastReportedStatus;
+}
+
+
+std::uint8_t ContainerImpl::minorVersion() const {
+    return currentMinorVersion;
+}
+
+
+bool ContainerImpl::supportsExtendedChunks() const {
+    return (
+           currentMinorVersion != static_cast<std::uint8_t>(-1)
+        && currentMinorVersion >= extendedChunkMinorVersion
+    );
+}
+
+
+bool ContainerImpl::supportsCompressedExtents() const {
+    return (
+           currentMinorVersion != static_cast<std::uint8_t>(-1)
+        && currentMinorVersion >= compressedExtentMinorVersion
+    );
+}
+
+
+CompressionEngine& ContainerImpl::compressionEngine() {
+    if (currentCompressionEngine == nullptr) {
+        currentCompressionEngine = new CompressionEngine;
+    }
+
+    return *currentCompressionEngine;
+}
+
+
+std::uint8_t* ContainerImpl::compressionBuffer() {
+    if (currentCompressionBuffer == nullptr) {
+        currentCompressionBuffer = new std::uint8_t[CompressionEngine::maximumBlockSize];
+    }
+
+    return currentCompressionBuffer;
+}
+
+
+bool ContainerImpl::supportsSharedChunks() const {
+    return (
+           currentMinorVersion != static_cast<std::uint8_t>(-1)
+        && currentMinorVersion >= sharedChunkMinorVersion
+    );
+}
+
+
+bool ContainerImpl::supportsInlinePayloads() const {
+    return (
+           currentMinorVersion != static_cast<std::uint8_t>(-1)
+        && currentMinorVersion >= inlinePayloadMinorVersion
+    );
+}
+
+
+void ContainerImpl::setDeduplication(bool enabled) {
+    deduplicationEnabled = enabled;
+}
+
+
+bool ContainerImpl::deduplication() const {
+    return deduplicationEnabled;
+}
+
+
+bool ContainerImpl::deduplicationActive() const {
+    return deduplicationEnabled && supportsSharedChunks();
+}
+
+
+Container::Status ContainerImpl::acquireSharedChunk(
+        const std::uint8_t*     extent,
+        ChunkHeader::FileIndex  nearIndex,
+        ChunkHeader::FileIndex* sharedIndex
+    ) {
+    Container::Status status;
+
+    CrcEngine::RunningCrc64      hash    = CrcEngine::calculate64(0, extent, sharedExtentSize);
+    SharedChunkHashMap::iterator hashPos = sharedChunksByHash.find(hash);
+    bool                         found   = false;
+
+    if (hashPos != sharedChunksByHash.end()) {
+        // The hash only identifies a candidate.  The extents are compared so that a hash collision can never
+        // alias two different extents.
+
+        std::uint8_t* existing = compressionBuffer();
+        status = loadSharedChunk(hashPos->second, existing);
+
+        if (!status && std::memcmp(existing, extent, sharedExtentSize) == 0) {
+            SharedChunkMap::iterator pos = sharedChunks.find(hashPos->second);
+            assert(pos != sharedChunks.end());
+
+            pos->second.addReference();
+
+            *sharedIndex = hashPos->second;
+            found        = true;
+        }
+    }
+
+    if (!status && !found) {
+        unsigned chunkSize = StreamDataChunk::chunkSizeForPayload(*this, sharedChunkHashSizeBytes + sharedExtentSize);
+
+        FreeSpace reservedFreeSpace = reserveFreeSpaceArea(
+            nearIndex,
+            ChunkHeader::toFileIndex(chunkSize),
+            ChunkHeader::toFileIndex(chunkSize)
+        );
+
+        std::uint8_t hashBytes[sharedChunkHashSizeBytes];
+        for (unsigned i=0 ; i<sharedChunkHashSizeBytes ; ++i) {
+            hashBytes[i] = static_cast<std::uint8_t>(hash >> (8 * i));
+        }
+
+        StreamDataChunk chunk(*this, reservedFreeSpace.startingIndex(), StreamChunk::sharedStreamIdentifier, 0);
+
+        chunk.setChunkSize(static_cast<unsigned>(ChunkHeader::toPosition(reservedFreeSpace.areaSize())));
+        chunk.addScatterGatherListSegment(hashBytes, sharedChunkHashSizeBytes);
+        chunk.addScatterGatherListSegment(const_cast<std::uint8_t*>(extent), sharedExtentSize);
+
+        status = chunk.save();
+
+        if (!status) {
+            assert(chunk.scatterGatherListSegment(1).processedCount() == sharedExtentSize);
+
+            ChunkHeader::FileIndex chunkFileSize = ChunkHeader::toFileIndex(chunk.chunkSize());
+
+            reservedFreeSpace.reduceBy(chunkFileSize, FreeSpace::Side::FROM_FRONT);
+            releaseReservation(reservedFreeSpace);
+
+            sharedChunks.insert(SharedChunkMapPair(chunk.fileIndex(), SharedChunkData(hash, chunkFileSize, 1)));
+
+            if (hashPos == sharedChunksByHash.end()) {
+                sharedChunksByHash.insert(SharedChunkHashMapPair(hash, chunk.fileIndex()));
+            }
+
+            *sharedIndex = chunk.fileIndex();
+        }
+    }
+
+    return status;
+}
+
+
+Container::Status ContainerImpl::allocateContiguousArea(
+        ChunkHeader::FileIndex nearIndex,
+        ChunkHeader::FileIndex areaSize,
+        ContainerArea*         area
+    ) {
+    Container::Status status;
+
+    ChunkHeader::FileIndex containerEnd      = ChunkHeader::toFileIndex(static_cast<unsigned long long>(size()));
+    FreeSpace              reservedFreeSpace = reserveFreeSpaceArea(nearIndex, areaSize, areaSize);
+
+    // Areas past the end of the container exist only in the free space map.  Write them as fill area so that the
+    // container covers the allocation.
+
+    ContainerArea fillArea(reservedFreeSpace.startingIndex(), reservedFreeSpace.areaSize());
+    if (fillArea.startingIndex() < containerEnd) {
+        ChunkHeader::FileIndex existingSize = containerEnd - fillArea.startingIndex();
+        ChunkHeader::FileIndex reduction    = existingSize < fillArea.areaSize() ? existingSize : fillArea.areaSize();
+
+        fillArea.reduceBy(reduction, ContainerArea::Side::FROM_FRONT);
+    }
+
+    while (!status && fillArea.areaSize() > 0) {
+        unsigned long long remainingBytes = ChunkHeader::toPosition(fillArea.areaSize());
+        unsigned           fillBytes      = static_cast<unsigned>(
+              remainingBytes < ChunkHeader::maximumExtendedChunkSize
+            ? remainingBytes
+            : ChunkHeader::maximumExtendedChunkSize
+        );
+
+        FillChunk chunk(*this, fillArea.startingIndex(), fillBytes);
+        status = chunk.save();
+
+        if (!status) {
+            fillArea.reduceBy(ChunkHeader::toFileIndex(chunk.chunkSize()), ContainerArea::Side::FROM_FRONT);
+        }
+    }
+
+    if (!status) {
+        *area = ContainerArea(reservedFreeSpace.startingIndex(), reservedFreeSpace.areaSize());
+
+        reservedFreeSpace.reduceBy(reservedFreeSpace.areaSize(), FreeSpace::Side::FROM_FRONT);
+        releaseReservation(reservedFreeSpace);
+    } else {
+        *area = ContainerArea();
+        releaseReservation(reservedFreeSpace);
+    }
+
+    return status;
+}
+
+
+Container::Status ContainerImpl::setWriteBufferBudget(unsigned long long newBudget) {
+    currentWriteBufferBudget = newBudget;
+    return enforceWriteBufferBudget();
+}
+
+
+unsigned long long ContainerImpl::writeBufferBudget() const {
+    return currentWriteBufferBudget;
+}
+
+
+unsigned long long ContainerImpl::bufferedBytes() const {
+    return totalBufferedBytes;
+}
+
+
+void ContainerImpl::bufferedBytesChanged(unsigned long long oldCount, unsigned long long newCount) {
+    assert(totalBufferedBytes >= oldCount);
+    totalBufferedBytes = totalBufferedBytes - oldCount + newCount;
+}
+
+
+Container::Status ContainerImpl::enforceWriteBufferBudget() {
+    Container::Status status;
+
+    if (currentWriteBufferBudget > 0 && totalBufferedBytes > currentWriteBufferBudget && !writeBufferBudgetEnforced) {
+        // The files holding the most data are written first so each file is written using a few large operations.
+        // Writing down to half the budget spreads the cost of writing over many calls.
+
+        typedef std::pair<unsigned long long, std::shared_ptr<VirtualFileImpl>> BufferedFile;
+
+        std::vector<BufferedFile> bufferedFiles;
+        for (IdentifierMap::iterator it=filesByIdentifier.begin(),end=filesByIdentifier.end() ; it!=end ; ++it) {
+            unsigned long long fileBytes = it->second->bytesInWriteCache();
+            if (fileBytes > 0) {
+                bufferedFiles.push_back(BufferedFile(fileBytes, it->second));
+            }
+        }
+
+        std::sort(bufferedFiles.begin(), bufferedFiles.end(), std::greater<BufferedFile>());
+
+        writeBufferBudgetEnforced = true;
+
+        unsigned long long                  targetBytes = currentWriteBufferBudget / 2;
+        std::vector<BufferedFile>::iterator pos         = bufferedFiles.begin();
+        std::vector<BufferedFile>::iterator end         = bufferedFiles.end();
+
+        while (!status && totalBufferedBytes > targetBytes && pos != end) {
+            status = pos->second->releaseBuffers();
+            ++pos;
+        }
+
+        writeBufferBudgetEnforced = false;
+    }
+
+    return status;
+}
+
+
+void ContainerImpl::releaseSharedChunk(ChunkHeader::FileIndex sharedIndex) {
+    SharedChunkMap::iterator pos = sharedChunks.find(sharedIndex);
+    assert(pos != sharedChunks.end());
+
+    if (pos != sharedChunks.end() && !pos->second.removeReference()) {
+        SharedChunkHashMap::iterator hashPos = sharedChunksByHash.find(pos->second.hash());
+        if (hashPos != sharedChunksByHash.end() && hashPos->second == sharedIndex) {
+            sharedChunksByHash.erase(hashPos);
+        }
+
+        newFreeSpaceArea(sharedIndex, pos->second.chunkSize(), true);
+        sharedChunks.erase(pos);
+    }
+}
+
+
+Container::Status ContainerImpl::loadSharedChunk(ChunkHeader::FileIndex sharedIndex, std::uint8_t* extent) {
+    Container::Status status;
+
+    std::uint8_t    hashBytes[sharedChunkHashSizeBytes];
+    StreamDataChunk chunk(*this, sharedIndex, StreamChunk::sharedStreamIdentifier, 0);
+
+    chunk.setChunkSize(ChunkHeader::maximumExtendedChunkSize); // The load method will set the actual chunk size.
+    chunk.addScatterGatherListSegment(hashBytes, sharedChunkHashSizeBytes);
+    chunk.addScatterGatherListSegment(extent, sharedExtentSize);
+
+    status = chunk.load(true);
+
+    if (!status && chunk.streamIdentifier() != StreamChunk::sharedStreamIdentifier) {
+        status = Container::StreamIdentifierMismatch(
+            chunk.streamIdentifier(),
+            StreamChunk::sharedStreamIdentifier,
+            ChunkHeader::toPosition(sharedIndex)
+        );
+    }
+
+    if (!status && chunk.scatterGatherListSegment(1).processedCount() != sharedExtentSize) {
+        status = Container::PayloadSizeMismatch(
+            chunk.scatterGatherListSegment(1).processedCount(),
+            sharedExtentSize,
+            ChunkHeader::toPosition(sharedIndex)
+        );
+    }
+
+    if (!status) {
+        status = verifyChunk(chunk);
+    }
+
+    return status;
+}
+
+
+void ContainerImpl::setCrcVerification(Container::Container::CrcVerification policy, unsigned sampleInterval) {
+    currentCrcVerification = policy;
+    crcSampleInterval      = sampleInterval > 0 ? sampleInterval : 1;
+    crcSampleCount         = 0;
+}
+
+
+Container::Container::CrcVerification ContainerImpl::crcVerification() const {
+    return currentCrcVerification;
+}
+
+
+void ContainerImpl::setPaddingFreeWrites(bool enabled) {
+    paddingFreeWritesEnabled = enabled;
+}
+
+
+bool ContainerImpl::paddingFreeWrites() const {
+    return paddingFreeWritesEnabled;
+}
+
+
+void ContainerImpl::setChunkChecksum(Container::Container::ChunkChecksum checksum) {
+    requestedChunkChecksum = checksum;
+}
+
+
+Container::Container::ChunkChecksum ContainerImpl::chunkChecksum() const {
+    return currentChunkChecksum;
+}
+
+
+bool ContainerImpl::usesPayloadChecksums() const {
+    return currentChunkChecksum == Container::Container::ChunkChecksum::CRC64;
+}
+
+
+Container::Status ContainerImpl::verifyChunk(const Chunk& chunk) {
+    Container::Status status;
+
+    ChunkHeader::FileIndex fileIndex = chunk.fileIndex();
+    std::uint64_t          bitMask   = 1ULL << (fileIndex % 64);
+    bool                   checkNeeded;
+
+    switch (currentCrcVerification) {
+        case Container::Container::CrcVerification::OFF: {
+            checkNeeded = false;
+            break;
+        }
+
+        case Container::Container::CrcVerification::SAMPLED: {
+            checkNeeded = (crcSampleCount == 0);
+
+            ++crcSampleCount;
+            if (crcSampleCount >= crcSampleInterval) {
+                crcSampleCount = 0;
+            }
+
+            break;
+        }
+
+        case Container::Container::CrcVerification::ALWAYS: {
+            checkNeeded = true;
+            break;
+        }
+
+        case Container::Container::CrcVerification::FIRST_TOUCH: {
+            ChunkBitmap::const_iterator pos = verifiedChunks.find(fileIndex / 64);
+            checkNeeded = (pos == verifiedChunks.cend() || (pos->second & bitMask) == 0);
+
+            break;
+        }
+
+        default: {
+            assert(false);
+            checkNeeded = true;
+            break;
+        }
+    }
+
+    if (checkNeeded) {
+        if (!chunk.checkCrc()) {
+            status = Container::ChunkCrcError(ChunkHeader::toPosition(fileIndex));
+        } else if (currentCrcVerification == Container::Container::CrcVerification::FIRST_TOUCH) {
+            verifiedChunks[fileIndex / 64] |= bitMask;
+        }
+    }
+
+    return status;
+}
+
+
+void ContainerImpl::forgetVerifiedChunks(ChunkHeader::FileIndex startingIndex, ChunkHeader::FileIndex areaSize) {
+    if (!verifiedChunks.empty() && areaSize > 0) {
+        ChunkHeader::FileIndex endingIndex = startingIndex + areaSize - 1;
+        ChunkHeader::FileIndex firstWord   = startingIndex / 64;
+        ChunkHeader::FileIndex lastWord    = endingIndex / 64;
+
+        if (lastWord - firstWord >= verifiedChunks.size()) {
+            // Large areas are handled by walking the bitmap rather than the area.
+
+            ChunkBitmap::iterator pos = verifiedChunks.begin();
+            while (pos != verifiedChunks.end()) {
+                ChunkHeader::FileIndex word = pos->first;
+
+                if (word >= firstWord && word <= lastWord) {
+                    unsigned lowBit  = word == firstWord ? startingIndex % 64 : 0;
+                    unsigned highBit = word == lastWord ? endingIndex % 64 : 63;
+
+                    pos->second &= ~((~0ULL << lowBit) & (~0ULL >> (63 - highBit)));
+                }
+
+                if (pos->second == 0) {
+                    pos = verifiedChunks.erase(pos);
+                } else {
+                    ++pos;
+                }
+            }
+        } else {
+            for (ChunkHeader::FileIndex word=firstWord ; word<=lastWord ; ++word) {
+                ChunkBitmap::iterator pos = verifiedChunks.find(word);
+
+                if (pos != verifiedChunks.end()) {
+                    unsigned lowBit  = word == firstWord ? startingIndex % 64 : 0;
+                    unsigned highBit = word == lastWord ? endingIndex % 64 : 63;
+
+                    pos->second &= ~((~0ULL << lowBit) & (~0ULL >> (63 - highBit)));
+
+                    if (pos->second == 0) {
+                        verifiedChunks.erase(pos);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+Container::Status ContainerImpl::open() {
+    Container::Status status;
+
+    status = setPosition(0);
+    if (!status) {
+        std::uint8_t commonHeader[ChunkHeader::minimumChunkHeaderSizeBytes];
+        status = read(commonHeader, ChunkHeader::minimumChunkHeaderSizeBytes);
+
+        if (status.success()                                                                          &&
+            Container::ReadSuccessful(status).bytesRead() == ChunkHeader::minimumChunkHeaderSizeBytes    ) {
+            FileHeaderChunk fileHeader(*this, 0, commonHeader);
+            status = fileHeader.load();
+
+            if (!ignoreIdentifierOnOpen) {
+                if (!status) {
+                    if (fileHeader.identifier() != currentFileIdentifier) {
+                        status = Container::HeaderIdentifierInvalid();
+                    }
+                }
+
+                if (!status) {
+                    if (fileHeader.majorVersion() < Container::Container::containerMajorVersion) {
+                        status = Container::VersionDownlevelStatus(
+                            fileHeader.majorVersion(),
+                            Container::Container::containerMajorVersion
+                        );
+                    }
+                }
+
+                if (!status) {
+                    if (fileHeader.majorVersion() > Container::Container::containerMajorVersion) {
+                        status = Container::HeaderVersionInvalid(
+                            fileHeader.majorVersion(),
+                            Container::Container::containerMajorVersion
+                        );
+                    }
+                }
+
+            }
+
+            if (!status) {
+                if (!fileHeader.checkCrc()) {
+                    status = Container::HeaderCrcError();
+                }
+            }
+
+            if (!status) {
+                currentMinorVersion  = fileHeader.minorVersion();
+                startingFileIndex    = ChunkHeader::toFileIndex(fileHeader.chunkSize());
+                currentChunkChecksum = Container::Container::ChunkChecksum::CRC16;
+
+                if (currentMinorVersion >= payloadChecksumMinorVersion) {
+                    bool ok;
+                    currentChunkChecksum = fileHeader.chunkChecksum(&ok);
+
+                    if (!ok) {
+                        status = Container::ContainerDataError(0);
+                    }
+                }
+            }
+
+            if (size() == startingFileIndex) {
+                fileMapsPopulated = true;
+            } else {
+                fileMapsPopulated = false;
+            }
+        } else if (size() == 0) {
+            FileHeaderChunk fileHeader(*this, 0, currentFileIdentifier);
+            fileHeader.setChunkChecksum(requestedChunkChecksum);
+
+            status = fileHeader.save();
+
+            if (!status) {
+                currentMinorVersion  = fileHeader.minorVersion();
+                startingFileIndex    = ChunkHeader::toFileIndex(fileHeader.chunkSize());
+                currentChunkChecksum = requestedChunkChecksum;
+                fileMapsPopulated    = true;
+            }
+        }
+    }
+
+    if (status) {
+        currentMinorVersion  = static_cast<std::uint8_t>(-1);
+        startingFileIndex    = ChunkHeader::invalidFileIndex;
+        currentChunkChecksum = Container::Container::ChunkChecksum::CRC16;
+        fileMapsPopulated    = false;
+    }
+
+    filesByIdentifier.clear();
+    fileApisByName.clear();
+    filesByName.clear();
+    recordsByName.clear();
+    recordsByIdentifier.clear();
+    verifiedChunks.clear();
+    sharedChunks.clear();
+    sharedChunksByHash.clear();
+
+    clearFreeSpace();
+
+    lastReportedStatus = status;
+    return status;
+}
+
+
+Container::Status ContainerImpl::close() {
+    Container::Status status;
+
+    if (ingestSessionActive) {
+        status = commitIngest();
+    }
+
+    DirectoryMap::iterator pos = filesByName.begin();
+    DirectoryMap::iterator end = filesByName.end();
+
+    // Files are flushed first as flushing a file can release space, for example when a modified shared or compressed
+    // extent is relocated.
+
+    while (!status && pos != end) {
+        status = pos->second->flush();
+        ++pos;
+    }
+
+    if (!status) {
+        bool success = flushFreeSpace();
+        if (!success) {
+            status = lastReportedStatus;
+        }
+    }
+
+    lastReportedStatus = status;
+    return status;
+}
+
+
+Container::Container::DirectoryMap ContainerImpl::directory() {
+    if (!fileMapsPopulated) {
+        lastReportedStatus = traverseContainer(true);
+    }
+
+    if (!lastReportedStatus) {
+        lastReportedStatus = materializeAllRecords();
+    }
+
+    return fileApisByName;
+}
+
+
+Container::Status ContainerImpl::forEachFile(
+        const Container::Container::FileVisitor& visitor,
+        const std::string&                       prefix
+    ) {
+    Container::Status status;
+
+    if (!fileMapsPopulated) {
+        status = traverseContainer(true);
+        lastReportedStatus = status;
+    }
+
+    // Entries are located by name on every step so that the visitor is free to modify the directory.  Each step picks
+    // the next name from either the materialised files or the outstanding records.
+
+    bool        continueVisit = true;
+    bool        firstEntry    = true;
+    std::string lastName;
+
+    while (!status && continueVisit) {
+        Container::Container::DirectoryMap::iterator apiIterator;
+        RecordMap::iterator                          recordIterator;
+
+        if (firstEntry) {
+            apiIterator    = fileApisByName.lower_bound(prefix);
+            recordIterator = recordsByName.lower_bound(prefix);
+            firstEntry     = false;
+        } else {
+            apiIterator    = fileApisByName.upper_bound(lastName);
+            recordIterator = recordsByName.upper_bound(lastName);
+        }
+
+        bool useRecord;
+        if (recordIterator == recordsByName.end()) {
+            useRecord = false;
+        } else if (apiIterator == fileApisByName.end()) {
+            useRecord = true;
+        } else {
+            useRecord = recordIterator->first < apiIterator->first;
+        }
+
+        if (useRecord) {
+            lastName = recordIterator->first;
+        } else if (apiIterator != fileApisByName.end()) {
+            lastName = apiIterator->first;
+        } else {
+            continueVisit = false;
+        }
+
+        if (continueVisit && lastName.compare(0, prefix.size(), prefix) != 0) {
+            continueVisit = false;
+        }
+
+        if (continueVisit) {
+            // We hold our own copies of the name and file so the visitor can rename or erase the entry.
+
+            std::shared_ptr<Container::VirtualFile> virtualFile;
+            if (useRecord) {
+                virtualFile = materializeRecord(recordIterator);
+                if (!virtualFile) {
+                    status = lastReportedStatus;
+                }
+            } else {
+                virtualFile = apiIterator->second;
+            }
+
+            if (!status) {
+                continueVisit = visitor(lastName, virtualFile);
+            }
+        }
+    }
+
+    return status;
+}
+
+
+std::shared_ptr<Container::VirtualFile> ContainerImpl::virtualFile(const std::string& virtualFileName) {
+    std::shared_ptr<Container::VirtualFile> result;
+
+    if (!fileMapsPopulated) {
+        lastReportedStatus = traverseContainer(true);
+    }
+
+    Container::Container::DirectoryMap::const_iterator pos = fileApisByName.find(virtualFileName);
+    if (pos != fileApisByName.end()) {
+        result = pos->second;
+    } else {
+        RecordMap::iterator recordIterator = recordsByName.find(virtualFileName);
+        if (recordIterator != recordsByName.end()) {
+            result = materializeRecord(recordIterator);
+        }
+    }
+
+    return result;
+}
+
+
+Container::Status ContainerImpl::eraseFiles(const std::vector<std::string>& virtualFileNames, bool verify) {
+    Container::Status status;
+
+    if (!fileMapsPopulated) {
+        status = traverseContainer(true);
+    }
+
+    std::vector<std::string>::const_iterator pos = virtualFileNames.cbegin();
+    std::vector<std::string>::const_iterator end = virtualFileNames.cend();
+
+    // Each file releases its space without updating the media.  The released areas are merged by the free space
+    // tracker and written once below.
+
+    while (!status && pos != end) {
+        if (virtualFile(*pos)) {
+            DirectoryMap::iterator filePosition = filesByName.find(*pos);
+            assert(filePosition != filesByName.end());
+
+            std::shared_ptr<VirtualFileImpl> file = filePosition->second;
+            status = file->erase(verify, false);
+        }
+
+        ++pos;
+    }
+
+    if (!status) {
+        bool success = flushFreeSpace();
+        if (!success) {
+            status = lastReportedStatus;
+        }
+    }
+
+    lastReportedStatus = status;
+    return status;
+}
+
+
+Container::Status ContainerImpl::clear() {
+    Container::Status status;
+
+    if (ingestSessionActive) {
+        endIngest();
+    }
+
+    for (IdentifierMap::iterator it=filesByIdentifier.begin(),end=filesByIdentifier.end() ; it!=end ; ++it) {
+        it->second->detach();
+    }
+
+    filesByIdentifier.clear();
+    fileApisByName.clear();
+    filesByName.clear();
+    recordsByName.clear();
+    recordsByIdentifier.clear();
+    verifiedChunks.clear();
+    sharedChunks.clear();
+    sharedChunksByHash.clear();
+
+    clearFreeSpace();
+
+    // Everything after the file header is released in one operation.  Containers that support truncation are cut
+    // back to the file header.  Other containers have the space marked as unused.
+
+    if (startingFileIndex != ChunkHeader::invalidFileIndex) {
+        ChunkHeader::FileIndex endingIndex = ChunkHeader::toFileIndex(static_cast<unsigned long long>(size()));
+        if (endingIndex > startingFileIndex) {
+            ContainerArea area(startingFileIndex, endingIndex - startingFileIndex);
+
+            bool success = flushArea(area);
+            if (!success) {
+                status = lastReportedStatus;
+            } else if (!supportsTruncation()) {
+                newFreeSpaceArea(area);
+            }
+        }
+
+        if (!status) {
+            fileMapsPopulated = true;
+        }
+    }
+
+    lastReportedStatus = status;
+    return status;
+}
+
+
+Container::Status ContainerImpl::beginIngest() {
+    Container::Status status;
+
+    if (ingestSessionActive) {
+        status = Container::IngestSessionError();
+    } else if (!fileMapsPopulated) {
+        status = traverseContainer(true);
+    }
+
+    if (!status) {
+        // Identifiers are handed out in sequence, starting above every identifier currently in use, so we never need
+        // to probe for an unused identifier.
+
+        StreamChunk::StreamIdentifier identifier = 0;
+
+        if (!filesByIdentifier.empty()) {
+            identifier = filesByIdentifier.rbegin()->first + 1;
+        }
+
+        RecordIdentifierMap::const_iterator pos = recordsByIdentifier.cbegin();
+        RecordIdentifierMap::const_iterator end = recordsByIdentifier.cend();
 
+        while (pos != end) {
+            if (pos->first >= identifier) {
+                identifier = pos->first + 1;
+            }
 
-Container::Status ContainerImpl::lastStatus() const {
-    return lastReportedStatus;
-}
+            ++pos;
+        }
 
+        ingestSessionActive   = true;
+        ingestStatus          = Container::NoStatus();
+        ingestBuffer          = new std::uint8_t[ingestBufferSizeBytes];
+        ingestBufferCount     = 0;
+        firstIngestIdentifier = identifier;
+        nextIngestIdentifier  = identifier;
+    }
 
-std::uint8_t ContainerImpl::minorVersion() const {
-    return currentMinorVersion;
+    lastReportedStatus = status;
+    return status;
 }
 
 
-Container::Status ContainerImpl::open() {
+Container::Status ContainerImpl::ingestFile(
+        const std::string&  virtualFileName,
+        const std::uint8_t* data,
+        unsigned long long  fileSize
+    ) {
     Container::Status status;
 
-    status = setPosition(0);
+    if (!ingestSessionActive || ingestStatus) {
+        status = Container::IngestSessionError();
+    } else if (fileApisByName.find(virtualFileName) != fileApisByName.end() ||
+               recordsByName.find(virtualFileName) != recordsByName.end()   ||
+               ingestRecords.find(virtualFileName) != ingestRecords.end()      ) {
+        status = Container::FileCreationError(
+            virtualFileName,
+            static_cast<unsigned long long>(size()) + ingestBufferCount
+        );
+    }
+
     if (!status) {
-        std::uint8_t commonHeader[ChunkHeader::minimumChunkHeaderSizeBytes];
-        status = read(commonHeader, ChunkHeader::minimumChunkHeaderSizeBytes);
+        StreamChunk::StreamIdentifier identifier = nextIngestIdentifier;
+        while (filesByIdentifier.find(identifier) != filesByIdentifier.end()) {
+            ++identifier;
+        }
 
-        if (status.success()                                                                          &&
-            Container::ReadSuccessful(status).bytesRead() == ChunkHeader::minimumChunkHeaderSizeBytes    ) {
-            FileHeaderChunk fileHeader(weakThis, 0, commonHeader);
-            status = fileHeader.load();
+        assert(identifier < StreamChunk::sharedStreamIdentifier);
+        nextIngestIdentifier = identifier + 1;
 
-            if (!ignoreIdentifierOnOpen) {
-                if (!status) {
-                    if (fileHeader.identifier() != currentFileIdentifier) {
-                        status = Container::HeaderIdentifierInvalid();
-                    }
-                }
+        // Small files are held entirely in the stream start chunk.
 
-                if (!status) {
-                    if (fileHeader.majorVersion() < Container::Container::containerMajorVersion) {
-                        status = Container::VersionDownlevelStatus(
-                            fileHeader.majorVersion(),
-                            Container::Container::containerMajorVersion
-                        );
-                    }
-                }
+        bool inlined = (
+               supportsInlinePayloads()
+            && fileSize > 0
+            && fileSize <= StreamStartChunk::maximumInlinePayloadSize
+        );
 
-                if (!status) {
-                    if (fileHeader.majorVersion() > Container::Container::containerMajorVersion) {
-                        status = Container::HeaderVersionInvalid(
-                            fileHeader.majorVersion(),
-                            Container::Container::containerMajorVersion
-                        );
-                    }
-                }
+        unsigned         inlineSize = inlined ? static_cast<unsigned>(fileSize) : 0;
+        StreamStartChunk startChunk(*this, 0, virtualFileName, identifier, inlineSize);
 
+        if (inlined) {
+            startChunk.setInlinePayload(data);
+        }
+
+        status = stageChunk(startChunk);
+
+        if (!status) {
+            RecordMap::iterator recordIterator = ingestRecords.insert(
+                RecordMapPair(virtualFileName, DirectoryRecord(identifier, startChunk.fileIndex()))
+            ).first;
+
+            DirectoryRecord&   record        = recordIterator->second;
+            bool               allowExtended = supportsExtendedChunks();
+            unsigned long long written       = inlineSize;
+
+            if (inlined) {
+                record.addChunkLocation(
+                    startChunk.fileIndex(),
+                    ChunkHeader::toFileIndex(startChunk.chunkSize()),
+                    0,
+                    inlineSize,
+                    false,
+                    ChunkHeader::invalidFileIndex,
+                    true
+                );
             }
 
-            if (!status) {
-                if (!fileHeader.checkCrc()) {
-                    status = Container::HeaderCrcError();
+            // Chunks are sized as they are for delayed allocation.  Large chunks are used where possible and the last
+            // chunk is sized to fit the remaining data.
+
+            while (!status && written < fileSize) {
+                unsigned long long remaining = fileSize - written;
+                unsigned           chunkSize = StreamDataChunk::preferredChunkSize(remaining, allowExtended);
+                unsigned           capacity  = StreamDataChunk::payloadCapacity(*this, chunkSize);
+
+                if (capacity >= remaining) {
+                    capacity  = static_cast<unsigned>(remaining);
+                    chunkSize = StreamDataChunk::chunkSizeForPayload(*this, capacity);
                 }
-            }
 
-            if (!status) {
-                currentMinorVersion = fileHeader.minorVersion();
-                startingFileIndex   = ChunkHeader::toFileIndex(fileHeader.chunkSize());
-            }
+                StreamDataChunk chunk(*this, 0, identifier, written);
 
-            if (size() == startingFileIndex) {
-                fileMapsPopulated = true;
-            } else {
-                fileMapsPopulated = false;
-            }
-        } else if (size() == 0) {
-            FileHeaderChunk fileHeader(weakThis, 0, currentFileIdentifier);
-            status = fileHeader.save();
+                chunk.setChunkSize(chunkSize);
+                chunk.addScatterGatherListSegment(const_cast<std::uint8_t*>(data + written), capacity);
 
-            if (!status) {
-                currentMinorVersion = fileHeader.minorVersion();
-                startingFileIndex   = ChunkHeader::toFileIndex(fileHeader.chunkSize());
-                fileMapsPopulated   = true;
+                status = stageChunk(chunk);
+
+                if (!status) {
+                    unsigned extentSize = chunk.scatterGatherListSegment(0).processedCount();
+
+                    record.addChunkLocation(
+                        chunk.fileIndex(),
+                        ChunkHeader::toFileIndex(chunk.chunkSize()),
+                        written,
+                        extentSize,
+                        false
+                    );
+
+                    written += extentSize;
+                }
             }
         }
     }
 
-    if (status) {
-        currentMinorVersion = static_cast<std::uint8_t>(-1);
-        startingFileIndex   = ChunkHeader::invalidFileIndex;
-        fileMapsPopulated   = false;
-    }
+    lastReportedStatus = status;
+    return status;
+}
 
-    filesByIdentifier.clear();
-    fileApisByName.clear();
-    filesByName.clear();
 
-    clearFreeSpace();
+Container::Status ContainerImpl::commitIngest() {
+    Container::Status status;
+
+    if (!ingestSessionActive) {
+        status = Container::IngestSessionError();
+    } else {
+        status = writeIngestBuffer();
+
+        if (!status) {
+            // The ingested files are only recorded here.  Each file is created the first time it's accessed.
+
+            for (RecordMap::iterator it=ingestRecords.begin(),end=ingestRecords.end() ; it!=end ; ++it) {
+                StreamChunk::StreamIdentifier identifier = it->second.streamIdentifier();
+
+                it->second.compact();
+
+                RecordMap::iterator recordIterator = recordsByName.insert(
+                    RecordMapPair(it->first, std::move(it->second))
+                ).first;
+
+                recordsByIdentifier.insert(RecordIdentifierMapPair(identifier, recordIterator));
+            }
+
+            endIngest();
+        } else {
+            abortIngest();
+        }
+    }
 
     lastReportedStatus = status;
     return status;
 }
 
 
-Container::Status ContainerImpl::close() {
+Container::Status ContainerImpl::abortIngest() {
     Container::Status status;
 
-    DirectoryMap::iterator pos = filesByName.begin();
-    DirectoryMap::iterator end = filesByName.end();
-
-    bool success = flushFreeSpace();
-    if (!success) {
-        status = lastReportedStatus;
+    if (!ingestSessionActive) {
+        status = Container::IngestSessionError();
     } else {
-        while (!status && pos != end) {
-            status = pos->second->flush();
+        // Staged data never reached the container.  Areas that were written are released and marked as unused.
+
+        ingestBufferCount = 0;
+
+        std::vector<ContainerArea>::const_iterator pos = ingestAreas.cbegin();
+        std::vector<ContainerArea>::const_iterator end = ingestAreas.cend();
+
+        while (pos != end) {
+            newFreeSpaceArea(*pos, true);
             ++pos;
         }
 
-        lastReportedStatus = status;
+        endIngest();
+
+        bool success = flushFreeSpace();
+        if (!success) {
+            status = lastReportedStatus;
+        }
     }
 
+    lastReportedStatus = status;
     return status;
 }
 
 
-Container::Container::DirectoryMap ContainerImpl::directory() {
-    if (!fileMapsPopulated) {
-        lastReportedStatus = traverseContainer(true);
-    }
-
-    return fileApisByName;
+bool ContainerImpl::ingestActive() const {
+    return ingestSessionActive;
 }
 
 
@@ -222,7 +1132,12 @@ StreamChunk::StreamIdentifier ContainerImpl::newStreamIdentifier(bool *ok) {
                 ++newIdentifier;
                 assert(newIdentifier != StreamChunk::invalidStreamIdentifier);
             }
-        } while (filesByIdentifier.find(newIdentifier) != filesByIdentifier.end());
+        } while (filesByIdentifier.find(newIdentifier) != filesByIdentifier.end()     ||
+                 recordsByIdentifier.find(newIdentifier) != recordsByIdentifier.end() ||
+                 newIdentifier == StreamChunk::sharedStreamIdentifier                 ||
+                 (ingestSessionActive                    &&
+                  newIdentifier >= firstIngestIdentifier &&
+                  newIdentifier < nextIngestIdentifier      )                            );
     }
 
     if (ok != nullptr) {
@@ -241,7 +1156,9 @@ std::shared_ptr<Container::VirtualFile> ContainerImpl::newVirtualFile(const std:
     }
 
     Container::Container::DirectoryMap::iterator pos = fileApisByName.find(newVirtualFileName);
-    if (pos == fileApisByName.end()) {
+    if (pos == fileApisByName.end()                                  &&
+        recordsByName.find(newVirtualFileName) == recordsByName.end() &&
+        ingestRecords.find(newVirtualFileName) == ingestRecords.end()    ) {
         Container::VirtualFile* virtualFile = createFile(newVirtualFileName);
         if (virtualFile != nullptr) {
             result.reset(virtualFile);
@@ -324,8 +1241,15 @@ bool ContainerImpl::fileErased(const std::string& name) {
 bool ContainerImpl::flushArea(const ContainerArea& area) {
     Container::Status status;
 
+    // Staged ingest data is placed at the current end of the container so it must be written before the container can
+    // be truncated.
+
+    if (ingestBufferCount > 0) {
+        status = writeIngestBuffer();
+    }
+
     unsigned long long containerSize = static_cast<unsigned long long>(size());
-    if (supportsTruncation() && ChunkHeader::toPosition(area.endingIndex()) >= containerSize) {
+    if (!status && supportsTruncation() && ChunkHeader::toPosition(area.endingIndex()) >= containerSize) {
         // If the area to flush and mark as free goes all the way to the end of the file and the container object
         // supports file truncation, truncate the file.
 
@@ -340,7 +1264,7 @@ bool ContainerImpl::flushArea(const ContainerArea& area) {
 
         while (!status && remainingArea.areaSize() > 0) {
             FillChunk chunk(
-                weakThis,
+                *this,
                 remainingArea.startingIndex(),
                 static_cast<unsigned>(ChunkHeader::toPosition(remainingArea.areaSize()))
             );
@@ -358,20 +1282,45 @@ bool ContainerImpl::flushArea(const ContainerArea& area) {
 }
 
 
+void ContainerImpl::extendingContainer() {
+    if (ingestBufferCount > 0) {
+        Container::Status status = writeIngestBuffer();
+        if (status) {
+            lastReportedStatus = status;
+        }
+    }
+}
+
+
+void ContainerImpl::areaReleased(const ContainerArea& area) {
+    forgetVerifiedChunks(area.startingIndex(), area.areaSize());
+}
+
+
 Container::Status ContainerImpl::traverseContainer(bool buildMapsOnly) {
     Container::Status status;
 
     fileMapsPopulated = true;
 
+    sharedChunks.clear();
+    sharedChunksByHash.clear();
+
     unsigned long long currentPosition = ChunkHeader::toPosition(startingFileIndex);
     unsigned long long fileSize        = size();
 
     std::uint8_t* buffer;
+    unsigned      bufferSize;
+
+    if (supportsExtendedChunks()) {
+        bufferSize = ChunkHeader::maximumExtendedChunkSize;
+    } else {
+        bufferSize = ChunkHeader::maximumChunkSize;
+    }
 
     if (buildMapsOnly) {
         buffer = nullptr;
     } else {
-        buffer = new std::uint8_t[ChunkHeader::maximumChunkSize];
+        buffer = new std::uint8_t[bufferSize];
     }
 
     while (!status && currentPosition < fileSize) {
@@ -407,83 +1356,234 @@ Container::Status ContainerImpl::traverseContainer(bool buildMapsOnly) {
                 }
 
                 case Chunk::Type::STREAM_START_CHUNK: {
-                    StreamStartChunk streamStartChunk(weakThis, Chunk::toFileIndex(currentPosition), commonHeader);
+                    StreamStartChunk streamStartChunk(*this, Chunk::toFileIndex(currentPosition), commonHeader);
                     status = streamStartChunk.load(false);
 
                     std::string                   virtualFilename;
                     StreamChunk::StreamIdentifier identifier = StreamChunk::invalidStreamIdentifier;
 
+                    unsigned inlineSize = streamStartChunk.inlinePayloadSize();
+
+                    if (!status && inlineSize > 0 && !supportsInlinePayloads()) {
+                        status = Container::ContainerDataError(currentPosition);
+                    }
+
                     if (!status) {
                         virtualFilename = streamStartChunk.virtualFilename();
                         identifier      = streamStartChunk.streamIdentifier();
 
-                        if (!status && filesByName.find(virtualFilename) != filesByName.end()) {
+                        if (filesByName.find(virtualFilename) != filesByName.end()     ||
+                            recordsByName.find(virtualFilename) != recordsByName.end()    ) {
                             status = Container::FilenameMismatch(virtualFilename, "", currentPosition);
                         }
                     }
 
                     if (!status) {
-                        std::shared_ptr<Container::VirtualFile> vf = callNewVirtualFile(virtualFilename);
-
-                        if (!vf) {
-                            status = Container::FileCreationError(virtualFilename, currentPosition);
+                        // We only record the location of the file here.  The virtual file itself is created the first
+                        // time it's accessed, unless the caller needs the file contents now.
+
+                        RecordMap::iterator recordIterator = recordsByName.insert(
+                            RecordMapPair(virtualFilename, DirectoryRecord(identifier, streamStartChunk.fileIndex()))
+                        ).first;
+
+                        recordsByIdentifier.insert(RecordIdentifierMapPair(identifier, recordIterator));
+
+                        if (inlineSize > 0) {
+                            recordIterator->second.addChunkLocation(
+                                streamStartChunk.fileIndex(),
+                                ChunkHeader::toFileIndex(chunkSize),
+                                0,
+                                inlineSize,
+                                false,
+                                ChunkHeader::invalidFileIndex,
+                                true
+                            );
                         }
 
-                        DirectoryMap::iterator pos = filesByName.find(virtualFilename);
-                        assert(pos != filesByName.end());
-
-                        std::shared_ptr<VirtualFileImpl> vfi = pos->second;
-
-                        // The virtual file will automatically assign an identifier and it may be incorrect. We
-                        // check if the identifier is incorrect and change it here, if needed.
+                        if (!buildMapsOnly) {
+                            std::shared_ptr<Container::VirtualFile> vf = materializeRecord(recordIterator);
+                            if (!vf) {
+                                status = Container::FileCreationError(virtualFilename, currentPosition);
+                            } else if (inlineSize > 0) {
+                                status = verifyChunk(streamStartChunk);
 
-                        StreamChunk::StreamIdentifier guessIdentifier = vfi->streamIdentifier();
+                                if (!status) {
+                                    IdentifierMap::iterator pos = filesByIdentifier.find(identifier);
+                                    assert(pos != filesByIdentifier.end());
 
-                        if (guessIdentifier != identifier) {
-                            IdentifierMap::iterator posByIdentifier = filesByIdentifier.find(guessIdentifier);
-                            assert(posByIdentifier != filesByIdentifier.end());
-
-                            vfi->setStreamIdentifier(identifier);
-
-                            filesByIdentifier.insert(IdentifierMapPair(identifier, posByIdentifier->second));
-                            filesByIdentifier.erase(posByIdentifier);
+                                    status = pos->second->receivedData(streamStartChunk.inlinePayload(), inlineSize);
+                                }
+                            }
                         }
-
-                        vfi->setStreamStartIndex(streamStartChunk.fileIndex());
                     }
 
                     break;
                 }
 
                 case Chunk::Type::STREAM_DATA_CHUNK: {
-                    StreamDataChunk streamDataChunk(weakThis, Chunk::toFileIndex(currentPosition), commonHeader);
-
-                    if (buildMapsOnly) {
+                    StreamDataChunk streamDataChunk(*this, Chunk::toFileIndex(currentPosition), commonHeader);
+
+                    std::uint8_t           leadingBytes[StreamDataChunk::sharedReferenceSizeBytes];
+                    const std::uint8_t*    payload       = buffer;
+                    unsigned               payloadSize   = 0;
+                    unsigned               payloadLength = 0;
+                    bool                   sharedChunk   = false;
+                    ChunkHeader::FileIndex sharedIndex   = ChunkHeader::invalidFileIndex;
+
+                    if (streamDataChunk.isExtended() && !supportsExtendedChunks()) {
+                        status = Container::ContainerDataError(currentPosition);
+                    } else if (buildMapsOnly) {
                         status = streamDataChunk.loadHeader(false);
+
+                        if (!status) {
+                            payloadSize = streamDataChunk.payloadSize();
+                            sharedChunk = (
+                                   supportsSharedChunks()
+                                && streamDataChunk.streamIdentifier() == StreamChunk::sharedStreamIdentifier
+                            );
+                        }
+
+                        if (!status && (sharedChunk || streamDataChunk.isCompressedExtent())) {
+                            // Only the leading bytes of the payload are needed to identify the extent.  Shared
+                            // chunks lead with the content hash of the shared extent.
+
+                            payloadLength =   payloadSize < StreamDataChunk::sharedReferenceSizeBytes
+                                            ? payloadSize
+                                            : StreamDataChunk::sharedReferenceSizeBytes;
+
+                            if (payloadLength < CompressionEngine::blockHeaderSizeBytes) {
+                                status = Container::ContainerDataError(currentPosition);
+                            } else {
+                                status = read(leadingBytes, payloadLength);
+                                if (status.success()                                                &&
+                                    Container::ReadSuccessful(status).bytesRead() == payloadLength    ) {
+                                    status = Container::NoStatus();
+                                }
+                            }
+
+                            payload = leadingBytes;
+                        }
                     } else {
-                        streamDataChunk.addScatterGatherListSegment(buffer, ChunkHeader::maximumChunkSize);
+                        streamDataChunk.addScatterGatherListSegment(buffer, bufferSize);
                         status = streamDataChunk.load(false);
+
+                        if (!status) {
+                            status = verifyChunk(streamDataChunk);
+                        }
+
+                        if (!status) {
+                            payloadSize   = streamDataChunk.scatterGatherListSegment(0).processedCount();
+                            payloadLength = payloadSize;
+                            sharedChunk   = (
+                                   supportsSharedChunks()
+                                && streamDataChunk.streamIdentifier() == StreamChunk::sharedStreamIdentifier
+                            );
+                        }
                     }
 
-                    if (!status) {
+                    if (!status && sharedChunk) {
+                        // Shared chunks are tracked by the container rather than by a virtual file.
+
+                        if (payloadLength < sharedChunkHashSizeBytes) {
+                            status = Container::ContainerDataError(currentPosition);
+                        } else {
+                            CrcEngine::RunningCrc64 hash = 0;
+                            for (unsigned i=0 ; i<sharedChunkHashSizeBytes ; ++i) {
+                                hash |= static_cast<CrcEngine::RunningCrc64>(payload[i]) << (8 * i);
+                            }
+
+                            SharedChunkData& sharedChunkData = sharedChunks[streamDataChunk.fileIndex()];
+                            sharedChunkData.setHash(hash);
+                            sharedChunkData.setChunkSize(ChunkHeader::toFileIndex(chunkSize));
+
+                            sharedChunksByHash.insert(SharedChunkHashMapPair(hash, streamDataChunk.fileIndex()));
+                        }
+                    } else if (!status && streamDataChunk.isCompressedExtent()) {
+                        unsigned extentSize;
+
+                        bool sharedReference = (
+                               supportsSharedChunks()
+                            && StreamDataChunk::decodeSharedReference(payload, payloadSize, &extentSize, &sharedIndex)
+                        );
+
+                        if (sharedReference) {
+                            payloadSize = extentSize;
+                            sharedChunks[sharedIndex].addReference();
+
+                            if (!buildMapsOnly) {
+                                payload = compressionBuffer();
+                                status  = loadSharedChunk(sharedIndex, compressionBuffer());
+
+                                if (!status && extentSize != sharedExtentSize) {
+                                    status = Container::PayloadSizeMismatch(
+                                        extentSize,
+                                        sharedExtentSize,
+                                        currentPosition
+                                    );
+                                }
+                            }
+                        } else if (buildMapsOnly) {
+                            payloadSize = CompressionEngine::decompressedSize(payload, payloadLength);
+                        } else {
+                            std::uint8_t* extent = compressionBuffer();
+
+                            extentSize = CompressionEngine::decompressedSize(buffer, payloadSize);
+                            bool success = CompressionEngine::decompress(
+                                buffer,
+                                payloadSize,
+                                extent,
+                                CompressionEngine::maximumBlockSize
+                            );
+
+                            if (success) {
+                                payload     = extent;
+                                payloadSize = extentSize;
+                            } else {
+                                status = Container::ContainerDataError(currentPosition);
+                            }
+                        }
+                    }
+
+                    if (!status                                                                          &&
+                        streamDataChunk.isCompressedExtent()                                             &&
+                        (!supportsCompressedExtents() || payloadSize > CompressionEngine::maximumBlockSize)    ) {
+                        status = Container::ContainerDataError(currentPosition);
+                    }
+
+                    if (!status && !sharedChunk) {
                         StreamChunk::StreamIdentifier identifier = streamDataChunk.streamIdentifier();
+                        bool                          compressed = (
+                               streamDataChunk.isCompressedExtent()
+                            && sharedIndex == ChunkHeader::invalidFileIndex
+                        );
 
-                        IdentifierMap::iterator pos = filesByIdentifier.find(identifier);
-                        if (pos == filesByIdentifier.end()) {
+                        RecordIdentifierMap::iterator recordPos = recordsByIdentifier.find(identifier);
+                        IdentifierMap::iterator       pos       = filesByIdentifier.find(identifier);
+
+                        if (recordPos != recordsByIdentifier.end()) {
+                            recordPos->second->second.addChunkLocation(
+                                streamDataChunk.fileIndex(),
+                                ChunkHeader::toFileIndex(streamDataChunk.chunkSize()),
+                                streamDataChunk.chunkOffset(),
+                                payloadSize,
+                                compressed,
+                                sharedIndex
+                            );
+                        } else if (pos == filesByIdentifier.end()) {
                             status = Container::StreamIdentifierMismatch(identifier, 0, currentPosition);
                         } else {
                             std::shared_ptr<VirtualFileImpl> vf = pos->second;
                             vf->addChunkLocation(
                                 streamDataChunk.fileIndex(),
+                                ChunkHeader::toFileIndex(streamDataChunk.chunkSize()),
                                 streamDataChunk.chunkOffset(),
-                                streamDataChunk.payloadSize()
+                                payloadSize,
+                                compressed,
+                                sharedIndex
                             );
 
                             if (!buildMapsOnly) {
-                                status = vf->receivedData(
-                                    buffer,
-                                    streamDataChunk.scatterGatherListSegment(0).processedCount()
-                                );
+                                status = vf->receivedData(payload, payloadSize);
                             }
                         }
                     }
@@ -507,5 +1607,174 @@ Container::Status ContainerImpl::traverseContainer(bool buildMapsOnly) {
         delete[] buffer;
     }
 
+    // Every referenced shared chunk must exist.  Shared chunks that are no longer referenced can be left behind if a
+    // container was not closed cleanly so we release them here.
+
+    SharedChunkMap::iterator sharedIterator = sharedChunks.begin();
+    while (!status && sharedIterator != sharedChunks.end()) {
+        if (sharedIterator->second.chunkSize() == 0) {
+            status = Container::ContainerDataError(ChunkHeader::toPosition(sharedIterator->first));
+        } else if (sharedIterator->second.referenceCount() == 0) {
+            SharedChunkHashMap::iterator hashPos = sharedChunksByHash.find(sharedIterator->second.hash());
+            if (hashPos != sharedChunksByHash.end() && hashPos->second == sharedIterator->first) {
+                sharedChunksByHash.erase(hashPos);
+            }
+
+            newFreeSpaceArea(sharedIterator->first, sharedIterator->second.chunkSize(), true);
+            sharedIterator = sharedChunks.erase(sharedIterator);
+        } else {
+            ++sharedIterator;
+        }
+    }
+
+    for (RecordMap::iterator it=recordsByName.begin(),end=recordsByName.end() ; it!=end ; ++it) {
+        it->second.compact();
+    }
+
+    return status;
+}
+
+
+std::shared_ptr<Container::VirtualFile> ContainerImpl::materializeRecord(RecordMap::iterator recordIterator) {
+    std::string     virtualFilename = recordIterator->first;
+    DirectoryRecord record          = std::move(recordIterator->second);
+
+    recordsByIdentifier.erase(record.streamIdentifier());
+    recordsByName.erase(recordIterator);
+
+    std::shared_ptr<Container::VirtualFile> vf = callNewVirtualFile(virtualFilename);
+
+    if (vf) {
+        DirectoryMap::iterator pos = filesByName.find(virtualFilename);
+        assert(pos != filesByName.end());
+
+        std::shared_ptr<VirtualFileImpl> vfi = pos->second;
+
+        // The virtual file will automatically assign an identifier and it may be incorrect. We check if the identifier
+        // is incorrect and change it here, if needed.
+
+        StreamChunk::StreamIdentifier guessIdentifier = vfi->streamIdentifier();
+        StreamChunk::StreamIdentifier identifier      = record.streamIdentifier();
+
+        if (guessIdentifier != identifier) {
+            IdentifierMap::iterator posByIdentifier = filesByIdentifier.find(guessIdentifier);
+            assert(posByIdentifier != filesByIdentifier.end());
+
+            vfi->setStreamIdentifier(identifier);
+
+            filesByIdentifier.insert(IdentifierMapPair(identifier, posByIdentifier->second));
+            filesByIdentifier.erase(posByIdentifier);
+        }
+
+        vfi->setStreamStartIndex(record.streamStartIndex());
+
+        typedef DirectoryRecord::ChunkLocations ChunkLocations;
+
+        const ChunkLocations& locations = record.chunkLocations();
+        for (ChunkLocations::const_iterator it=locations.cbegin(),end=locations.cend() ; it!=end ; ++it) {
+            vfi->addChunkLocation(
+                it->startingIndex(),
+                it->areaSize(),
+                it->baseOffset(),
+                it->payloadSize(),
+                it->compressed(),
+                it->sharedIndex(),
+                it->inlined()
+            );
+        }
+    } else {
+        lastReportedStatus = Container::FileCreationError(
+            virtualFilename,
+            ChunkHeader::toPosition(record.streamStartIndex())
+        );
+    }
+
+    return vf;
+}
+
+
+Container::Status ContainerImpl::materializeAllRecords() {
+    Container::Status status;
+
+    while (!status && !recordsByName.empty()) {
+        std::shared_ptr<Container::VirtualFile> vf = materializeRecord(recordsByName.begin());
+        if (!vf) {
+            status = lastReportedStatus;
+        }
+    }
+
+    return status;
+}
+
+
+Container::Status ContainerImpl::stageChunk(Chunk& chunk) {
+    Container::Status status;
+
+    if (ingestBufferCount + chunk.chunkSize() > ingestBufferSizeBytes) {
+        status = writeIngestBuffer();
+    }
+
+    if (!status) {
+        if (ingestBufferCount == 0) {
+            // Staged data is always written at the current end of the container.  Free space can extend past the end
+            // of the container so it's removed to keep later allocations from being placed over the staged data.
+
+            ingestBufferIndex = ChunkHeader::toFileIndex(static_cast<unsigned long long>(size()));
+            discardFreeSpace(ingestBufferIndex);
+        }
+
+        chunk.setFileIndex(ingestBufferIndex + ChunkHeader::toFileIndex(ingestBufferCount));
+        ingestBufferCount += chunk.render(ingestBuffer + ingestBufferCount);
+    }
+
+    return status;
+}
+
+
+Container::Status ContainerImpl::writeIngestBuffer() {
+    Container::Status status = ingestStatus;
+
+    if (!status && ingestBufferCount > 0) {
+        forgetVerifiedChunks(ingestBufferIndex, ChunkHeader::toFileIndex(ingestBufferCount));
+        status = setPosition(ChunkHeader::toPosition(ingestBufferIndex));
+
+        if (!status) {
+            status = write(ingestBuffer, ingestBufferCount);
+            if (status.success() && Container::WriteSuccessful(status).bytesWritten() == ingestBufferCount) {
+                status = Container::NoStatus();
+            }
+        }
+
+        if (!status) {
+            ContainerArea writtenArea(ingestBufferIndex, ChunkHeader::toFileIndex(ingestBufferCount));
+
+            if (!ingestAreas.empty() && ingestAreas.back().endingIndex() == writtenArea.startingIndex()) {
+                ingestAreas.back().expandBy(writtenArea.areaSize(), ContainerArea::Side::FROM_BACK);
+            } else {
+                ingestAreas.push_back(writtenArea);
+            }
+        } else {
+            ingestStatus = status;
+        }
+
+        ingestBufferCount = 0;
+    }
+
     return status;
 }
+
+
+void ContainerImpl::endIngest() {
+    delete[] ingestBuffer;
+
+    ingestSessionActive   = false;
+    ingestStatus          = Container::NoStatus();
+    ingestBuffer          = nullptr;
+    ingestBufferCount     = 0;
+    ingestBufferIndex     = ChunkHeader::invalidFileIndex;
+    firstIngestIdentifier = StreamChunk::invalidStreamIdentifier;
+    nextIngestIdentifier  = StreamChunk::invalidStreamIdentifier;
+
+    ingestRecords.clear();
+    ingestAreas.clear();
+}
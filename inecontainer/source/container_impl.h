@@ -29,17 +29,23 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "container_status.h"
 #include "free_space_tracker.h"
 #include "chunk_header.h"
 #include "chunk.h"
 #include "stream_chunk.h"
+#include "directory_record.h"
+#include "crc_engine.h"
+#include "shared_chunk_data.h"
 #include "container_container.h"
 
 class VirtualFileImpl;
 class VirtualFile;
+class CompressionEngine;
 
 /**
  * Pure virtual container implementation class.  You should derive from this class to create a pimpl for the public
@@ -56,6 +62,12 @@ class ContainerImpl:public FreeSpaceTracker {
          */
         typedef std::map<std::string, std::shared_ptr<VirtualFileImpl>> DirectoryMap;
 
+        /**
+         * The size of every extent held by a shared chunk, in bytes.  The value is selected so that the extent and its
+         * content hash fit within a 64 KiB chunk.
+         */
+        static constexpr unsigned sharedExtentSize = 65472;
+
         /**
          * Class used to construct pairs for the Map class.
          */
@@ -104,6 +116,248 @@ class ContainerImpl:public FreeSpaceTracker {
          */
         std::uint8_t minorVersion() const;
 
+        /**
+         * Method you can use to determine if this container supports extended chunks.  Extended chunks were added in
+         * container minor version 1.  Older containers are never written with extended chunks.
+         *
+         * \return Returns true if extended chunks can be read from and written to this container.
+         */
+        bool supportsExtendedChunks() const;
+
+        /**
+         * Method you can use to determine if this container supports compressed extents.  Compressed extents were
+         * added in container minor version 3.
+         *
+         * \return Returns true if compressed extents can be read from and written to this container.
+         */
+        bool supportsCompressedExtents() const;
+
+        /**
+         * Method that returns the compression engine shared by virtual files in this container.  The engine is
+         * created the first time it is needed.
+         *
+         * \return Returns a reference to the compression engine.
+         */
+        CompressionEngine& compressionEngine();
+
+        /**
+         * Method that returns a scratch buffer used to hold compressed extents.  The buffer is shared by all virtual
+         * files in this container and holds \ref CompressionEngine::maximumBlockSize bytes.
+         *
+         * \return Returns a pointer to the compression buffer.
+         */
+        std::uint8_t* compressionBuffer();
+
+        /**
+         * Method you can use to determine if this container supports shared chunks.  Shared chunks were added in
+         * container minor version 4.
+         *
+         * \return Returns true if shared chunks can be read from and written to this container.
+         */
+        bool supportsSharedChunks() const;
+
+        /**
+         * Method you can use to determine if this container supports inline payloads.  Inline payloads hold the
+         * contents of small virtual files in the stream start chunk and were added in container minor version 5.
+         *
+         * \return Returns true if inline payloads can be read from and written to this container.
+         */
+        bool supportsInlinePayloads() const;
+
+        /**
+         * Method you can use to enable or disable chunk deduplication.
+         *
+         * \param[in] enabled If true, identical extents written to virtual files will be stored once.
+         */
+        void setDeduplication(bool enabled);
+
+        /**
+         * Method you can use to determine if chunk deduplication is enabled.
+         *
+         * \return Returns true if chunk deduplication is enabled.
+         */
+        bool deduplication() const;
+
+        /**
+         * Method you can use to determine if newly written extents should be deduplicated.
+         *
+         * \return Returns true if deduplication is enabled and supported by this container.
+         */
+        bool deduplicationActive() const;
+
+        /**
+         * Method that obtains a reference to a shared chunk holding an extent.  If an identical extent is already
+         * held by a shared chunk, a reference to that chunk is added.  Otherwise a new shared chunk is written.
+         *
+         * \param[in]  extent      The extent to be shared.  The extent must be \ref ContainerImpl::sharedExtentSize
+         *                         bytes in length.
+         *
+         * \param[in]  nearIndex   A file index near where a new shared chunk should be placed.
+         *
+         * \param[out] sharedIndex Location to receive the file index of the shared chunk.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status acquireSharedChunk(
+            const std::uint8_t*     extent,
+            ChunkHeader::FileIndex  nearIndex,
+            ChunkHeader::FileIndex* sharedIndex
+        );
+
+        /**
+         * Method that releases a reference to a shared chunk.  The chunk is released once the last reference is
+         * removed.
+         *
+         * \param[in] sharedIndex The file index of the shared chunk.
+         */
+        void releaseSharedChunk(ChunkHeader::FileIndex sharedIndex);
+
+        /**
+         * Method that loads the extent held by a shared chunk.
+         *
+         * \param[in]  sharedIndex The file index of the shared chunk.
+         *
+         * \param[out] extent      Buffer to receive the extent.  The buffer must hold at least
+         *                         \ref ContainerImpl::sharedExtentSize bytes.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status loadSharedChunk(ChunkHeader::FileIndex sharedIndex, std::uint8_t* extent);
+
+        /**
+         * Method that allocates a contiguous area of the container for use by a single virtual file.  Any portion of
+         * the area past the end of the container is written as fill area so later allocations are placed after the
+         * area.  The area is removed from the free space map.  Unused portions must be returned using
+         * \ref FreeSpaceTracker::newFreeSpaceArea.
+         *
+         * \param[in]  nearIndex The file index that the area should be placed near.
+         *
+         * \param[in]  areaSize  The size of the area, in file index counts.
+         *
+         * \param[out] area      Location to receive the allocated area.  An empty area is returned on error.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status allocateContiguousArea(
+            ChunkHeader::FileIndex nearIndex,
+            ChunkHeader::FileIndex areaSize,
+            ContainerArea*         area
+        );
+
+        /**
+         * Method you can use to set the maximum amount of data that virtual files in this container may hold in
+         * memory, pending write.  Data is written immediately if the buffered data exceeds the new budget.
+         *
+         * \param[in] newBudget The new budget, in bytes.  A value of 0 removes the limit.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status setWriteBufferBudget(unsigned long long newBudget);
+
+        /**
+         * Method you can use to determine the maximum amount of data that virtual files may hold in memory.
+         *
+         * \return Returns the write buffer budget, in bytes.
+         */
+        unsigned long long writeBufferBudget() const;
+
+        /**
+         * Method you can use to determine the amount of data virtual files in this container hold in memory, pending
+         * write.
+         *
+         * \return Returns the number of buffered bytes.
+         */
+        unsigned long long bufferedBytes() const;
+
+        /**
+         * Method that is called by virtual files to report a change in the amount of data they hold pending write.
+         *
+         * \param[in] oldCount The number of bytes previously reported by the virtual file.
+         *
+         * \param[in] newCount The number of bytes now held by the virtual file.
+         */
+        void bufferedBytesChanged(unsigned long long oldCount, unsigned long long newCount);
+
+        /**
+         * Method that writes data held by virtual files once the write buffer budget is exceeded.  Files holding the
+         * most data are written first.  Data is written until half the budget is in use.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status enforceWriteBufferBudget();
+
+        /**
+         * Method you can use to select how data chunk CRCs are verified when chunks are read.
+         *
+         * \param[in] policy         The new verification policy.
+         *
+         * \param[in] sampleInterval The number of chunk reads per verified chunk when sampling.
+         */
+        void setCrcVerification(Container::Container::CrcVerification policy, unsigned sampleInterval);
+
+        /**
+         * Method you can use to determine the current data chunk CRC verification policy.
+         *
+         * \return Returns the current verification policy.
+         */
+        Container::Container::CrcVerification crcVerification() const;
+
+        /**
+         * Method you can use to enable or disable padding-free chunk writes.
+         *
+         * \param[in] enabled If true, unused chunk space that already exists in the container will not be written.
+         */
+        void setPaddingFreeWrites(bool enabled);
+
+        /**
+         * Method you can use to determine if padding-free chunk writes are enabled.
+         *
+         * \return Returns true if padding-free chunk writes are enabled.
+         */
+        bool paddingFreeWrites() const;
+
+        /**
+         * Method you can use to select the checksum used to protect data chunks when a new container is created.
+         *
+         * \param[in] checksum The checksum to use for new containers.
+         */
+        void setChunkChecksum(Container::Container::ChunkChecksum checksum);
+
+        /**
+         * Method you can use to determine the checksum used to protect data chunks in the open container.
+         *
+         * \return Returns the checksum used by the container.
+         */
+        Container::Container::ChunkChecksum chunkChecksum() const;
+
+        /**
+         * Method you can use to determine if data chunks in this container carry a 64-bit payload checksum.
+         *
+         * \return Returns true if data chunks carry a 64-bit payload checksum.
+         */
+        bool usesPayloadChecksums() const;
+
+        /**
+         * Method that is called after a chunk's payload has been read to verify the chunk's CRC under the current
+         * verification policy.
+         *
+         * \param[in] chunk The chunk to be verified.  The chunk must hold its entire payload.
+         *
+         * \return Returns the status from the verification.  A \ref Container::ChunkCrcError is returned if the
+         *         chunk was checked and found to be corrupt.
+         */
+        Container::Status verifyChunk(const Chunk& chunk);
+
+        /**
+         * Method that is called when chunks are written to the container.  Any chunk starting within the area must be
+         * verified again when next read.
+         *
+         * \param[in] startingIndex The file index of the first chunk written.
+         *
+         * \param[in] areaSize      The size of the area written, in file index counts.
+         */
+        void forgetVerifiedChunks(ChunkHeader::FileIndex startingIndex, ChunkHeader::FileIndex areaSize = 1);
+
         /**
          * Method that should be called to open the container.  If the container is empty, the method will attempt
          * to create a file header.  If the container is not empty, the method will verify that the file container
@@ -124,12 +378,110 @@ class ContainerImpl:public FreeSpaceTracker {
         Container::Status close();
 
         /**
-         * Returns a directory of all the streams in the container.
+         * Returns a directory of all the streams in the container.  Note that this method will materialise a virtual
+         * file instance for every file in the container.
          *
          * \return Returns a map, keyed by the stream name, of streams in the container.
          */
         Container::Container::DirectoryMap directory();
 
+        /**
+         * Method that visits entries in the directory without copying the directory.  Entries are visited in name
+         * order.  The visitor may rename or erase files, including the visited file, during the visit.  Virtual file
+         * instances are materialised only for the visited entries.
+         *
+         * \param[in] visitor The function to call for each visited entry.
+         *
+         * \param[in] prefix  The name prefix of the entries to be visited.  An empty prefix visits every entry.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status forEachFile(
+            const Container::Container::FileVisitor& visitor,
+            const std::string&                       prefix
+        );
+
+        /**
+         * Method that locates a single virtual file by name.
+         *
+         * \param[in] virtualFileName The name of the virtual file to locate.
+         *
+         * \return Returns the requested virtual file.  A null pointer is returned if the file does not exist.
+         */
+        std::shared_ptr<Container::VirtualFile> virtualFile(const std::string& virtualFileName);
+
+        /**
+         * Method that erases a group of virtual files.  Space released by the files is merged before it is marked on
+         * the media.  Names that do not match a virtual file are ignored.
+         *
+         * \param[in] virtualFileNames The names of the virtual files to erase.
+         *
+         * \param[in] verify           If true, each chunk is read back and checked before its space is released.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status eraseFiles(const std::vector<std::string>& virtualFileNames, bool verify);
+
+        /**
+         * Method that erases every virtual file in the container by cutting the container back to the file header.
+         * Existing virtual files are detached and any data they hold, pending write, is discarded.  An active bulk
+         * ingest session is discarded.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status clear();
+
+        /**
+         * Method that starts a bulk ingest session.  During the session, files are added with
+         * \ref ContainerImpl::ingestFile and are appended to the end of the container.  The files are added to the
+         * directory when the session is committed.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status beginIngest();
+
+        /**
+         * Method that adds a virtual file during a bulk ingest session.  The file's chunks are placed into a staging
+         * buffer that is written to the end of the container in large blocks.  Data is stored uncompressed and is not
+         * deduplicated.
+         *
+         * \param[in] virtualFileName The name of the new virtual file.  The name must not already be in use.
+         *
+         * \param[in] data            The file contents.
+         *
+         * \param[in] fileSize        The size of the file contents, in bytes.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status ingestFile(
+            const std::string&  virtualFileName,
+            const std::uint8_t* data,
+            unsigned long long  fileSize
+        );
+
+        /**
+         * Method that ends a bulk ingest session, writing any staged data and adding the ingested files to the
+         * directory.  If the session can not be committed, the files added during the session are discarded.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status commitIngest();
+
+        /**
+         * Method that ends a bulk ingest session, discarding the files added during the session.  Space already
+         * written by the session is released.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status abortIngest();
+
+        /**
+         * Method you can use to determine if a bulk ingest session is active.
+         *
+         * \return Returns true if a session is active.  Returns false if no session is active.
+         */
+        bool ingestActive() const;
+
         /**
          * Method you can call to perform a sequential read across the container.
          *
@@ -306,6 +658,26 @@ class ContainerImpl:public FreeSpaceTracker {
          */
         virtual Container::Status flush() = 0;
 
+        /**
+         * Method that calls the overloaded \ref Container::Container::supportsPinning method defined by the public
+         * API.
+         *
+         * \return Returns true if pinning is supported.
+         */
+        virtual bool supportsPinning() const = 0;
+
+        /**
+         * Method that calls the overloaded \ref Container::Container::pin method defined by the public API.
+         *
+         * \param[in] offset The offset of the first byte of the region.
+         *
+         * \param[in] count  The number of bytes in the region.
+         *
+         * \return Returns a pointer to the first byte of the region.  A null pointer is returned if the region can not
+         *         be accessed directly.
+         */
+        virtual std::shared_ptr<const std::uint8_t> pin(unsigned long long offset, unsigned count) = 0;
+
     protected:
         /**
          * Method that is called to trigger an area of the container to be written as fill area.
@@ -318,7 +690,85 @@ class ContainerImpl:public FreeSpaceTracker {
          */
         bool flushArea(const ContainerArea& area) final;
 
+        /**
+         * Method that is called before an area is allocated past the end of the container.  Data staged by a bulk
+         * ingest session is written so that the new area is placed after it.
+         *
+         * Detailed failure status will be handled through lastReportedStatus.
+         */
+        void extendingContainer() final;
+
+        /**
+         * Method that is called when an area is reported as free space.  Chunks within the area must be verified
+         * again when next read.
+         *
+         * \param[in] area The area being released.
+         */
+        void areaReleased(const ContainerArea& area) final;
+
     private:
+        /**
+         * The first container minor version to support extended chunks.
+         */
+        static constexpr std::uint8_t extendedChunkMinorVersion = 1;
+
+        /**
+         * The first container minor version to support 64-bit payload checksums.
+         */
+        static constexpr std::uint8_t payloadChecksumMinorVersion = 2;
+
+        /**
+         * The first container minor version to support compressed extents.
+         */
+        static constexpr std::uint8_t compressedExtentMinorVersion = 3;
+
+        /**
+         * The first container minor version to support shared chunks.
+         */
+        static constexpr std::uint8_t sharedChunkMinorVersion = 4;
+
+        /**
+         * The first container minor version to support inline payloads in stream start chunks.
+         */
+        static constexpr std::uint8_t inlinePayloadMinorVersion = 5;
+
+        /**
+         * The size of the content hash at the start of every shared chunk payload, in bytes.
+         */
+        static constexpr unsigned sharedChunkHashSizeBytes = 8;
+
+        /**
+         * The size of the buffer used to stage chunks during a bulk ingest session, in bytes.  The buffer must be able
+         * to hold the largest chunk.
+         */
+        static constexpr unsigned ingestBufferSizeBytes = 4 * ChunkHeader::maximumExtendedChunkSize;
+
+        /**
+         * Type used to track shared chunks by file index.
+         */
+        typedef std::unordered_map<ChunkHeader::FileIndex, SharedChunkData> SharedChunkMap;
+
+        /**
+         * Class used to construct pairs for the SharedChunkMap class.
+         */
+        typedef std::pair<ChunkHeader::FileIndex, SharedChunkData> SharedChunkMapPair;
+
+        /**
+         * Type used to locate shared chunks by content hash.
+         */
+        typedef std::unordered_map<CrcEngine::RunningCrc64, ChunkHeader::FileIndex> SharedChunkHashMap;
+
+        /**
+         * Class used to construct pairs for the SharedChunkHashMap class.
+         */
+        typedef std::pair<CrcEngine::RunningCrc64, ChunkHeader::FileIndex> SharedChunkHashMapPair;
+
+        /**
+         * Type used to track verified chunks.  Each entry holds one 64-bit word of the bitmap, keyed by the word
+         * index.  Bits are indexed by chunk file index so only words covering chunks that were read are allocated.
+         */
+        typedef std::unordered_map<ChunkHeader::FileIndex, std::uint64_t> ChunkBitmap;
+
         /**
          * Flag that indicates that the identifier in the file header should be ignored when the container is opened.
          */
@@ -339,6 +789,43 @@ class ContainerImpl:public FreeSpaceTracker {
          */
         typedef std::pair<StreamChunk::StreamIdentifier, std::shared_ptr<VirtualFileImpl>> IdentifierMapPair;
 
+        /**
+         * Type used to track directory records for files that have not yet been materialised, by name.
+         */
+        typedef std::map<std::string, DirectoryRecord> RecordMap;
+
+        /**
+         * Class used to construct pairs for the RecordMap class.
+         */
+        typedef std::pair<std::string, DirectoryRecord> RecordMapPair;
+
+        /**
+         * Type used to locate directory records by stream ID.
+         */
+        typedef std::unordered_map<StreamChunk::StreamIdentifier, RecordMap::iterator> RecordIdentifierMap;
+
+        /**
+         * Class used to construct pairs for the RecordIdentifierMap class.
+         */
+        typedef std::pair<StreamChunk::StreamIdentifier, RecordMap::iterator> RecordIdentifierMapPair;
+
+        /**
+         * Method that materialises the virtual file described by a directory record.  The record is removed from the
+         * record maps and the newly created virtual file is added to the directory.
+         *
+         * \param[in] recordIterator Iterator to the record to be materialised.
+         *
+         * \return Returns the newly created virtual file.  A null pointer is returned on error.
+         */
+        std::shared_ptr<Container::VirtualFile> materializeRecord(RecordMap::iterator recordIterator);
+
+        /**
+         * Method that materialises every outstanding directory record.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status materializeAllRecords();
+
         /**
          * Method that is called to build file maps, if needed.
          *
@@ -349,6 +836,28 @@ class ContainerImpl:public FreeSpaceTracker {
          */
         Container::Status traverseContainer(bool buildMapsOnly);
 
+        /**
+         * Method that places a chunk into the bulk ingest staging buffer.  The staging buffer is written first if the
+         * chunk will not fit.  The chunk's file index is updated to the location where the chunk will be written.
+         *
+         * \param[in] chunk The chunk to be staged.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status stageChunk(Chunk& chunk);
+
+        /**
+         * Method that writes the bulk ingest staging buffer to the end of the container.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status writeIngestBuffer();
+
+        /**
+         * Method that releases the resources held by a bulk ingest session and ends the session.
+         */
+        void endIngest();
+
         /**
          * Weak pointer reference to this.
          */
@@ -384,10 +893,140 @@ class ContainerImpl:public FreeSpaceTracker {
          */
         DirectoryMap filesByName;
 
+        /**
+         * Map of files found in the container that have not yet been materialised, by name.
+         */
+        RecordMap recordsByName;
+
+        /**
+         * Map of files found in the container that have not yet been materialised, by stream ID.
+         */
+        RecordIdentifierMap recordsByIdentifier;
+
         /**
          * Flag that indicates if the file maps are fully populated.
          */
         bool fileMapsPopulated;
+
+        /**
+         * The current data chunk CRC verification policy.
+         */
+        Container::Container::CrcVerification currentCrcVerification;
+
+        /**
+         * Flag indicating if padding-free chunk writes are enabled.
+         */
+        bool paddingFreeWritesEnabled;
+
+        /**
+         * The data chunk checksum to use when a new container is created.
+         */
+        Container::Container::ChunkChecksum requestedChunkChecksum;
+
+        /**
+         * The data chunk checksum used by the open container.
+         */
+        Container::Container::ChunkChecksum currentChunkChecksum;
+
+        /**
+         * The number of chunk reads per verified chunk when sampling.
+         */
+        unsigned crcSampleInterval;
+
+        /**
+         * The number of chunk reads since the last sampled chunk.
+         */
+        unsigned crcSampleCount;
+
+        /**
+         * Bitmap of chunks that have passed verification since the container was opened.
+         */
+        ChunkBitmap verifiedChunks;
+
+        /**
+         * The compression engine, created when first needed.
+         */
+        CompressionEngine* currentCompressionEngine;
+
+        /**
+         * Buffer used to hold compressed extents, created when first needed.
+         */
+        std::uint8_t* currentCompressionBuffer;
+
+        /**
+         * Flag indicating if chunk deduplication is enabled.
+         */
+        bool deduplicationEnabled;
+
+        /**
+         * Map of shared chunks by file index.
+         */
+        SharedChunkMap sharedChunks;
+
+        /**
+         * Map of shared chunks by content hash.
+         */
+        SharedChunkHashMap sharedChunksByHash;
+
+        /**
+         * The maximum number of bytes virtual files may hold in memory, pending write.
+         */
+        unsigned long long currentWriteBufferBudget;
+
+        /**
+         * The number of bytes virtual files currently hold in memory, pending write.
+         */
+        unsigned long long totalBufferedBytes;
+
+        /**
+         * Flag indicating that buffered data is being written to satisfy the write buffer budget.
+         */
+        bool writeBufferBudgetEnforced;
+
+        /**
+         * Flag indicating that a bulk ingest session is active.
+         */
+        bool ingestSessionActive;
+
+        /**
+         * The first status reported by a bulk ingest write.  A failed session can only be aborted.
+         */
+        Container::Status ingestStatus;
+
+        /**
+         * Buffer used to stage chunks during a bulk ingest session.
+         */
+        std::uint8_t* ingestBuffer;
+
+        /**
+         * The number of bytes held in the staging buffer.
+         */
+        unsigned ingestBufferCount;
+
+        /**
+         * The file index where the staging buffer will be written.
+         */
+        ChunkHeader::FileIndex ingestBufferIndex;
+
+        /**
+         * The first stream identifier handed out by the current bulk ingest session.
+         */
+        StreamChunk::StreamIdentifier firstIngestIdentifier;
+
+        /**
+         * The next stream identifier to be handed out by the current bulk ingest session.
+         */
+        StreamChunk::StreamIdentifier nextIngestIdentifier;
+
+        /**
+         * Directory records for the files added by the current bulk ingest session.
+         */
+        RecordMap ingestRecords;
+
+        /**
+         * The container areas written by the current bulk ingest session.
+         */
+        std::vector<ContainerArea> ingestAreas;
 };
 
 #endif
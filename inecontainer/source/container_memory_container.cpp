@@ -106,4 +106,14 @@ namespace Container {
     Status MemoryContainer::flush() {
         return impl->flush();
     }
+
+
+    bool MemoryContainer::supportsPinning() const {
+        return impl->supportsPinning();
+    }
+
+
+    std::shared_ptr<const std::uint8_t> MemoryContainer::pin(unsigned long long offset, unsigned count) {
+        return impl->pin(offset, count);
+    }
 }
@@ -144,4 +144,20 @@ namespace Container {
     Status MemoryContainer::Private::flush() {
         return NoStatus();
     }
+
+
+    bool MemoryContainer::Private::supportsPinning() const {
+        return true;
+    }
+
+
+    std::shared_ptr<const std::uint8_t> MemoryContainer::Private::pin(unsigned long long offset, unsigned count) {
+        std::shared_ptr<const std::uint8_t> result;
+
+        if (memoryBuffer && offset <= memoryBuffer->size() && count <= memoryBuffer->size() - offset) {
+            result = std::shared_ptr<const std::uint8_t>(memoryBuffer, memoryBuffer->data() + offset);
+        }
+
+        return result;
+    }
 }
@@ -141,6 +141,25 @@ namespace Container {
              */
             Status flush();
 
+            /**
+             * Method that indicates that memory containers support pinning.
+             *
+             * \return Returns true.
+             */
+            bool supportsPinning() const;
+
+            /**
+             * Method that provides direct, read-only access to a region of the memory buffer.
+             *
+             * \param[in] offset The offset of the first byte of the region.
+             *
+             * \param[in] count  The number of bytes in the region.
+             *
+             * \return Returns a pointer to the first byte of the region.  The pointer shares ownership of the memory
+             *         buffer.  A null pointer is returned if the region extends past the end of the buffer.
+             */
+            std::shared_ptr<const std::uint8_t> pin(unsigned long long offset, unsigned count);
+
         private:
             /**
              * Pointer to the memory container class instance.
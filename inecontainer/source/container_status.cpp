@@ -69,6 +69,15 @@ namespace Container {
     InternalError::InternalError(InternalError::PimplBase* pimpl):Status(pimpl) {}
 
 
+    InternalError::InternalError(
+            InternalError::PimplBase& pimpl,
+            unsigned long long        value
+        ):Status(
+            pimpl,
+            value
+        ) {}
+
+
     InternalError::InternalError(const Status& other):Status(other) {}
 }
 
@@ -135,6 +144,15 @@ namespace Container {
     FormatError::FormatError(FormatError::PimplBase* pimpl):Status(pimpl) {}
 
 
+    FormatError::FormatError(
+            FormatError::PimplBase& pimpl,
+            unsigned long long      value
+        ):Status(
+            pimpl,
+            value
+        ) {}
+
+
     FormatError::FormatError(const Status& other):Status(other) {}
 }
 
@@ -165,6 +183,15 @@ namespace Container {
     HeaderError::HeaderError(HeaderError::PimplBase* pimpl):Status(pimpl) {}
 
 
+    HeaderError::HeaderError(
+            HeaderError::PimplBase& pimpl,
+            unsigned long long      value
+        ):Status(
+            pimpl,
+            value
+        ) {}
+
+
     HeaderError::HeaderError(const Status& other):Status(other) {}
 }
 
@@ -195,6 +222,15 @@ namespace Container {
     FilesystemStatus::FilesystemStatus(FilesystemStatus::PimplBase* pimpl):Status(pimpl) {}
 
 
+    FilesystemStatus::FilesystemStatus(
+            FilesystemStatus::PimplBase& pimpl,
+            unsigned long long           value
+        ):Status(
+            pimpl,
+            value
+        ) {}
+
+
     FilesystemStatus::FilesystemStatus(const Status& other):Status(other) {}
 }
 
@@ -225,6 +261,15 @@ namespace Container {
     FilesystemError::FilesystemError(FilesystemError::PimplBase* pimpl):Status(pimpl) {}
 
 
+    FilesystemError::FilesystemError(
+            FilesystemError::PimplBase& pimpl,
+            unsigned long long          value
+        ):Status(
+            pimpl,
+            value
+        ) {}
+
+
     FilesystemError::FilesystemError(const Status& other):Status(other) {}
 }
 
@@ -261,7 +306,7 @@ namespace Container {
  */
 
 namespace Container {
-    StreamingReadError::StreamingReadError():Status(new StreamingReadError::PimplBase) {};
+    StreamingReadError::StreamingReadError():Status(StreamingReadError::defaultPimpl()) {}
 
 
     StreamingReadError::StreamingReadError(const Status& other):Status(other) {}
@@ -271,6 +316,21 @@ namespace Container {
 
 
     StreamingReadError::StreamingReadError(StreamingReadError::PimplBase* pimpl):Status(pimpl) {}
+
+
+    StreamingReadError::StreamingReadError(
+            StreamingReadError::PimplBase& pimpl,
+            unsigned long long             value
+        ):Status(
+            pimpl,
+            value
+        ) {}
+
+
+    StreamingReadError::PimplBase& StreamingReadError::defaultPimpl() {
+        static StreamingReadError::PimplBase pimpl;
+        return pimpl;
+    }
 }
 
 /***********************************************************************************************************************
@@ -284,6 +344,8 @@ namespace Container {
 
             ~Pimpl() override;
 
+            static Pimpl& instance();
+
             int errorCode() const final;
 
             std::string description() const final;
@@ -296,6 +358,12 @@ namespace Container {
     ContainerUnavailable::Pimpl::~Pimpl() {}
 
 
+    ContainerUnavailable::Pimpl& ContainerUnavailable::Pimpl::instance() {
+        static Pimpl pimpl;
+        return pimpl;
+    }
+
+
     int ContainerUnavailable::Pimpl::errorCode() const {
         return ContainerUnavailable::reportedErrorCode;
     }
@@ -311,7 +379,7 @@ namespace Container {
  */
 
 namespace Container {
-    ContainerUnavailable::ContainerUnavailable():InternalError(new ContainerUnavailable::Pimpl()) {}
+    ContainerUnavailable::ContainerUnavailable():InternalError(ContainerUnavailable::Pimpl::instance()) {}
 
 
     ContainerUnavailable::ContainerUnavailable(const Status &other):InternalError(other) {}
@@ -1002,6 +1070,8 @@ namespace Container {
 
             ~Pimpl() override;
 
+            static Pimpl& instance();
+
             int errorCode() const final;
 
             std::string description() const final;
@@ -1014,6 +1084,12 @@ namespace Container {
     HeaderIdentifierInvalid::Pimpl::~Pimpl() {}
 
 
+    HeaderIdentifierInvalid::Pimpl& HeaderIdentifierInvalid::Pimpl::instance() {
+        static Pimpl pimpl;
+        return pimpl;
+    }
+
+
     int HeaderIdentifierInvalid::Pimpl::errorCode() const {
         return HeaderIdentifierInvalid::reportedErrorCode;
     }
@@ -1029,7 +1105,7 @@ namespace Container {
  */
 
 namespace Container {
-    HeaderIdentifierInvalid::HeaderIdentifierInvalid():HeaderError(new HeaderIdentifierInvalid::Pimpl()) {}
+    HeaderIdentifierInvalid::HeaderIdentifierInvalid():HeaderError(HeaderIdentifierInvalid::Pimpl::instance()) {}
 
 
     HeaderIdentifierInvalid::HeaderIdentifierInvalid(const Status &other):HeaderError(other) {}
@@ -1139,6 +1215,8 @@ namespace Container {
 
             ~Pimpl() override;
 
+            static Pimpl& instance();
+
             int errorCode() const final;
 
             std::string description() const final;
@@ -1151,6 +1229,12 @@ namespace Container {
     HeaderCrcError::Pimpl::~Pimpl() {}
 
 
+    HeaderCrcError::Pimpl& HeaderCrcError::Pimpl::instance() {
+        static Pimpl pimpl;
+        return pimpl;
+    }
+
+
     int HeaderCrcError::Pimpl::errorCode() const {
         return HeaderCrcError::reportedErrorCode;
     }
@@ -1166,7 +1250,7 @@ namespace Container {
  */
 
 namespace Container {
-    HeaderCrcError::HeaderCrcError():HeaderError(new HeaderCrcError::Pimpl()) {}
+    HeaderCrcError::HeaderCrcError():HeaderError(HeaderCrcError::Pimpl::instance()) {}
 
 
     HeaderCrcError::HeaderCrcError(const Status &other):HeaderError(other) {}
@@ -1182,31 +1266,29 @@ namespace Container {
 namespace Container {
     class ReadSuccessful::Pimpl:public FilesystemStatus::PimplBase {
         public:
-            Pimpl(unsigned bytesRead);
+            Pimpl();
 
             ~Pimpl() override;
 
-            unsigned bytesRead() const;
+            static Pimpl& instance();
 
             int errorCode() const final;
 
             std::string description() const final;
 
-        private:
-            unsigned currentBytesRead;
+            std::string valueDescription(unsigned long long value) const final;
     };
 
 
-    ReadSuccessful::Pimpl::Pimpl(unsigned bytesRead) {
-        currentBytesRead = bytesRead;
-    }
+    ReadSuccessful::Pimpl::Pimpl() {}
 
 
     ReadSuccessful::Pimpl::~Pimpl() {}
 
 
-    unsigned ReadSuccessful::Pimpl::bytesRead() const {
-        return currentBytesRead;
+    ReadSuccessful::Pimpl& ReadSuccessful::Pimpl::instance() {
+        static Pimpl pimpl;
+        return pimpl;
     }
 
 
@@ -1216,11 +1298,16 @@ namespace Container {
 
 
     std::string ReadSuccessful::Pimpl::description() const {
+        return "Read successful";
+    }
+
+
+    std::string ReadSuccessful::Pimpl::valueDescription(unsigned long long value) const {
         std::stringstream stream;
 
-        stream << "Read successful, " << currentBytesRead << " transferred";
+        stream << "Read successful, " << value << " transferred";
         return stream.str();
-    };
+    }
 }
 
 /***********************************************************************************************************************
@@ -1228,7 +1315,7 @@ namespace Container {
  */
 
 namespace Container {
-    ReadSuccessful::ReadSuccessful(unsigned bytesRead):FilesystemStatus(new ReadSuccessful::Pimpl(bytesRead)) {}
+    ReadSuccessful::ReadSuccessful(unsigned bytesRead):FilesystemStatus(ReadSuccessful::Pimpl::instance(), bytesRead) {}
 
 
     ReadSuccessful::ReadSuccessful(const Status& other):FilesystemStatus(other) {}
@@ -1238,7 +1325,7 @@ namespace Container {
 
 
     unsigned ReadSuccessful::bytesRead() const {
-        return std::dynamic_pointer_cast<ReadSuccessful::Pimpl>(pimpl())->bytesRead();
+        return static_cast<unsigned>(inlineValue());
     }
 }
 
@@ -1249,31 +1336,29 @@ namespace Container {
 namespace Container {
     class WriteSuccessful::Pimpl:public FilesystemStatus::PimplBase {
         public:
-            Pimpl(unsigned bytesWritten);
+            Pimpl();
 
             ~Pimpl() override;
 
-            unsigned bytesWritten() const;
+            static Pimpl& instance();
 
             int errorCode() const final;
 
             std::string description() const final;
 
-        private:
-            unsigned currentBytesWritten;
+            std::string valueDescription(unsigned long long value) const final;
     };
 
 
-    WriteSuccessful::Pimpl::Pimpl(unsigned bytesWritten) {
-        currentBytesWritten = bytesWritten;
-    }
+    WriteSuccessful::Pimpl::Pimpl() {}
 
 
     WriteSuccessful::Pimpl::~Pimpl() {}
 
 
-    unsigned WriteSuccessful::Pimpl::bytesWritten() const {
-        return currentBytesWritten;
+    WriteSuccessful::Pimpl& WriteSuccessful::Pimpl::instance() {
+        static Pimpl pimpl;
+        return pimpl;
     }
 
 
@@ -1283,11 +1368,16 @@ namespace Container {
 
 
     std::string WriteSuccessful::Pimpl::description() const {
+        return "Write successful";
+    }
+
+
+    std::string WriteSuccessful::Pimpl::valueDescription(unsigned long long value) const {
         std::stringstream stream;
 
-        stream << "Write successful, " << currentBytesWritten << " transferred";
+        stream << "Write successful, " << value << " transferred";
         return stream.str();
-    };
+    }
 }
 
 /***********************************************************************************************************************
@@ -1298,7 +1388,8 @@ namespace Container {
     WriteSuccessful::WriteSuccessful(
             unsigned bytesWritten
         ):FilesystemStatus(
-            new WriteSuccessful::Pimpl(bytesWritten)
+            WriteSuccessful::Pimpl::instance(),
+            bytesWritten
         ) {}
 
 
@@ -1309,7 +1400,7 @@ namespace Container {
 
 
     unsigned WriteSuccessful::bytesWritten() const {
-        return std::dynamic_pointer_cast<WriteSuccessful::Pimpl>(pimpl())->bytesWritten();
+        return static_cast<unsigned>(inlineValue());
     }
 }
 
@@ -1481,6 +1572,8 @@ namespace Container {
 
             ~Pimpl() override;
 
+            static Pimpl& instance();
+
             int errorCode() const final;
 
             std::string description() const final;
@@ -1493,6 +1586,12 @@ namespace Container {
     FileContainerNotOpen::Pimpl::~Pimpl() {}
 
 
+    FileContainerNotOpen::Pimpl& FileContainerNotOpen::Pimpl::instance() {
+        static Pimpl pimpl;
+        return pimpl;
+    }
+
+
     int FileContainerNotOpen::Pimpl::errorCode() const {
         return FileContainerNotOpen::reportedErrorCode;
     }
@@ -1508,7 +1607,7 @@ namespace Container {
  */
 
 namespace Container {
-    FileContainerNotOpen::FileContainerNotOpen():FilesystemError(new FileContainerNotOpen::Pimpl()) {}
+    FileContainerNotOpen::FileContainerNotOpen():FilesystemError(FileContainerNotOpen::Pimpl::instance()) {}
 
 
     FileContainerNotOpen::FileContainerNotOpen(const Status& other):FilesystemError(other) {}
@@ -2108,3 +2207,134 @@ namespace Container {
         return std::dynamic_pointer_cast<FileFlushError::Pimpl>(pimpl())->errorNumber();
     }
 }
+
+/***********************************************************************************************************************
+ * Container::ChunkCrcError::Pimpl
+ */
+
+namespace Container {
+    class ChunkCrcError::Pimpl:public FormatError::PimplBase {
+        public:
+            Pimpl();
+
+            ~Pimpl() override;
+
+            static Pimpl& instance();
+
+            int errorCode() const final;
+
+            std::string description() const final;
+
+            std::string valueDescription(unsigned long long value) const final;
+    };
+
+
+    ChunkCrcError::Pimpl::Pimpl() {}
+
+
+    ChunkCrcError::Pimpl::~Pimpl() {}
+
+
+    ChunkCrcError::Pimpl& ChunkCrcError::Pimpl::instance() {
+        static Pimpl pimpl;
+        return pimpl;
+    }
+
+
+    int ChunkCrcError::Pimpl::errorCode() const {
+        return ChunkCrcError::reportedErrorCode;
+    }
+
+
+    std::string ChunkCrcError::Pimpl::description() const {
+        return "Chunk CRC error";
+    }
+
+
+    std::string ChunkCrcError::Pimpl::valueDescription(unsigned long long value) const {
+        std::stringstream stream;
+
+        stream << "Chunk CRC error at " << value;
+
+        return stream.str();
+    }
+}
+
+/***********************************************************************************************************************
+ * Container::ChunkCrcError
+ */
+
+namespace Container {
+    ChunkCrcError::ChunkCrcError(
+            unsigned long long filePosition
+        ):FormatError(
+            ChunkCrcError::Pimpl::instance(),
+            filePosition
+        ) {}
+
+
+    ChunkCrcError::ChunkCrcError(const Status& other):FormatError(other) {}
+
+
+    ChunkCrcError::~ChunkCrcError() {}
+
+
+    unsigned long long ChunkCrcError::filePosition() const {
+        return inlineValue();
+    }
+}
+
+/***********************************************************************************************************************
+ * Container::IngestSessionError::Pimpl
+ */
+
+namespace Container {
+    class IngestSessionError::Pimpl:public InternalError::PimplBase {
+        public:
+            Pimpl();
+
+            ~Pimpl() override;
+
+            static Pimpl& instance();
+
+            int errorCode() const final;
+
+            std::string description() const final;
+    };
+
+
+    IngestSessionError::Pimpl::Pimpl() {}
+
+
+    IngestSessionError::Pimpl::~Pimpl() {}
+
+
+    IngestSessionError::Pimpl& IngestSessionError::Pimpl::instance() {
+        static Pimpl pimpl;
+        return pimpl;
+    }
+
+
+    int IngestSessionError::Pimpl::errorCode() const {
+        return IngestSessionError::reportedErrorCode;
+    }
+
+
+    std::string IngestSessionError::Pimpl::description() const {
+        return "Bulk ingest session error";
+    }
+}
+
+/***********************************************************************************************************************
+ * Container::IngestSessionError
+ */
+
+namespace Container {
+    IngestSessionError::IngestSessionError():InternalError(IngestSessionError::Pimpl::instance()) {}
+
+
+    IngestSessionError::IngestSessionError(const Status &other):InternalError(other) {}
+
+
+    IngestSessionError::~IngestSessionError() {}
+}
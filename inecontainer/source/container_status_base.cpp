@@ -35,17 +35,27 @@
 
 namespace Container {
     Status::Status(PimplBase* pimpl) {
-        impl = std::shared_ptr<Status::PimplBase>(pimpl);
+        impl         = std::shared_ptr<Status::PimplBase>(pimpl);
+        currentValue = 0;
+    }
+
+
+    Status::Status(PimplBase& pimpl, unsigned long long value) {
+        // The aliasing constructor with an empty owner gives us a pointer with no control block so construction,
+        // copies, and destruction never allocate or touch a reference count.
+        impl         = std::shared_ptr<Status::PimplBase>(std::shared_ptr<Status::PimplBase>(), &pimpl);
+        currentValue = value;
     }
 
 
     Status::Status() {
-        impl = std::shared_ptr<Status::PimplBase>(nullptr);
+        currentValue = 0;
     }
 
 
     Status::Status(const Status& other) {
-        impl = other.impl;
+        impl         = other.impl;
+        currentValue = other.currentValue;
     }
 
 
@@ -53,7 +63,9 @@ namespace Container {
 
 
     Status& Status::operator=(const Status& other) {
-        impl = other.impl;
+        impl         = other.impl;
+        currentValue = other.currentValue;
+
         return *this;
     }
 
@@ -69,7 +81,7 @@ namespace Container {
 
 
     std::string Status::description() const {
-        return impl ? impl->description() : std::string();
+        return impl ? impl->valueDescription(currentValue) : std::string();
     }
 
 
@@ -106,6 +118,11 @@ namespace Container {
     std::shared_ptr<Status::PimplBase> Status::pimpl() const {
         return impl;
     }
+
+
+    unsigned long long Status::inlineValue() const {
+        return currentValue;
+    }
 };
 
 /***********************************************************************************************************************
@@ -119,6 +136,11 @@ namespace Container {
     Status::PimplBase::~PimplBase() {}
 
 
+    std::string Status::PimplBase::valueDescription(unsigned long long) const {
+        return description();
+    }
+
+
     bool Status::PimplBase::informationAvailable() const {
         return true;
     }
@@ -25,6 +25,7 @@
 #include <map>
 #include <string>
 #include <memory>
+#include <utility>
 
 #include "container_status.h"
 #include "stream_chunk.h"
@@ -35,6 +36,64 @@
 #include "container_virtual_file.h"
 
 namespace Container {
+    VirtualFile::View::View() {
+        totalBytes = 0;
+    }
+
+
+    VirtualFile::View::View(const VirtualFile::View& other) {
+        spans      = other.spans;
+        lengths    = other.lengths;
+        totalBytes = other.totalBytes;
+    }
+
+
+    VirtualFile::View::~View() {}
+
+
+    unsigned VirtualFile::View::numberSpans() const {
+        return static_cast<unsigned>(spans.size());
+    }
+
+
+    const std::uint8_t* VirtualFile::View::spanData(unsigned index) const {
+        return index < spans.size() ? spans[index].get() : nullptr;
+    }
+
+
+    unsigned VirtualFile::View::spanLength(unsigned index) const {
+        return index < lengths.size() ? lengths[index] : 0;
+    }
+
+
+    unsigned long long VirtualFile::View::size() const {
+        return totalBytes;
+    }
+
+
+    void VirtualFile::View::release() {
+        spans.clear();
+        lengths.clear();
+        totalBytes = 0;
+    }
+
+
+    VirtualFile::View& VirtualFile::View::operator=(const VirtualFile::View& other) {
+        spans      = other.spans;
+        lengths    = other.lengths;
+        totalBytes = other.totalBytes;
+
+        return *this;
+    }
+
+
+    void VirtualFile::View::append(std::shared_ptr<const std::uint8_t> data, unsigned length) {
+        spans.push_back(data);
+        lengths.push_back(length);
+        totalBytes += length;
+    }
+
+
     VirtualFile::VirtualFile(const std::string& newName, Container* container) {
         StreamChunk::StreamIdentifier streamIdentifier = container->impl->newStreamIdentifier();
         impl = std::make_shared<VirtualFile::Private>(newName, streamIdentifier, container, this);
@@ -84,18 +143,58 @@ namespace Container {
     }
 
 
+    Status VirtualFile::readView(unsigned desiredCount, VirtualFile::View& view) {
+        return impl->readView(desiredCount, view);
+    }
+
+
+    Status VirtualFile::readAt(unsigned long long offset, std::uint8_t* buffer, unsigned desiredCount) {
+        return impl->readAt(offset, buffer, desiredCount);
+    }
+
+
     Status VirtualFile::write(const std::uint8_t* buffer, unsigned desiredCount) {
         return impl->write(buffer, desiredCount);
     }
 
 
+    Status VirtualFile::writeAt(unsigned long long offset, const std::uint8_t* buffer, unsigned count) {
+        return impl->writeAt(offset, buffer, count);
+    }
+
+
     Status VirtualFile::append(const std::uint8_t* buffer, unsigned desiredCount) {
         return impl->append(buffer, desiredCount);
     }
 
 
-    Status VirtualFile::truncate() {
-        return impl->truncate();
+    Status VirtualFile::readv(const VirtualFile::ReadBuffer* buffers, unsigned numberBuffers) {
+        return impl->readv(buffers, numberBuffers);
+    }
+
+
+    Status VirtualFile::writev(const VirtualFile::WriteBuffer* buffers, unsigned numberBuffers) {
+        return impl->writev(buffers, numberBuffers);
+    }
+
+
+    Status VirtualFile::write(std::vector<std::uint8_t>&& buffer) {
+        return impl->write(std::move(buffer));
+    }
+
+
+    Status VirtualFile::reserve(unsigned long long expectedSize) {
+        return impl->reserve(expectedSize);
+    }
+
+
+    unsigned long long VirtualFile::bytesReserved() const {
+        return impl->bytesReserved();
+    }
+
+
+    Status VirtualFile::truncate(bool verify) {
+        return impl->truncate(verify);
     }
 
 
@@ -104,8 +203,8 @@ namespace Container {
     }
 
 
-    Status VirtualFile::erase() {
-        return impl->erase();
+    Status VirtualFile::erase(bool verify) {
+        return impl->erase(verify, verify);
     }
 
 
@@ -114,6 +213,46 @@ namespace Container {
     }
 
 
+    Status VirtualFile::setCompression(VirtualFile::Compression newCompression) {
+        return impl->setCompression(newCompression);
+    }
+
+
+    VirtualFile::Compression VirtualFile::compression() const {
+        return impl->compression();
+    }
+
+
+    Status VirtualFile::setWriteCacheSize(unsigned long long newSize) {
+        return impl->setWriteCacheSize(newSize);
+    }
+
+
+    unsigned long long VirtualFile::writeCacheSize() const {
+        return impl->writeCacheSize();
+    }
+
+
+    void VirtualFile::setReadCacheSize(unsigned numberChunks) {
+        impl->setReadCacheSize(numberChunks);
+    }
+
+
+    unsigned VirtualFile::readCacheSize() const {
+        return impl->readCacheSize();
+    }
+
+
+    unsigned long long VirtualFile::readCacheHits() const {
+        return impl->readCacheHits();
+    }
+
+
+    unsigned long long VirtualFile::readCacheMisses() const {
+        return impl->readCacheMisses();
+    }
+
+
     VirtualFile& VirtualFile::operator=(const VirtualFile& other) {
         impl = other.impl;
         return *this;
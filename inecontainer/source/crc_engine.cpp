@@ -0,0 +1,836 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref CrcEngine class.
+***********************************************************************************************************************/
+
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)))
+
+    #define CRC_ENGINE_X86_CLMUL
+    #include <immintrin.h>
+
+#elif (defined(__aarch64__) && (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES)))
+
+    #define CRC_ENGINE_ARM_PMULL
+    #include <arm_neon.h>
+
+    #if (defined(__linux__))
+
+        #include <sys/auxv.h>
+        #include <asm/hwcap.h>
+
+    #endif
+
+#endif
+
+#include "crc_engine.h"
+
+const std::uint16_t CrcEngine::crcTable[256] = {
+//    +0      +1      +2      +3      +4      +5      +6      +7
+//  ------  ------  ------  ------  ------  ------  ------  ------
+    0x0000, 0x8005, 0x800F, 0x000A, 0x801B, 0x001E, 0x0014, 0x8011, //   +0
+    0x8033, 0x0036, 0x003C, 0x8039, 0x0028, 0x802D, 0x8027, 0x0022, //   +8
+    0x8063, 0x0066, 0x006C, 0x8069, 0x0078, 0x807D, 0x8077, 0x0072, //  +16
+    0x0050, 0x8055, 0x805F, 0x005A, 0x804B, 0x004E, 0x0044, 0x8041, //  +24
+    0x80C3, 0x00C6, 0x00CC, 0x80C9, 0x00D8, 0x80DD, 0x80D7, 0x00D2, //  +32
+    0x00F0, 0x80F5, 0x80FF, 0x00FA, 0x80EB, 0x00EE, 0x00E4, 0x80E1, //  +40
+    0x00A0, 0x80A5, 0x80AF, 0x00AA, 0x80BB, 0x00BE, 0x00B4, 0x80B1, //  +48
+    0x8093, 0x0096, 0x009C, 0x8099, 0x0088, 0x808D, 0x8087, 0x0082, //  +56
+    0x8183, 0x0186, 0x018C, 0x8189, 0x0198, 0x819D, 0x8197, 0x0192, //  +64
+    0x01B0, 0x81B5, 0x81BF, 0x01BA, 0x81AB, 0x01AE, 0x01A4, 0x81A1, //  +72
+    0x01E0, 0x81E5, 0x81EF, 0x01EA, 0x81FB, 0x01FE, 0x01F4, 0x81F1, //  +80
+    0x81D3, 0x01D6, 0x01DC, 0x81D9, 0x01C8, 0x81CD, 0x81C7, 0x01C2, //  +88
+    0x0140, 0x8145, 0x814F, 0x014A, 0x815B, 0x015E, 0x0154, 0x8151, //  +96
+    0x8173, 0x0176, 0x017C, 0x8179, 0x0168, 0x816D, 0x8167, 0x0162, // +104
+    0x8123, 0x0126, 0x012C, 0x8129, 0x0138, 0x813D, 0x8137, 0x0132, // +112
+    0x0110, 0x8115, 0x811F, 0x011A, 0x810B, 0x010E, 0x0104, 0x8101, // +120
+    0x8303, 0x0306, 0x030C, 0x8309, 0x0318, 0x831D, 0x8317, 0x0312, // +128
+    0x0330, 0x8335, 0x833F, 0x033A, 0x832B, 0x032E, 0x0324, 0x8321, // +136
+    0x0360, 0x8365, 0x836F, 0x036A, 0x837B, 0x037E, 0x0374, 0x8371, // +144
+    0x8353, 0x0356, 0x035C, 0x8359, 0x0348, 0x834D, 0x8347, 0x0342, // +152
+    0x03C0, 0x83C5, 0x83CF, 0x03CA, 0x83DB, 0x03DE, 0x03D4, 0x83D1, // +160
+    0x83F3, 0x03F6, 0x03FC, 0x83F9, 0x03E8, 0x83ED, 0x83E7, 0x03E2, // +168
+    0x83A3, 0x03A6, 0x03AC, 0x83A9, 0x03B8, 0x83BD, 0x83B7, 0x03B2, // +176
+    0x0390, 0x8395, 0x839F, 0x039A, 0x838B, 0x038E, 0x0384, 0x8381, // +184
+    0x0280, 0x8285, 0x828F, 0x028A, 0x829B, 0x029E, 0x0294, 0x8291, // +192
+    0x82B3, 0x02B6, 0x02BC, 0x82B9, 0x02A8, 0x82AD, 0x82A7, 0x02A2, // +200
+    0x82E3, 0x02E6, 0x02EC, 0x82E9, 0x02F8, 0x82FD, 0x82F7, 0x02F2, // +208
+    0x02D0, 0x82D5, 0x82DF, 0x02DA, 0x82CB, 0x02CE, 0x02C4, 0x82C1, // +216
+    0x8243, 0x0246, 0x024C, 0x8249, 0x0258, 0x825D, 0x8257, 0x0252, // +224
+    0x0270, 0x8275, 0x827F, 0x027A, 0x826B, 0x026E, 0x0264, 0x8261, // +232
+    0x0220, 0x8225, 0x822F, 0x022A, 0x823B, 0x023E, 0x0234, 0x8231, // +240
+    0x8213, 0x0216, 0x021C, 0x8219, 0x0208, 0x820D, 0x8207, 0x0202  // +248
+};
+
+std::uint16_t CrcEngine::sliceTables[16][256];
+std::uint64_t CrcEngine::foldConstants[4];
+std::uint64_t CrcEngine::crc64Tables[8][256];
+std::uint64_t CrcEngine::fold64Constants[4];
+
+CrcEngine::Implementation CrcEngine::implementation() {
+    static const Implementation selectedImplementation = selectImplementation();
+    return selectedImplementation;
+}
+
+
+bool CrcEngine::isSupported(CrcEngine::Implementation implementation) {
+    bool result;
+
+    if (implementation == Implementation::CARRY_LESS_MULTIPLY) {
+        #if (defined(CRC_ENGINE_X86_CLMUL))
+
+            result = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+
+        #elif (defined(CRC_ENGINE_ARM_PMULL) && defined(__linux__))
+
+            result = (getauxval(AT_HWCAP) & HWCAP_PMULL) != 0;
+
+        #elif (defined(CRC_ENGINE_ARM_PMULL))
+
+            result = true; // The compiler was told the crypto extensions are always present.
+
+        #else
+
+            result = false;
+
+        #endif
+    } else {
+        result = true;
+    }
+
+    return result;
+}
+
+
+CrcEngine::RunningCrc CrcEngine::calculate(
+        CrcEngine::RunningCrc currentCrc,
+        const std::uint8_t*   data,
+        unsigned              dataLength
+    ) {
+    static const CalculateFunction calculateFunction = function(implementation());
+    return (*calculateFunction)(currentCrc, data, dataLength);
+}
+
+
+CrcEngine::RunningCrc CrcEngine::calculate(
+        CrcEngine::Implementation implementation,
+        CrcEngine::RunningCrc     currentCrc,
+        const std::uint8_t*       data,
+        unsigned                  dataLength
+    ) {
+    CrcEngine::implementation(); // Guarantees the tables are initialized.
+
+    if (!isSupported(implementation)) {
+        implementation = Implementation::BYTEWISE;
+    }
+
+    return (*function(implementation))(currentCrc, data, dataLength);
+}
+
+
+CrcEngine::RunningCrc CrcEngine::copyAndCalculate(
+        CrcEngine::RunningCrc currentCrc,
+        std::uint8_t*         destination,
+        const std::uint8_t*   source,
+        unsigned              dataLength
+    ) {
+    // We copy a block at a time and then calculate the CRC from the destination while it is still in the L1 cache.
+    // This lets the copy use the platform's optimized memcpy and the CRC use the fastest available kernel while only
+    // pulling the data through the memory hierarchy once.
+
+    while (dataLength > 0) {
+        unsigned blockLength = dataLength < copyBlockSize ? dataLength : copyBlockSize;
+
+        std::memcpy(destination, source, blockLength);
+        currentCrc = calculate(currentCrc, destination, blockLength);
+
+        destination += blockLength;
+        source      += blockLength;
+        dataLength  -= blockLength;
+    }
+
+    return currentCrc;
+}
+
+
+CrcEngine::RunningCrc CrcEngine::combine(
+        CrcEngine::RunningCrc leadingCrc,
+        CrcEngine::RunningCrc trailingCrc,
+        unsigned long long    trailingLength
+    ) {
+    // Processing n additional bytes multiplies the leading CRC by x^(8n).  The CRC is linear so the contribution of
+    // the trailing data simply adds.
+
+    return multiplyModP(leadingCrc, xPowerModP(8 * trailingLength)) ^ trailingCrc;
+}
+
+
+CrcEngine::RunningCrc64 CrcEngine::calculate64(
+        CrcEngine::RunningCrc64 currentCrc,
+        const std::uint8_t*     data,
+        unsigned                dataLength
+    ) {
+    static const Calculate64Function calculateFunction = function64(implementation());
+    return (*calculateFunction)(currentCrc, data, dataLength);
+}
+
+
+CrcEngine::RunningCrc64 CrcEngine::calculate64(
+        CrcEngine::Implementation implementation,
+        CrcEngine::RunningCrc64   currentCrc,
+        const std::uint8_t*       data,
+        unsigned                  dataLength
+    ) {
+    CrcEngine::implementation(); // Guarantees the tables are initialized.
+
+    if (!isSupported(implementation)) {
+        implementation = Implementation::BYTEWISE;
+    }
+
+    return (*function64(implementation))(currentCrc, data, dataLength);
+}
+
+
+CrcEngine::RunningCrc64 CrcEngine::combine64(
+        CrcEngine::RunningCrc64 leadingCrc,
+        CrcEngine::RunningCrc64 trailingCrc,
+        unsigned long long      trailingLength
+    ) {
+    return multiplyModP64(leadingCrc, xPowerModP64(8 * trailingLength)) ^ trailingCrc;
+}
+
+
+CrcEngine::Implementation CrcEngine::selectImplementation() {
+    initializeTables();
+
+    Implementation result;
+    if (isSupported(Implementation::CARRY_LESS_MULTIPLY)) {
+        result = Implementation::CARRY_LESS_MULTIPLY;
+    } else {
+        result = Implementation::SLICE_BY_16;
+    }
+
+    return result;
+}
+
+
+CrcEngine::CalculateFunction CrcEngine::function(CrcEngine::Implementation implementation) {
+    CalculateFunction result;
+
+    switch (implementation) {
+        case Implementation::BYTEWISE:            { result = &calculateBytewise;           break; }
+        case Implementation::SLICE_BY_8:          { result = &calculateSliceBy8;           break; }
+        case Implementation::SLICE_BY_16:         { result = &calculateSliceBy16;          break; }
+        case Implementation::CARRY_LESS_MULTIPLY: { result = &calculateCarryLessMultiply;  break; }
+        default:                                  { result = &calculateBytewise;           break; }
+    }
+
+    return result;
+}
+
+
+CrcEngine::Calculate64Function CrcEngine::function64(CrcEngine::Implementation implementation) {
+    Calculate64Function result;
+
+    switch (implementation) {
+        case Implementation::BYTEWISE:            { result = &calculate64Bytewise;           break; }
+        case Implementation::SLICE_BY_8:          { result = &calculate64SliceBy8;           break; }
+        case Implementation::SLICE_BY_16:         { result = &calculate64SliceBy8;           break; }
+        case Implementation::CARRY_LESS_MULTIPLY: { result = &calculate64CarryLessMultiply;  break; }
+        default:                                  { result = &calculate64Bytewise;           break; }
+    }
+
+    return result;
+}
+
+
+CrcEngine::RunningCrc CrcEngine::calculateBytewise(
+        CrcEngine::RunningCrc currentCrc,
+        const std::uint8_t*   data,
+        unsigned              dataLength
+    ) {
+    const std::uint8_t* endingByte = data + dataLength;
+    while (data != endingByte) {
+        RunningCrc xorValue = crcTable[currentCrc >> 8];
+        currentCrc = ((currentCrc << 8) | *data) ^ xorValue;
+
+        ++data;
+    }
+
+    return currentCrc;
+}
+
+
+CrcEngine::RunningCrc CrcEngine::calculateSliceBy8(
+        CrcEngine::RunningCrc currentCrc,
+        const std::uint8_t*   data,
+        unsigned              dataLength
+    ) {
+    // Processing 8 bytes multiplies the running CRC by x^64.  The high and low bytes of the CRC therefore land on
+    // x^72 and x^64 while data byte i lands on x^(8 * (7 - i)).  The two final data bytes need no reduction.
+
+    while (dataLength >= 8) {
+        currentCrc = (
+              sliceTables[7][currentCrc >> 8]
+            ^ sliceTables[6][currentCrc & 0xFF]
+            ^ sliceTables[5][data[0]]
+            ^ sliceTables[4][data[1]]
+            ^ sliceTables[3][data[2]]
+            ^ sliceTables[2][data[3]]
+            ^ sliceTables[1][data[4]]
+            ^ sliceTables[0][data[5]]
+            ^ (static_cast<RunningCrc>(data[6]) << 8)
+            ^ data[7]
+        );
+
+        data       += 8;
+        dataLength -= 8;
+    }
+
+    return calculateBytewise(currentCrc, data, dataLength);
+}
+
+
+CrcEngine::RunningCrc CrcEngine::calculateSliceBy16(
+        CrcEngine::RunningCrc currentCrc,
+        const std::uint8_t*   data,
+        unsigned              dataLength
+    ) {
+    while (dataLength >= 16) {
+        currentCrc = (
+              sliceTables[15][currentCrc >> 8]
+            ^ sliceTables[14][currentCrc & 0xFF]
+            ^ sliceTables[13][data[ 0]]
+            ^ sliceTables[12][data[ 1]]
+            ^ sliceTables[11][data[ 2]]
+            ^ sliceTables[10][data[ 3]]
+            ^ sliceTables[ 9][data[ 4]]
+            ^ sliceTables[ 8][data[ 5]]
+            ^ sliceTables[ 7][data[ 6]]
+            ^ sliceTables[ 6][data[ 7]]
+            ^ sliceTables[ 5][data[ 8]]
+            ^ sliceTables[ 4][data[ 9]]
+            ^ sliceTables[ 3][data[10]]
+            ^ sliceTables[ 2][data[11]]
+            ^ sliceTables[ 1][data[12]]
+            ^ sliceTables[ 0][data[13]]
+            ^ (static_cast<RunningCrc>(data[14]) << 8)
+            ^ data[15]
+        );
+
+        data       += 16;
+        dataLength -= 16;
+    }
+
+    return calculateSliceBy8(currentCrc, data, dataLength);
+}
+
+CrcEngine::RunningCrc64 CrcEngine::calculate64Bytewise(
+        CrcEngine::RunningCrc64 currentCrc,
+        const std::uint8_t*     data,
+        unsigned                dataLength
+    ) {
+    const std::uint8_t* endingByte = data + dataLength;
+    while (data != endingByte) {
+        RunningCrc64 xorValue = crc64Tables[0][currentCrc >> 56];
+        currentCrc = ((currentCrc << 8) | *data) ^ xorValue;
+
+        ++data;
+    }
+
+    return currentCrc;
+}
+
+
+CrcEngine::RunningCrc64 CrcEngine::calculate64SliceBy8(
+        CrcEngine::RunningCrc64 currentCrc,
+        const std::uint8_t*     data,
+        unsigned                dataLength
+    ) {
+    // Processing 8 bytes multiplies the running CRC by x^64.  Each byte of the CRC is reduced using its own table and
+    // the data bytes, which are already reduced, are simply added.
+
+    while (dataLength >= 8) {
+        currentCrc = (
+              crc64Tables[7][ currentCrc >> 56        ]
+            ^ crc64Tables[6][(currentCrc >> 48) & 0xFF]
+            ^ crc64Tables[5][(currentCrc >> 40) & 0xFF]
+            ^ crc64Tables[4][(currentCrc >> 32) & 0xFF]
+            ^ crc64Tables[3][(currentCrc >> 24) & 0xFF]
+            ^ crc64Tables[2][(currentCrc >> 16) & 0xFF]
+            ^ crc64Tables[1][(currentCrc >>  8) & 0xFF]
+            ^ crc64Tables[0][ currentCrc        & 0xFF]
+            ^ (static_cast<RunningCrc64>(data[0]) << 56)
+            ^ (static_cast<RunningCrc64>(data[1]) << 48)
+            ^ (static_cast<RunningCrc64>(data[2]) << 40)
+            ^ (static_cast<RunningCrc64>(data[3]) << 32)
+            ^ (static_cast<RunningCrc64>(data[4]) << 24)
+            ^ (static_cast<RunningCrc64>(data[5]) << 16)
+            ^ (static_cast<RunningCrc64>(data[6]) <<  8)
+            ^  static_cast<RunningCrc64>(data[7])
+        );
+
+        data       += 8;
+        dataLength -= 8;
+    }
+
+    return calculate64Bytewise(currentCrc, data, dataLength);
+}
+
+#if (defined(CRC_ENGINE_X86_CLMUL))
+
+    /**
+     * Function that multiplies both halves of a 128-bit value by folding constants and sums the result.
+     *
+     * \param[in] value     The value to be folded.
+     *
+     * \param[in] constants The folding constants.  The upper half of the value is multiplied by the upper constant.
+     *
+     * \return Returns a value congruent to the provided value times \f$x^{128}\f$ or \f$x^{512}\f$.
+     */
+    __attribute__((target("pclmul,ssse3"))) static inline __m128i fold(__m128i value, __m128i constants) {
+        return _mm_xor_si128(
+            _mm_clmulepi64_si128(value, constants, 0x11),
+            _mm_clmulepi64_si128(value, constants, 0x00)
+        );
+    }
+
+
+    /**
+     * Function that loads 16 bytes of data as a polynomial, first byte most significant.
+     *
+     * \param[in] data Pointer to the data to be loaded.
+     *
+     * \return Returns the loaded polynomial.
+     */
+    __attribute__((target("pclmul,ssse3"))) static inline __m128i loadBlock(const std::uint8_t* data) {
+        const __m128i byteReverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), byteReverse);
+    }
+
+
+    /**
+     * Function that stores a polynomial as 16 bytes of data, first byte most significant.
+     *
+     * \param[in] data  Pointer to the location to receive the data.
+     *
+     * \param[in] value The polynomial to be stored.
+     */
+    __attribute__((target("pclmul,ssse3"))) static inline void storeBlock(std::uint8_t* data, __m128i value) {
+        const __m128i byteReverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data), _mm_shuffle_epi8(value, byteReverse));
+    }
+
+
+    /**
+     * Function that folds data into a single 128-bit accumulator.
+     *
+     * \param[in]     seed       The running CRC, treated as a block preceding the data.
+     *
+     * \param[in,out] data       Pointer to the data.  The pointer is advanced past the processed data.
+     *
+     * \param[in,out] dataLength The length of the data, in bytes.  The value must be at least 64 and is updated to
+     *                           hold the number of unprocessed bytes, always less than 16.
+     *
+     * \param[in]     fold128    The constants used to fold by 128 bits.
+     *
+     * \param[in]     fold512    The constants used to fold by 512 bits.
+     *
+     * \return Returns a value congruent to the seed and processed data.
+     */
+    __attribute__((target("pclmul,ssse3"))) static inline __m128i foldData(
+            __m128i              seed,
+            const std::uint8_t*& data,
+            unsigned&            dataLength,
+            __m128i              fold128,
+            __m128i              fold512
+        ) {
+        // We fold 128-bit blocks into four independent accumulators.  Each fold multiplies the upper and lower 64 bits
+        // of an accumulator by x^(n+64) and x^n, modulo P(x), and adds the next block.  The constants are at most 64
+        // bits wide so every product fits within 128 bits and the accumulators always remain congruent to the data
+        // processed so far.
+
+        __m128i lane0 = _mm_xor_si128(fold(seed, fold128), loadBlock(data));
+        __m128i lane1 = loadBlock(data + 16);
+        __m128i lane2 = loadBlock(data + 32);
+        __m128i lane3 = loadBlock(data + 48);
+
+        data       += 64;
+        dataLength -= 64;
+
+        while (dataLength >= 64) {
+            lane0 = _mm_xor_si128(fold(lane0, fold512), loadBlock(data     ));
+            lane1 = _mm_xor_si128(fold(lane1, fold512), loadBlock(data + 16));
+            lane2 = _mm_xor_si128(fold(lane2, fold512), loadBlock(data + 32));
+            lane3 = _mm_xor_si128(fold(lane3, fold512), loadBlock(data + 48));
+
+            data       += 64;
+            dataLength -= 64;
+        }
+
+        __m128i accumulator = lane0;
+        accumulator = _mm_xor_si128(fold(accumulator, fold128), lane1);
+        accumulator = _mm_xor_si128(fold(accumulator, fold128), lane2);
+        accumulator = _mm_xor_si128(fold(accumulator, fold128), lane3);
+
+        while (dataLength >= 16) {
+            accumulator = _mm_xor_si128(fold(accumulator, fold128), loadBlock(data));
+
+            data       += 16;
+            dataLength -= 16;
+        }
+
+        return accumulator;
+    }
+
+
+    __attribute__((target("pclmul,ssse3"))) CrcEngine::RunningCrc CrcEngine::calculateCarryLessMultiply(
+            CrcEngine::RunningCrc currentCrc,
+            const std::uint8_t*   data,
+            unsigned              dataLength
+        ) {
+        // The data is folded into a single 128-bit accumulator which is then reduced using the table driven
+        // implementation.
+
+        if (dataLength >= 64) {
+            const __m128i fold128 = _mm_set_epi64x(
+                static_cast<long long>(foldConstants[1]),
+                static_cast<long long>(foldConstants[0])
+            );
+
+            const __m128i fold512 = _mm_set_epi64x(
+                static_cast<long long>(foldConstants[3]),
+                static_cast<long long>(foldConstants[2])
+            );
+
+            __m128i accumulator = foldData(_mm_cvtsi32_si128(currentCrc), data, dataLength, fold128, fold512);
+
+            std::uint8_t accumulatorBytes[16];
+            storeBlock(accumulatorBytes, accumulator);
+
+            currentCrc = calculateSliceBy16(0, accumulatorBytes, 16);
+        }
+
+        return calculateSliceBy8(currentCrc, data, dataLength);
+    }
+
+
+    __attribute__((target("pclmul,ssse3"))) CrcEngine::RunningCrc64 CrcEngine::calculate64CarryLessMultiply(
+            CrcEngine::RunningCrc64 currentCrc,
+            const std::uint8_t*     data,
+            unsigned                dataLength
+        ) {
+        if (dataLength >= 64) {
+            const __m128i fold128 = _mm_set_epi64x(
+                static_cast<long long>(fold64Constants[1]),
+                static_cast<long long>(fold64Constants[0])
+            );
+
+            const __m128i fold512 = _mm_set_epi64x(
+                static_cast<long long>(fold64Constants[3]),
+                static_cast<long long>(fold64Constants[2])
+            );
+
+            __m128i seed        = _mm_set_epi64x(0, static_cast<long long>(currentCrc));
+            __m128i accumulator = foldData(seed, data, dataLength, fold128, fold512);
+
+            std::uint8_t accumulatorBytes[16];
+            storeBlock(accumulatorBytes, accumulator);
+
+            currentCrc = calculate64SliceBy8(0, accumulatorBytes, 16);
+        }
+
+        return calculate64SliceBy8(currentCrc, data, dataLength);
+    }
+
+#elif (defined(CRC_ENGINE_ARM_PMULL))
+
+    /**
+     * Function that multiplies both halves of a 128-bit value by folding constants and sums the result.
+     *
+     * \param[in] value        The value to be folded.
+     *
+     * \param[in] lowConstant  The constant applied to the lower 64 bits of the value.
+     *
+     * \param[in] highConstant The constant applied to the upper 64 bits of the value.
+     *
+     * \return Returns a value congruent to the provided value times \f$x^{128}\f$ or \f$x^{512}\f$.
+     */
+    static inline uint64x2_t fold(uint64x2_t value, poly64_t lowConstant, poly64_t highConstant) {
+        poly128_t high = vmull_p64(static_cast<poly64_t>(vgetq_lane_u64(value, 1)), highConstant);
+        poly128_t low  = vmull_p64(static_cast<poly64_t>(vgetq_lane_u64(value, 0)), lowConstant);
+
+        return veorq_u64(vreinterpretq_u64_p128(high), vreinterpretq_u64_p128(low));
+    }
+
+
+    /**
+     * Function that loads 16 bytes of data as a polynomial, first byte most significant.
+     *
+     * \param[in] data Pointer to the data to be loaded.
+     *
+     * \return Returns the loaded polynomial.
+     */
+    static inline uint64x2_t loadBlock(const std::uint8_t* data) {
+        uint64x2_t value = vreinterpretq_u64_u8(vrev64q_u8(vld1q_u8(data)));
+        return vextq_u64(value, value, 1);
+    }
+
+
+    /**
+     * Function that stores a polynomial as 16 bytes of data, first byte most significant.
+     *
+     * \param[in] data  Pointer to the location to receive the data.
+     *
+     * \param[in] value The polynomial to be stored.
+     */
+    static inline void storeBlock(std::uint8_t* data, uint64x2_t value) {
+        vst1q_u8(data, vrev64q_u8(vreinterpretq_u8_u64(vextq_u64(value, value, 1))));
+    }
+
+
+    /**
+     * Function that folds data into a single 128-bit accumulator.  See the x86 implementation for a description of
+     * the algorithm.
+     *
+     * \param[in]     seed       The running CRC, treated as a block preceding the data.
+     *
+     * \param[in,out] data       Pointer to the data.  The pointer is advanced past the processed data.
+     *
+     * \param[in,out] dataLength The length of the data, in bytes.  The value must be at least 64 and is updated to
+     *                           hold the number of unprocessed bytes, always less than 16.
+     *
+     * \param[in]     constants  The folding constants for \f$x^{128}\f$, \f$x^{192}\f$, \f$x^{512}\f$, and
+     *                           \f$x^{576}\f$, in that order.
+     *
+     * \return Returns a value congruent to the seed and processed data.
+     */
+    static inline uint64x2_t foldData(
+            uint64x2_t           seed,
+            const std::uint8_t*& data,
+            unsigned&            dataLength,
+            const std::uint64_t* constants
+        ) {
+        const poly64_t fold128Low  = static_cast<poly64_t>(constants[0]);
+        const poly64_t fold128High = static_cast<poly64_t>(constants[1]);
+        const poly64_t fold512Low  = static_cast<poly64_t>(constants[2]);
+        const poly64_t fold512High = static_cast<poly64_t>(constants[3]);
+
+        uint64x2_t lane0 = veorq_u64(fold(seed, fold128Low, fold128High), loadBlock(data));
+        uint64x2_t lane1 = loadBlock(data + 16);
+        uint64x2_t lane2 = loadBlock(data + 32);
+        uint64x2_t lane3 = loadBlock(data + 48);
+
+        data       += 64;
+        dataLength -= 64;
+
+        while (dataLength >= 64) {
+            lane0 = veorq_u64(fold(lane0, fold512Low, fold512High), loadBlock(data     ));
+            lane1 = veorq_u64(fold(lane1, fold512Low, fold512High), loadBlock(data + 16));
+            lane2 = veorq_u64(fold(lane2, fold512Low, fold512High), loadBlock(data + 32));
+            lane3 = veorq_u64(fold(lane3, fold512Low, fold512High), loadBlock(data + 48));
+
+            data       += 64;
+            dataLength -= 64;
+        }
+
+        uint64x2_t accumulator = lane0;
+        accumulator = veorq_u64(fold(accumulator, fold128Low, fold128High), lane1);
+        accumulator = veorq_u64(fold(accumulator, fold128Low, fold128High), lane2);
+        accumulator = veorq_u64(fold(accumulator, fold128Low, fold128High), lane3);
+
+        while (dataLength >= 16) {
+            accumulator = veorq_u64(fold(accumulator, fold128Low, fold128High), loadBlock(data));
+
+            data       += 16;
+            dataLength -= 16;
+        }
+
+        return accumulator;
+    }
+
+
+    CrcEngine::RunningCrc CrcEngine::calculateCarryLessMultiply(
+            CrcEngine::RunningCrc currentCrc,
+            const std::uint8_t*   data,
+            unsigned              dataLength
+        ) {
+        if (dataLength >= 64) {
+            uint64x2_t seed        = vcombine_u64(vcreate_u64(currentCrc), vcreate_u64(0));
+            uint64x2_t accumulator = foldData(seed, data, dataLength, foldConstants);
+
+            std::uint8_t accumulatorBytes[16];
+            storeBlock(accumulatorBytes, accumulator);
+
+            currentCrc = calculateSliceBy16(0, accumulatorBytes, 16);
+        }
+
+        return calculateSliceBy8(currentCrc, data, dataLength);
+    }
+
+
+    CrcEngine::RunningCrc64 CrcEngine::calculate64CarryLessMultiply(
+            CrcEngine::RunningCrc64 currentCrc,
+            const std::uint8_t*     data,
+            unsigned                dataLength
+        ) {
+        if (dataLength >= 64) {
+            uint64x2_t seed        = vcombine_u64(vcreate_u64(currentCrc), vcreate_u64(0));
+            uint64x2_t accumulator = foldData(seed, data, dataLength, fold64Constants);
+
+            std::uint8_t accumulatorBytes[16];
+            storeBlock(accumulatorBytes, accumulator);
+
+            currentCrc = calculate64SliceBy8(0, accumulatorBytes, 16);
+        }
+
+        return calculate64SliceBy8(currentCrc, data, dataLength);
+    }
+
+#else
+
+    CrcEngine::RunningCrc CrcEngine::calculateCarryLessMultiply(
+            CrcEngine::RunningCrc currentCrc,
+            const std::uint8_t*   data,
+            unsigned              dataLength
+        ) {
+        return calculateSliceBy16(currentCrc, data, dataLength);
+    }
+
+
+    CrcEngine::RunningCrc64 CrcEngine::calculate64CarryLessMultiply(
+            CrcEngine::RunningCrc64 currentCrc,
+            const std::uint8_t*     data,
+            unsigned                dataLength
+        ) {
+        return calculate64SliceBy8(currentCrc, data, dataLength);
+    }
+
+#endif
+
+CrcEngine::RunningCrc CrcEngine::xPowerModP(unsigned long long exponent) {
+    RunningCrc result = 1;
+    RunningCrc power  = 2; // x^1
+
+    while (exponent != 0) {
+        if (exponent & 1) {
+            result = multiplyModP(result, power);
+        }
+
+        power      = multiplyModP(power, power);
+        exponent >>= 1;
+    }
+
+    return result;
+}
+
+
+CrcEngine::RunningCrc CrcEngine::multiplyModP(CrcEngine::RunningCrc a, CrcEngine::RunningCrc b) {
+    RunningCrc result = 0;
+
+    for (unsigned i=0 ; i<16 ; ++i) {
+        if (b & 0x8000) {
+            result = static_cast<RunningCrc>((result << 1) ^ ((result & 0x8000) ? polynomial : 0)) ^ a;
+        } else {
+            result = static_cast<RunningCrc>((result << 1) ^ ((result & 0x8000) ? polynomial : 0));
+        }
+
+        b <<= 1;
+    }
+
+    return result;
+}
+
+
+CrcEngine::RunningCrc64 CrcEngine::xPowerModP64(unsigned long long exponent) {
+    RunningCrc64 result = 1;
+    RunningCrc64 power  = 2; // x^1
+
+    while (exponent != 0) {
+        if (exponent & 1) {
+            result = multiplyModP64(result, power);
+        }
+
+        power      = multiplyModP64(power, power);
+        exponent >>= 1;
+    }
+
+    return result;
+}
+
+
+CrcEngine::RunningCrc64 CrcEngine::multiplyModP64(CrcEngine::RunningCrc64 a, CrcEngine::RunningCrc64 b) {
+    RunningCrc64 result = 0;
+
+    for (unsigned i=0 ; i<64 ; ++i) {
+        result = (result << 1) ^ ((result & 0x8000000000000000ULL) ? polynomial64 : 0);
+
+        if (b & 0x8000000000000000ULL) {
+            result ^= a;
+        }
+
+        b <<= 1;
+    }
+
+    return result;
+}
+
+
+void CrcEngine::initializeTables() {
+    for (unsigned v=0 ; v<256 ; ++v) {
+        RunningCrc value = crcTable[v];
+        sliceTables[0][v] = value;
+
+        for (unsigned k=1 ; k<16 ; ++k) {
+            value = static_cast<RunningCrc>(value << 8) ^ crcTable[value >> 8];
+            sliceTables[k][v] = value;
+        }
+    }
+
+    foldConstants[0] = xPowerModP(128);
+    foldConstants[1] = xPowerModP(192);
+    foldConstants[2] = xPowerModP(512);
+    foldConstants[3] = xPowerModP(576);
+
+    for (unsigned v=0 ; v<256 ; ++v) {
+        RunningCrc64 value = static_cast<RunningCrc64>(v) << 56;
+        for (unsigned bit=0 ; bit<8 ; ++bit) {
+            value = (value << 1) ^ ((value & 0x8000000000000000ULL) ? polynomial64 : 0);
+        }
+
+        crc64Tables[0][v] = value;
+    }
+
+    for (unsigned v=0 ; v<256 ; ++v) {
+        RunningCrc64 value = crc64Tables[0][v];
+
+        for (unsigned k=1 ; k<8 ; ++k) {
+            value = (value << 8) ^ crc64Tables[0][value >> 56];
+            crc64Tables[k][v] = value;
+        }
+    }
+
+    fold64Constants[0] = xPowerModP64(128);
+    fold64Constants[1] = xPowerModP64(192);
+    fold64Constants[2] = xPowerModP64(512);
+    fold64Constants[3] = xPowerModP64(576);
+}
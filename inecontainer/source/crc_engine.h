@@ -0,0 +1,453 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This header defines the \ref CrcEngine class.
+***********************************************************************************************************************/
+
+/* .. sphinx-project inecontainer */
+
+#ifndef CRC_ENGINE_H
+#define CRC_ENGINE_H
+
+#include <cstdint>
+
+/**
+ * Class that calculates the CRC-16 used to protect chunks.  The class provides several implementations of the same
+ * CRC and selects the fastest implementation supported by the processor at run-time.  All implementations produce
+ * identical results.
+ *
+ * The CRC is calculated as the remainder of the data, treated as a polynomial with the first byte being most
+ * significant, divided by the generator polynomial \f$x^{16} + x^{15} + x^2 + 1\f$.
+ *
+ * The class also calculates a 64-bit CRC, used to protect chunk payloads in containers that request strong payload
+ * checksums.  The 64-bit CRC is calculated the same way using the ECMA-182 generator polynomial and shares the same
+ * implementations.
+ */
+class CrcEngine {
+    public:
+        /**
+         * Type used to represent a running CRC value.
+         */
+        typedef std::uint16_t RunningCrc;
+
+        /**
+         * Type used to represent a running 64-bit CRC value.
+         */
+        typedef std::uint64_t RunningCrc64;
+
+        /**
+         * Enumeration of supported implementations.
+         */
+        enum class Implementation {
+            /**
+             * Indicates the classic table driven implementation that processes one byte at a time.
+             */
+            BYTEWISE,
+
+            /**
+             * Indicates a table driven implementation that processes 8 bytes at a time.
+             */
+            SLICE_BY_8,
+
+            /**
+             * Indicates a table driven implementation that processes 16 bytes at a time.
+             */
+            SLICE_BY_16,
+
+            /**
+             * Indicates an implementation that uses carry-less multiply instructions (PCLMULQDQ or PMULL) to fold the
+             * data 64 bytes at a time.
+             */
+            CARRY_LESS_MULTIPLY
+        };
+
+        /**
+         * Method that determines the implementation used by \ref CrcEngine::calculate.
+         *
+         * \return Returns the implementation selected for this processor.
+         */
+        static Implementation implementation();
+
+        /**
+         * Method that determines if an implementation is supported on this processor.
+         *
+         * \param[in] implementation The implementation to check.
+         *
+         * \return Returns true if the implementation is supported.  Returns false if the implementation is not
+         *         supported.
+         */
+        static bool isSupported(Implementation implementation);
+
+        /**
+         * Method that updates a running CRC value with additional data using the fastest available implementation.
+         *
+         * \param[in] currentCrc The current running CRC value.
+         *
+         * \param[in] data       Pointer to the data to be added to the CRC.
+         *
+         * \param[in] dataLength The length of the data, in bytes.
+         *
+         * \return Returns the updated running CRC value.
+         */
+        static RunningCrc calculate(RunningCrc currentCrc, const std::uint8_t* data, unsigned dataLength);
+
+        /**
+         * Method that updates a running CRC value with additional data using a specific implementation.
+         *
+         * \param[in] implementation The implementation to use.  The bytewise implementation will be used if the
+         *                           requested implementation is not supported.
+         *
+         * \param[in] currentCrc     The current running CRC value.
+         *
+         * \param[in] data           Pointer to the data to be added to the CRC.
+         *
+         * \param[in] dataLength     The length of the data, in bytes.
+         *
+         * \return Returns the updated running CRC value.
+         */
+        static RunningCrc calculate(
+            Implementation      implementation,
+            RunningCrc          currentCrc,
+            const std::uint8_t* data,
+            unsigned            dataLength
+        );
+
+        /**
+         * Method that copies data while updating a running CRC value.  The data is processed in blocks small enough
+         * to remain in the processor's L1 cache so the data only needs to be brought into the cache once.
+         *
+         * \param[in] currentCrc  The current running CRC value.
+         *
+         * \param[in] destination Pointer to the location to receive the data.
+         *
+         * \param[in] source      Pointer to the data to be copied and added to the CRC.  The source and destination
+         *                        must not overlap.
+         *
+         * \param[in] dataLength  The length of the data, in bytes.
+         *
+         * \return Returns the updated running CRC value.
+         */
+        static RunningCrc copyAndCalculate(
+            RunningCrc          currentCrc,
+            std::uint8_t*       destination,
+            const std::uint8_t* source,
+            unsigned            dataLength
+        );
+
+        /**
+         * Method that combines the CRC of two adjacent blocks of data.
+         *
+         * \param[in] leadingCrc     The running CRC after processing the first block of data.
+         *
+         * \param[in] trailingCrc    The CRC of the second block of data, calculated with an initial value of 0.
+         *
+         * \param[in] trailingLength The length of the second block of data, in bytes.
+         *
+         * \return Returns the running CRC value that would be obtained by processing both blocks in order.
+         */
+        static RunningCrc combine(RunningCrc leadingCrc, RunningCrc trailingCrc, unsigned long long trailingLength);
+
+        /**
+         * Method that updates a running 64-bit CRC value with additional data using the fastest available
+         * implementation.
+         *
+         * \param[in] currentCrc The current running CRC value.
+         *
+         * \param[in] data       Pointer to the data to be added to the CRC.
+         *
+         * \param[in] dataLength The length of the data, in bytes.
+         *
+         * \return Returns the updated running CRC value.
+         */
+        static RunningCrc64 calculate64(RunningCrc64 currentCrc, const std::uint8_t* data, unsigned dataLength);
+
+        /**
+         * Method that updates a running 64-bit CRC value with additional data using a specific implementation.  The
+         * slice-by-16 implementation uses slice-by-8 for the 64-bit CRC.
+         *
+         * \param[in] implementation The implementation to use.  The bytewise implementation will be used if the
+         *                           requested implementation is not supported.
+         *
+         * \param[in] currentCrc     The current running CRC value.
+         *
+         * \param[in] data           Pointer to the data to be added to the CRC.
+         *
+         * \param[in] dataLength     The length of the data, in bytes.
+         *
+         * \return Returns the updated running CRC value.
+         */
+        static RunningCrc64 calculate64(
+            Implementation      implementation,
+            RunningCrc64        currentCrc,
+            const std::uint8_t* data,
+            unsigned            dataLength
+        );
+
+        /**
+         * Method that combines the 64-bit CRC of two adjacent blocks of data.
+         *
+         * \param[in] leadingCrc     The running CRC after processing the first block of data.
+         *
+         * \param[in] trailingCrc    The CRC of the second block of data, calculated with an initial value of 0.
+         *
+         * \param[in] trailingLength The length of the second block of data, in bytes.
+         *
+         * \return Returns the running CRC value that would be obtained by processing both blocks in order.
+         */
+        static RunningCrc64 combine64(
+            RunningCrc64       leadingCrc,
+            RunningCrc64       trailingCrc,
+            unsigned long long trailingLength
+        );
+
+    private:
+        /**
+         * The generator polynomial, excluding the \f$x^{16}\f$ term.
+         */
+        static constexpr std::uint16_t polynomial = 0x8005;
+
+        /**
+         * The 64-bit generator polynomial, excluding the \f$x^{64}\f$ term.
+         */
+        static constexpr std::uint64_t polynomial64 = 0x42F0E1EBA9EA3693ULL;
+
+        /**
+         * Size of the blocks used by \ref CrcEngine::copyAndCalculate, in bytes.
+         */
+        static constexpr unsigned copyBlockSize = 4096;
+
+        /**
+         * Type of the function used to implement each version of the CRC.
+         */
+        typedef RunningCrc (*CalculateFunction)(RunningCrc, const std::uint8_t*, unsigned);
+
+        /**
+         * Type of the function used to implement each version of the 64-bit CRC.
+         */
+        typedef RunningCrc64 (*Calculate64Function)(RunningCrc64, const std::uint8_t*, unsigned);
+
+        /**
+         * Method that selects the fastest implementation for this processor.
+         *
+         * \return Returns the selected implementation.
+         */
+        static Implementation selectImplementation();
+
+        /**
+         * Method that returns the function used to support an implementation.
+         *
+         * \param[in] implementation The implementation of interest.
+         *
+         * \return Returns a pointer to the implementing function.
+         */
+        static CalculateFunction function(Implementation implementation);
+
+        /**
+         * Method that returns the function used to support an implementation of the 64-bit CRC.
+         *
+         * \param[in] implementation The implementation of interest.
+         *
+         * \return Returns a pointer to the implementing function.
+         */
+        static Calculate64Function function64(Implementation implementation);
+
+        /**
+         * Bytewise implementation.
+         *
+         * \param[in] currentCrc The current running CRC value.
+         *
+         * \param[in] data       Pointer to the data to be added to the CRC.
+         *
+         * \param[in] dataLength The length of the data, in bytes.
+         *
+         * \return Returns the updated running CRC value.
+         */
+        static RunningCrc calculateBytewise(RunningCrc currentCrc, const std::uint8_t* data, unsigned dataLength);
+
+        /**
+         * Slice-by-8 implementation.
+         *
+         * \param[in] currentCrc The current running CRC value.
+         *
+         * \param[in] data       Pointer to the data to be added to the CRC.
+         *
+         * \param[in] dataLength The length of the data, in bytes.
+         *
+         * \return Returns the updated running CRC value.
+         */
+        static RunningCrc calculateSliceBy8(RunningCrc currentCrc, const std::uint8_t* data, unsigned dataLength);
+
+        /**
+         * Slice-by-16 implementation.
+         *
+         * \param[in] currentCrc The current running CRC value.
+         *
+         * \param[in] data       Pointer to the data to be added to the CRC.
+         *
+         * \param[in] dataLength The length of the data, in bytes.
+         *
+         * \return Returns the updated running CRC value.
+         */
+        static RunningCrc calculateSliceBy16(RunningCrc currentCrc, const std::uint8_t* data, unsigned dataLength);
+
+        /**
+         * Carry-less multiply implementation.
+         *
+         * \param[in] currentCrc The current running CRC value.
+         *
+         * \param[in] data       Pointer to the data to be added to the CRC.
+         *
+         * \param[in] dataLength The length of the data, in bytes.
+         *
+         * \return Returns the updated running CRC value.
+         */
+        static RunningCrc calculateCarryLessMultiply(
+            RunningCrc          currentCrc,
+            const std::uint8_t* data,
+            unsigned            dataLength
+        );
+
+        /**
+         * Bytewise implementation of the 64-bit CRC.
+         *
+         * \param[in] currentCrc The current running CRC value.
+         *
+         * \param[in] data       Pointer to the data to be added to the CRC.
+         *
+         * \param[in] dataLength The length of the data, in bytes.
+         *
+         * \return Returns the updated running CRC value.
+         */
+        static RunningCrc64 calculate64Bytewise(
+            RunningCrc64        currentCrc,
+            const std::uint8_t* data,
+            unsigned            dataLength
+        );
+
+        /**
+         * Slice-by-8 implementation of the 64-bit CRC.
+         *
+         * \param[in] currentCrc The current running CRC value.
+         *
+         * \param[in] data       Pointer to the data to be added to the CRC.
+         *
+         * \param[in] dataLength The length of the data, in bytes.
+         *
+         * \return Returns the updated running CRC value.
+         */
+        static RunningCrc64 calculate64SliceBy8(
+            RunningCrc64        currentCrc,
+            const std::uint8_t* data,
+            unsigned            dataLength
+        );
+
+        /**
+         * Carry-less multiply implementation of the 64-bit CRC.
+         *
+         * \param[in] currentCrc The current running CRC value.
+         *
+         * \param[in] data       Pointer to the data to be added to the CRC.
+         *
+         * \param[in] dataLength The length of the data, in bytes.
+         *
+         * \return Returns the updated running CRC value.
+         */
+        static RunningCrc64 calculate64CarryLessMultiply(
+            RunningCrc64        currentCrc,
+            const std::uint8_t* data,
+            unsigned            dataLength
+        );
+
+        /**
+         * Method that calculates \f$x^{exponent} \bmod P\left(x\right)\f$.
+         *
+         * \param[in] exponent The power of x to be reduced.
+         *
+         * \return Returns the reduced value.
+         */
+        static RunningCrc xPowerModP(unsigned long long exponent);
+
+        /**
+         * Method that calculates \f$a\left(x\right) b\left(x\right) \bmod P\left(x\right)\f$.
+         *
+         * \param[in] a The first multiplicand.
+         *
+         * \param[in] b The second multiplicand.
+         *
+         * \return Returns the reduced product.
+         */
+        static RunningCrc multiplyModP(RunningCrc a, RunningCrc b);
+
+        /**
+         * Method that calculates \f$x^{exponent}\f$ modulo the 64-bit generator polynomial.
+         *
+         * \param[in] exponent The power of x to be reduced.
+         *
+         * \return Returns the reduced value.
+         */
+        static RunningCrc64 xPowerModP64(unsigned long long exponent);
+
+        /**
+         * Method that calculates \f$a\left(x\right) b\left(x\right)\f$ modulo the 64-bit generator polynomial.
+         *
+         * \param[in] a The first multiplicand.
+         *
+         * \param[in] b The second multiplicand.
+         *
+         * \return Returns the reduced product.
+         */
+        static RunningCrc64 multiplyModP64(RunningCrc64 a, RunningCrc64 b);
+
+        /**
+         * Table used to perform bytewise CRC calculations.
+         */
+        static const std::uint16_t crcTable[256];
+
+        /**
+         * Tables used by the slice-by-N implementations.  Entry [k][v] holds \f$v x^{8 \left(k+2\right)} \bmod
+         * P\left(x\right)\f$.
+         */
+        static std::uint16_t sliceTables[16][256];
+
+        /**
+         * Folding constants used by the carry-less multiply implementation.  The values hold \f$x^{128}\f$,
+         * \f$x^{192}\f$, \f$x^{512}\f$, and \f$x^{576}\f$, modulo \f$P\left(x\right)\f$.
+         */
+        static std::uint64_t foldConstants[4];
+
+        /**
+         * Tables used by the 64-bit CRC.  Entry [k][v] holds \f$v x^{8 \left(k+8\right)}\f$ modulo the 64-bit
+         * generator polynomial.
+         */
+        static std::uint64_t crc64Tables[8][256];
+
+        /**
+         * Folding constants used by the 64-bit carry-less multiply implementation.  The values hold \f$x^{128}\f$,
+         * \f$x^{192}\f$, \f$x^{512}\f$, and \f$x^{576}\f$, modulo the 64-bit generator polynomial.
+         */
+        static std::uint64_t fold64Constants[4];
+
+        /**
+         * Method that initializes the slice tables and folding constants for both CRCs.  Called once, before the first
+         * CRC is calculated.
+         */
+        static void initializeTables();
+};
+
+#endif
@@ -0,0 +1,132 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref DirectoryRecord class.
+***********************************************************************************************************************/
+
+#include <vector>
+
+#include "chunk_header.h"
+#include "stream_chunk.h"
+#include "directory_record.h"
+
+/***********************************************************************************************************************
+ * DirectoryRecord::ChunkLocation
+ */
+
+DirectoryRecord::ChunkLocation::ChunkLocation(
+        ChunkHeader::FileIndex startingIndex,
+        ChunkHeader::FileIndex areaSize,
+        unsigned long long     baseOffset,
+        unsigned               payloadSize,
+        bool                   compressed,
+        ChunkHeader::FileIndex sharedIndex,
+        bool                   inlined
+    ) {
+    currentBaseOffset    = baseOffset;
+    currentStartingIndex = startingIndex;
+    currentAreaSize      = areaSize;
+    currentPayloadSize   = payloadSize | (compressed ? compressedFlag : 0) | (inlined ? inlinedFlag : 0);
+    currentSharedIndex   = sharedIndex;
+}
+
+
+ChunkHeader::FileIndex DirectoryRecord::ChunkLocation::startingIndex() const {
+    return currentStartingIndex;
+}
+
+
+ChunkHeader::FileIndex DirectoryRecord::ChunkLocation::areaSize() const {
+    return currentAreaSize;
+}
+
+
+unsigned long long DirectoryRecord::ChunkLocation::baseOffset() const {
+    return currentBaseOffset;
+}
+
+
+unsigned DirectoryRecord::ChunkLocation::payloadSize() const {
+    return currentPayloadSize & ~(compressedFlag | inlinedFlag);
+}
+
+
+bool DirectoryRecord::ChunkLocation::compressed() const {
+    return (currentPayloadSize & compressedFlag) != 0;
+}
+
+
+ChunkHeader::FileIndex DirectoryRecord::ChunkLocation::sharedIndex() const {
+    return currentSharedIndex;
+}
+
+
+bool DirectoryRecord::ChunkLocation::inlined() const {
+    return (currentPayloadSize & inlinedFlag) != 0;
+}
+
+/***********************************************************************************************************************
+ * DirectoryRecord
+ */
+
+DirectoryRecord::DirectoryRecord(
+        StreamChunk::StreamIdentifier streamIdentifier,
+        ChunkHeader::FileIndex        streamStartIndex
+    ) {
+    currentStreamIdentifier = streamIdentifier;
+    currentStreamStartIndex = streamStartIndex;
+}
+
+
+DirectoryRecord::~DirectoryRecord() {}
+
+
+StreamChunk::StreamIdentifier DirectoryRecord::streamIdentifier() const {
+    return currentStreamIdentifier;
+}
+
+
+ChunkHeader::FileIndex DirectoryRecord::streamStartIndex() const {
+    return currentStreamStartIndex;
+}
+
+
+void DirectoryRecord::addChunkLocation(
+        ChunkHeader::FileIndex startingIndex,
+        ChunkHeader::FileIndex areaSize,
+        unsigned long long     baseOffset,
+        unsigned               payloadSize,
+        bool                   compressed,
+        ChunkHeader::FileIndex sharedIndex,
+        bool                   inlined
+    ) {
+    currentChunkLocations.push_back(
+        ChunkLocation(startingIndex, areaSize, baseOffset, payloadSize, compressed, sharedIndex, inlined)
+    );
+}
+
+
+const DirectoryRecord::ChunkLocations& DirectoryRecord::chunkLocations() const {
+    return currentChunkLocations;
+}
+
+
+void DirectoryRecord::compact() {
+    currentChunkLocations.shrink_to_fit();
+}
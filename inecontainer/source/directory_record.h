@@ -0,0 +1,248 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This header defines the \ref DirectoryRecord class.
+***********************************************************************************************************************/
+
+/* .. sphinx-project inecontainer */
+
+#ifndef DIRECTORY_RECORD_H
+#define DIRECTORY_RECORD_H
+
+#include <vector>
+
+#include "chunk_header.h"
+#include "stream_chunk.h"
+
+/**
+ * Compact record used to track a virtual file found while scanning the container.  Records hold just enough
+ * information to materialise the full virtual file when it is first accessed so that containers with very large
+ * numbers of files do not need a complete virtual file instance per file.
+ */
+class DirectoryRecord {
+    public:
+        /**
+         * Class that tracks the location of a single data chunk belonging to the virtual file.
+         */
+        class ChunkLocation {
+            public:
+                /**
+                 * Constructor.
+                 *
+                 * \param[in] startingIndex The zero based file index where the chunk can be found.
+                 *
+                 * \param[in] areaSize      The size of the chunk in the container, in file index counts.
+                 *
+                 * \param[in] baseOffset    The zero based byte offset into the virtual file tied to the chunk.
+                 *
+                 * \param[in] payloadSize   The size of the chunk's payload, in bytes.
+                 *
+                 * \param[in] compressed    If true, the chunk holds a compressed extent.
+                 *
+                 * \param[in] sharedIndex   The file index of the shared chunk holding the payload or
+                 *                          \ref ChunkHeader::invalidFileIndex if the chunk holds the payload.
+                 *
+                 * \param[in] inlined       If true, the payload is held inline in the stream start chunk.
+                 */
+                ChunkLocation(
+                    ChunkHeader::FileIndex startingIndex,
+                    ChunkHeader::FileIndex areaSize,
+                    unsigned long long     baseOffset,
+                    unsigned               payloadSize,
+                    bool                   compressed,
+                    ChunkHeader::FileIndex sharedIndex,
+                    bool                   inlined
+                );
+
+                /**
+                 * Method that returns the file index of the chunk.
+                 *
+                 * \return Returns the zero based file index of the chunk.
+                 */
+                ChunkHeader::FileIndex startingIndex() const;
+
+                /**
+                 * Method that returns the size of the chunk in the container.
+                 *
+                 * \return Returns the size of the chunk, in file index counts.
+                 */
+                ChunkHeader::FileIndex areaSize() const;
+
+                /**
+                 * Method that returns the byte offset into the virtual file tied to the chunk.
+                 *
+                 * \return Returns the zero based byte offset into the virtual file.
+                 */
+                unsigned long long baseOffset() const;
+
+                /**
+                 * Method that returns the size of the chunk payload.
+                 *
+                 * \return Returns the size of the chunk payload, in bytes.
+                 */
+                unsigned payloadSize() const;
+
+                /**
+                 * Method that indicates if the chunk holds a compressed extent.
+                 *
+                 * \return Returns true if the chunk holds a compressed extent.
+                 */
+                bool compressed() const;
+
+                /**
+                 * Method that returns the file index of the shared chunk holding the payload.
+                 *
+                 * \return Returns the file index of the shared chunk or \ref ChunkHeader::invalidFileIndex if the
+                 *         chunk holds the payload.
+                 */
+                ChunkHeader::FileIndex sharedIndex() const;
+
+                /**
+                 * Method that indicates if the payload is held inline in the stream start chunk.
+                 *
+                 * \return Returns true if the payload is held inline.
+                 */
+                bool inlined() const;
+
+            private:
+                /**
+                 * Bit of the stored payload size used to mark compressed extents.  Payloads never approach 2^31 bytes
+                 * so the flag is packed into the payload size to keep records compact.
+                 */
+                static constexpr unsigned compressedFlag = 0x80000000U;
+
+                /**
+                 * Bit of the stored payload size used to mark payloads held inline in the stream start chunk.
+                 */
+                static constexpr unsigned inlinedFlag = 0x40000000U;
+
+                /**
+                 * The byte offset into the virtual file.
+                 */
+                unsigned long long currentBaseOffset;
+
+                /**
+                 * The file index of the chunk.
+                 */
+                ChunkHeader::FileIndex currentStartingIndex;
+
+                /**
+                 * The size of the chunk, in file index counts.
+                 */
+                ChunkHeader::FileIndex currentAreaSize;
+
+                /**
+                 * The chunk payload size, in bytes, and the compressed extent and inline payload flags.
+                 */
+                unsigned currentPayloadSize;
+
+                /**
+                 * The file index of the shared chunk holding the payload.
+                 */
+                ChunkHeader::FileIndex currentSharedIndex;
+        };
+
+        /**
+         * Type used to hold the list of chunk locations.
+         */
+        typedef std::vector<ChunkLocation> ChunkLocations;
+
+        /**
+         * Constructor.
+         *
+         * \param[in] streamIdentifier The stream identifier of the virtual file.
+         *
+         * \param[in] streamStartIndex The file index of the virtual file's stream start chunk.
+         */
+        DirectoryRecord(StreamChunk::StreamIdentifier streamIdentifier, ChunkHeader::FileIndex streamStartIndex);
+
+        ~DirectoryRecord();
+
+        /**
+         * Method that returns the stream identifier of the virtual file.
+         *
+         * \return Returns the stream identifier.
+         */
+        StreamChunk::StreamIdentifier streamIdentifier() const;
+
+        /**
+         * Method that returns the file index of the stream start chunk.
+         *
+         * \return Returns the file index of the stream start chunk.
+         */
+        ChunkHeader::FileIndex streamStartIndex() const;
+
+        /**
+         * Method that records the location of a data chunk belonging to the virtual file.
+         *
+         * \param[in] startingIndex The zero based file index where the chunk can be found.
+         *
+         * \param[in] areaSize      The size of the chunk in the container, in file index counts.
+         *
+         * \param[in] baseOffset    The zero based byte offset into the virtual file tied to the chunk.
+         *
+         * \param[in] payloadSize   The size of the chunk's payload, in bytes.
+         *
+         * \param[in] compressed    If true, the chunk holds a compressed extent.
+         *
+         * \param[in] sharedIndex   The file index of the shared chunk holding the payload or
+         *                          \ref ChunkHeader::invalidFileIndex if the chunk holds the payload.
+         *
+         * \param[in] inlined       If true, the payload is held inline in the stream start chunk.
+         */
+        void addChunkLocation(
+            ChunkHeader::FileIndex startingIndex,
+            ChunkHeader::FileIndex areaSize,
+            unsigned long long     baseOffset,
+            unsigned               payloadSize,
+            bool                   compressed,
+            ChunkHeader::FileIndex sharedIndex = ChunkHeader::invalidFileIndex,
+            bool                   inlined = false
+        );
+
+        /**
+         * Method that returns the recorded chunk locations, in the order they were found.
+         *
+         * \return Returns a reference to the recorded chunk locations.
+         */
+        const ChunkLocations& chunkLocations() const;
+
+        /**
+         * Method that releases any unused capacity held by the record.  Called once the container scan is complete.
+         */
+        void compact();
+
+    private:
+        /**
+         * The stream identifier.
+         */
+        StreamChunk::StreamIdentifier currentStreamIdentifier;
+
+        /**
+         * The file index of the stream start chunk.
+         */
+        ChunkHeader::FileIndex currentStreamStartIndex;
+
+        /**
+         * The recorded chunk locations.
+         */
+        ChunkLocations currentChunkLocations;
+};
+
+#endif
@@ -29,7 +29,7 @@
 #include "file_header_chunk.h"
 
 FileHeaderChunk::FileHeaderChunk(
-        std::weak_ptr<ContainerImpl> container,
+        ContainerImpl&               container,
         FileIndex                    fileIndex,
         const std::string&           identifier
     ):Chunk(
@@ -55,7 +55,7 @@ FileHeaderChunk::FileHeaderChunk(
 
 
 FileHeaderChunk::FileHeaderChunk(
-        std::weak_ptr<ContainerImpl> container,
+        ContainerImpl&               container,
         FileIndex                    fileIndex,
         std::uint8_t                 commonHeader[Chunk::minimumChunkHeaderSizeBytes]
     ):Chunk(
@@ -78,6 +78,57 @@ std::uint8_t FileHeaderChunk::minorVersion() const {
 }
 
 
+void FileHeaderChunk::setChunkChecksum(Container::Container::ChunkChecksum newChecksum) {
+    std::uint8_t* header = additionalHeader();
+
+    switch (newChecksum) {
+        case Container::Container::ChunkChecksum::CRC16: {
+            header[2] = crc16ChecksumCode;
+            break;
+        }
+
+        case Container::Container::ChunkChecksum::CRC64: {
+            header[2] = crc64ChecksumCode;
+            break;
+        }
+
+        default: {
+            assert(false);
+            break;
+        }
+    }
+}
+
+
+Container::Container::ChunkChecksum FileHeaderChunk::chunkChecksum(bool* ok) const {
+    Container::Container::ChunkChecksum result  = Container::Container::ChunkChecksum::CRC16;
+    bool                                success = true;
+
+    switch (additionalHeader()[2]) {
+        case crc16ChecksumCode: {
+            result = Container::Container::ChunkChecksum::CRC16;
+            break;
+        }
+
+        case crc64ChecksumCode: {
+            result = Container::Container::ChunkChecksum::CRC64;
+            break;
+        }
+
+        default: {
+            success = false;
+            break;
+        }
+    }
+
+    if (ok != nullptr) {
+        *ok = success;
+    }
+
+    return result;
+}
+
+
 std::string FileHeaderChunk::identifier() const {
     unsigned    validBytes = numberValidBytes();
     std::string identifierString;
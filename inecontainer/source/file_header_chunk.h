@@ -45,7 +45,7 @@ class FileHeaderChunk:public Chunk {
          *
          * \param[in] identifier A string used to identify the file type.
          */
-        FileHeaderChunk(std::weak_ptr<ContainerImpl> container, FileIndex fileIndex, const std::string& identifier);
+        FileHeaderChunk(ContainerImpl& container, FileIndex fileIndex, const std::string& identifier);
 
         /**
          * Constructor.
@@ -57,7 +57,7 @@ class FileHeaderChunk:public Chunk {
          * \param[in] commonHeader         Array holding header data common to all chunk types.
          */
         FileHeaderChunk(
-            std::weak_ptr<ContainerImpl> container,
+            ContainerImpl&               container,
             FileIndex                    fileIndex,
             std::uint8_t                 commonHeader[Chunk::minimumChunkHeaderSizeBytes]
         );
@@ -78,6 +78,24 @@ class FileHeaderChunk:public Chunk {
          */
         std::uint8_t minorVersion() const;
 
+        /**
+         * Method that sets the checksum used to protect data chunks in the container.
+         *
+         * \param[in] newChecksum The new data chunk checksum.
+         */
+        void setChunkChecksum(Container::Container::ChunkChecksum newChecksum);
+
+        /**
+         * Method that returns the checksum used to protect data chunks in the container.  The value is only
+         * meaningful for containers with a minor version of 2 or later.
+         *
+         * \param[out] ok An optional pointer to a boolean value that will be set to false if the checksum code is not
+         *                recognized.
+         *
+         * \return Returns the data chunk checksum.
+         */
+        Container::Container::ChunkChecksum chunkChecksum(bool* ok = nullptr) const;
+
         /**
          * Method that returns the identifier string tied to this file header.
          *
@@ -93,6 +111,17 @@ class FileHeaderChunk:public Chunk {
          * \return Returns true if the file header is valid.  Returns false if the file header is invalid.
          */
         bool isValid(const std::string& expectedIdentifier) const;
+
+    private:
+        /**
+         * Code used to indicate that data chunks are protected by the 16-bit chunk CRC.
+         */
+        static constexpr std::uint8_t crc16ChecksumCode = 0;
+
+        /**
+         * Code used to indicate that data chunk payloads are protected by a 64-bit CRC.
+         */
+        static constexpr std::uint8_t crc64ChecksumCode = 1;
 };
 
 #endif
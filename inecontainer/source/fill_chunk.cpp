@@ -28,7 +28,7 @@
 #include "fill_chunk.h"
 
 FillChunk::FillChunk(
-        std::weak_ptr<ContainerImpl> container,
+        ContainerImpl&               container,
         FileIndex                    fileIndex,
         unsigned                     availableSpace
     ):Chunk(
@@ -42,7 +42,7 @@ FillChunk::FillChunk(
 
 
 FillChunk::FillChunk(
-        std::weak_ptr<ContainerImpl> container,
+        ContainerImpl&               container,
         FileIndex                    fileIndex,
         std::uint8_t                 commonHeader[Chunk::minimumChunkHeaderSizeBytes]
     ):Chunk(
@@ -47,7 +47,7 @@ class FillChunk:public Chunk {
          *                           always take up this amount of space, or less with the constraint that a full chunk
          *                           can never take up less than 32-bytes of space.
          */
-        FillChunk(std::weak_ptr<ContainerImpl> container, FileIndex fileIndex, unsigned availableSpace = 0);
+        FillChunk(ContainerImpl& container, FileIndex fileIndex, unsigned availableSpace = 0);
 
         /**
          * Constructor.
@@ -59,7 +59,7 @@ class FillChunk:public Chunk {
          * \param[in] commonHeader Array holding header data common to all chunk types.
          */
         FillChunk(
-            std::weak_ptr<ContainerImpl> container,
+            ContainerImpl&               container,
             FileIndex                    fileIndex,
             std::uint8_t                 commonHeader[Chunk::minimumChunkHeaderSizeBytes]
         );
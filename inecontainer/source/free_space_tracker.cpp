@@ -45,6 +45,8 @@ void FreeSpaceTracker::newFreeSpaceArea(
         ChunkHeader::FileIndex areaSize,
         bool                   fileUpdateNeeded
     ) {
+    areaReleased(ContainerArea(startingIndex, areaSize));
+
     // See if we can merge with the previous region.
 
     ChunkHeader::FileIndex endingIndex            = startingIndex + areaSize;
@@ -192,6 +194,8 @@ FreeSpace FreeSpaceTracker::reserveFreeSpaceArea(
     } else {
         // No usable split.  Add new free space at the end of the file.
 
+        extendingContainer();
+
         allocationStartingIndex = ChunkHeader::toFileIndex(size());
         allocationAreaSize      = desiredChunkSize;
         allocationEndingIndex   = allocationStartingIndex + allocationAreaSize;
@@ -204,6 +208,32 @@ FreeSpace FreeSpaceTracker::reserveFreeSpaceArea(
 }
 
 
+FreeSpace FreeSpaceTracker::reserveLargestFreeSpaceArea(
+        ChunkHeader::FileIndex startingIndex,
+        ChunkHeader::FileIndex areaSize
+    ) {
+    ChunkHeader::FileIndex bestStartingIndex = startingIndex;
+    ChunkHeader::FileIndex bestAreaSize      = 0;
+
+    for (FreeMap::const_iterator it=freeMap.begin(),end=freeMap.end() ; it!=end ; ++it) {
+        if (!it->second.isReserved() && it->second.endingIndex() > startingIndex) {
+            ChunkHeader::FileIndex regionStartingIndex = it->first < startingIndex ? startingIndex : it->first;
+            ChunkHeader::FileIndex regionAreaSize      = it->second.endingIndex() - regionStartingIndex;
+
+            if (regionAreaSize >= areaSize && regionAreaSize > bestAreaSize) {
+                bestStartingIndex = regionStartingIndex;
+                bestAreaSize      = regionAreaSize;
+            }
+        }
+    }
+
+    // The selected region is the first region at or after its starting index that can hold the area.  If no region
+    // was selected, no region can hold the area and it will be placed at the end of the file.
+
+    return reserveFreeSpaceArea(bestStartingIndex, areaSize, areaSize);
+}
+
+
 void FreeSpaceTracker::releaseReservation(const FreeSpace& freeSpaceRegion) {
     assert(freeSpaceRegion.isValid());
 
@@ -306,6 +336,34 @@ bool FreeSpaceTracker::flushFreeSpace(bool flushAll) {
 }
 
 
+void FreeSpaceTracker::extendingContainer() {}
+
+
+void FreeSpaceTracker::areaReleased(const ContainerArea&) {}
+
+
 void FreeSpaceTracker::clearFreeSpace() {
     freeMap.clear();
 }
+
+
+void FreeSpaceTracker::discardFreeSpace(ChunkHeader::FileIndex startingIndex) {
+    FreeMap::iterator it = freeMap.lower_bound(startingIndex);
+
+    if (it != freeMap.begin()) {
+        FreeMap::iterator previous = it;
+        --previous;
+
+        if (!previous->second.isReserved() && previous->second.endingIndex() > startingIndex) {
+            previous->second.setEndingIndex(startingIndex);
+        }
+    }
+
+    while (it != freeMap.end()) {
+        if (it->second.isReserved()) {
+            ++it;
+        } else {
+            it = freeMap.erase(it);
+        }
+    }
+}
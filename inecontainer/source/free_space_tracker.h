@@ -91,6 +91,19 @@ class FreeSpaceTracker {
             ChunkHeader::FileIndex desiredChunkSize = 0
         );
 
+        /**
+         * Method that reserves an area of an exact size from the largest free space region at or after a specified
+         * file index.  If no free space region can hold the area, the area is allocated at the end of the file.
+         *
+         * \param[in] startingIndex The lowest allowed file index.  This method will never return an index less than
+         *                          this value.
+         *
+         * \param[in] areaSize      The required area size in file index values.
+         *
+         * \return Returns an instance of \ref FreeSpace that can be used.
+         */
+        FreeSpace reserveLargestFreeSpaceArea(ChunkHeader::FileIndex startingIndex, ChunkHeader::FileIndex areaSize);
+
         /**
          * Method that releases a reserved free space area.  You must call this method on every free space area you
          * reserve even if that area has been fully consumed.
@@ -150,11 +163,34 @@ class FreeSpaceTracker {
          */
         virtual bool flushArea(const ContainerArea& area) = 0;
 
+        /**
+         * Method that is called before an area is allocated past the end of the container.  You can overload this
+         * method to write out any data held for the end of the container so that the new area is placed after it.
+         * The default implementation does nothing.
+         */
+        virtual void extendingContainer();
+
+        /**
+         * Method that is called when an area is reported as free space.  You can overload this method to discard any
+         * state held for chunks within the area.  The default implementation does nothing.
+         *
+         * \param[in] area The area being released.
+         */
+        virtual void areaReleased(const ContainerArea& area);
+
         /**
          * Method that can be called to clear all the available free space data.
          */
         void clearFreeSpace();
 
+        /**
+         * Method that removes all unreserved free space at or after a file index.  You can use this method before
+         * writing data past the end of the container so that later allocations are not placed over the data.
+         *
+         * \param[in] startingIndex The file index of the first location to remove from the free space map.
+         */
+        void discardFreeSpace(ChunkHeader::FileIndex startingIndex);
+
     private:
         /**
          * Type used to track free space.
@@ -0,0 +1,94 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements the \ref SharedChunkData class.
+***********************************************************************************************************************/
+
+#include <cassert>
+
+#include "chunk_header.h"
+#include "crc_engine.h"
+#include "shared_chunk_data.h"
+
+SharedChunkData::SharedChunkData(
+        CrcEngine::RunningCrc64 hash,
+        ChunkHeader::FileIndex  chunkSize,
+        unsigned                referenceCount
+    ) {
+    currentHash           = hash;
+    currentChunkSize      = chunkSize;
+    currentReferenceCount = referenceCount;
+}
+
+
+SharedChunkData::SharedChunkData(const SharedChunkData& other) {
+    currentHash           = other.currentHash;
+    currentChunkSize      = other.currentChunkSize;
+    currentReferenceCount = other.currentReferenceCount;
+}
+
+
+SharedChunkData::~SharedChunkData() {}
+
+
+void SharedChunkData::setHash(CrcEngine::RunningCrc64 newHash) {
+    currentHash = newHash;
+}
+
+
+CrcEngine::RunningCrc64 SharedChunkData::hash() const {
+    return currentHash;
+}
+
+
+void SharedChunkData::setChunkSize(ChunkHeader::FileIndex newChunkSize) {
+    currentChunkSize = newChunkSize;
+}
+
+
+ChunkHeader::FileIndex SharedChunkData::chunkSize() const {
+    return currentChunkSize;
+}
+
+
+void SharedChunkData::addReference() {
+    ++currentReferenceCount;
+}
+
+
+bool SharedChunkData::removeReference() {
+    assert(currentReferenceCount > 0);
+
+    --currentReferenceCount;
+    return currentReferenceCount > 0;
+}
+
+
+unsigned SharedChunkData::referenceCount() const {
+    return currentReferenceCount;
+}
+
+
+SharedChunkData& SharedChunkData::operator=(const SharedChunkData& other) {
+    currentHash           = other.currentHash;
+    currentChunkSize      = other.currentChunkSize;
+    currentReferenceCount = other.currentReferenceCount;
+
+    return *this;
+}
@@ -0,0 +1,134 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This header defines the \ref SharedChunkData class.
+***********************************************************************************************************************/
+
+/* .. sphinx-project inecontainer */
+
+#ifndef SHARED_CHUNK_DATA_H
+#define SHARED_CHUNK_DATA_H
+
+#include "chunk_header.h"
+#include "crc_engine.h"
+
+/**
+ * Class that is used to track a chunk holding a payload shared by one or more virtual files.
+ */
+class SharedChunkData {
+    public:
+        /**
+         * Constructor.
+         *
+         * \param[in] hash           The content hash of the shared payload.
+         *
+         * \param[in] chunkSize      The size of the shared chunk, in file index units.  A value of 0 indicates that
+         *                           the chunk has been referenced but not yet located.
+         *
+         * \param[in] referenceCount The initial number of references to the chunk.
+         */
+        SharedChunkData(
+            CrcEngine::RunningCrc64 hash = 0,
+            ChunkHeader::FileIndex  chunkSize = 0,
+            unsigned                referenceCount = 0
+        );
+
+        /**
+         * Copy constructor.
+         *
+         * \param[in] other The instance to be copied.
+         */
+        SharedChunkData(const SharedChunkData& other);
+
+        ~SharedChunkData();
+
+        /**
+         * Method that can be used to set the content hash of the shared payload.
+         *
+         * \param[in] newHash The new content hash.
+         */
+        void setHash(CrcEngine::RunningCrc64 newHash);
+
+        /**
+         * Method that can be used to obtain the content hash of the shared payload.
+         *
+         * \return Returns the content hash.
+         */
+        CrcEngine::RunningCrc64 hash() const;
+
+        /**
+         * Method that can be used to set the size of the shared chunk.
+         *
+         * \param[in] newChunkSize The new chunk size, in file index units.
+         */
+        void setChunkSize(ChunkHeader::FileIndex newChunkSize);
+
+        /**
+         * Method that can be used to obtain the size of the shared chunk.
+         *
+         * \return Returns the chunk size, in file index units.
+         */
+        ChunkHeader::FileIndex chunkSize() const;
+
+        /**
+         * Method that adds a reference to the shared chunk.
+         */
+        void addReference();
+
+        /**
+         * Method that removes a reference to the shared chunk.
+         *
+         * \return Returns true if the chunk is still referenced.  Returns false if the last reference was removed.
+         */
+        bool removeReference();
+
+        /**
+         * Method that can be used to obtain the number of references to the shared chunk.
+         *
+         * \return Returns the current reference count.
+         */
+        unsigned referenceCount() const;
+
+        /**
+         * Assignment operator.
+         *
+         * \param[in] other The instance to be copied.
+         *
+         * \return A reference to this class instance.
+         */
+        SharedChunkData& operator=(const SharedChunkData& other);
+
+    private:
+        /**
+         * The content hash of the shared payload.
+         */
+        CrcEngine::RunningCrc64 currentHash;
+
+        /**
+         * The chunk size, in file index units.
+         */
+        ChunkHeader::FileIndex currentChunkSize;
+
+        /**
+         * The number of references to the chunk.
+         */
+        unsigned currentReferenceCount;
+};
+
+#endif
@@ -29,7 +29,7 @@
 #include "stream_chunk.h"
 
 StreamChunk::StreamChunk(
-        std::weak_ptr<ContainerImpl> container,
+        ContainerImpl&               container,
         FileIndex                    fileIndex,
         StreamIdentifier             streamIdentifier,
         unsigned                     additionalChunkHeaderSizeBytes
@@ -44,7 +44,7 @@ StreamChunk::StreamChunk(
 
 
 StreamChunk::StreamChunk(
-        std::weak_ptr<ContainerImpl> container,
+        ContainerImpl&               container,
         FileIndex                    fileIndex,
         std::uint8_t                 commonHeader[Chunk::minimumChunkHeaderSizeBytes],
         unsigned                     additionalChunkHeaderSizeBytes
@@ -47,6 +47,12 @@ class StreamChunk:public Chunk {
          */
         static constexpr StreamIdentifier invalidStreamIdentifier = static_cast<StreamIdentifier>(-1);
 
+        /**
+         * Value reserved for data chunks that hold payloads shared by multiple virtual files.  Shared chunks do not
+         * belong to any stream and are only recognized by containers supporting shared chunks.
+         */
+        static constexpr StreamIdentifier sharedStreamIdentifier = 0x7FFFFFFFUL;
+
     protected:
         /**
          * Constructor.
@@ -61,7 +67,7 @@ class StreamChunk:public Chunk {
          *                                           into account space used for the stream identifier and EOF flag.
          */
         StreamChunk(
-            std::weak_ptr<ContainerImpl> container,
+            ContainerImpl&               container,
             FileIndex                    fileIndex,
             StreamIdentifier             streamIdentifier,
             unsigned                     additionalChunkHeaderSizeBytes
@@ -80,7 +86,7 @@ class StreamChunk:public Chunk {
          *                                           into account space used for the stream identifier and EOF flag.
          */
         StreamChunk(
-            std::weak_ptr<ContainerImpl> container,
+            ContainerImpl&               container,
             FileIndex                    fileIndex,
             std::uint8_t                 commonHeader[Chunk::minimumChunkHeaderSizeBytes],
             unsigned                     additionalChunkHeaderSizeBytes
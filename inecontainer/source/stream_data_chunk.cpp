@@ -27,12 +27,13 @@
 
 #include "container_status.h"
 #include "container_impl.h"
+#include "crc_engine.h"
 #include "scatter_gather_list_segment.h"
 #include "stream_chunk.h"
 #include "stream_data_chunk.h"
 
 StreamDataChunk::StreamDataChunk(
-        std::weak_ptr<ContainerImpl> container,
+        ContainerImpl&               container,
         FileIndex                    fileIndex,
         StreamIdentifier             streamIdentifier,
         unsigned long long           chunkOffset
@@ -40,8 +41,10 @@ StreamDataChunk::StreamDataChunk(
         container,
         fileIndex,
         streamIdentifier,
-        numberAdditionalStreamHeaderBytes
+        numberAdditionalHeaderBytes(container)
     ) {
+    payloadChecksumPresent = numberAdditionalHeaderBytes(container) != numberAdditionalStreamHeaderBytes;
+
     setType(ChunkHeader::Type::STREAM_DATA_CHUNK);
     setChunkOffset(chunkOffset);
     clearScatterGatherList();
@@ -49,15 +52,16 @@ StreamDataChunk::StreamDataChunk(
 
 
 StreamDataChunk::StreamDataChunk(
-        std::weak_ptr<ContainerImpl> container,
+        ContainerImpl&               container,
         FileIndex                    fileIndex,
         std::uint8_t                 commonHeader[Chunk::minimumChunkHeaderSizeBytes]
     ):StreamChunk(
         container,
         fileIndex,
         commonHeader,
-        numberAdditionalStreamHeaderBytes
+        numberAdditionalHeaderBytes(container)
     ) {
+    payloadChecksumPresent = numberAdditionalHeaderBytes(container) != numberAdditionalStreamHeaderBytes;
     clearScatterGatherList();
 }
 
@@ -66,7 +70,44 @@ StreamDataChunk::~StreamDataChunk() {}
 
 
 unsigned StreamDataChunk::setChunkSize(unsigned newChunkSize) {
-    return setBestFitSize(newChunkSize);
+    return setBestFitSize(newChunkSize, true);
+}
+
+
+unsigned StreamDataChunk::preferredChunkSize(unsigned long long pendingPayloadBytes, bool allowExtended) {
+    unsigned result = ChunkHeader::maximumChunkSize;
+
+    if (allowExtended) {
+        while (result < ChunkHeader::maximumExtendedChunkSize && 2ULL * result <= pendingPayloadBytes) {
+            result *= 2;
+        }
+    }
+
+    return result;
+}
+
+
+unsigned StreamDataChunk::payloadCapacity(ContainerImpl& container, unsigned chunkSize) {
+    unsigned headerSize =   ChunkHeader::minimumChunkHeaderSizeBytes
+                          + StreamChunk::numberAdditionalStreamHeaderBytes
+                          + numberAdditionalHeaderBytes(container);
+
+    if (chunkSize > ChunkHeader::maximumChunkSize) {
+        headerSize += ChunkHeader::extendedChunkHeaderSizeBytes;
+    }
+
+    return chunkSize - headerSize;
+}
+
+
+unsigned StreamDataChunk::chunkSizeForPayload(ContainerImpl& container, unsigned payloadBytes) {
+    unsigned result = ChunkHeader::minimumChunkSize;
+
+    while (result < ChunkHeader::maximumExtendedChunkSize && payloadCapacity(container, result) < payloadBytes) {
+        result *= 2;
+    }
+
+    return result;
 }
 
 
@@ -98,28 +139,120 @@ unsigned long long StreamDataChunk::chunkOffset() const {
 }
 
 
+void StreamDataChunk::setCompressedExtent(bool nowCompressed) {
+    setLast(nowCompressed);
+}
+
+
+bool StreamDataChunk::isCompressedExtent() const {
+    return isLast();
+}
+
+
+void StreamDataChunk::encodeSharedReference(
+        std::uint8_t*          payload,
+        unsigned               extentSize,
+        ChunkHeader::FileIndex sharedIndex
+    ) {
+    std::uint32_t blockHeader = static_cast<std::uint32_t>(extentSize) | sharedReferenceFlag;
+
+    payload[0] = static_cast<std::uint8_t>(blockHeader      );
+    payload[1] = static_cast<std::uint8_t>(blockHeader >>  8);
+    payload[2] = static_cast<std::uint8_t>(blockHeader >> 16);
+    payload[3] = static_cast<std::uint8_t>(blockHeader >> 24);
+    payload[4] = static_cast<std::uint8_t>(sharedIndex      );
+    payload[5] = static_cast<std::uint8_t>(sharedIndex >>  8);
+    payload[6] = static_cast<std::uint8_t>(sharedIndex >> 16);
+    payload[7] = static_cast<std::uint8_t>(sharedIndex >> 24);
+}
+
+
+bool StreamDataChunk::decodeSharedReference(
+        const std::uint8_t*     payload,
+        unsigned                payloadLength,
+        unsigned*               extentSize,
+        ChunkHeader::FileIndex* sharedIndex
+    ) {
+    bool isReference = false;
+
+    if (payloadLength == sharedReferenceSizeBytes) {
+        std::uint32_t blockHeader = (
+              static_cast<std::uint32_t>(payload[0])
+            | (static_cast<std::uint32_t>(payload[1]) <<  8)
+            | (static_cast<std::uint32_t>(payload[2]) << 16)
+            | (static_cast<std::uint32_t>(payload[3]) << 24)
+        );
+
+        if ((blockHeader & sharedReferenceFlag) != 0) {
+            isReference  = true;
+            *extentSize  = static_cast<unsigned>(blockHeader & ~sharedReferenceFlag);
+            *sharedIndex = (
+                  static_cast<ChunkHeader::FileIndex>(payload[4])
+                | (static_cast<ChunkHeader::FileIndex>(payload[5]) <<  8)
+                | (static_cast<ChunkHeader::FileIndex>(payload[6]) << 16)
+                | (static_cast<ChunkHeader::FileIndex>(payload[7]) << 24)
+            );
+        }
+    }
+
+    return isReference;
+}
+
+
 unsigned StreamDataChunk::payloadSize() const {
     return numberValidBytes() - ChunkHeader::additionalHeaderSizeBytes();
 }
 
 
+unsigned long long StreamDataChunk::payloadPosition() const {
+    return toPosition(fileIndex()) + fullHeaderSizeBytes();
+}
+
+
+bool StreamDataChunk::hasPayloadChecksum() const {
+    return payloadChecksumPresent;
+}
+
+
+CrcEngine::RunningCrc64 StreamDataChunk::payloadChecksum() const {
+    CrcEngine::RunningCrc64 checksum = 0;
+
+    if (payloadChecksumPresent) {
+        const std::uint8_t* header = StreamChunk::additionalHeader() + numberAdditionalStreamHeaderBytes;
+
+        for (unsigned i=0 ; i<payloadChecksumSizeBytes ; ++i) {
+            checksum |= static_cast<CrcEngine::RunningCrc64>(header[i]) << (8 * i);
+        }
+    }
+
+    return checksum;
+}
+
+
 void StreamDataChunk::clearScatterGatherList() {
-    scatterGatherList.clear();
+    currentScatterGatherListSize      = 0;
     currentScatterGatherListByteCount = 0;
+    leadingPayloadCrc                 = 0;
+    leadingPayloadCrcLength           = 0;
 }
 
 
 unsigned StreamDataChunk::addScatterGatherListSegment(const ScatterGatherListSegment& newSegment) {
-    scatterGatherList.push_back(newSegment);
+    unsigned expectedBytesProcessed = 0;
 
-    unsigned availableSpace         = additionalAvailableSpace();
-    unsigned bytesRemainingInChunk  =   availableSpace > currentScatterGatherListByteCount
-                                      ? availableSpace - currentScatterGatherListByteCount
-                                      : 0;
-    unsigned segmentLength          = newSegment.length();
-    unsigned expectedBytesProcessed = segmentLength < bytesRemainingInChunk ? segmentLength : bytesRemainingInChunk;
+    if (currentScatterGatherListSize < maximumScatterGatherListSize) {
+        scatterGatherList[currentScatterGatherListSize] = newSegment;
+        ++currentScatterGatherListSize;
 
-    currentScatterGatherListByteCount += segmentLength;
+        unsigned availableSpace        = additionalAvailableSpace();
+        unsigned bytesRemainingInChunk =   availableSpace > currentScatterGatherListByteCount
+                                         ? availableSpace - currentScatterGatherListByteCount
+                                         : 0;
+        unsigned segmentLength         = newSegment.length();
+
+        expectedBytesProcessed = segmentLength < bytesRemainingInChunk ? segmentLength : bytesRemainingInChunk;
+        currentScatterGatherListByteCount += segmentLength;
+    }
 
     return expectedBytesProcessed;
 }
@@ -130,22 +263,91 @@ unsigned StreamDataChunk::addScatterGatherListSegment(uint8_t* buffer, unsigned
 }
 
 
+void StreamDataChunk::setLeadingPayloadCrc(ChunkHeader::RunningCrc crc, unsigned length) {
+    leadingPayloadCrc       = crc;
+    leadingPayloadCrcLength = length;
+}
+
+
 unsigned StreamDataChunk::scatterGatherListSize() const {
-    return static_cast<unsigned>(scatterGatherList.size());
+    return currentScatterGatherListSize;
 }
 
 
 ScatterGatherListSegment StreamDataChunk::scatterGatherListSegment(unsigned index) const {
     ScatterGatherListSegment segment;
 
-    if (index < scatterGatherList.size()) {
-        segment = scatterGatherList.at(index);
+    if (index < currentScatterGatherListSize) {
+        segment = scatterGatherList[index];
     }
 
     return segment;
 }
 
 
+unsigned StreamDataChunk::numberAdditionalHeaderBytes(ContainerImpl& container) {
+    unsigned result = numberAdditionalStreamHeaderBytes;
+
+    if (container.usesPayloadChecksums()) {
+        result += payloadChecksumSizeBytes;
+    }
+
+    return result;
+}
+
+
+unsigned StreamDataChunk::preparePayload() {
+    unsigned payloadBytes = additionalAvailableSpace();
+
+    if (currentScatterGatherListByteCount < payloadBytes) {
+        payloadBytes = currentScatterGatherListByteCount;
+    }
+
+    // TODO: Clean-up the statement below.  We're reaching down into some of the gory details of the base class.  We
+    //       can also probably simplify the setNumberValidBytes method.  Note that the chunk size may shrink
+    //       Assert was included to verify that the things are actually working as expected.
+
+    unsigned actualPayload = ChunkHeader::setNumberValidBytes(payloadBytes + ChunkHeader::additionalHeaderSizeBytes());
+    (void) actualPayload;
+    assert(actualPayload == payloadBytes + ChunkHeader::additionalHeaderSizeBytes());
+
+    return payloadBytes;
+}
+
+
+void StreamDataChunk::setPayloadChecksum(CrcEngine::RunningCrc64 newChecksum) {
+    assert(payloadChecksumPresent);
+
+    std::uint8_t* header = StreamChunk::additionalHeader() + numberAdditionalStreamHeaderBytes;
+
+    for (unsigned i=0 ; i<payloadChecksumSizeBytes ; ++i) {
+        header[i] = static_cast<std::uint8_t>(newChecksum >> (8 * i));
+    }
+}
+
+
+CrcEngine::RunningCrc64 StreamDataChunk::calculatePayloadChecksum() const {
+    CrcEngine::RunningCrc64 checksum = 0;
+
+    unsigned                        payloadBytesRemaining = payloadSize();
+    const ScatterGatherListSegment* it                    = scatterGatherList;
+    const ScatterGatherListSegment* end                   = scatterGatherList + currentScatterGatherListSize;
+
+    while (payloadBytesRemaining > 0 && it != end) {
+        unsigned      segmentLength  = it->length();
+        std::uint8_t* segmentBase    = it->base();
+        unsigned      bytesToProcess = segmentLength < payloadBytesRemaining ? segmentLength : payloadBytesRemaining;
+
+        checksum = CrcEngine::calculate64(checksum, segmentBase, bytesToProcess);
+
+        payloadBytesRemaining -= bytesToProcess;
+        ++it;
+    }
+
+    return checksum;
+}
+
+
 Container::Status StreamDataChunk::loadHeader(bool includeCommonHeader) {
     return StreamChunk::load(includeCommonHeader);
 }
@@ -155,17 +357,17 @@ Container::Status StreamDataChunk::load(bool includeCommonHeader) {
     Container::Status status = loadHeader(includeCommonHeader);
 
     unsigned payloadBytesRemaining = payloadSize();
-    std::vector<ScatterGatherListSegment>::iterator it  = scatterGatherList.begin();
-    std::vector<ScatterGatherListSegment>::iterator end = scatterGatherList.end();
+    ScatterGatherListSegment* it  = scatterGatherList;
+    ScatterGatherListSegment* end = scatterGatherList + currentScatterGatherListSize;
 
-    std::shared_ptr<ContainerImpl> cont = container().lock();
+    ContainerImpl& cont = container();
 
     while (!status && payloadBytesRemaining > 0 && it != end) {
         unsigned      segmentLength = it->length();
         std::uint8_t* segmentBase   = it->base();
         unsigned      bytesToRead   = segmentLength < payloadBytesRemaining ? segmentLength : payloadBytesRemaining;
 
-        status = cont->read(segmentBase, bytesToRead);
+        status = cont.read(segmentBase, bytesToRead);
         if (status.success() && Container::ReadSuccessful(status).bytesRead() == bytesToRead) {
             status = Container::NoStatus();
             it->setProcessedCount(bytesToRead);
@@ -180,36 +382,22 @@ Container::Status StreamDataChunk::load(bool includeCommonHeader) {
 
 
 Container::Status StreamDataChunk::save(bool padToChunkSize) {
-    unsigned payloadBytesRemaining = additionalAvailableSpace();
-
-    if (currentScatterGatherListByteCount < payloadBytesRemaining) {
-        payloadBytesRemaining = currentScatterGatherListByteCount;
-    }
-
-    // TODO: Clean-up the statement below.  We're reaching down into some of the gory details of the base class.  We
-    //       can also probably simplify the setNumberValidBytes method.  Note that the chunk size may shrink
-    //       Assert was included to verify that the things are actually working as expected.
-
-    unsigned actualPayload = ChunkHeader::setNumberValidBytes(
-        payloadBytesRemaining + ChunkHeader::additionalHeaderSizeBytes()
-    );
-    (void) actualPayload;
-    assert(actualPayload == payloadBytesRemaining + ChunkHeader::additionalHeaderSizeBytes());
+    unsigned payloadBytesRemaining = preparePayload();
 
     // Use the base class function to set the container pointer, calculate the CRC, and write the header data.
     Container::Status status = Chunk::save(false);
 
-    std::shared_ptr<ContainerImpl> cont = container().lock();
+    ContainerImpl& cont = container();
 
-    std::vector<ScatterGatherListSegment>::iterator it  = scatterGatherList.begin();
-    std::vector<ScatterGatherListSegment>::iterator end = scatterGatherList.end();
+    ScatterGatherListSegment* it  = scatterGatherList;
+    ScatterGatherListSegment* end = scatterGatherList + currentScatterGatherListSize;
 
     while (!status && payloadBytesRemaining > 0 && it != end) {
         unsigned      segmentLength = it->length();
         std::uint8_t* segmentBase   = it->base();
         unsigned      bytesToWrite  = segmentLength < payloadBytesRemaining ? segmentLength : payloadBytesRemaining;
 
-        status = cont->write(segmentBase, bytesToWrite);
+        status = cont.write(segmentBase, bytesToWrite);
         if (status.success() && Container::WriteSuccessful(status).bytesWritten() == bytesToWrite) {
             status = Container::NoStatus();
             it->setProcessedCount(bytesToWrite);
@@ -227,45 +415,181 @@ Container::Status StreamDataChunk::save(bool padToChunkSize) {
 }
 
 
-bool StreamDataChunk::checkCrc() const {
-    ChunkHeader::RunningCrc currentCrc = initializeCrc();
+unsigned StreamDataChunk::render(std::uint8_t* buffer) {
+    unsigned payloadBytesRemaining = preparePayload();
 
-    unsigned                                              payloadBytesRemaining = additionalAvailableSpace();
-    std::vector<ScatterGatherListSegment>::const_iterator it                    = scatterGatherList.cbegin();
-    std::vector<ScatterGatherListSegment>::const_iterator end                   = scatterGatherList.cend();
+    updateCrc();
+
+    unsigned headerSize = fullHeaderSizeBytes();
+    unsigned totalSize  = chunkSize();
+
+    std::memcpy(buffer, fullHeader(), headerSize);
+
+    std::uint8_t*             destination = buffer + headerSize;
+    ScatterGatherListSegment* it          = scatterGatherList;
+    ScatterGatherListSegment* end         = scatterGatherList + currentScatterGatherListSize;
 
     while (payloadBytesRemaining > 0 && it != end) {
-        unsigned      segmentLength  = it->length();
-        std::uint8_t* segmentBase    = it->base();
-        unsigned      bytesToProcess = segmentLength < payloadBytesRemaining ? segmentLength : payloadBytesRemaining;
+        unsigned segmentLength = it->length();
+        unsigned bytesToCopy   = segmentLength < payloadBytesRemaining ? segmentLength : payloadBytesRemaining;
 
-        currentCrc = calculateCrc(currentCrc, segmentBase, bytesToProcess);
+        std::memcpy(destination, it->base(), bytesToCopy);
+        it->setProcessedCount(bytesToCopy);
 
-        payloadBytesRemaining -= bytesToProcess;
+        destination           += bytesToCopy;
+        payloadBytesRemaining -= bytesToCopy;
         ++it;
     }
 
-    return currentCrc == crc();
+    std::memset(destination, 0, static_cast<unsigned>(buffer + totalSize - destination));
+
+    return totalSize;
 }
 
 
-void StreamDataChunk::updateCrc() {
-    ChunkHeader::RunningCrc currentCrc = initializeCrc();
+Container::Status StreamDataChunk::patchPayload(
+        unsigned            offset,
+        const std::uint8_t* oldData,
+        const std::uint8_t* newData,
+        unsigned            count
+    ) {
+    assert(offset + count <= payloadSize());
 
-    unsigned                                              payloadBytesRemaining = additionalAvailableSpace();
-    std::vector<ScatterGatherListSegment>::const_iterator it                    = scatterGatherList.cbegin();
-    std::vector<ScatterGatherListSegment>::const_iterator end                   = scatterGatherList.cend();
+    // Old and new payloads of equal length differ in CRC by the CRC of their XOR, taken with an initial value of 0,
+    // and then advanced over the unchanged bytes that follow.
 
-    while (payloadBytesRemaining > 0 && it != end) {
-        unsigned      segmentLength  = it->length();
-        std::uint8_t* segmentBase    = it->base();
-        unsigned      bytesToProcess = segmentLength < payloadBytesRemaining ? segmentLength : payloadBytesRemaining;
+    unsigned trailingLength = payloadSize() - offset - count;
 
-        currentCrc = calculateCrc(currentCrc, segmentBase, bytesToProcess);
+    ChunkHeader::RunningCrc deltaCrc   = 0;
+    CrcEngine::RunningCrc64 deltaCrc64 = 0;
+    std::uint8_t            delta[patchBlockSizeBytes];
 
-        payloadBytesRemaining -= bytesToProcess;
-        ++it;
+    unsigned bytesRemaining = count;
+    unsigned index          = 0;
+    while (bytesRemaining > 0) {
+        unsigned blockSize = bytesRemaining < patchBlockSizeBytes ? bytesRemaining : patchBlockSizeBytes;
+
+        for (unsigned i=0 ; i<blockSize ; ++i) {
+            delta[i] = oldData[index + i] ^ newData[index + i];
+        }
+
+        if (payloadChecksumPresent) {
+            deltaCrc64 = CrcEngine::calculate64(deltaCrc64, delta, blockSize);
+        } else {
+            deltaCrc = calculateCrc(deltaCrc, delta, blockSize);
+        }
+
+        index          += blockSize;
+        bytesRemaining -= blockSize;
     }
 
-    setCrc(currentCrc);
+    if (payloadChecksumPresent) {
+        setPayloadChecksum(payloadChecksum() ^ CrcEngine::combine64(deltaCrc64, 0, trailingLength));
+        setCrc(initializeCrc());
+    } else {
+        setCrc(crc() ^ CrcEngine::combine(deltaCrc, 0, trailingLength));
+    }
+
+    ContainerImpl& cont = container();
+    cont.forgetVerifiedChunks(fileIndex());
+
+    Container::Status status = cont.setPosition(payloadPosition() + offset);
+
+    if (!status) {
+        status = cont.write(newData, count);
+        if (status.success() && Container::WriteSuccessful(status).bytesWritten() == count) {
+            status = Container::NoStatus();
+        }
+    }
+
+    if (!status) {
+        status = cont.setPosition(toPosition(fileIndex()));
+    }
+
+    if (!status) {
+        status = cont.write(fullHeader(), fullHeaderSizeBytes());
+        if (status.success() && Container::WriteSuccessful(status).bytesWritten() == fullHeaderSizeBytes()) {
+            status = Container::NoStatus();
+        }
+    }
+
+    return status;
+}
+
+
+bool StreamDataChunk::checkCrc() const {
+    bool result;
+
+    if (payloadChecksumPresent) {
+        result = initializeCrc() == crc() && calculatePayloadChecksum() == payloadChecksum();
+    } else {
+        ChunkHeader::RunningCrc currentCrc = initializeCrc();
+
+        unsigned                        payloadBytesRemaining = payloadSize();
+        const ScatterGatherListSegment* it                    = scatterGatherList;
+        const ScatterGatherListSegment* end                   = scatterGatherList + currentScatterGatherListSize;
+
+        while (payloadBytesRemaining > 0 && it != end) {
+            unsigned      segmentLength  = it->length();
+            std::uint8_t* segmentBase    = it->base();
+            unsigned      bytesToProcess =   segmentLength < payloadBytesRemaining
+                                           ? segmentLength
+                                           : payloadBytesRemaining;
+
+            currentCrc = calculateCrc(currentCrc, segmentBase, bytesToProcess);
+
+            payloadBytesRemaining -= bytesToProcess;
+            ++it;
+        }
+
+        result = currentCrc == crc();
+    }
+
+    return result;
+}
+
+
+void StreamDataChunk::updateCrc() {
+    if (payloadChecksumPresent) {
+        // The payload checksum is held in the header so it must be set before the header CRC is calculated.
+        setPayloadChecksum(calculatePayloadChecksum());
+        setCrc(initializeCrc());
+    } else {
+        ChunkHeader::RunningCrc currentCrc = initializeCrc();
+
+        unsigned                        payloadBytesRemaining = additionalAvailableSpace();
+        const ScatterGatherListSegment* it                    = scatterGatherList;
+        const ScatterGatherListSegment* end                   = scatterGatherList + currentScatterGatherListSize;
+        unsigned                        bytesToSkip           = 0;
+
+        if (leadingPayloadCrcLength > 0                                  &&
+            leadingPayloadCrcLength <= payloadBytesRemaining             &&
+            leadingPayloadCrcLength <= currentScatterGatherListByteCount    ) {
+            currentCrc             = CrcEngine::combine(currentCrc, leadingPayloadCrc, leadingPayloadCrcLength);
+            bytesToSkip            = leadingPayloadCrcLength;
+            payloadBytesRemaining -= leadingPayloadCrcLength;
+        }
+
+        while (payloadBytesRemaining > 0 && it != end) {
+            unsigned      segmentLength  = it->length();
+            std::uint8_t* segmentBase    = it->base();
+
+            if (bytesToSkip >= segmentLength) {
+                bytesToSkip -= segmentLength;
+            } else {
+                segmentLength -= bytesToSkip;
+                segmentBase   += bytesToSkip;
+                bytesToSkip    = 0;
+
+                unsigned bytesToProcess = segmentLength < payloadBytesRemaining ? segmentLength : payloadBytesRemaining;
+                currentCrc = calculateCrc(currentCrc, segmentBase, bytesToProcess);
+
+                payloadBytesRemaining -= bytesToProcess;
+            }
+
+            ++it;
+        }
+
+        setCrc(currentCrc);
+    }
 }
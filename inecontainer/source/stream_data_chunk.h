@@ -26,8 +26,8 @@
 #define STREAM_DATA_CHUNK_H
 
 #include <cstdint>
-#include <vector>
 
+#include "crc_engine.h"
 #include "scatter_gather_list_segment.h"
 #include "stream_chunk.h"
 
@@ -41,6 +41,17 @@ class StreamDataChunk:public StreamChunk {
          */
         typedef unsigned long long ChunkOffset;
 
+        /**
+         * The maximum number of entries in the scatter-gather list.  Virtual files build chunks from, at most, the two
+         * halves of a ring buffer and a caller supplied buffer.
+         */
+        static constexpr unsigned maximumScatterGatherListSize = 8;
+
+        /**
+         * The size of a shared extent reference, in bytes.
+         */
+        static constexpr unsigned sharedReferenceSizeBytes = 8;
+
         /**
          * Constructor.
          *
@@ -54,7 +65,7 @@ class StreamDataChunk:public StreamChunk {
          *                             this chunk.
          */
         StreamDataChunk(
-            std::weak_ptr<ContainerImpl> container,
+            ContainerImpl&               container,
             FileIndex                    fileIndex,
             StreamIdentifier             streamIdentifier,
             unsigned long long           chunkOffset
@@ -70,7 +81,7 @@ class StreamDataChunk:public StreamChunk {
          * \param[in] commonHeader Array holding header data common to all chunk types.
          */
         StreamDataChunk(
-            std::weak_ptr<ContainerImpl> container,
+            ContainerImpl&               container,
             FileIndex                    fileIndex,
             std::uint8_t                 commonHeader[Chunk::minimumChunkHeaderSizeBytes]
         );
@@ -83,10 +94,47 @@ class StreamDataChunk:public StreamChunk {
          *
          * \param[in] newChunkSize The new chunk size, in bytes.
          *
-         * \return Returns the actual chunk size which will be equal to or less then the provided chunk size.
+         * \return Returns the actual chunk size which will be equal to or less then the provided chunk size.  Values
+         *         above \ref ChunkHeader::maximumChunkSize will cause an extended chunk to be used.
          */
         unsigned setChunkSize(unsigned newChunkSize);
 
+        /**
+         * Method that determines the preferred chunk size for a given amount of pending payload data.  The value will
+         * always be a power of two and will be sized so that the chunk can be completely filled.
+         *
+         * \param[in] pendingPayloadBytes The number of bytes waiting to be written.
+         *
+         * \param[in] allowExtended       If true, extended chunks can be used.  If false, the returned value will be
+         *                                \ref ChunkHeader::maximumChunkSize.
+         *
+         * \return Returns the preferred chunk size, in bytes.
+         */
+        static unsigned preferredChunkSize(unsigned long long pendingPayloadBytes, bool allowExtended);
+
+        /**
+         * Method that determines the number of payload bytes a data chunk of a given size can hold.
+         *
+         * \param[in] container The container that will hold the chunk.
+         *
+         * \param[in] chunkSize The chunk size, in bytes.  The value must be a power of two.
+         *
+         * \return Returns the payload capacity, in bytes.
+         */
+        static unsigned payloadCapacity(ContainerImpl& container, unsigned chunkSize);
+
+        /**
+         * Method that determines the smallest chunk size that can hold a given payload.
+         *
+         * \param[in] container    The container that will hold the chunk.
+         *
+         * \param[in] payloadBytes The number of payload bytes.
+         *
+         * \return Returns the required chunk size, in bytes.  Values above \ref ChunkHeader::maximumChunkSize
+         *         require an extended chunk.
+         */
+        static unsigned chunkSizeForPayload(ContainerImpl& container, unsigned payloadBytes);
+
         /**
          * Method that can be used to set the bytes offset of the first byte of this chunk in the stream.
          *
@@ -103,6 +151,61 @@ class StreamDataChunk:public StreamChunk {
          */
         ChunkOffset chunkOffset() const;
 
+        /**
+         * Method that marks this chunk as holding a compressed extent.  The payload of a compressed extent is a
+         * \ref CompressionEngine block and the chunk offset is the offset of the first uncompressed byte.  The flag is
+         * held in the stream EOF bit which is otherwise unused by data chunks.
+         *
+         * \param[in] nowCompressed If true, the chunk holds a compressed extent.
+         */
+        void setCompressedExtent(bool nowCompressed);
+
+        /**
+         * Method that indicates if this chunk holds a compressed extent.
+         *
+         * \return Returns true if the chunk holds a compressed extent.
+         */
+        bool isCompressedExtent() const;
+
+        /**
+         * Method that builds the payload of a shared extent reference.  A shared extent reference is a compressed
+         * extent whose block header has bit 31 set.  The remaining bits hold the extent size and the following 4 bytes
+         * hold the file index of the shared chunk holding the extent.
+         *
+         * \param[out] payload     Buffer to receive the reference.  The buffer must hold at least
+         *                         \ref StreamDataChunk::sharedReferenceSizeBytes bytes.
+         *
+         * \param[in]  extentSize  The size of the referenced extent, in bytes.
+         *
+         * \param[in]  sharedIndex The file index of the shared chunk.
+         */
+        static void encodeSharedReference(
+            std::uint8_t*          payload,
+            unsigned               extentSize,
+            ChunkHeader::FileIndex sharedIndex
+        );
+
+        /**
+         * Method that decodes the payload of a shared extent reference.
+         *
+         * \param[in]  payload       The compressed extent payload.
+         *
+         * \param[in]  payloadLength The length of the payload, in bytes.
+         *
+         * \param[out] extentSize    Location to receive the size of the referenced extent, in bytes.
+         *
+         * \param[out] sharedIndex   Location to receive the file index of the shared chunk.
+         *
+         * \return Returns true if the payload holds a shared extent reference.  Returns false if the payload holds a
+         *         compressed block.
+         */
+        static bool decodeSharedReference(
+            const std::uint8_t*     payload,
+            unsigned                payloadLength,
+            unsigned*               extentSize,
+            ChunkHeader::FileIndex* sharedIndex
+        );
+
         /**
          * Method that indicates the payload size for this chunk.
          *
@@ -110,23 +213,63 @@ class StreamDataChunk:public StreamChunk {
          */
         unsigned payloadSize() const;
 
+        /**
+         * Method that returns the position of the first payload byte in the container.  The chunk header must be
+         * loaded before calling this method.
+         *
+         * \return Returns the byte offset of the payload from the start of the container.
+         */
+        unsigned long long payloadPosition() const;
+
+        /**
+         * Method that indicates if this chunk carries a 64-bit payload checksum.  Payload checksums are used when the
+         * container was created with \ref Container::Container::ChunkChecksum::CRC64.
+         *
+         * \return Returns true if the chunk carries a 64-bit payload checksum.
+         */
+        bool hasPayloadChecksum() const;
+
+        /**
+         * Method that returns the 64-bit payload checksum stored in the chunk header.
+         *
+         * \return Returns the payload checksum.  The value is meaningless if the chunk does not carry a payload
+         *         checksum.
+         */
+        CrcEngine::RunningCrc64 payloadChecksum() const;
+
         /**
          * Method that clears the scatter-gather list used to track where payload data should be loaded/stored from/to.
          */
         void clearScatterGatherList();
 
         /**
-         * Method that appends an entry to the scatter-gather list.
+         * Method that appends an entry to the scatter-gather list.  The list can hold up to
+         * \ref StreamDataChunk::maximumScatterGatherListSize entries.  Segments added to a full list are refused.
          *
          * \param[in] newSegment       The segment to be added.
          *
          * \return Returns the number of bytes of this segment that are expected to be written based on the current
          *         chunk size.  The value also represents the expected amount read if the chunk is fully populated.
+         *         A value of 0 is returned if the segment was refused.
          */
         unsigned addScatterGatherListSegment(const ScatterGatherListSegment& newSegment);
 
         /**
-         * Convenience method that appends an entry to the scatter-gather list.
+         * Method that provides a precalculated CRC for the start of the payload.  The value lets callers that have
+         * already calculated a CRC while staging the data avoid a second pass over that data when the chunk is saved.
+         * The value is discarded when the scatter-gather list is cleared and is ignored if the chunk is too small to
+         * hold the described data.
+         *
+         * \param[in] crc    The CRC of the first bytes of the scatter-gather list, calculated with an initial value
+         *                   of 0.
+         *
+         * \param[in] length The number of bytes covered by the CRC.
+         */
+        void setLeadingPayloadCrc(ChunkHeader::RunningCrc crc, unsigned length);
+
+        /**
+         * Convenience method that appends an entry to the scatter-gather list.  Segments added to a full list are
+         * refused.
          *
          * \param[in] buffer       Base pointer to the buffer to be added.
          *
@@ -134,6 +277,7 @@ class StreamDataChunk:public StreamChunk {
          *
          * \return Returns the number of bytes of this segment that are expected to be written based on the current
          *         chunk size.  The value also represents the expected amount read if the chunk is fully populated.
+         *         A value of 0 is returned if the segment was refused.
          */
         unsigned addScatterGatherListSegment(std::uint8_t* buffer, unsigned bufferLength);
 
@@ -192,8 +336,44 @@ class StreamDataChunk:public StreamChunk {
         Container::Status save(bool padToChunkSize = true) final;
 
         /**
-         * Method that checks if the CRC is valid.  This version assumes that the entire chunk contents are contained
-         * within the additional header data.
+         * Method that places the chunk into a memory buffer rather than writing it to the container.  The buffer
+         * receives the same bytes that \ref StreamDataChunk::save would write, including the padding at the end of the
+         * chunk.  As with a save operation, the chunk size might be adjusted downward.
+         *
+         * \param[in] buffer The buffer to receive the chunk.  The buffer must be able to hold \ref chunkSize bytes.
+         *
+         * \return Returns the number of bytes placed into the buffer.
+         */
+        unsigned render(std::uint8_t* buffer) final;
+
+        /**
+         * Method that overwrites part of the payload of a chunk already in the container.  Only the modified bytes
+         * and the chunk header are written.  The CRC is linear so the new CRC is derived from the current CRC and the
+         * CRC of the difference between the old and new bytes, avoiding a pass over the rest of the payload.  The
+         * header must be loaded, including the common header, before calling this method.
+         *
+         * \param[in] offset  The offset into the payload of the first byte to be overwritten.
+         *
+         * \param[in] oldData The bytes currently held in the payload at the offset.
+         *
+         * \param[in] newData The bytes to be written.
+         *
+         * \param[in] count   The number of bytes to be overwritten.  The range must lie within the payload.
+         *
+         * \return Returns the status from the write operations.
+         */
+        Container::Status patchPayload(
+            unsigned            offset,
+            const std::uint8_t* oldData,
+            const std::uint8_t* newData,
+            unsigned            count
+        );
+
+        /**
+         * Method that checks if the CRC is valid.  The CRC is calculated over the chunk header and the payload held
+         * in the scatter-gather list.  Padding past the payload is not included.  The scatter-gather list must hold
+         * the entire payload.  For chunks carrying a payload checksum, the 16-bit CRC covers only the header and the
+         * payload is checked against the 64-bit payload checksum.
          */
         bool checkCrc() const final;
 
@@ -204,20 +384,85 @@ class StreamDataChunk:public StreamChunk {
         void updateCrc() final;
 
     private:
+        /**
+         * Method that determines the number of additional header bytes used by data chunks in a container.
+         *
+         * \param[in] container The container holding the chunk.
+         *
+         * \return Returns the number of additional header bytes.
+         */
+        static unsigned numberAdditionalHeaderBytes(ContainerImpl& container);
+
+        /**
+         * Method that sizes the chunk to the payload held in the scatter-gather list.
+         *
+         * \return Returns the number of payload bytes that will be stored in the chunk.
+         */
+        unsigned preparePayload();
+
+        /**
+         * Method that sets the 64-bit payload checksum stored in the chunk header.
+         *
+         * \param[in] newChecksum The new payload checksum.
+         */
+        void setPayloadChecksum(CrcEngine::RunningCrc64 newChecksum);
+
+        /**
+         * Method that calculates the 64-bit checksum of the payload held in the scatter-gather list.
+         *
+         * \return Returns the calculated payload checksum.
+         */
+        CrcEngine::RunningCrc64 calculatePayloadChecksum() const;
+
         /**
          * The scatter-gather list used during load/save operations.
          */
-        std::vector<ScatterGatherListSegment> scatterGatherList;
+        ScatterGatherListSegment scatterGatherList[maximumScatterGatherListSize];
+
+        /**
+         * The number of entries in the scatter-gather list.
+         */
+        unsigned currentScatterGatherListSize;
 
         /**
          * The current byte count of the scatter-gather list.
          */
         unsigned currentScatterGatherListByteCount;
 
+        /**
+         * A precalculated CRC of the first bytes of the scatter-gather list.
+         */
+        ChunkHeader::RunningCrc leadingPayloadCrc;
+
+        /**
+         * The number of bytes covered by the precalculated CRC.  A value of 0 indicates no precalculated CRC.
+         */
+        unsigned leadingPayloadCrcLength;
+
+        /**
+         * Flag indicating if this chunk carries a 64-bit payload checksum.
+         */
+        bool payloadChecksumPresent;
+
         /**
          * The number of addtional bytes used to track the stream data in this chunk.
          */
         static constexpr unsigned numberAdditionalStreamHeaderBytes = 6;
+
+        /**
+         * The number of additional bytes used to hold the 64-bit payload checksum, when present.
+         */
+        static constexpr unsigned payloadChecksumSizeBytes = 8;
+
+        /**
+         * Size of the block used to hold the difference between the old and new payload bytes while patching.
+         */
+        static constexpr unsigned patchBlockSizeBytes = 512;
+
+        /**
+         * Bit of the compressed block header used to mark shared extent references.
+         */
+        static constexpr std::uint32_t sharedReferenceFlag = 0x80000000UL;
 };
 
 #endif
@@ -29,33 +29,37 @@
 #include "stream_start_chunk.h"
 
 StreamStartChunk::StreamStartChunk(
-        std::weak_ptr<ContainerImpl> container,
+        ContainerImpl&               container,
         FileIndex                    fileIndex,
         const std::string&           virtualFilename,
-        StreamIdentifier             streamIdentifier
+        StreamIdentifier             streamIdentifier,
+        unsigned                     inlinePayloadSize
     ):StreamChunk(
         container,
         fileIndex,
         streamIdentifier,
-        numberAdditionalStreamHeaderBytes
+        additionalHeaderSize(virtualFilename, inlinePayloadSize)
     ) {
+    assert(inlinePayloadSize <= maximumInlinePayloadSize);
+
     setType(ChunkHeader::Type::STREAM_START_CHUNK);
     setVirtualFilename(virtualFilename);
+    setLast(inlinePayloadSize > 0);
 }
 
 
 StreamStartChunk::StreamStartChunk(
-        std::weak_ptr<ContainerImpl> container,
+        ContainerImpl&               container,
         FileIndex                    fileIndex,
         std::uint8_t                 commonHeader[Chunk::minimumChunkHeaderSizeBytes]
     ):StreamChunk(
         container,
         fileIndex,
         commonHeader,
-        numberAdditionalStreamHeaderBytes
+        additionalHeaderSize(commonHeader)
     ) {
     std::uint8_t* header = additionalHeader();
-    std::memset(header, 0, numberAdditionalStreamHeaderBytes);
+    std::memset(header, 0, additionalHeaderSizeBytes());
 }
 
 
@@ -63,11 +67,21 @@ StreamStartChunk::~StreamStartChunk() {}
 
 
 void StreamStartChunk::setVirtualFilename(const std::string& newVirtualFilename) {
-    char*         rawFilename = reinterpret_cast<char*>(additionalHeader());
+    char*         rawFilename  = reinterpret_cast<char*>(additionalHeader());
+    unsigned      nameArea     = additionalHeaderSizeBytes();
     unsigned      bytesWritten = static_cast<unsigned>(newVirtualFilename.length() + 1);
 
-    std::strncpy(rawFilename, newVirtualFilename.c_str(), maximumVirtualFilenameLength);
-    std::memset(rawFilename + bytesWritten, 0, maximumVirtualFilenameLength - bytesWritten);
+    if (nameArea > numberAdditionalStreamHeaderBytes) {
+        nameArea = numberAdditionalStreamHeaderBytes;
+    }
+
+    if (bytesWritten > nameArea) {
+        // The name is truncated, leaving room for the terminating null.
+        bytesWritten = nameArea;
+    }
+
+    std::memcpy(rawFilename, newVirtualFilename.c_str(), bytesWritten - 1);
+    std::memset(rawFilename + bytesWritten - 1, 0, nameArea - bytesWritten + 1);
 }
 
 
@@ -77,8 +91,88 @@ std::string StreamStartChunk::virtualFilename() const {
     // Buffer and use strncpy to keep us from every walking off into unallocated memory if the contents of the chunk are
     // somehow invalid (no termination).
 
+    unsigned nameArea = additionalHeaderSizeBytes();
+    if (nameArea > maximumVirtualFilenameLength) {
+        nameArea = maximumVirtualFilenameLength;
+    }
+
     char filenameBuffer[maximumVirtualFilenameLength + 1];
-    std::strncpy(filenameBuffer, rawFilename, maximumVirtualFilenameLength);
+    std::strncpy(filenameBuffer, rawFilename, nameArea);
+    filenameBuffer[nameArea] = '\0';
 
     return std::string(filenameBuffer);
 }
+
+
+bool StreamStartChunk::holdsInlinePayload() const {
+    return isLast();
+}
+
+
+unsigned StreamStartChunk::inlinePayloadSize() const {
+    return holdsInlinePayload() ? additionalHeaderSizeBytes() - nameAreaSize() : 0;
+}
+
+
+void StreamStartChunk::setInlinePayload(const std::uint8_t* payload) {
+    std::memcpy(additionalHeader() + nameAreaSize(), payload, inlinePayloadSize());
+}
+
+
+const std::uint8_t* StreamStartChunk::inlinePayload() const {
+    return additionalHeader() + nameAreaSize();
+}
+
+
+unsigned StreamStartChunk::additionalHeaderSize(const std::string& virtualFilename, unsigned inlinePayloadSize) {
+    unsigned headerSize;
+
+    if (inlinePayloadSize == 0) {
+        headerSize = numberAdditionalStreamHeaderBytes;
+    } else {
+        unsigned nameLength = static_cast<unsigned>(virtualFilename.length());
+        if (nameLength > maximumVirtualFilenameLength) {
+            nameLength = maximumVirtualFilenameLength;
+        }
+
+        headerSize = nameLength + 1 + inlinePayloadSize;
+    }
+
+    return headerSize;
+}
+
+
+unsigned StreamStartChunk::additionalHeaderSize(std::uint8_t commonHeader[Chunk::minimumChunkHeaderSizeBytes]) {
+    // Stream start chunks are never extended chunks and hold at least the terminating null of the name.  Invalid
+    // sizes are clamped so that a damaged chunk can't cause us to walk off the end of the header.
+
+    ChunkHeader header(commonHeader, 0);
+    unsigned    streamHeaderBytes = StreamChunk::numberAdditionalStreamHeaderBytes;
+    unsigned    maximumBytes      = numberAdditionalStreamHeaderBytes + maximumInlinePayloadSize;
+    unsigned    headerSize;
+
+    if (header.isExtended() || header.numberValidBytes() <= streamHeaderBytes) {
+        headerSize = numberAdditionalStreamHeaderBytes;
+    } else {
+        headerSize = header.numberValidBytes() - streamHeaderBytes;
+
+        if (headerSize > maximumBytes) {
+            headerSize = maximumBytes;
+        }
+    }
+
+    return headerSize;
+}
+
+
+unsigned StreamStartChunk::nameAreaSize() const {
+    const char* rawFilename = reinterpret_cast<const char*>(additionalHeader());
+    unsigned    headerSize  = additionalHeaderSizeBytes();
+    unsigned    nameLength  = 0;
+
+    while (nameLength < headerSize && rawFilename[nameLength] != '\0') {
+        ++nameLength;
+    }
+
+    return nameLength < headerSize ? nameLength + 1 : headerSize;
+}
@@ -33,6 +33,11 @@
 
 /**
  * Class that manages a chunk that represents the start of a stream or virtual file.
+ *
+ * Containers with a minor version of 5 or later can hold the entire contents of small virtual files inline.  The
+ * payload directly follows the terminating null of the virtual filename, replacing the unused portion of the name
+ * area, and the chunk is sized to fit.  The payload size is implied by the number of valid bytes in the chunk.  Chunks
+ * holding an inline payload are marked using the stream EOF bit which is otherwise unused by stream start chunks.
  */
 class StreamStartChunk:public StreamChunk {
     public:
@@ -41,6 +46,11 @@ class StreamStartChunk:public StreamChunk {
          */
         static constexpr unsigned maximumVirtualFilenameLength = 119;
 
+        /**
+         * The largest payload that can be held inline, in bytes.  The value limits stream start chunks to 512 bytes.
+         */
+        static constexpr unsigned maximumInlinePayloadSize = 384;
+
         /**
          * Constructor.
          *
@@ -52,12 +62,16 @@ class StreamStartChunk:public StreamChunk {
          *                             it is excessively long.
          *
          * \param[in] streamIdentifier The identifier associated with this stream.
+         *
+         * \param[in] inlinePayloadSize The number of payload bytes to be held inline.  The value must not exceed
+         *                              \ref StreamStartChunk::maximumInlinePayloadSize.
          */
         StreamStartChunk(
-            std::weak_ptr<ContainerImpl> container,
+            ContainerImpl&               container,
             FileIndex                    fileIndex,
             const std::string&           virtualFilename,
-            StreamIdentifier             streamIdentifier
+            StreamIdentifier             streamIdentifier,
+            unsigned                     inlinePayloadSize = 0
         );
 
         /**
@@ -70,7 +84,7 @@ class StreamStartChunk:public StreamChunk {
          * \param[in] commonHeader Array holding header data common to all chunk types.
          */
         StreamStartChunk(
-            std::weak_ptr<ContainerImpl> container,
+            ContainerImpl&               container,
             FileIndex                    fileIndex,
             std::uint8_t                 commonHeader[Chunk::minimumChunkHeaderSizeBytes]
         );
@@ -78,7 +92,9 @@ class StreamStartChunk:public StreamChunk {
         ~StreamStartChunk() override;
 
         /**
-         * Method you can use to update the virtual filename tied to this stream.
+         * Method you can use to update the virtual filename tied to this stream.  The name area of a chunk holding an
+         * inline payload is sized for the name supplied to the constructor so the name should only be changed by
+         * creating a new chunk.
          *
          * \param[in] newVirtualFilename The new virtual filename tied to this stream.
          */
@@ -91,11 +107,70 @@ class StreamStartChunk:public StreamChunk {
          */
         std::string virtualFilename() const;
 
+        /**
+         * Method you can use to determine if this chunk holds an inline payload.
+         *
+         * \return Returns true if the chunk holds an inline payload.
+         */
+        bool holdsInlinePayload() const;
+
+        /**
+         * Method you can use to determine the number of payload bytes held inline.
+         *
+         * \return Returns the size of the inline payload, in bytes.  A value of 0 is returned if the chunk does not
+         *         hold an inline payload.
+         */
+        unsigned inlinePayloadSize() const;
+
+        /**
+         * Method you can use to update the inline payload.
+         *
+         * \param[in] payload The payload data.  The buffer must hold \ref StreamStartChunk::inlinePayloadSize bytes.
+         *                    The payload must be set after the virtual filename.
+         */
+        void setInlinePayload(const std::uint8_t* payload);
+
+        /**
+         * Method you can use to obtain the inline payload.
+         *
+         * \return Returns a pointer to the inline payload.
+         */
+        const std::uint8_t* inlinePayload() const;
+
     protected:
         /**
          * The number of addtional bytes used to track the stream data in this chunk.
          */
         static constexpr unsigned numberAdditionalStreamHeaderBytes = 120;
+
+    private:
+        /**
+         * Method that determines the number of additional header bytes needed to hold a virtual filename and inline
+         * payload.
+         *
+         * \param[in] virtualFilename   The virtual filename.
+         *
+         * \param[in] inlinePayloadSize The size of the inline payload, in bytes.
+         *
+         * \return Returns the number of additional header bytes.
+         */
+        static unsigned additionalHeaderSize(const std::string& virtualFilename, unsigned inlinePayloadSize);
+
+        /**
+         * Method that determines the number of additional header bytes described by a common header.
+         *
+         * \param[in] commonHeader Array holding header data common to all chunk types.
+         *
+         * \return Returns the number of additional header bytes.
+         */
+        static unsigned additionalHeaderSize(std::uint8_t commonHeader[Chunk::minimumChunkHeaderSizeBytes]);
+
+        /**
+         * Method that determines the number of bytes used by the virtual filename, including the terminating null.
+         *
+         * \return Returns the size of the name area, in bytes.
+         */
+        unsigned nameAreaSize() const;
 };
 
 #endif
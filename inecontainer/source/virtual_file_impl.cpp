@@ -23,9 +23,12 @@
 #include <cstdint>
 #include <vector>
 #include <map>
+#include <list>
 #include <utility>
 #include <string>
 #include <memory>
+#include <cstring>
+#include <algorithm>
 #include <cassert>
 
 #include "container_status.h"
@@ -38,6 +41,9 @@
 #include "ring_buffer.h"
 #include "chunk_map_data.h"
 #include "container_impl.h"
+#include "crc_engine.h"
+#include "compression_engine.h"
+#include "container_virtual_file.h"
 #include "virtual_file_impl.h"
 
 VirtualFileImpl::VirtualFileImpl(
@@ -49,27 +55,33 @@ VirtualFileImpl::VirtualFileImpl(
     currentContainer        = container;
 
     startChunkIndex         = ChunkHeader::invalidFileIndex;
+    startChunkSize          = 0;
     chunkBuffer             = nullptr;
+    chunkBufferCapacity     = 0;
     chunkBufferFlushNeeded  = false;
+    lastPatchEnd            = static_cast<unsigned long long>(-1);
+    lastChunkReopenable     = true;
+    writeCacheBytes         = 0;
+    reportedBufferedBytes   = 0;
+    maximumWriteCacheBytes  = defaultWriteCacheSize;
+    maximumReadCacheEntries = defaultReadCacheSize;
+    readCacheHitCount       = 0;
+    readCacheMissCount      = 0;
+    tailBufferCrc           = 0;
+    tailBufferCrcValid      = true;
     currentChunk            = chunkMap.end();
     currentPosition         = 0;
-}
-
-
-VirtualFileImpl::VirtualFileImpl(std::shared_ptr<StreamStartChunk> streamStartChunk) {
-    currentContainer        = streamStartChunk->container();
-    currentName             = streamStartChunk->virtualFilename();
-    currentStreamIdentifier = streamStartChunk->streamIdentifier();
-    startChunkIndex         = streamStartChunk->fileIndex();
-
-    chunkBuffer             = nullptr;
-    chunkBufferFlushNeeded  = false;
-    currentChunk            = chunkMap.end();
-    currentPosition         = 0;
+    currentCompression      = Container::VirtualFile::Compression::NONE;
 }
 
 
 VirtualFileImpl::~VirtualFileImpl() {
+    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
+    if (container) {
+        releaseReservedArea(*container);
+        container->bufferedBytesChanged(reportedBufferedBytes, 0);
+    }
+
     if (chunkBuffer != nullptr) {
         delete[] chunkBuffer;
     }
@@ -88,6 +100,7 @@ void VirtualFileImpl::setStreamIdentifier(StreamChunk::StreamIdentifier newIdent
 
 void VirtualFileImpl::setStreamStartIndex(ChunkHeader::FileIndex streamStartFileIndex) {
     startChunkIndex = streamStartFileIndex;
+    startChunkSize  = 0; // Determined when first needed.
 }
 
 
@@ -112,7 +125,7 @@ long long VirtualFileImpl::size() {
                 currentSize = currentStoredSize();
             }
         } else {
-            currentSize = currentStoredSize() + tailBuffer.count();
+            currentSize = currentStoredSize() + tailBuffer.count() + pendingExtent.size();
         }
     }
 
@@ -167,13 +180,13 @@ long long VirtualFileImpl::position() const {
 
 
 unsigned long long VirtualFileImpl::bytesInWriteCache() const {
-    unsigned cachedBytes = 0;
+    unsigned long long cachedBytes = writeCacheBytes;
 
     if (chunkBufferFlushNeeded && currentChunk != chunkMap.end()) {
-        cachedBytes = currentChunk->second.payloadSize();
+        cachedBytes += currentChunk->second.payloadSize();
     }
 
-    cachedBytes += tailBuffer.count();
+    cachedBytes += tailBuffer.count() + pendingExtent.size();
 
     return cachedBytes;
 }
@@ -215,7 +228,7 @@ Container::Status VirtualFileImpl::read(std::uint8_t* buffer, unsigned desiredCo
                 assert(currentChunk != chunkMap.end());
                 assert(chunkBuffer != nullptr);
 
-                status = flushChunkBuffer();
+                status = evictChunkBuffer(*container);
             }
 
             if (!status) {
@@ -248,17 +261,25 @@ Container::Status VirtualFileImpl::read(std::uint8_t* buffer, unsigned desiredCo
                 // We don't have the chunk in local memory.  We have to read it into either the chunk buffer (and copy
                 // portions) or into the read buffer.
 
-                if (readEnd > chunkEndingOffset) {
+                bool directRead = (
+                       !currentChunk->second.compressed()
+                    && !currentChunk->second.shared()
+                    && !currentChunk->second.inlined()
+                    && writeCache.find(chunkStartingOffset) == writeCache.end()
+                    && !readCacheContains(chunkStartingOffset)
+                );
+
+                if (readEnd > chunkEndingOffset && directRead) {
                     // We're going to read another chunk after this one, read directly into the read buffer.
 
                     StreamDataChunk chunk(
-                        currentContainer,
+                        *container,
                         currentChunk->second.startingIndex(),
                         currentStreamIdentifier,
                         chunkStartingOffset
                     );
 
-                    chunk.setChunkSize(ChunkHeader::maximumChunkSize); // Chunk size adjusted during the read.
+                    chunk.setChunkSize(ChunkHeader::maximumExtendedChunkSize); // Chunk size adjusted during the read.
 
                     if (currentPosition == chunkStartingOffset) {
                         // We're going to read the entire chunk.
@@ -270,10 +291,7 @@ Container::Status VirtualFileImpl::read(std::uint8_t* buffer, unsigned desiredCo
                         // throw it away.
 
                         bytesOfReadData = static_cast<unsigned>(chunkEndingOffset - currentPosition);
-
-                        if (chunkBuffer == nullptr) {
-                            chunkBuffer = new std::uint8_t[chunkBufferSize];
-                        }
+                        reserveChunkBuffer(static_cast<unsigned>(currentPosition - chunkStartingOffset));
 
                         chunk.addScatterGatherListSegment(
                             chunkBuffer,
@@ -314,12 +332,17 @@ Container::Status VirtualFileImpl::read(std::uint8_t* buffer, unsigned desiredCo
                         );
                     }
 
+                    if (!status) {
+                        status = container->verifyChunk(chunk);
+                    }
+
                     currentChunk = chunkMap.end();
                 } else {
                     // We end on this chunk so we expect this chunk to reside in the chunk buffer.  Read into the chunk
-                    // buffer and copy.
+                    // buffer and copy.  Compressed extents must always be decompressed into the chunk buffer and shared
+                    // extents are always loaded from their shared chunk.
 
-                    status = loadChunkIntoBuffer();
+                    status = loadChunkIntoBuffer(*container);
 
                     if (!status) {
                         unsigned chunkBytesRemaining = static_cast<unsigned>(chunkEndingOffset - currentPosition);
@@ -344,15 +367,22 @@ Container::Status VirtualFileImpl::read(std::uint8_t* buffer, unsigned desiredCo
         }
     }
 
-    // If we have any additional data to read, it will be in the tail buffer.  Snoop the tail buffer to read that data.
+    // If we have any additional data to read, it will be in the tail buffer or the pending extent.  Snoop the tail
+    // buffer to read that data.
     if (!status && remainingToRead > 0) {
         assert(currentPosition >= tailBufferBase);
 
         unsigned offset = static_cast<unsigned>(currentPosition - tailBufferBase);
-        assert(remainingToRead <= tailBuffer.count() - offset);
 
-        for (unsigned i=0 ; i<remainingToRead ; ++i) {
-            bufferSegment[i] = tailBuffer.snoop(offset + i);
+        if (!pendingExtent.empty()) {
+            assert(remainingToRead <= pendingExtent.size() - offset);
+            std::memcpy(bufferSegment, pendingExtent.data() + offset, remainingToRead);
+        } else {
+            assert(remainingToRead <= tailBuffer.count() - offset);
+
+            for (unsigned i=0 ; i<remainingToRead ; ++i) {
+                bufferSegment[i] = tailBuffer.snoop(offset + i);
+            }
         }
 
         currentPosition += remainingToRead;
@@ -370,6 +400,338 @@ Container::Status VirtualFileImpl::read(std::uint8_t* buffer, unsigned desiredCo
 }
 
 
+Container::Status VirtualFileImpl::readView(unsigned desiredCount, Container::VirtualFile::View& view) {
+    Container::Status status;
+
+    view.release();
+
+    unsigned long long distanceToEof     = size() - currentPosition;
+    unsigned           numberBytesToRead = static_cast<unsigned>(  desiredCount < distanceToEof
+                                                                 ? desiredCount
+                                                                 : distanceToEof
+                                                                );
+
+    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
+    if (!container) {
+        status = Container::ContainerUnavailable();
+    }
+
+    if (!status && container->containerScanNeeded()) {
+        status = container->scanContainer();
+    }
+
+    if (!status && chunkBufferFlushNeeded) {
+        // Pinned data comes from the container so any modified chunk must be written out first.
+        status = flushChunkBuffer(*container);
+    }
+
+    unsigned long long tailBufferBase = currentStoredSize();                    // Inclusive
+    unsigned long long readEnd        = currentPosition + numberBytesToRead;    // Exclusive
+    unsigned long long copyStart      = currentPosition;                        // Start of data not yet in the view.
+
+    bool pinningSupported = !status && container->supportsPinning();
+
+    while (!status && pinningSupported && currentPosition < readEnd && currentPosition < tailBufferBase) {
+        ChunkMap::const_iterator pos = chunkMap.upper_bound(currentPosition);
+        --pos;
+
+        unsigned long long chunkStartingOffset = pos->first;                                    // Inclusive
+        unsigned long long chunkEndingOffset   = chunkStartingOffset + pos->second.payloadSize(); // Exclusive
+        unsigned long long spanEnd             = readEnd < chunkEndingOffset ? readEnd : chunkEndingOffset;
+
+        std::shared_ptr<const std::uint8_t> payload;
+        bool pinnable = (
+               !pos->second.compressed()
+            && !pos->second.shared()
+            && !pos->second.inlined()
+            && writeCache.find(pos->first) == writeCache.end()
+        );
+
+        if (pinnable) {
+            status = pinChunkPayload(*container, pos, &payload);
+        }
+
+        if (!status && payload) {
+            if (copyStart < currentPosition) {
+                unsigned long long spanStart = currentPosition;
+
+                currentPosition = copyStart;
+                status          = copyIntoView(static_cast<unsigned>(spanStart - copyStart), view);
+            }
+
+            if (!status) {
+                const std::uint8_t* spanData = payload.get() + (currentPosition - chunkStartingOffset);
+                view.append(
+                    std::shared_ptr<const std::uint8_t>(payload, spanData),
+                    static_cast<unsigned>(spanEnd - currentPosition)
+                );
+
+                copyStart = spanEnd;
+            }
+        }
+
+        currentPosition = spanEnd;
+    }
+
+    // Anything left over is compressed, shared, cached, or held in a container that does not support pinning.  Copy
+    // it using the normal read path.
+    if (!status && copyStart < readEnd) {
+        currentPosition = copyStart;
+        status          = copyIntoView(static_cast<unsigned>(readEnd - copyStart), view);
+    }
+
+    if (!status) {
+        status = Container::ReadSuccessful(numberBytesToRead);
+    } else {
+        view.release();
+    }
+
+    if (container) {
+        container->setLastStatus(status);
+    }
+
+    return status;
+}
+
+
+Container::Status VirtualFileImpl::readAt(unsigned long long offset, std::uint8_t* buffer, unsigned desiredCount) {
+    Container::Status status;
+
+    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
+    if (!container) {
+        status = Container::ContainerUnavailable();
+    }
+
+    long long currentSize = size();
+    if (!status && (currentSize < 0 || offset > static_cast<unsigned long long>(currentSize))) {
+        status = Container::SeekError(offset, static_cast<unsigned long long>(currentSize));
+    }
+
+    unsigned numberBytesToRead = 0;
+    if (!status) {
+        unsigned long long distanceToEof = static_cast<unsigned long long>(currentSize) - offset;
+        numberBytesToRead = static_cast<unsigned>(desiredCount < distanceToEof ? desiredCount : distanceToEof);
+    }
+
+    std::uint8_t*      bufferSegment   = buffer;
+    unsigned           remainingToRead = numberBytesToRead;
+    unsigned long long readPosition    = offset;
+    unsigned long long tailBufferBase  = currentStoredSize(); // Inclusive
+
+    // Chunks are read without disturbing the chunk buffer.  The chunk buffer is used only if it already holds the
+    // chunk we need.  Chunks that are only partially read are loaded into a local buffer.
+
+    std::vector<std::uint8_t> extent;
+
+    while (!status && remainingToRead > 0 && readPosition < tailBufferBase) {
+        ChunkMap::const_iterator pos = chunkMap.upper_bound(readPosition);
+        --pos;
+
+        unsigned           chunkSize           = pos->second.payloadSize();
+        unsigned long long chunkStartingOffset = pos->first;                            // Inclusive
+        unsigned long long chunkEndingOffset   = chunkStartingOffset + chunkSize;       // Exclusive
+        unsigned           chunkBytesRemaining = static_cast<unsigned>(chunkEndingOffset - readPosition);
+        unsigned           bytesOfReadData     =   remainingToRead < chunkBytesRemaining
+                                                 ? remainingToRead
+                                                 : chunkBytesRemaining;
+
+        if (currentChunk != chunkMap.end() && pos == ChunkMap::const_iterator(currentChunk)) {
+            std::memcpy(bufferSegment, chunkBuffer + (readPosition - chunkStartingOffset), bytesOfReadData);
+        } else if (bytesOfReadData == chunkSize) {
+            status = loadExtent(*container, pos, bufferSegment);
+        } else {
+            extent.resize(chunkSize);
+            status = loadExtent(*container, pos, extent.data());
+
+            if (!status) {
+                std::memcpy(bufferSegment, extent.data() + (readPosition - chunkStartingOffset), bytesOfReadData);
+            }
+        }
+
+        bufferSegment   += bytesOfReadData;
+        remainingToRead -= bytesOfReadData;
+        readPosition    += bytesOfReadData;
+    }
+
+    if (!status && remainingToRead > 0) {
+        assert(readPosition >= tailBufferBase);
+
+        unsigned tailOffset = static_cast<unsigned>(readPosition - tailBufferBase);
+
+        if (!pendingExtent.empty()) {
+            assert(remainingToRead <= pendingExtent.size() - tailOffset);
+            std::memcpy(bufferSegment, pendingExtent.data() + tailOffset, remainingToRead);
+        } else {
+            assert(remainingToRead <= tailBuffer.count() - tailOffset);
+
+            for (unsigned i=0 ; i<remainingToRead ; ++i) {
+                bufferSegment[i] = tailBuffer.snoop(tailOffset + i);
+            }
+        }
+    }
+
+    if (!status) {
+        status = Container::ReadSuccessful(numberBytesToRead);
+    }
+
+    if (container) {
+        container->setLastStatus(status);
+    }
+
+    return status;
+}
+
+
+Container::Status VirtualFileImpl::writeAt(unsigned long long offset, const std::uint8_t* buffer, unsigned count) {
+    Container::Status status;
+
+    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
+    if (!container) {
+        status = Container::ContainerUnavailable();
+    }
+
+    long long currentSize = size();
+    if (!status && (currentSize < 0 || offset > static_cast<unsigned long long>(currentSize))) {
+        status = Container::SeekError(offset, static_cast<unsigned long long>(currentSize));
+    }
+
+    const std::uint8_t* bufferSegment     = buffer;
+    unsigned            remainingInBuffer = count;
+    unsigned long long  writePosition     = offset;
+    unsigned long long  tailBufferBase    = currentStoredSize(); // Inclusive
+
+    // Chunks are updated without disturbing the chunk buffer.  If the chunk buffer holds the chunk, the chunk buffer
+    // is updated.  Other chunks are updated in the write cache or, if the write cache is disabled, written to the
+    // media directly.
+
+    std::vector<std::uint8_t> extent;
+
+    while (!status && remainingInBuffer > 0 && writePosition < tailBufferBase) {
+        ChunkMap::iterator pos = chunkMap.upper_bound(writePosition);
+        --pos;
+
+        unsigned           chunkSize           = pos->second.payloadSize();
+        unsigned long long chunkStartingOffset = pos->first;                            // Inclusive
+        unsigned long long chunkEndingOffset   = chunkStartingOffset + chunkSize;       // Exclusive
+        unsigned           chunkBytesRemaining = static_cast<unsigned>(chunkEndingOffset - writePosition);
+        unsigned           bytesOfNewData      =   remainingInBuffer < chunkBytesRemaining
+                                                 ? remainingInBuffer
+                                                 : chunkBytesRemaining;
+
+        if (pos == currentChunk) {
+            std::memcpy(chunkBuffer + (writePosition - chunkStartingOffset), bufferSegment, bytesOfNewData);
+            chunkBufferFlushNeeded = true;
+        } else if (maximumWriteCacheBytes > 0) {
+            WriteCache::iterator cached = writeCache.find(chunkStartingOffset);
+
+            if (cached == writeCache.end()) {
+                std::vector<std::uint8_t> payload(chunkSize);
+
+                if (bytesOfNewData != chunkSize) {
+                    status = loadExtent(*container, pos, payload.data());
+                }
+
+                if (!status) {
+                    cached           = writeCache.insert(std::make_pair(chunkStartingOffset, std::move(payload))).first;
+                    writeCacheBytes += chunkSize;
+                }
+            }
+
+            if (!status) {
+                std::memcpy(
+                    cached->second.data() + (writePosition - chunkStartingOffset),
+                    bufferSegment,
+                    bytesOfNewData
+                );
+
+                if (writeCacheBytes > maximumWriteCacheBytes) {
+                    status = flushWriteCache(*container);
+                }
+            }
+        } else {
+            bool          inPlace = !pos->second.compressed() && !pos->second.shared() && !pos->second.inlined();
+            std::uint8_t* payload;
+
+            if (inPlace && bytesOfNewData != chunkSize) {
+                status = patchExtent(
+                    *container,
+                    pos,
+                    static_cast<unsigned>(writePosition - chunkStartingOffset),
+                    bufferSegment,
+                    bytesOfNewData
+                );
+
+                payload = nullptr;
+            } else if (inPlace) {
+                payload = const_cast<std::uint8_t*>(bufferSegment);
+            } else {
+                extent.resize(chunkSize);
+                payload = extent.data();
+
+                if (bytesOfNewData != chunkSize) {
+                    status = loadExtent(*container, pos, payload);
+                }
+
+                if (!status) {
+                    std::memcpy(payload + (writePosition - chunkStartingOffset), bufferSegment, bytesOfNewData);
+                }
+            }
+
+            if (!status && payload != nullptr) {
+                status = saveExtent(*container, pos, payload);
+            }
+        }
+
+        bufferSegment     += bytesOfNewData;
+        remainingInBuffer -= bytesOfNewData;
+        writePosition     += bytesOfNewData;
+    }
+
+    if (!status && remainingInBuffer > 0 && writePosition < static_cast<unsigned long long>(currentSize)) {
+        unsigned tailOffset     = static_cast<unsigned>(writePosition - tailBufferBase);
+        unsigned remainingInEnd = static_cast<unsigned>(static_cast<unsigned long long>(currentSize) - writePosition);
+        unsigned bytesToCopy    = remainingInBuffer < remainingInEnd ? remainingInBuffer : remainingInEnd;
+
+        if (!pendingExtent.empty()) {
+            std::memcpy(pendingExtent.data() + tailOffset, bufferSegment, bytesToCopy);
+        } else {
+            for (unsigned i=0 ; i<bytesToCopy ; ++i) {
+                tailBuffer.snoop(tailOffset + i) = bufferSegment[i];
+            }
+
+            tailBufferCrcValid = false;
+        }
+
+        bufferSegment     += bytesToCopy;
+        remainingInBuffer -= bytesToCopy;
+    }
+
+    if (!status && remainingInBuffer > 0) {
+        // Append the remaining data, leaving the file position untouched.
+
+        unsigned long long savedPosition = currentPosition;
+
+        status = append(bufferSegment, remainingInBuffer);
+        if (status.success() && Container::WriteSuccessful(status).bytesWritten() == remainingInBuffer) {
+            status = Container::NoStatus();
+        }
+
+        currentPosition = savedPosition;
+    }
+
+    if (!status) {
+        status = Container::WriteSuccessful(count);
+    }
+
+    if (container) {
+        status = applyWriteBufferBudget(*container, status);
+        container->setLastStatus(status);
+    }
+
+    return status;
+}
+
+
 Container::Status VirtualFileImpl::write(const std::uint8_t* buffer, unsigned desiredCount) {
     Container::Status status;
 
@@ -386,7 +748,7 @@ Container::Status VirtualFileImpl::write(const std::uint8_t* buffer, unsigned de
     }
 
     unsigned long long tailBufferBase = currentStoredSize();                 // Inclusive
-    unsigned long long tailBufferEnd  = tailBufferBase + tailBuffer.count(); // Exclusive
+    unsigned long long tailBufferEnd  = tailBufferBase + tailBuffer.count() + pendingExtent.size(); // Exclusive
     unsigned long long writeEnd       = currentPosition + remainingInBuffer; // Exclusive
 
     // First do RMW of chunks.
@@ -410,7 +772,7 @@ Container::Status VirtualFileImpl::write(const std::uint8_t* buffer, unsigned de
                 assert(currentChunk != chunkMap.end());
                 assert(chunkBuffer != nullptr);
 
-                status = flushChunkBuffer();
+                status = evictChunkBuffer(*container);
             }
 
             if (!status) {
@@ -433,17 +795,58 @@ Container::Status VirtualFileImpl::write(const std::uint8_t* buffer, unsigned de
 
             unsigned bytesOfNewData = 0;
 
-            if (writeEnd > chunkEndingOffset) {
+            // Partial updates are staged in the write cache, when enabled, so only chunks we overwrite in full are
+            // written directly.
+
+            bool directWrite = (
+                   !currentChunk->second.compressed()
+                && !currentChunk->second.shared()
+                && !currentChunk->second.inlined()
+                && writeCache.find(chunkStartingOffset) == writeCache.end()
+                && (maximumWriteCacheBytes == 0 || currentPosition == chunkStartingOffset)
+            );
+
+            // With the write cache disabled, a partial update is patched in place unless the write continues a
+            // previous patch.  Sequential writes are gathered in the chunk buffer so the chunk is written once.
+
+            bool patchInPlace = (
+                   directWrite
+                && maximumWriteCacheBytes == 0
+                && (!chunkLoaded || !chunkBufferFlushNeeded)
+                && currentPosition != lastPatchEnd
+                && (currentPosition != chunkStartingOffset || writeEnd < chunkEndingOffset)
+            );
+
+            if (patchInPlace) {
+                unsigned chunkBytesRemaining = static_cast<unsigned>(chunkEndingOffset - currentPosition);
+                bytesOfNewData = remainingInBuffer < chunkBytesRemaining ? remainingInBuffer : chunkBytesRemaining;
+
+                ChunkMap::iterator pos = currentChunk;
+                if (!chunkLoaded) {
+                    // The chunk buffer holds some other chunk.
+                    currentChunk = chunkMap.end();
+                }
+
+                status = patchExtent(
+                    *container,
+                    pos,
+                    static_cast<unsigned>(currentPosition - chunkStartingOffset),
+                    bufferSegment,
+                    bytesOfNewData
+                );
+
+                lastPatchEnd = currentPosition + bytesOfNewData;
+            } else if (writeEnd > chunkEndingOffset && directWrite) {
                 // We're going to evict this chunk, no need to keep the chunk buffer coherent.
 
                 StreamDataChunk chunk(
-                    currentContainer,
+                    *container,
                     currentChunk->second.startingIndex(),
                     currentStreamIdentifier,
                     chunkStartingOffset
                 );
 
-                chunk.setChunkSize(ChunkHeader::maximumChunkSize);
+                chunk.setChunkSize(ChunkHeader::maximumExtendedChunkSize); // Chunk is right-sized on save.
 
                 if (currentPosition == chunkStartingOffset) {
                     // We're going to overwrite the entire chunk.  Don't need to read-modify-write.
@@ -456,7 +859,7 @@ Container::Status VirtualFileImpl::write(const std::uint8_t* buffer, unsigned de
                     // coherent.
 
                     if (!chunkLoaded) {
-                        status = loadChunkIntoBuffer();
+                        status = loadChunkIntoBuffer(*container);
                     }
 
                     if (!status) {
@@ -472,22 +875,25 @@ Container::Status VirtualFileImpl::write(const std::uint8_t* buffer, unsigned de
                 }
 
                 status = chunk.save(); // Chunk is right-sized here.
+                invalidateReadCache(chunkStartingOffset);
 
                 currentChunk           = chunkMap.end();
                 chunkBufferFlushNeeded = false;
             } else {
-                // The write will end at or before the end of this chunk.  This chunk will stay in the buffer.
-                // Need to load the chunk into the buffer and then update the chunk buffer with the new data.
+                // The write will end at or before the end of this chunk, or the chunk is a compressed, shared or
+                // inline extent that must be rewritten in full.  This chunk will stay in the buffer.  Need to load the
+                // chunk into the buffer and then update the chunk buffer with the new data.
 
-                bytesOfNewData = remainingInBuffer;
+                unsigned chunkBytesRemaining = static_cast<unsigned>(chunkEndingOffset - currentPosition);
+                bytesOfNewData = remainingInBuffer < chunkBytesRemaining ? remainingInBuffer : chunkBytesRemaining;
 
                 if (!chunkLoaded) {
-                    status = loadChunkIntoBuffer();
+                    status = loadChunkIntoBuffer(*container);
                 }
 
                 if (!status) {
                     std::uint8_t* writeBuffer = chunkBuffer + (currentPosition - chunkStartingOffset);
-                    std::memcpy(writeBuffer, bufferSegment, remainingInBuffer);
+                    std::memcpy(writeBuffer, bufferSegment, bytesOfNewData);
 
                     chunkBufferFlushNeeded = true;
                 }
@@ -506,10 +912,24 @@ Container::Status VirtualFileImpl::write(const std::uint8_t* buffer, unsigned de
     if (!status && remainingInBuffer > 0) {
         assert(currentPosition >= tailBufferBase);
 
-        if (currentPosition == tailBufferBase && remainingInBuffer >= tailBuffer.length()) {
+        if (!pendingExtent.empty()) {
+            unsigned offset                   = static_cast<unsigned>(currentPosition - tailBufferBase);
+            unsigned remainingInPendingExtent = static_cast<unsigned>(pendingExtent.size()) - offset;
+            unsigned bytesToCopy              =   remainingInBuffer < remainingInPendingExtent
+                                                ? remainingInBuffer
+                                                : remainingInPendingExtent;
+
+            std::memcpy(pendingExtent.data() + offset, bufferSegment, bytesToCopy);
+
+            bufferSegment     += bytesToCopy;
+            remainingInBuffer -= bytesToCopy;
+            currentPosition   += bytesToCopy;
+        } else if (currentPosition == tailBufferBase && remainingInBuffer >= tailBuffer.length()) {
             // We'll replace the entire tail buffer.  Let's simply clear it out and append.
             tailBuffer.clear();
-            tailBufferEnd = tailBufferBase;
+            tailBufferEnd      = tailBufferBase;
+            tailBufferCrc      = 0;
+            tailBufferCrcValid = true;
         } else {
             unsigned offset                = static_cast<unsigned>(currentPosition - tailBufferBase);
             unsigned remainingInTailBuffer = tailBuffer.count() - offset;
@@ -521,6 +941,8 @@ Container::Status VirtualFileImpl::write(const std::uint8_t* buffer, unsigned de
                 tailBuffer.snoop(offset + i) = bufferSegment[i];
             }
 
+            tailBufferCrcValid = false;
+
             bufferSegment     += entriesToSnoop;
             remainingInBuffer -= entriesToSnoop;
             currentPosition   += entriesToSnoop;
@@ -541,6 +963,7 @@ Container::Status VirtualFileImpl::write(const std::uint8_t* buffer, unsigned de
     }
 
     if (container) {
+        status = applyWriteBufferBudget(*container, status);
         container->setLastStatus(status);
     }
 
@@ -548,121 +971,456 @@ Container::Status VirtualFileImpl::write(const std::uint8_t* buffer, unsigned de
 }
 
 
-Container::Status VirtualFileImpl::append(const std::uint8_t* buffer, unsigned desiredCount) {
-    Container::Status status = writeStreamStartIfNeeded();
+Container::Status VirtualFileImpl::readv(const Container::VirtualFile::ReadBuffer* buffers, unsigned numberBuffers) {
+    Container::Status status;
 
-    unsigned            remainingInBuffer = desiredCount;
-    const std::uint8_t* bufferSegment     = buffer;
+    unsigned bytesRead = 0;
+    bool     endOfFile = false;
 
-    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
-    if (!status && !container) {
-        status = Container::ContainerUnavailable();
-    }
+    for (unsigned i=0 ; !status && !endOfFile && i<numberBuffers ; ++i) {
+        status = read(buffers[i].first, buffers[i].second);
+        if (status.success()) {
+            unsigned count = Container::ReadSuccessful(status).bytesRead();
 
-    if (!status && container->containerScanNeeded()) {
-        status = container->scanContainer();
+            bytesRead += count;
+            endOfFile  = count < buffers[i].second;
+            status     = Container::NoStatus();
+        }
     }
 
-    // Write out chunks until we have less than a full chunk left.
-    while (!status && tailBuffer.available() <= remainingInBuffer) {
-        std::unique_ptr<StreamDataChunk> chunk;
-        FreeSpace                        reservedFreeSpace;
+    if (!status) {
+        status = Container::ReadSuccessful(bytesRead);
+    }
 
-        // Position at EOF, allocate new free space.
+    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
+    if (container) {
+        container->setLastStatus(status);
+    }
 
-        reservedFreeSpace = container->reserveFreeSpaceArea(
-            lastKnownFileIndex(),
-            ChunkHeader::toFileIndex(ChunkHeader::minimumChunkSize),
-            ChunkHeader::toFileIndex(ChunkHeader::maximumChunkSize)
-        );
+    return status;
+}
 
-        chunk.reset(new StreamDataChunk(
-            currentContainer,
-            reservedFreeSpace.startingIndex(),
-            currentStreamIdentifier,
-            currentStoredSize()
-        ));
 
-        chunk->setChunkSize(static_cast<unsigned>(ChunkHeader::toPosition(reservedFreeSpace.areaSize())));
+Container::Status VirtualFileImpl::writev(const Container::VirtualFile::WriteBuffer* buffers, unsigned numberBuffers) {
+    Container::Status status;
 
-        unsigned numberLocalSegments;
-        if (tailBuffer.empty()) {
-            numberLocalSegments = 0;
-        } else {
-            std::uint8_t* p1;
-            unsigned      l1;
-            std::uint8_t* p2;
-            unsigned      l2;
+    unsigned desiredCount = 0;
+    for (unsigned i=0 ; i<numberBuffers ; ++i) {
+        desiredCount += buffers[i].second;
+    }
 
-            unsigned      tailBufferCount = tailBuffer.bulkExtractionStart(&p1, &l1, &p2, &l2);
-            (void) tailBufferCount;
-            assert(tailBufferCount == l1 + l2);
+    unsigned bufferIndex  = 0;
+    unsigned bufferOffset = 0;
+
+    advanceBuffers(buffers, numberBuffers, 0, &bufferIndex, &bufferOffset);
+
+    // Data that overwrites existing data is written one buffer at a time.  Data past the end of the file is appended
+    // in one operation so that the buffers can be gathered directly into new chunks.
+
+    long long fileSize = size();
+    while (!status                                                       &&
+           bufferIndex < numberBuffers                                   &&
+           fileSize >= 0                                                 &&
+           currentPosition < static_cast<unsigned long long>(fileSize)      ) {
+        unsigned long long distanceToEof      = static_cast<unsigned long long>(fileSize) - currentPosition;
+        unsigned           remainingInSegment = buffers[bufferIndex].second - bufferOffset;
+        unsigned           count              = static_cast<unsigned>(
+              remainingInSegment < distanceToEof
+            ? remainingInSegment
+            : distanceToEof
+        );
 
-            chunk->addScatterGatherListSegment(p1, l1);
-            if (l2 == 0) {
-                numberLocalSegments = 1;
-            } else {
-                numberLocalSegments = 2;
-                chunk->addScatterGatherListSegment(p2, l2);
-            }
+        status = write(buffers[bufferIndex].first + bufferOffset, count);
+        if (status.success() && Container::WriteSuccessful(status).bytesWritten() == count) {
+            status = Container::NoStatus();
         }
 
-        chunk->addScatterGatherListSegment(const_cast<std::uint8_t*>(bufferSegment), remainingInBuffer);
-        status = chunk->save();
+        advanceBuffers(buffers, numberBuffers, count, &bufferIndex, &bufferOffset);
+    }
 
-        if (!status) {
-            unsigned freeSpaceAdjustment = ChunkHeader::toFileIndex(chunk->chunkSize());
-            reservedFreeSpace.reduceBy(freeSpaceAdjustment, FreeSpace::Side::FROM_FRONT);
+    if (!status && bufferIndex < numberBuffers && bufferOffset > 0) {
+        unsigned count = buffers[bufferIndex].second - bufferOffset;
 
-            container->releaseReservation(reservedFreeSpace);
+        status = append(buffers[bufferIndex].first + bufferOffset, count);
+        if (status.success() && Container::WriteSuccessful(status).bytesWritten() == count) {
+            status = Container::NoStatus();
+        }
 
-            unsigned writtenTailBuffer = 0;
-            for (unsigned i=0 ; i<numberLocalSegments ; ++i) {
-                writtenTailBuffer += chunk->scatterGatherListSegment(i).processedCount();
-            }
+        ++bufferIndex;
+    }
 
-            bool success = tailBuffer.bulkExtractionFinish(writtenTailBuffer);
-            (void) success;
-            assert(success);
+    if (!status && bufferIndex < numberBuffers) {
+        unsigned count = 0;
+        for (unsigned i=bufferIndex ; i<numberBuffers ; ++i) {
+            count += buffers[i].second;
+        }
+
+        status = appendv(buffers + bufferIndex, numberBuffers - bufferIndex);
+        if (status.success() && Container::WriteSuccessful(status).bytesWritten() == count) {
+            status = Container::NoStatus();
+        }
+    }
+
+    if (!status) {
+        status = Container::WriteSuccessful(desiredCount);
+    }
+
+    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
+    if (container) {
+        container->setLastStatus(status);
+    }
+
+    return status;
+}
+
+
+Container::Status VirtualFileImpl::write(std::vector<std::uint8_t>&& buffer) {
+    Container::Status status;
+
+    std::vector<std::uint8_t> data(std::move(buffer));
+    unsigned                  desiredCount = static_cast<unsigned>(data.size());
 
-            unsigned writtenFromCall = chunk->scatterGatherListSegment(numberLocalSegments).processedCount();
-            assert(writtenFromCall <= remainingInBuffer);
+    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
+
+    bool adoptBuffer = (
+           container
+        && !container->containerScanNeeded()
+        && stagingActive(*container)
+        && pendingExtent.empty()
+        && tailBuffer.empty()
+        && currentPosition == currentStoredSize()
+    );
+
+    if (adoptBuffer) {
+        // The buffer becomes the staged data so that it can be compressed or shared without first being copied.
+        // Whatever does not fill an extent remains staged.
 
-            remainingInBuffer -= writtenFromCall;
-            bufferSegment     += writtenFromCall;
+        status = writeStreamStartIfNeeded(*container);
 
-            unsigned totalWrittenThisChunk = writtenTailBuffer + writtenFromCall;
+        if (!status) {
+            pendingExtent.swap(data);
+            status = flushPendingExtent(*container, false);
+        }
 
-            addChunkLocation(chunk->fileIndex(), chunk->chunkOffset(), totalWrittenThisChunk);
+        if (!status) {
+            currentPosition = size();
+            status          = Container::WriteSuccessful(desiredCount);
         }
+
+        status = applyWriteBufferBudget(*container, status);
+        container->setLastStatus(status);
+    } else {
+        status = write(data.data(), desiredCount);
     }
 
-    // If we have any data left, store it into the local buffer.
-    if (!status && remainingInBuffer > 0) {
-        unsigned      storedBytes = remainingInBuffer;
-        std::uint8_t* p1;
-        unsigned      l1;
-        std::uint8_t* p2;
-        unsigned      l2;
+    return status;
+}
+
+
+Container::Status VirtualFileImpl::append(const std::uint8_t* buffer, unsigned desiredCount) {
+    Container::VirtualFile::WriteBuffer writeBuffer(buffer, desiredCount);
+    return appendv(&writeBuffer, 1);
+}
+
+
+Container::Status VirtualFileImpl::appendv(const Container::VirtualFile::WriteBuffer* buffers, unsigned numberBuffers) {
+    Container::Status status;
+
+    unsigned desiredCount = 0;
+    for (unsigned i=0 ; i<numberBuffers ; ++i) {
+        desiredCount += buffers[i].second;
+    }
+
+    unsigned remainingInBuffers = desiredCount;
+    unsigned bufferIndex        = 0; // The buffer holding the next byte to be written.
+    unsigned bufferOffset       = 0; // The offset of the next byte to be written in the buffer.
+
+    advanceBuffers(buffers, numberBuffers, 0, &bufferIndex, &bufferOffset);
 
-        unsigned availableSpace = tailBuffer.bulkInsertionStart(&p1, &l1, &p2, &l2);
-        (void) availableSpace;
-        assert(availableSpace > remainingInBuffer);
+    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
+    if (!container) {
+        status = Container::ContainerUnavailable();
+    } else {
+        status = writeStreamStartIfNeeded(*container);
+    }
+
+    if (!status && container->containerScanNeeded()) {
+        status = container->scanContainer();
+    }
+
+    if (!status && !stagingActive(*container) && !delayedAllocationActive(*container) && !pendingExtent.empty()) {
+        // Deduplication or delayed allocation was disabled while data was staged.  Write the staged data so the tail
+        // buffer can be used.
 
-        unsigned countP1 = (l1 < remainingInBuffer) ? l1 : remainingInBuffer;
-        std::memcpy(p1, bufferSegment, countP1);
+        status = flushPendingExtent(*container, true);
+    }
 
-        remainingInBuffer -= countP1;
-        bufferSegment     += countP1;
+    if (!status && stagingActive(*container)) {
+        // Data is staged uncompressed until a full extent is available so that each extent can be compressed or
+        // shared independently.  The tail buffer is not used.
 
-        if (remainingInBuffer > 0) {
-            assert(p2 != nullptr && l2 >= remainingInBuffer);
-            std::memcpy(p2, bufferSegment, remainingInBuffer);
+        if (tailBuffer.notEmpty()) {
+            status = flush();
         }
 
-        bool success = tailBuffer.bulkInsertionFinish(storedBytes);
-        (void) success;
-        assert(success);
+        while (!status && remainingInBuffers > 0) {
+            const std::uint8_t* bufferSegment      = buffers[bufferIndex].first + bufferOffset;
+            unsigned            remainingInSegment = buffers[bufferIndex].second - bufferOffset;
+            unsigned            pendingCount       = static_cast<unsigned>(pendingExtent.size());
+            unsigned            available          = CompressionEngine::maximumBlockSize - pendingCount;
+            unsigned            bytesToStage       = remainingInSegment < available ? remainingInSegment : available;
+
+            pendingExtent.insert(pendingExtent.end(), bufferSegment, bufferSegment + bytesToStage);
+
+            remainingInBuffers -= bytesToStage;
+            advanceBuffers(buffers, numberBuffers, bytesToStage, &bufferIndex, &bufferOffset);
+
+            if (pendingExtent.size() >= CompressionEngine::maximumBlockSize) {
+                status = flushPendingExtent(*container, false);
+            }
+        }
+    }
+
+    if (!status && delayedAllocationActive(*container)) {
+        // Appended data is held in memory and is only assigned container space when the write cache budget is
+        // reached or the file is flushed.  The whole run can then be placed in a single free space region.  Data in
+        // the tail buffer joins the run.
+
+        if (tailBuffer.notEmpty()) {
+            std::uint8_t* p1;
+            unsigned      l1;
+            std::uint8_t* p2;
+            unsigned      l2;
+
+            unsigned tailBufferCount = tailBuffer.bulkExtractionStart(&p1, &l1, &p2, &l2);
+
+            pendingExtent.insert(pendingExtent.end(), p1, p1 + l1);
+            if (p2 != nullptr) {
+                pendingExtent.insert(pendingExtent.end(), p2, p2 + l2);
+            }
+
+            tailBuffer.bulkExtractionFinish(tailBufferCount);
+
+            tailBufferCrc      = 0;
+            tailBufferCrcValid = true;
+        }
+
+        while (!status && remainingInBuffers > 0) {
+            const std::uint8_t* bufferSegment      = buffers[bufferIndex].first + bufferOffset;
+            unsigned            remainingInSegment = buffers[bufferIndex].second - bufferOffset;
+            unsigned long long  pendingCount       = pendingExtent.size();
+            unsigned long long  available          =   pendingCount < maximumWriteCacheBytes
+                                                     ? maximumWriteCacheBytes - pendingCount
+                                                     : 0;
+            unsigned            bytesToStage       =   remainingInSegment < available
+                                                     ? remainingInSegment
+                                                     : static_cast<unsigned>(available);
+
+            pendingExtent.insert(pendingExtent.end(), bufferSegment, bufferSegment + bytesToStage);
+
+            remainingInBuffers -= bytesToStage;
+            advanceBuffers(buffers, numberBuffers, bytesToStage, &bufferIndex, &bufferOffset);
+
+            if (pendingExtent.size() >= maximumWriteCacheBytes) {
+                status = writeDelayedExtent(*container);
+            }
+        }
+    }
+
+    if (!status && remainingInBuffers > 0 && tailBuffer.available() <= remainingInBuffers) {
+        status = spillInlinePayload(*container);
+    }
+
+    while (!status && remainingInBuffers > 0) {
+        const std::uint8_t* bufferSegment      = buffers[bufferIndex].first + bufferOffset;
+        unsigned            remainingInSegment = buffers[bufferIndex].second - bufferOffset;
+
+        if (tailBuffer.available() <= remainingInSegment) {
+            // This buffer can complete a chunk so write out a chunk holding the tail buffer followed by this buffer
+            // and as many of the following buffers as the scatter-gather list will hold.
+            //
+            // Large appends use extended chunks, if supported, so that the payload is written using fewer, larger
+            // I/O operations.  The chunk is sized based on the data that can be referenced by the scatter-gather list
+            // so that the chunk will be filled.
+
+            std::uint8_t* p1 = nullptr;
+            unsigned      l1 = 0;
+            std::uint8_t* p2 = nullptr;
+            unsigned      l2 = 0;
+
+            unsigned tailBufferCount = tailBuffer.empty() ? 0 : tailBuffer.bulkExtractionStart(&p1, &l1, &p2, &l2);
+            assert(tailBufferCount == l1 + l2);
+
+            // A partly filled last chunk is rewritten along with this chunk so that data appended between frequent
+            // flushes isn't left in small chunks.
+
+            std::vector<std::uint8_t> reopened;
+            reopenLastChunk(*container, reopened);
+
+            unsigned reopenedCount       = static_cast<unsigned>(reopened.size());
+            unsigned firstTailSegment    = reopenedCount > 0 ? 1 : 0;
+            unsigned numberLocalSegments = (l1 > 0 ? 1 : 0) + (l2 > 0 ? 1 : 0);
+
+            unsigned long long gatheredBytes = reopenedCount + tailBufferCount;
+            unsigned           gatherIndex   = bufferIndex;
+            unsigned           gatherOffset  = bufferOffset;
+            unsigned           gatherCount   = firstTailSegment + numberLocalSegments;
+
+            while (gatherIndex < numberBuffers && gatherCount < StreamDataChunk::maximumScatterGatherListSize) {
+                if (buffers[gatherIndex].second > gatherOffset) {
+                    gatheredBytes += buffers[gatherIndex].second - gatherOffset;
+                    ++gatherCount;
+                }
+
+                ++gatherIndex;
+                gatherOffset = 0;
+            }
+
+            unsigned desiredChunkSize = StreamDataChunk::preferredChunkSize(
+                gatheredBytes,
+                container->supportsExtendedChunks()
+            );
+
+            FreeSpace reservedFreeSpace = reserveReopenedChunkArea(
+                *container,
+                reopenedCount,
+                gatheredBytes,
+                ChunkHeader::toFileIndex(desiredChunkSize)
+            );
+
+            StreamDataChunk chunk(
+                *container,
+                reservedFreeSpace.startingIndex(),
+                currentStreamIdentifier,
+                currentStoredSize() - reopenedCount
+            );
+
+            chunk.setChunkSize(static_cast<unsigned>(ChunkHeader::toPosition(reservedFreeSpace.areaSize())));
+
+            if (reopenedCount > 0) {
+                chunk.addScatterGatherListSegment(reopened.data(), reopenedCount);
+            }
+
+            if (l1 > 0) {
+                chunk.addScatterGatherListSegment(p1, l1);
+            }
+
+            if (l2 > 0) {
+                chunk.addScatterGatherListSegment(p2, l2);
+            }
+
+            if (tailBufferCount > 0 && tailBufferCrcValid && reopenedCount == 0) {
+                chunk.setLeadingPayloadCrc(tailBufferCrc, tailBufferCount);
+            }
+
+            gatherIndex  = bufferIndex;
+            gatherOffset = bufferOffset;
+
+            while (gatherIndex < numberBuffers && chunk.scatterGatherListSize() < gatherCount) {
+                if (buffers[gatherIndex].second > gatherOffset) {
+                    chunk.addScatterGatherListSegment(
+                        const_cast<std::uint8_t*>(buffers[gatherIndex].first + gatherOffset),
+                        buffers[gatherIndex].second - gatherOffset
+                    );
+                }
+
+                ++gatherIndex;
+                gatherOffset = 0;
+            }
+
+            status = chunk.save();
+
+            if (!status) {
+                if (reopenedCount > 0) {
+                    releaseReopenedChunkArea(*container, reservedFreeSpace, chunk.chunkSize());
+                } else {
+                    releaseChunkArea(*container, reservedFreeSpace, chunk.chunkSize());
+                }
+
+                assert(reopenedCount == 0 || chunk.scatterGatherListSegment(0).processedCount() == reopenedCount);
+
+                unsigned writtenTailBuffer = 0;
+                for (unsigned i=firstTailSegment ; i<firstTailSegment + numberLocalSegments ; ++i) {
+                    writtenTailBuffer += chunk.scatterGatherListSegment(i).processedCount();
+                }
+
+                bool success = tailBuffer.bulkExtractionFinish(writtenTailBuffer);
+                (void) success;
+                assert(success);
+
+                if (tailBuffer.empty()) {
+                    tailBufferCrc      = 0;
+                    tailBufferCrcValid = true;
+                } else {
+                    tailBufferCrcValid = false;
+                }
+
+                unsigned writtenFromCall = 0;
+                for (unsigned i=firstTailSegment + numberLocalSegments ; i<chunk.scatterGatherListSize() ; ++i) {
+                    writtenFromCall += chunk.scatterGatherListSegment(i).processedCount();
+                }
+
+                assert(writtenFromCall <= remainingInBuffers);
+
+                remainingInBuffers -= writtenFromCall;
+                advanceBuffers(buffers, numberBuffers, writtenFromCall, &bufferIndex, &bufferOffset);
+
+                unsigned totalWrittenThisChunk = reopenedCount + writtenTailBuffer + writtenFromCall;
+
+                addChunkLocation(
+                    chunk.fileIndex(),
+                    ChunkHeader::toFileIndex(chunk.chunkSize()),
+                    chunk.chunkOffset(),
+                    totalWrittenThisChunk,
+                    false
+                );
+
+                lastChunkReopenable = false;
+            }
+        } else {
+            // This buffer will not complete a chunk, store it into the tail buffer.
+
+            std::uint8_t* p1;
+            unsigned      l1;
+            std::uint8_t* p2;
+            unsigned      l2;
+
+            unsigned availableSpace = tailBuffer.bulkInsertionStart(&p1, &l1, &p2, &l2);
+            (void) availableSpace;
+            assert(availableSpace > remainingInSegment);
+
+            // The CRC is calculated as the data is copied so that the data does not need to be scanned again when the
+            // tail buffer is written to the container.  Containers using payload checksums only protect the chunk
+            // header with the 16-bit CRC so the data is simply copied.
+
+            bool     calculateCrc = !container->usesPayloadChecksums();
+            unsigned countP1      = (l1 < remainingInSegment) ? l1 : remainingInSegment;
+            unsigned countP2      = remainingInSegment - countP1;
+
+            if (calculateCrc) {
+                tailBufferCrc = CrcEngine::copyAndCalculate(tailBufferCrc, p1, bufferSegment, countP1);
+            } else {
+                std::memcpy(p1, bufferSegment, countP1);
+                tailBufferCrcValid = false;
+            }
+
+            if (countP2 > 0) {
+                assert(p2 != nullptr && l2 >= countP2);
+
+                if (calculateCrc) {
+                    tailBufferCrc = CrcEngine::copyAndCalculate(tailBufferCrc, p2, bufferSegment + countP1, countP2);
+                } else {
+                    std::memcpy(p2, bufferSegment + countP1, countP2);
+                }
+            }
+
+            bool success = tailBuffer.bulkInsertionFinish(remainingInSegment);
+            (void) success;
+            assert(success);
+
+            remainingInBuffers -= remainingInSegment;
+            advanceBuffers(buffers, numberBuffers, remainingInSegment, &bufferIndex, &bufferOffset);
+        }
     }
 
     if (!status) {
@@ -670,6 +1428,51 @@ Container::Status VirtualFileImpl::append(const std::uint8_t* buffer, unsigned d
         status = Container::WriteSuccessful(desiredCount);
     }
 
+    if (container) {
+        status = applyWriteBufferBudget(*container, status);
+        container->setLastStatus(status);
+    }
+
+    return status;
+}
+
+
+Container::Status VirtualFileImpl::reserve(unsigned long long expectedSize) {
+    Container::Status status;
+
+    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
+    if (!container) {
+        status = Container::ContainerUnavailable();
+    }
+
+    if (!status && container->containerScanNeeded()) {
+        status = container->scanContainer();
+    }
+
+    if (!status) {
+        releaseReservedArea(*container);
+
+        if (expectedSize > 0) {
+            // The stream start chunk must precede the file's data so we place it before the reserved area.
+            status = writeStreamStartIfNeeded(*container);
+        }
+
+        if (!status && expectedSize > 0) {
+            // Size the area assuming the data will be written through the chunk buffer.  Larger chunks used for
+            // large appends carry proportionally less header overhead and will also fit.
+
+            unsigned chunkSize     = ChunkHeader::maximumChunkSize;
+            unsigned chunkCapacity = StreamDataChunk::payloadCapacity(*container, chunkSize);
+
+            unsigned long long numberChunks = (expectedSize + chunkCapacity - 1) / chunkCapacity;
+            status = container->allocateContiguousArea(
+                lastKnownFileIndex(),
+                ChunkHeader::toFileIndex(numberChunks * chunkSize),
+                &reservedArea
+            );
+        }
+    }
+
     if (container) {
         container->setLastStatus(status);
     }
@@ -678,7 +1481,12 @@ Container::Status VirtualFileImpl::append(const std::uint8_t* buffer, unsigned d
 }
 
 
-Container::Status VirtualFileImpl::truncate() {
+unsigned long long VirtualFileImpl::bytesReserved() const {
+    return ChunkHeader::toPosition(reservedArea.areaSize());
+}
+
+
+Container::Status VirtualFileImpl::truncate(bool verify) {
     Container::Status status;
 
     std::shared_ptr<ContainerImpl> container = currentContainer.lock();
@@ -697,14 +1505,51 @@ Container::Status VirtualFileImpl::truncate() {
 
         assert(pos != chunkMap.end());
 
-        if (pos->first < currentPosition) {
+        if (pos->first < currentPosition && pos->second.inlined()) {
+            // We must preserve a portion of an inline payload.  The stream start chunk is rewritten with the portion
+            // we keep.
+
+            std::uint8_t payload[StreamStartChunk::maximumInlinePayloadSize];
+            unsigned     bytesToKeep = static_cast<unsigned>(currentPosition - pos->first);
+
+            currentChunk = chunkMap.end();
+            status = loadInlinePayload(*container, pos, payload);
+
+            if (!status) {
+                status = saveStreamStart(*container, currentName, payload, bytesToKeep);
+            }
+
+            if (!status) {
+                pos->second.setPayloadSize(bytesToKeep);
+                ++pos;
+            }
+        } else if (pos->first < currentPosition && (pos->second.compressed() || pos->second.shared())) {
+            // We must preserve a portion of a compressed or shared extent.  Load the extent and rewrite the portion
+            // we keep.
+
+            currentChunk = pos;
+            status = loadChunkIntoBuffer(*container);
+
+            if (!status) {
+                currentChunk = chunkMap.end();
+                unsigned bytesToKeep = static_cast<unsigned>(currentPosition - pos->first);
+                status = relocateExtent(*container, pos, chunkBuffer, bytesToKeep);
+            }
+
+            if (!status) {
+                pos = chunkMap.lower_bound(currentPosition);
+            }
+        } else if (pos->first < currentPosition) {
             // We must preserve a portion of the first chunk.
 
             ChunkHeader::FileIndex startingIndex  = pos->second.startingIndex();
             unsigned long long     startingOffset = pos->first;
 
-            std::uint8_t buffer[ChunkHeader::maximumChunkSize];
-            StreamDataChunk oldChunk(currentContainer, startingIndex, currentStreamIdentifier, startingOffset);
+            reserveChunkBuffer(pos->second.payloadSize());
+            currentChunk = chunkMap.end(); // The chunk buffer is reused below.
+
+            std::uint8_t*   buffer = chunkBuffer;
+            StreamDataChunk oldChunk(*container, startingIndex, currentStreamIdentifier, startingOffset);
 
             if (!status && oldChunk.streamIdentifier() != currentStreamIdentifier) {
                 status = Container::StreamIdentifierMismatch(
@@ -723,12 +1568,16 @@ Container::Status VirtualFileImpl::truncate() {
             }
 
             if (!status) {
-                oldChunk.addScatterGatherListSegment(buffer, ChunkHeader::maximumChunkSize);
+                oldChunk.addScatterGatherListSegment(buffer, chunkBufferCapacity);
                 status = oldChunk.load(true);
             }
 
             if (!status) {
-                StreamDataChunk newChunk(currentContainer, startingIndex, currentStreamIdentifier, startingOffset);
+                status = container->verifyChunk(oldChunk);
+            }
+
+            if (!status) {
+                StreamDataChunk newChunk(*container, startingIndex, currentStreamIdentifier, startingOffset);
                 newChunk.setChunkSize(oldChunk.chunkSize());
 
                 unsigned long long bytesThisChunk = currentPosition - startingOffset;
@@ -749,6 +1598,7 @@ Container::Status VirtualFileImpl::truncate() {
                         ChunkHeader::FileIndex newChunkSize = ChunkHeader::toFileIndex(newChunk.chunkSize());
 
                         container->newFreeSpaceArea(startingIndex + newChunkSize, oldChunkSize - newChunkSize, true);
+                        pos->second.setAreaSize(newChunkSize);
                     }
 
                     ++pos;
@@ -758,11 +1608,1400 @@ Container::Status VirtualFileImpl::truncate() {
 
         // Now wipe out any and all remaining chunks.
 
-        while (!status && pos != chunkMap.end()) {
-            ChunkHeader::FileIndex startingIndex  = pos->second.startingIndex();
-            unsigned long long     startingOffset = pos->first;
+        if (!status && pos != chunkMap.end() && pos->second.inlined()) {
+            status = saveStreamStart(*container, currentName, nullptr, 0);
+        }
+
+        std::vector<ContainerArea> areasToRelease;
+        if (!status) {
+            status = collectChunkAreas(*container, pos, verify, areasToRelease);
+        }
+
+        if (!status) {
+            std::vector<ContainerArea>::const_iterator areaIterator = areasToRelease.cbegin();
+            std::vector<ContainerArea>::const_iterator areaEnd      = areasToRelease.cend();
+            while (areaIterator != areaEnd) {
+                container->newFreeSpaceArea(*areaIterator, true);
+                ++areaIterator;
+            }
+
+            for (ChunkMap::iterator it=pos,end=chunkMap.end() ; it!=end ; ++it) {
+                if (it->second.shared()) {
+                    container->releaseSharedChunk(it->second.sharedIndex());
+                }
+            }
+
+            chunkMap.erase(pos, chunkMap.end());
+            currentChunk = chunkMap.end();
+        }
+    }
+
+    readCache.clear();
+
+    return status;
+}
+
+
+Container::Status VirtualFileImpl::flush() {
+    Container::Status status;
+
+    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
+    if (!container) {
+        status = Container::ContainerUnavailable();
+    } else {
+        status = writeBufferedData(*container);
+    }
+
+    if (!status) {
+        releaseReservedArea(*container);
+    }
+
+    if (container) {
+        reportBufferedBytes(*container);
+        container->setLastStatus(status);
+    }
+
+    return status;
+}
+
+
+Container::Status VirtualFileImpl::releaseBuffers() {
+    Container::Status status;
+
+    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
+    if (!container) {
+        status = Container::ContainerUnavailable();
+    } else {
+        status = writeBufferedData(*container);
+    }
+
+    if (!status) {
+        // Give the memory back, not just the data, so idle files cost little.  The buffers are recreated when the
+        // file is next used.
+
+        if (chunkBuffer != nullptr) {
+            delete[] chunkBuffer;
+
+            chunkBuffer         = nullptr;
+            chunkBufferCapacity = 0;
+            currentChunk        = chunkMap.end();
+        }
+
+        std::vector<std::uint8_t>().swap(pendingExtent);
+    }
+
+    if (container) {
+        reportBufferedBytes(*container);
+    }
+
+    return status;
+}
+
+
+Container::Status VirtualFileImpl::erase(bool verify, bool updateMedia) {
+    Container::Status status;
+
+    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
+    if (!container) {
+        status = Container::ContainerUnavailable();
+    }
+
+    if (!status && container->containerScanNeeded()) {
+        status = container->scanContainer();
+    }
+
+    if (!status) {
+        releaseReservedArea(*container);
+    }
+
+    std::vector<ContainerArea>          areasToRelease;
+    std::vector<ChunkHeader::FileIndex> sharedChunksToRelease;
+
+    if (!status && startChunkIndex != ChunkHeader::invalidFileIndex) {
+        StreamStartChunk chunk(*container, startChunkIndex, currentName, currentStreamIdentifier);
+        status = chunk.load(true);
+
+        if (!status && chunk.streamIdentifier() != currentStreamIdentifier) {
+            status = Container::StreamIdentifierMismatch(
+                chunk.streamIdentifier(),
+                currentStreamIdentifier,
+                ChunkHeader::toPosition(chunk.fileIndex())
+            );
+        }
+
+        if (!status && chunk.virtualFilename() != currentName) {
+            status = Container::FilenameMismatch(
+                chunk.virtualFilename(),
+                currentName,
+                ChunkHeader::toPosition(startChunkIndex)
+            );
+        }
+
+        if (!status) {
+            areasToRelease.push_back(ContainerArea(startChunkIndex, ChunkHeader::toFileIndex(chunk.chunkSize())));
+        }
+    }
+
+    if (!status) {
+        status = collectChunkAreas(*container, chunkMap.begin(), verify, areasToRelease);
+    }
+
+    for (ChunkMap::iterator pos=chunkMap.begin(),end=chunkMap.end() ; pos!=end ; ++pos) {
+        if (pos->second.shared()) {
+            sharedChunksToRelease.push_back(pos->second.sharedIndex());
+        }
+    }
+
+    if (!status) {
+        for (std::vector<ContainerArea>::iterator it=areasToRelease.begin(),end=areasToRelease.end() ; it!=end ; ++it) {
+            container->newFreeSpaceArea(it->startingIndex(), it->areaSize(), true);
+        }
+
+        for (unsigned i=0 ; i<sharedChunksToRelease.size() ; ++i) {
+            container->releaseSharedChunk(sharedChunksToRelease[i]);
+        }
+
+        if (updateMedia) {
+            bool success = container->flushFreeSpace();
+            if (!success) {
+                status = container->lastStatus();
+            }
+        }
+    }
+
+    if (!status) {
+        writeCache.clear();
+        writeCacheBytes = 0;
+        readCache.clear();
+
+        container->bufferedBytesChanged(reportedBufferedBytes, 0);
+        reportedBufferedBytes = 0;
+
+        bool success = container->fileErased(currentName);
+        (void) success;
+        assert(success);
+
+        container->setLastStatus(status);
+
+        container.reset();
+        currentContainer.reset();
+    } else {
+        if (container) {
+            container->setLastStatus(status);
+        }
+    }
+
+    return status;
+}
+
+
+void VirtualFileImpl::detach() {
+    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
+    if (container) {
+        container->bufferedBytesChanged(reportedBufferedBytes, 0);
+    }
+
+    if (chunkBuffer != nullptr) {
+        delete[] chunkBuffer;
+
+        chunkBuffer         = nullptr;
+        chunkBufferCapacity = 0;
+    }
+
+    chunkMap.clear();
+    writeCache.clear();
+    readCache.clear();
+    tailBuffer.clear();
+    std::vector<std::uint8_t>().swap(pendingExtent);
+
+    startChunkIndex        = ChunkHeader::invalidFileIndex;
+    startChunkSize         = 0;
+    chunkBufferFlushNeeded = false;
+    writeCacheBytes        = 0;
+    reportedBufferedBytes  = 0;
+    tailBufferCrc          = 0;
+    tailBufferCrcValid     = true;
+    currentChunk           = chunkMap.end();
+    reservedArea           = ContainerArea();
+
+    currentContainer.reset();
+}
+
+
+Container::Status VirtualFileImpl::setCompression(Container::VirtualFile::Compression newCompression) {
+    Container::Status status;
+
+    if (newCompression != currentCompression) {
+        // Pending data is held differently when compression is active so we push it to the container first.
+
+        if (tailBuffer.notEmpty() || !pendingExtent.empty()) {
+            status = flush();
+        }
+
+        if (!status) {
+            currentCompression = newCompression;
+        }
+    }
+
+    return status;
+}
+
+
+Container::VirtualFile::Compression VirtualFileImpl::compression() const {
+    return currentCompression;
+}
+
+
+Container::Status VirtualFileImpl::setWriteCacheSize(unsigned long long newSize) {
+    Container::Status status;
+
+    if (writeCacheBytes > newSize || pendingExtent.size() > newSize) {
+        std::shared_ptr<ContainerImpl> container = currentContainer.lock();
+        if (!container) {
+            status = Container::ContainerUnavailable();
+        } else {
+            status = flushWriteCache(*container);
+
+            if (!status && !stagingActive(*container) && !pendingExtent.empty()) {
+                status = writeDelayedExtent(*container);
+            }
+
+            reportBufferedBytes(*container);
+        }
+    }
+
+    if (!status) {
+        maximumWriteCacheBytes = newSize;
+    }
+
+    return status;
+}
+
+
+unsigned long long VirtualFileImpl::writeCacheSize() const {
+    return maximumWriteCacheBytes;
+}
+
+
+void VirtualFileImpl::setReadCacheSize(unsigned numberChunks) {
+    maximumReadCacheEntries = numberChunks;
+
+    while (readCache.size() > maximumReadCacheEntries) {
+        readCache.pop_back();
+    }
+}
+
+
+unsigned VirtualFileImpl::readCacheSize() const {
+    return maximumReadCacheEntries;
+}
+
+
+unsigned long long VirtualFileImpl::readCacheHits() const {
+    return readCacheHitCount;
+}
+
+
+unsigned long long VirtualFileImpl::readCacheMisses() const {
+    return readCacheMissCount;
+}
+
+
+Container::Status VirtualFileImpl::rename(const std::string& newName) {
+    Container::Status status;
+
+    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
+    if (!container) {
+        status = Container::ContainerUnavailable();
+    }
+
+    std::string oldName = currentName;
+
+    if (!status && oldName != newName) {
+        if (startChunkIndex != ChunkHeader::invalidFileIndex) {
+            // Any inline payload must be carried over as it's held in the stream start chunk.
+
+            std::uint8_t payload[StreamStartChunk::maximumInlinePayloadSize];
+            unsigned     count = 0;
+
+            if (!chunkMap.empty() && chunkMap.begin()->second.inlined()) {
+                count  = chunkMap.begin()->second.payloadSize();
+                status = loadInlinePayload(*container, chunkMap.begin(), payload);
+            }
+
+            if (!status) {
+                status = saveStreamStart(*container, newName, payload, count);
+            }
+        }
+
+        if (!status) {
+            currentName = newName;
+
+            bool success = currentContainer.lock()->fileRenamed(oldName, newName);
+            (void) success;
+            assert(success);
+        }
+    }
+
+    if (container) {
+        container->setLastStatus(status);
+    }
+
+    return status;
+}
+
+
+void VirtualFileImpl::addChunkLocation(
+        ChunkHeader::FileIndex startingIndex,
+        ChunkHeader::FileIndex areaSize,
+        unsigned long long     baseOffset,
+        unsigned               payloadSize,
+        bool                   compressed,
+        ChunkHeader::FileIndex sharedIndex,
+        bool                   inlined
+    ) {
+    ChunkMap::iterator pos = chunkMap.find(baseOffset);
+
+    if (pos != chunkMap.end()) {
+        invalidateReadCache(baseOffset);
+        pos->second = ChunkMapData(startingIndex, areaSize, payloadSize, compressed, sharedIndex, inlined);
+    } else {
+        chunkMap.insert(
+            ChunkMapPair(
+                baseOffset,
+                ChunkMapData(startingIndex, areaSize, payloadSize, compressed, sharedIndex, inlined)
+            )
+        );
+    }
+
+    if (inlined) {
+        startChunkSize = areaSize;
+    }
+}
+
+
+Container::Status VirtualFileImpl::writeBufferedData(ContainerImpl& container) {
+    Container::Status status;
+
+    if (inlinePayloadFits(container)) {
+        status = writeInlinePayload(container);
+    } else {
+        status = writeStreamStartIfNeeded(container);
+    }
+
+    if (!status && chunkBufferFlushNeeded) {
+        status = flushChunkBuffer(container);
+    }
+
+    if (!status && !writeCache.empty()) {
+        status = flushWriteCache(container);
+    }
+
+    if (!status && (!pendingExtent.empty() || tailBuffer.notEmpty())) {
+        status = spillInlinePayload(container);
+    }
+
+    if (!status && !pendingExtent.empty()) {
+        status = flushPendingExtent(container, true);
+    }
+
+    if (!status) {
+        while (!status && tailBuffer.notEmpty()) {
+            std::uint8_t* p1;
+            unsigned      l1;
+            std::uint8_t* p2;
+            unsigned      l2;
+
+            // A partly filled last chunk is rewritten along with the tail buffer so that frequent flushes don't leave
+            // a trail of small chunks behind.
+
+            std::vector<std::uint8_t> reopened;
+            reopenLastChunk(container, reopened);
+
+            unsigned reopenedCount = static_cast<unsigned>(reopened.size());
+
+            FreeSpace reservedFreeSpace = reserveReopenedChunkArea(
+                container,
+                reopenedCount,
+                reopenedCount + tailBuffer.count(),
+                ChunkHeader::toFileIndex(ChunkHeader::maximumChunkSize)
+            );
+
+            StreamDataChunk chunk(
+                container,
+                reservedFreeSpace.startingIndex(),
+                currentStreamIdentifier,
+                currentStoredSize() - reopenedCount
+            );
+
+            chunk.setChunkSize(static_cast<unsigned>(ChunkHeader::toPosition(reservedFreeSpace.areaSize())));
+
+            if (reopenedCount > 0) {
+                chunk.addScatterGatherListSegment(reopened.data(), reopenedCount);
+            }
+
+            unsigned tailBufferCount = tailBuffer.bulkExtractionStart(&p1, &l1, &p2, &l2);
+            chunk.addScatterGatherListSegment(p1, l1);
+            if (p2 != nullptr) {
+                chunk.addScatterGatherListSegment(p2, l2);
+            }
+
+            if (tailBufferCrcValid && reopenedCount == 0) {
+                chunk.setLeadingPayloadCrc(tailBufferCrc, tailBufferCount);
+            }
+
+            status = chunk.save();
+
+            if (!status) {
+                if (reopenedCount > 0) {
+                    releaseReopenedChunkArea(container, reservedFreeSpace, chunk.chunkSize());
+                } else {
+                    releaseChunkArea(container, reservedFreeSpace, chunk.chunkSize());
+                }
+
+                unsigned numberBytesWritten = 0;
+                for (unsigned i=0 ; i<chunk.scatterGatherListSize() ; ++i) {
+                    numberBytesWritten += chunk.scatterGatherListSegment(i).processedCount();
+                }
+
+                assert(reopenedCount == 0 || chunk.scatterGatherListSegment(0).processedCount() == reopenedCount);
+                numberBytesWritten -= reopenedCount;
+
+                assert(numberBytesWritten <= tailBuffer.count()); // Verify that we're sane.
+
+                addChunkLocation(
+                    chunk.fileIndex(),
+                    ChunkHeader::toFileIndex(chunk.chunkSize()),
+                    chunk.chunkOffset(),
+                    reopenedCount + numberBytesWritten,
+                    false
+                );
+
+                lastChunkReopenable = true;
+
+                tailBuffer.bulkExtractionFinish(numberBytesWritten);
+
+                if (tailBuffer.empty()) {
+                    tailBufferCrc      = 0;
+                    tailBufferCrcValid = true;
+                } else {
+                    tailBufferCrcValid = false;
+                }
+            }
+        }
+    }
+
+    return status;
+}
+
+
+void VirtualFileImpl::reportBufferedBytes(ContainerImpl& container) {
+    unsigned long long bufferedBytes = bytesInWriteCache();
+
+    container.bufferedBytesChanged(reportedBufferedBytes, bufferedBytes);
+    reportedBufferedBytes = bufferedBytes;
+}
+
+
+Container::Status VirtualFileImpl::applyWriteBufferBudget(ContainerImpl& container, const Container::Status& status) {
+    Container::Status result = status;
+
+    reportBufferedBytes(container);
+
+    if (status.success()) {
+        Container::Status budgetStatus = container.enforceWriteBufferBudget();
+        if (budgetStatus) {
+            result = budgetStatus;
+        }
+    }
+
+    return result;
+}
+
+
+Container::Status VirtualFileImpl::writeStreamStartIfNeeded(ContainerImpl& container) {
+    Container::Status status;
+
+    if (startChunkIndex == ChunkHeader::invalidFileIndex) {
+        status = saveStreamStart(container, currentName, nullptr, 0);
+    }
+
+    return status;
+}
+
+
+bool VirtualFileImpl::inlinePayloadFits(ContainerImpl& container) {
+    bool result = false;
+
+    if (container.supportsInlinePayloads()                         &&
+        reservedArea.areaSize() == 0                                &&
+        (pendingExtent.size() > 0 || tailBuffer.notEmpty())            ) {
+        bool onlyInline = (
+               chunkMap.empty()
+            || (chunkMap.size() == 1 && chunkMap.begin()->second.inlined())
+        );
+
+        if (onlyInline) {
+            unsigned long long totalSize = currentStoredSize() + pendingExtent.size() + tailBuffer.count();
+            result = (totalSize <= StreamStartChunk::maximumInlinePayloadSize);
+        }
+    }
+
+    return result;
+}
+
+
+Container::Status VirtualFileImpl::writeInlinePayload(ContainerImpl& container) {
+    Container::Status status;
+
+    std::uint8_t payload[StreamStartChunk::maximumInlinePayloadSize];
+    unsigned     storedCount = static_cast<unsigned>(currentStoredSize());
+
+    if (storedCount > 0) {
+        ChunkMap::iterator pos = chunkMap.begin();
+
+        if (pos == currentChunk && chunkBufferFlushNeeded) {
+            std::memcpy(payload, chunkBuffer, storedCount);
+        } else {
+            status = loadExtent(container, pos, payload);
+        }
+    }
+
+    unsigned count = storedCount;
+    if (!status) {
+        if (!pendingExtent.empty()) {
+            std::memcpy(payload + count, pendingExtent.data(), pendingExtent.size());
+            count += static_cast<unsigned>(pendingExtent.size());
+        } else {
+            unsigned tailBufferCount = tailBuffer.count();
+            for (unsigned i=0 ; i<tailBufferCount ; ++i) {
+                payload[count + i] = tailBuffer.snoop(i);
+            }
+
+            count += tailBufferCount;
+        }
+
+        status = saveStreamStart(container, currentName, payload, count);
+    }
+
+    if (!status) {
+        WriteCache::iterator cached = writeCache.find(0);
+        if (cached != writeCache.end()) {
+            writeCacheBytes -= cached->second.size();
+            writeCache.erase(cached);
+        }
+
+        pendingExtent.clear();
+        tailBuffer.clear();
+
+        tailBufferCrc          = 0;
+        tailBufferCrcValid     = true;
+        chunkBufferFlushNeeded = false;
+        currentChunk           = chunkMap.end();
+
+        addChunkLocation(startChunkIndex, startChunkSize, 0, count, false, ChunkHeader::invalidFileIndex, true);
+    }
+
+    return status;
+}
+
+
+Container::Status VirtualFileImpl::spillInlinePayload(ContainerImpl& container) {
+    Container::Status status;
+
+    if (!chunkMap.empty() && chunkMap.begin()->second.inlined()) {
+        ChunkMap::iterator pos   = chunkMap.begin();
+        unsigned           count = pos->second.payloadSize();
+        std::uint8_t       payload[StreamStartChunk::maximumInlinePayloadSize];
+
+        if (pos == currentChunk && chunkBufferFlushNeeded) {
+            std::memcpy(payload, chunkBuffer, count);
+        } else {
+            status = loadExtent(container, pos, payload);
+        }
+
+        if (!status) {
+            // No data chunks exist yet so the stream start chunk can be moved if it must grow.  Data chunks are then
+            // placed after it, as the container scan expects.
+
+            status = saveStreamStart(container, currentName, nullptr, 0);
+        }
+
+        if (!status) {
+            WriteCache::iterator cached = writeCache.find(0);
+            if (cached != writeCache.end()) {
+                writeCacheBytes -= cached->second.size();
+                writeCache.erase(cached);
+            }
+
+            chunkBufferFlushNeeded = false;
+            currentChunk           = chunkMap.end();
+
+            // The read cache may hold the payload from before the chunk buffer was modified.
+
+            invalidateReadCache(0);
+            chunkMap.erase(pos);
+
+            unsigned written = 0;
+            while (!status && written < count) {
+                unsigned bytesWritten;
+                status = writeExtent(
+                    container,
+                    written,
+                    payload + written,
+                    count - written,
+                    lastKnownFileIndex(),
+                    &bytesWritten
+                );
+
+                written += bytesWritten;
+            }
+
+            lastChunkReopenable = true;
+        }
+    }
+
+    return status;
+}
+
+
+Container::Status VirtualFileImpl::saveStreamStart(
+        ContainerImpl&      container,
+        const std::string&  virtualFilename,
+        const std::uint8_t* payload,
+        unsigned            count
+    ) {
+    Container::Status status;
+
+    StreamStartChunk chunk(container, startChunkIndex, virtualFilename, currentStreamIdentifier, count);
+    if (count > 0) {
+        chunk.setInlinePayload(payload);
+    }
+
+    ChunkHeader::FileIndex chunkSize = ChunkHeader::toFileIndex(chunk.chunkSize());
+
+    if (startChunkIndex != ChunkHeader::invalidFileIndex && startChunkSize == 0) {
+        // The size of a stream start chunk found by the container scan is only known if the chunk holds an inline
+        // payload so we read it from the media.
+
+        StreamStartChunk existing(container, startChunkIndex, currentName, currentStreamIdentifier);
+        status = existing.load(true);
+
+        if (!status) {
+            startChunkSize = ChunkHeader::toFileIndex(existing.chunkSize());
+        }
+    }
+
+    if (!status && startChunkIndex != ChunkHeader::invalidFileIndex && chunkSize <= startChunkSize) {
+        status = chunk.save();
+
+        if (!status && chunkSize < startChunkSize) {
+            container.newFreeSpaceArea(startChunkIndex + chunkSize, startChunkSize - chunkSize, true);
+        }
+    } else if (!status) {
+        FreeSpace reservedFreeSpace;
+        bool      adjacent = false;
+
+        if (startChunkIndex != ChunkHeader::invalidFileIndex) {
+            ChunkHeader::FileIndex startChunkEnd = startChunkIndex + startChunkSize;
+            ChunkHeader::FileIndex growth        = chunkSize - startChunkSize;
+
+            reservedFreeSpace = container.reserveFreeSpaceArea(startChunkEnd, growth, growth);
+
+            if (reservedFreeSpace.startingIndex() == startChunkEnd) {
+                // The unused portion is trimmed from the front when the reservation is released so the chunk must be
+                // placed at the start of the area.
+
+                reservedFreeSpace.setStartingIndex(startChunkIndex);
+                reservedFreeSpace.setAreaSize(reservedFreeSpace.areaSize() + startChunkSize);
+
+                adjacent = true;
+            } else {
+                container.releaseReservation(reservedFreeSpace);
+                reservedFreeSpace = container.reserveFreeSpaceArea(startChunkIndex, chunkSize);
+            }
+        } else {
+            reservedFreeSpace = container.reserveFreeSpaceArea(0, chunkSize);
+        }
+
+        chunk.setFileIndex(reservedFreeSpace.startingIndex());
+        status = chunk.save();
+
+        if (!status) {
+            reservedFreeSpace.reduceBy(chunkSize, FreeSpace::Side::FROM_FRONT);
+            container.releaseReservation(reservedFreeSpace);
+
+            if (startChunkIndex != ChunkHeader::invalidFileIndex && !adjacent) {
+                container.newFreeSpaceArea(startChunkIndex, startChunkSize, true);
+            }
+        }
+    }
+
+    if (!status) {
+        startChunkIndex = chunk.fileIndex();
+        startChunkSize  = chunkSize;
+
+        if (!chunkMap.empty() && chunkMap.begin()->second.inlined()) {
+            chunkMap.begin()->second.setStartingIndex(startChunkIndex);
+            chunkMap.begin()->second.setAreaSize(startChunkSize);
+        }
+    }
+
+    return status;
+}
+
+
+Container::Status VirtualFileImpl::flushChunkBuffer(ContainerImpl& container) {
+    ChunkMap::iterator pos = currentChunk;
+
+    if (pos->second.compressed() || pos->second.shared()) {
+        // The extent will be relocated and may be split so the chunk buffer will no longer be valid.
+        currentChunk = chunkMap.end();
+    }
+
+    Container::Status status = saveExtent(container, pos, chunkBuffer);
+
+    if (!status) {
+        chunkBufferFlushNeeded = false;
+    }
+
+    return status;
+}
+
+
+Container::Status VirtualFileImpl::evictChunkBuffer(ContainerImpl& container) {
+    Container::Status status;
+
+    if (maximumWriteCacheBytes > 0) {
+        unsigned payloadSize = currentChunk->second.payloadSize();
+
+        writeCache[currentChunk->first].assign(chunkBuffer, chunkBuffer + payloadSize);
+        writeCacheBytes += payloadSize;
+
+        chunkBufferFlushNeeded = false;
+        currentChunk           = chunkMap.end();
+
+        if (writeCacheBytes > maximumWriteCacheBytes) {
+            status = flushWriteCache(container);
+        }
+    } else {
+        status = flushChunkBuffer(container);
+    }
+
+    return status;
+}
+
+
+Container::Status VirtualFileImpl::flushWriteCache(ContainerImpl& container) {
+    Container::Status status;
+
+    // Chunks are written in the order they appear in the container so the media sees a single forward sweep rather
+    // than one seek per modified chunk.
+
+    std::vector<std::pair<ChunkHeader::FileIndex, unsigned long long>> writeOrder;
+    writeOrder.reserve(writeCache.size());
+
+    for (WriteCache::const_iterator it=writeCache.begin(),end=writeCache.end() ; it!=end ; ++it) {
+        ChunkMap::const_iterator pos = chunkMap.find(it->first);
+        assert(pos != chunkMap.end());
+
+        writeOrder.push_back(std::make_pair(pos->second.startingIndex(), it->first));
+    }
+
+    std::sort(writeOrder.begin(), writeOrder.end());
+
+    for (unsigned i=0 ; !status && i<writeOrder.size() ; ++i) {
+        WriteCache::iterator cached = writeCache.find(writeOrder[i].second);
+        ChunkMap::iterator   pos    = chunkMap.find(writeOrder[i].second);
+
+        status = saveExtent(container, pos, cached->second.data());
+
+        if (!status) {
+            writeCacheBytes -= cached->second.size();
+            writeCache.erase(cached);
+        }
+    }
+
+    return status;
+}
+
+
+Container::Status VirtualFileImpl::saveExtent(
+        ContainerImpl&      container,
+        ChunkMap::iterator  pos,
+        const std::uint8_t* data
+    ) {
+    Container::Status status;
+
+    invalidateReadCache(pos->first);
+
+    if (pos->second.compressed() || pos->second.shared()) {
+        // The modified extent may no longer fit in its chunk, or may no longer match its shared chunk, so it's written
+        // to a new location.
+
+        status = relocateExtent(container, pos, data, pos->second.payloadSize());
+    } else if (pos->second.inlined()) {
+        status = saveStreamStart(container, currentName, data, pos->second.payloadSize());
+    } else {
+        StreamDataChunk chunk(container, pos->second.startingIndex(), currentStreamIdentifier, pos->first);
+
+        chunk.setChunkSize(ChunkHeader::maximumExtendedChunkSize); // The save method will right-size the chunk.
+        chunk.addScatterGatherListSegment(const_cast<std::uint8_t*>(data), pos->second.payloadSize());
+
+        status = chunk.save();
+    }
+
+    return status;
+}
+
+
+Container::Status VirtualFileImpl::patchExtent(
+        ContainerImpl&      container,
+        ChunkMap::iterator  pos,
+        unsigned            offset,
+        const std::uint8_t* data,
+        unsigned            count
+    ) {
+    assert(!pos->second.compressed() && !pos->second.shared());
+    assert(pos != currentChunk || !chunkBufferFlushNeeded);
+
+    std::uint8_t* buffered = pos == currentChunk ? chunkBuffer + offset : nullptr;
+    std::uint8_t* cached   = nullptr;
+
+    ReadCache::iterator it  = readCache.begin();
+    ReadCache::iterator end = readCache.end();
+
+    while (it != end && it->first != pos->first) {
+        ++it;
+    }
+
+    if (it != end) {
+        cached = it->second.data() + offset;
+    }
+
+    StreamDataChunk chunk(container, pos->second.startingIndex(), currentStreamIdentifier, pos->first);
+    Container::Status status = chunk.loadHeader(true);
+
+    std::vector<std::uint8_t> original;
+    const std::uint8_t*       oldData = buffered != nullptr ? buffered : cached;
+
+    if (!status && oldData == nullptr) {
+        original.resize(count);
+        oldData = original.data();
+
+        status = container.setPosition(chunk.payloadPosition() + offset);
+        if (!status) {
+            status = container.read(original.data(), count);
+            if (status.success() && Container::ReadSuccessful(status).bytesRead() == count) {
+                status = Container::NoStatus();
+            }
+        }
+    }
+
+    if (!status) {
+        status = chunk.patchPayload(offset, oldData, data, count);
+    }
+
+    if (!status) {
+        if (buffered != nullptr) {
+            std::memcpy(buffered, data, count);
+        }
+
+        if (cached != nullptr) {
+            std::memcpy(cached, data, count);
+        }
+    } else {
+        // The state of the chunk on the media is unknown so we drop any copies we hold.
+
+        invalidateReadCache(pos->first);
+
+        if (buffered != nullptr) {
+            currentChunk = chunkMap.end();
+        }
+    }
+
+    return status;
+}
+
+
+Container::Status VirtualFileImpl::loadChunkIntoBuffer(ContainerImpl& container) {
+    reserveChunkBuffer(currentChunk->second.payloadSize());
+
+    Container::Status status = loadExtent(container, currentChunk, chunkBuffer);
+
+    if (!status) {
+        WriteCache::iterator cached = writeCache.find(currentChunk->first);
+        if (cached != writeCache.end()) {
+            // The chunk buffer now holds the only current copy of the chunk.
+
+            writeCacheBytes -= cached->second.size();
+            writeCache.erase(cached);
+
+            chunkBufferFlushNeeded = true;
+        }
+    }
+
+    return status;
+}
+
+
+Container::Status VirtualFileImpl::loadExtent(
+        ContainerImpl&           container,
+        ChunkMap::const_iterator pos,
+        std::uint8_t*            destination
+    ) {
+    Container::Status status;
+
+    WriteCache::const_iterator cached = writeCache.find(pos->first);
+
+    if (cached != writeCache.end()) {
+        assert(cached->second.size() == pos->second.payloadSize());
+        std::memcpy(destination, cached->second.data(), cached->second.size());
+    } else if (!loadFromReadCache(pos->first, destination)) {
+        status = loadExtentFromContainer(container, pos, destination);
+
+        if (!status) {
+            addToReadCache(pos->first, destination, pos->second.payloadSize());
+        }
+    }
+
+    return status;
+}
+
+
+Container::Status VirtualFileImpl::loadExtentFromContainer(
+        ContainerImpl&           container,
+        ChunkMap::const_iterator pos,
+        std::uint8_t*            destination
+    ) {
+    Container::Status status;
+
+    if (pos->second.shared()) {
+        // Shared extents are loaded directly from the shared chunk.  The reference chunk was validated when the
+        // container was scanned.
+
+        unsigned payloadSize = pos->second.payloadSize();
+
+        if (payloadSize != ContainerImpl::sharedExtentSize) {
+            status = Container::PayloadSizeMismatch(
+                ContainerImpl::sharedExtentSize,
+                payloadSize,
+                ChunkHeader::toPosition(pos->second.startingIndex())
+            );
+        } else {
+            status = container.loadSharedChunk(pos->second.sharedIndex(), destination);
+        }
+    } else if (pos->second.inlined()) {
+        status = loadInlinePayload(container, pos, destination);
+    } else {
+        StreamDataChunk chunk(container, pos->second.startingIndex(), currentStreamIdentifier, pos->first);
+
+        chunk.setChunkSize(ChunkHeader::maximumExtendedChunkSize); // The load method will set the actual chunk size.
+
+        bool          compressed  = pos->second.compressed();
+        unsigned      payloadSize = pos->second.payloadSize();
+        std::uint8_t* payloadBuffer;
+
+        if (compressed) {
+            // Compressed extents are loaded into the container's compression buffer and then decompressed into the
+            // destination.
+
+            payloadBuffer = container.compressionBuffer();
+            chunk.addScatterGatherListSegment(payloadBuffer, CompressionEngine::maximumBlockSize);
+        } else {
+            payloadBuffer = destination;
+            chunk.addScatterGatherListSegment(payloadBuffer, payloadSize);
+        }
+
+        status = chunk.load(true);
+
+        if (!status && chunk.streamIdentifier() != currentStreamIdentifier) {
+            status = Container::StreamIdentifierMismatch(
+                chunk.streamIdentifier(),
+                currentStreamIdentifier,
+                ChunkHeader::toPosition(chunk.fileIndex())
+            );
+        }
+
+        if (!status && chunk.chunkOffset() != pos->first) {
+            status = Container::OffsetMismatch(
+                chunk.chunkOffset(),
+                pos->first,
+                ChunkHeader::toPosition(chunk.fileIndex())
+            );
+        }
+
+        unsigned loadedSize     = chunk.scatterGatherListSegment(0).processedCount();
+        unsigned expectedLoaded = compressed ? chunk.payloadSize() : payloadSize;
+
+        if (!status && chunk.isCompressedExtent() != compressed) {
+            status = Container::ContainerDataError(ChunkHeader::toPosition(chunk.fileIndex()));
+        }
+
+        if (!status && loadedSize != expectedLoaded) {
+            status = Container::PayloadSizeMismatch(
+                loadedSize,
+                expectedLoaded,
+                ChunkHeader::toPosition(chunk.fileIndex())
+            );
+        }
+
+        if (!status) {
+            status = container.verifyChunk(chunk);
+        }
+
+        if (!status && compressed) {
+            unsigned extentSize = CompressionEngine::decompressedSize(payloadBuffer, loadedSize);
+
+            if (extentSize != payloadSize) {
+                status = Container::PayloadSizeMismatch(
+                    extentSize,
+                    payloadSize,
+                    ChunkHeader::toPosition(chunk.fileIndex())
+                );
+            } else if (!CompressionEngine::decompress(payloadBuffer, loadedSize, destination, payloadSize)) {
+                status = Container::ContainerDataError(ChunkHeader::toPosition(chunk.fileIndex()));
+            }
+        }
+    }
+
+    return status;
+}
+
+
+Container::Status VirtualFileImpl::loadInlinePayload(
+        ContainerImpl&           container,
+        ChunkMap::const_iterator pos,
+        std::uint8_t*            destination
+    ) {
+    unsigned         payloadSize = pos->second.payloadSize();
+    StreamStartChunk chunk(
+        container,
+        pos->second.startingIndex(),
+        currentName,
+        currentStreamIdentifier,
+        payloadSize
+    );
+
+    // The chunk is sized for the expected name and payload so any difference shows up in the number of valid bytes.
+    unsigned expectedValidBytes = chunk.numberValidBytes();
+
+    Container::Status status = chunk.load(true);
+
+    if (!status && chunk.type() != ChunkHeader::Type::STREAM_START_CHUNK) {
+        status = Container::ContainerDataError(ChunkHeader::toPosition(chunk.fileIndex()));
+    }
+
+    if (!status && chunk.streamIdentifier() != currentStreamIdentifier) {
+        status = Container::StreamIdentifierMismatch(
+            chunk.streamIdentifier(),
+            currentStreamIdentifier,
+            ChunkHeader::toPosition(chunk.fileIndex())
+        );
+    }
+
+    if (!status && chunk.virtualFilename() != currentName) {
+        status = Container::FilenameMismatch(
+            chunk.virtualFilename(),
+            currentName,
+            ChunkHeader::toPosition(chunk.fileIndex())
+        );
+    }
+
+    if (!status && (!chunk.holdsInlinePayload() || chunk.numberValidBytes() != expectedValidBytes)) {
+        status = Container::PayloadSizeMismatch(
+            chunk.inlinePayloadSize(),
+            payloadSize,
+            ChunkHeader::toPosition(chunk.fileIndex())
+        );
+    }
+
+    if (!status) {
+        status = container.verifyChunk(chunk);
+    }
+
+    if (!status) {
+        std::memcpy(destination, chunk.inlinePayload(), payloadSize);
+    }
+
+    return status;
+}
+
+
+bool VirtualFileImpl::readCacheContains(unsigned long long offset) const {
+    ReadCache::const_iterator it  = readCache.begin();
+    ReadCache::const_iterator end = readCache.end();
+
+    while (it != end && it->first != offset) {
+        ++it;
+    }
+
+    return it != end;
+}
+
+
+bool VirtualFileImpl::loadFromReadCache(unsigned long long offset, std::uint8_t* destination) {
+    ReadCache::iterator it  = readCache.begin();
+    ReadCache::iterator end = readCache.end();
+
+    while (it != end && it->first != offset) {
+        ++it;
+    }
+
+    bool found = (it != end);
+
+    if (found) {
+        readCache.splice(readCache.begin(), readCache, it);
+        std::memcpy(destination, it->second.data(), it->second.size());
+
+        ++readCacheHitCount;
+    } else {
+        ++readCacheMissCount;
+    }
+
+    return found;
+}
+
+
+void VirtualFileImpl::addToReadCache(unsigned long long offset, const std::uint8_t* data, unsigned count) {
+    if (maximumReadCacheEntries > 0) {
+        invalidateReadCache(offset);
+
+        if (readCache.size() >= maximumReadCacheEntries) {
+            // Reuse the least recently used entry.
+            readCache.splice(readCache.begin(), readCache, --readCache.end());
+        } else {
+            readCache.emplace_front();
+        }
+
+        readCache.front().first = offset;
+        readCache.front().second.assign(data, data + count);
+    }
+}
+
+
+void VirtualFileImpl::invalidateReadCache(unsigned long long offset) {
+    ReadCache::iterator it  = readCache.begin();
+    ReadCache::iterator end = readCache.end();
+
+    while (it != end && it->first != offset) {
+        ++it;
+    }
+
+    if (it != end) {
+        readCache.erase(it);
+    }
+}
+
+
+FreeSpace VirtualFileImpl::reserveChunkArea(
+        ContainerImpl&         container,
+        ChunkHeader::FileIndex nearIndex,
+        ChunkHeader::FileIndex minimumSize,
+        ChunkHeader::FileIndex desiredSize
+    ) {
+    FreeSpace result;
+
+    if (reservedArea.areaSize() >= minimumSize && reservedArea.areaSize() > 0) {
+        // Space in our own area is not tracked by the container so it's returned as an invalid free space area.
+
+        result.setStartingIndex(reservedArea.startingIndex());
+        result.setAreaSize(reservedArea.areaSize() < desiredSize ? reservedArea.areaSize() : desiredSize);
+    } else {
+        result = container.reserveFreeSpaceArea(nearIndex, minimumSize, desiredSize);
+    }
+
+    return result;
+}
+
+
+void VirtualFileImpl::releaseChunkArea(ContainerImpl& container, FreeSpace& area, unsigned chunkSize) {
+    ChunkHeader::FileIndex usedSize = ChunkHeader::toFileIndex(chunkSize);
+
+    if (area.isInvalid()) {
+        // The chunk was placed at the front of our reserved area.
+        reservedArea.reduceBy(usedSize, ContainerArea::Side::FROM_FRONT);
+    } else {
+        area.reduceBy(usedSize, FreeSpace::Side::FROM_FRONT);
+        container.releaseReservation(area);
+    }
+}
+
+
+void VirtualFileImpl::reopenLastChunk(ContainerImpl& container, std::vector<std::uint8_t>& payload) {
+    payload.clear();
+
+    if (lastChunkReopenable && !chunkMap.empty() && reservedArea.areaSize() == 0) {
+        ChunkMap::iterator last = chunkMap.end();
+        --last;
+
+        bool reopen = (
+               !last->second.compressed()
+            && !last->second.shared()
+            && !last->second.inlined()
+            && last->second.payloadSize() > 0
+            && last->second.payloadSize() < StreamDataChunk::payloadCapacity(container, ChunkHeader::maximumChunkSize)
+            && writeCache.find(last->first) == writeCache.end()
+            && (last != currentChunk || !chunkBufferFlushNeeded)
+        );
+
+        if (reopen) {
+            payload.resize(last->second.payloadSize());
+
+            Container::Status status = loadExtent(container, last, payload.data());
+            if (status) {
+                payload.clear();
+            } else if (last == currentChunk) {
+                // The chunk buffer will no longer match the chunk once it's rewritten.
+                currentChunk = chunkMap.end();
+            }
+        }
+    }
+}
+
+
+FreeSpace VirtualFileImpl::growLastChunk(
+        ContainerImpl&         container,
+        ChunkHeader::FileIndex requiredSize,
+        ChunkHeader::FileIndex desiredSize
+    ) {
+    FreeSpace result;
+
+    ChunkMap::iterator last = chunkMap.end();
+    --last;
+
+    ChunkHeader::FileIndex lastIndex = last->second.startingIndex();
+    ChunkHeader::FileIndex lastSize  = last->second.areaSize();
+    ChunkHeader::FileIndex lastEnd   = lastIndex + lastSize;
+
+    if (desiredSize > lastSize) {
+        ChunkHeader::FileIndex minimumGrowth = requiredSize > lastSize ? requiredSize - lastSize : 1;
+        FreeSpace              growth        = container.reserveFreeSpaceArea(
+            lastEnd,
+            minimumGrowth,
+            desiredSize - lastSize
+        );
+
+        if (growth.startingIndex() == lastEnd) {
+            // The unused portion is trimmed from the front when the reservation is released so the chunk must be
+            // placed at the start of the area.
+
+            growth.setStartingIndex(lastIndex);
+            growth.setAreaSize(growth.areaSize() + lastSize);
+
+            result = growth;
+        } else {
+            container.releaseReservation(growth);
+        }
+    }
+
+    if (!result.isValid() && requiredSize <= lastSize) {
+        // The data still fits so the chunk is simply rewritten.  The space already belongs to this file so it's not
+        // reserved from the container.
+
+        result.setStartingIndex(lastIndex);
+        result.setAreaSize(lastSize);
+    }
+
+    return result;
+}
+
+
+FreeSpace VirtualFileImpl::reserveReopenedChunkArea(
+        ContainerImpl&         container,
+        unsigned               reopenedBytes,
+        unsigned long long     payloadBytes,
+        ChunkHeader::FileIndex desiredSize
+    ) {
+    FreeSpace result;
+
+    if (reopenedBytes > 0) {
+        unsigned               desiredBytes = static_cast<unsigned>(ChunkHeader::toPosition(desiredSize));
+        ChunkHeader::FileIndex requiredSize;
+
+        if (payloadBytes < StreamDataChunk::payloadCapacity(container, desiredBytes)) {
+            unsigned requiredBytes = StreamDataChunk::chunkSizeForPayload(
+                container,
+                static_cast<unsigned>(payloadBytes)
+            );
+
+            requiredSize = ChunkHeader::toFileIndex(requiredBytes);
+        } else {
+            requiredSize = desiredSize;
+        }
+
+        result = growLastChunk(container, requiredSize, desiredSize);
+
+        if (result.areaSize() == 0) {
+            result = reserveChunkArea(container, lastKnownFileIndex(), requiredSize, desiredSize);
+        }
+    } else {
+        result = reserveChunkArea(
+            container,
+            lastKnownFileIndex(),
+            ChunkHeader::toFileIndex(ChunkHeader::minimumChunkSize),
+            desiredSize
+        );
+    }
+
+    return result;
+}
+
+
+void VirtualFileImpl::releaseReopenedChunkArea(ContainerImpl& container, FreeSpace& area, unsigned chunkSize) {
+    releaseReopenedChunk(container, area.startingIndex());
+
+    if (area.isValid()) {
+        releaseChunkArea(container, area, chunkSize);
+    } else {
+        // The chunk was rewritten in its own space.
+
+        area.reduceBy(ChunkHeader::toFileIndex(chunkSize), FreeSpace::Side::FROM_FRONT);
+        if (area.areaSize() > 0) {
+            container.newFreeSpaceArea(area, true);
+        }
+    }
+}
+
+
+void VirtualFileImpl::releaseReopenedChunk(ContainerImpl& container, ChunkHeader::FileIndex replacementIndex) {
+    ChunkMap::iterator last = chunkMap.end();
+    --last;
+
+    if (replacementIndex != last->second.startingIndex()) {
+        // The chunk was rewritten elsewhere so the space holding the original chunk is no longer needed.
+        container.newFreeSpaceArea(last->second.startingIndex(), last->second.areaSize(), true);
+    }
+}
+
+
+void VirtualFileImpl::releaseReservedArea(ContainerImpl& container) {
+    if (reservedArea.areaSize() > 0) {
+        container.newFreeSpaceArea(reservedArea, true);
+        reservedArea = ContainerArea();
+    }
+}
+
+
+Container::Status VirtualFileImpl::collectChunkAreas(
+        ContainerImpl&              container,
+        ChunkMap::iterator          pos,
+        bool                        verify,
+        std::vector<ContainerArea>& areas
+    ) {
+    Container::Status status;
+
+    ChunkMap::iterator end = chunkMap.end();
+    while (!status && pos != end) {
+        ChunkHeader::FileIndex startingIndex = pos->second.startingIndex();
+        ChunkHeader::FileIndex areaSize      = pos->second.areaSize();
+
+        // An inline payload occupies the stream start chunk which is released with the stream start chunk.
+        bool inlined = pos->second.inlined();
 
-            StreamDataChunk chunk(currentContainer, startingIndex, currentStreamIdentifier, startingOffset);
+        if (verify && !inlined) {
+            unsigned long long startingOffset = pos->first;
+            StreamDataChunk    chunk(container, startingIndex, currentStreamIdentifier, startingOffset);
 
             status = chunk.load(true);
 
@@ -783,13 +3022,21 @@ Container::Status VirtualFileImpl::truncate() {
             }
 
             if (!status) {
-                container->newFreeSpaceArea(chunk.fileIndex(), ChunkHeader::toFileIndex(chunk.chunkSize()), true);
-                pos = chunkMap.erase(pos);
+                areaSize = ChunkHeader::toFileIndex(chunk.chunkSize());
+                assert(areaSize == pos->second.areaSize());
             }
         }
 
         if (!status) {
-            currentChunk = chunkMap.end();
+            if (!inlined) {
+                if (!areas.empty() && areas.back().endingIndex() == startingIndex) {
+                    areas.back().expandBy(areaSize, ContainerArea::Side::FROM_BACK);
+                } else {
+                    areas.push_back(ContainerArea(startingIndex, areaSize));
+                }
+            }
+
+            ++pos;
         }
     }
 
@@ -797,241 +3044,353 @@ Container::Status VirtualFileImpl::truncate() {
 }
 
 
-Container::Status VirtualFileImpl::flush() {
-    Container::Status status = writeStreamStartIfNeeded();
+bool VirtualFileImpl::compressionActive(ContainerImpl& container) const {
+    return currentCompression != Container::VirtualFile::Compression::NONE && container.supportsCompressedExtents();
+}
 
-    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
-    if (!status && !container) {
-        status = Container::ContainerUnavailable();
-    }
 
-    if (!status && chunkBufferFlushNeeded) {
-        status = flushChunkBuffer();
-    }
+bool VirtualFileImpl::stagingActive(ContainerImpl& container) const {
+    return compressionActive(container) || container.deduplicationActive();
+}
 
-    if (!status) {
-        while (!status && tailBuffer.notEmpty()) {
-            std::uint8_t* p1;
-            unsigned      l1;
-            std::uint8_t* p2;
-            unsigned      l2;
 
-            FreeSpace reservedFreeSpace = container->reserveFreeSpaceArea(
-                lastKnownFileIndex(),
-                ChunkHeader::toFileIndex(ChunkHeader::minimumChunkSize),
-                ChunkHeader::toFileIndex(ChunkHeader::maximumChunkSize)
-            );
+bool VirtualFileImpl::delayedAllocationActive(ContainerImpl& container) const {
+    return !stagingActive(container) && maximumWriteCacheBytes >= ChunkHeader::maximumChunkSize;
+}
 
-            StreamDataChunk chunk(
-                currentContainer,
-                reservedFreeSpace.startingIndex(),
-                currentStreamIdentifier,
-                currentStoredSize()
-            );
 
-            chunk.setChunkSize(static_cast<unsigned>(ChunkHeader::toPosition(reservedFreeSpace.areaSize())));
+Container::Status VirtualFileImpl::writeExtent(
+        ContainerImpl&         container,
+        unsigned long long     offset,
+        const std::uint8_t*    data,
+        unsigned               count,
+        ChunkHeader::FileIndex nearIndex,
+        unsigned*              bytesWritten
+    ) {
+    Container::Status status;
 
-            tailBuffer.bulkExtractionStart(&p1, &l1, &p2, &l2);
-            chunk.addScatterGatherListSegment(p1, l1);
-            if (p2 != nullptr) {
-                chunk.addScatterGatherListSegment(p2, l2);
-            }
+    std::uint8_t* block          = container.compressionBuffer();
+    unsigned      blockLength    = 0;
+    unsigned      extentSize     = 0;
+    unsigned      blockChunkSize = 0;
 
-            status = chunk.save();
+    assert(count <= CompressionEngine::maximumBlockSize);
 
-            if (!status) {
-                reservedFreeSpace.reduceBy(ChunkHeader::toFileIndex(chunk.chunkSize()), FreeSpace::Side::FROM_FRONT);
-                container->releaseReservation(reservedFreeSpace);
+    if (compressionActive(container) && count >= minimumCompressedExtentSize) {
+        CompressionEngine&       engine = container.compressionEngine();
+        CompressionEngine::Level level  =   currentCompression == Container::VirtualFile::Compression::HIGH_RATIO
+                                          ? CompressionEngine::Level::HIGH_RATIO
+                                          : CompressionEngine::Level::FAST;
 
-                unsigned numberBytesWritten = 0;
-                for (unsigned i=0 ; i<chunk.scatterGatherListSize() ; ++i) {
-                    numberBytesWritten += chunk.scatterGatherListSegment(i).processedCount();
-                }
+        // Extents are only kept compressed if we save at least 1/8 of the space.  Limiting the block size lets the
+        // compressor give up early on data that does not compress.
 
-                assert(numberBytesWritten <= tailBuffer.count()); // Verify that we're sane.
+        blockLength = engine.compress(level, data, count, block, count - count / 8, &extentSize);
 
-                addChunkLocation(chunk.fileIndex(), chunk.chunkOffset(), numberBytesWritten);
+        if (blockLength > 0 && blockLength <= extentSize - extentSize / 8) {
+            blockChunkSize = StreamDataChunk::chunkSizeForPayload(container, blockLength);
 
-                tailBuffer.bulkExtractionFinish(numberBytesWritten);
+            // Chunks are powers of two in size.  If the block leaves much of its chunk unused, try to fill the next
+            // smaller chunk instead and leave the remaining data for the next extent.
+
+            unsigned capacity        = StreamDataChunk::payloadCapacity(container, blockChunkSize);
+            unsigned smallerCapacity = StreamDataChunk::payloadCapacity(container, blockChunkSize / 2);
+
+            if (blockChunkSize > ChunkHeader::minimumChunkSize                &&
+                extentSize == count                                            &&
+                blockLength - smallerCapacity < (capacity - smallerCapacity) / 4    ) {
+                unsigned smallerExtentSize;
+                unsigned smallerLength = engine.compress(
+                    level,
+                    data,
+                    count,
+                    block,
+                    smallerCapacity,
+                    &smallerExtentSize
+                );
+
+                if (smallerLength > 0 && smallerLength <= smallerExtentSize - smallerExtentSize / 8) {
+                    blockLength    = smallerLength;
+                    extentSize     = smallerExtentSize;
+                    blockChunkSize = blockChunkSize / 2;
+                } else {
+                    blockLength = engine.compress(level, data, count, block, count - count / 8, &extentSize);
+                }
             }
+        } else {
+            blockChunkSize = 0;
         }
     }
 
-    if (container) {
-        container->setLastStatus(status);
+    if (blockChunkSize > 0) {
+        FreeSpace reservedFreeSpace = reserveChunkArea(
+            container,
+            nearIndex,
+            ChunkHeader::toFileIndex(blockChunkSize),
+            ChunkHeader::toFileIndex(blockChunkSize)
+        );
+
+        StreamDataChunk chunk(container, reservedFreeSpace.startingIndex(), currentStreamIdentifier, offset);
+
+        chunk.setChunkSize(static_cast<unsigned>(ChunkHeader::toPosition(reservedFreeSpace.areaSize())));
+        chunk.setCompressedExtent(true);
+        chunk.addScatterGatherListSegment(block, blockLength);
+
+        status = chunk.save();
+
+        if (!status) {
+            assert(chunk.scatterGatherListSegment(0).processedCount() == blockLength);
+
+            releaseChunkArea(container, reservedFreeSpace, chunk.chunkSize());
+
+            addChunkLocation(
+                chunk.fileIndex(),
+                ChunkHeader::toFileIndex(chunk.chunkSize()),
+                offset,
+                extentSize,
+                true
+            );
+        }
+    } else {
+        unsigned desiredChunkSize = StreamDataChunk::preferredChunkSize(count, container.supportsExtendedChunks());
+
+        FreeSpace reservedFreeSpace = reserveChunkArea(
+            container,
+            nearIndex,
+            ChunkHeader::toFileIndex(ChunkHeader::minimumChunkSize),
+            ChunkHeader::toFileIndex(desiredChunkSize)
+        );
+
+        StreamDataChunk chunk(container, reservedFreeSpace.startingIndex(), currentStreamIdentifier, offset);
+
+        chunk.setChunkSize(static_cast<unsigned>(ChunkHeader::toPosition(reservedFreeSpace.areaSize())));
+        chunk.addScatterGatherListSegment(const_cast<std::uint8_t*>(data), count);
+
+        status = chunk.save();
+
+        if (!status) {
+            releaseChunkArea(container, reservedFreeSpace, chunk.chunkSize());
+
+            extentSize = chunk.scatterGatherListSegment(0).processedCount();
+            addChunkLocation(
+                chunk.fileIndex(),
+                ChunkHeader::toFileIndex(chunk.chunkSize()),
+                offset,
+                extentSize,
+                false
+            );
+        }
     }
 
+    *bytesWritten = status ? 0 : extentSize;
+
     return status;
 }
 
 
-Container::Status VirtualFileImpl::erase() {
+Container::Status VirtualFileImpl::flushPendingExtent(ContainerImpl& container, bool all) {
     Container::Status status;
 
-    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
-    if (!container) {
-        status = Container::ContainerUnavailable();
-    }
+    bool     deduplicate  = container.deduplicationActive();
+    unsigned pendingCount = static_cast<unsigned>(pendingExtent.size());
+    unsigned written      = 0;
+    bool     done         = false;
 
-    if (!status && container->containerScanNeeded()) {
-        status = container->scanContainer();
+    if (!stagingActive(container)) {
+        // The data was held for delayed allocation and is written as a single run.
+        status = writeDelayedExtent(container);
+        done   = true;
     }
 
-    std::vector<ContainerArea> areasToRelease;
+    while (!status && !done) {
+        unsigned long long offset    = currentStoredSize();
+        unsigned           remaining = pendingCount - written;
+        unsigned           limit;
 
-    if (!status && startChunkIndex != ChunkHeader::invalidFileIndex) {
-        StreamStartChunk chunk(container, startChunkIndex, currentName, currentStreamIdentifier);
-        status = chunk.load(true);
+        if (deduplicate) {
+            // Extents are aligned to multiples of the shared extent size so identical data at the same offset in
+            // different files produces identical extents.
 
-        if (!status && chunk.streamIdentifier() != currentStreamIdentifier) {
-            status = Container::StreamIdentifierMismatch(
-                chunk.streamIdentifier(),
-                currentStreamIdentifier,
-                ChunkHeader::toPosition(chunk.fileIndex())
-            );
+            limit = ContainerImpl::sharedExtentSize - static_cast<unsigned>(offset % ContainerImpl::sharedExtentSize);
+        } else {
+            limit = CompressionEngine::maximumBlockSize;
         }
 
-        if (!status && chunk.virtualFilename() != currentName) {
-            status = Container::FilenameMismatch(
-                chunk.virtualFilename(),
-                currentName,
-                ChunkHeader::toPosition(startChunkIndex)
-            );
-        }
+        if (remaining >= limit || (all && remaining > 0)) {
+            const std::uint8_t* data  = pendingExtent.data() + written;
+            unsigned            count = remaining < limit ? remaining : limit;
+            unsigned            bytesWritten;
 
-        if (!status) {
-            areasToRelease.push_back(ContainerArea(startChunkIndex, ChunkHeader::toFileIndex(chunk.chunkSize())));
+            status = spillInlinePayload(container);
+
+            if (status) {
+                bytesWritten = 0;
+            } else if (deduplicate && count == ContainerImpl::sharedExtentSize) {
+                status       = writeSharedExtent(container, offset, data, lastKnownFileIndex());
+                bytesWritten = status ? 0 : count;
+            } else {
+                status = writeExtent(container, offset, data, count, lastKnownFileIndex(), &bytesWritten);
+            }
+
+            written += bytesWritten;
+        } else {
+            done = true;
         }
     }
 
-    ChunkMap::iterator pos = chunkMap.begin();
-    ChunkMap::iterator end = chunkMap.end();
+    pendingExtent.erase(pendingExtent.begin(), pendingExtent.begin() + written);
 
-    while (!status && pos != end) {
-        ChunkHeader::FileIndex startingIndex  = pos->second.startingIndex();
-        unsigned long long     startingOffset = pos->first;
+    return status;
+}
 
-        StreamDataChunk chunk(currentContainer, startingIndex, currentStreamIdentifier, startingOffset);
 
-        status = chunk.load(true);
+Container::Status VirtualFileImpl::writeDelayedExtent(ContainerImpl& container) {
+    Container::Status status = spillInlinePayload(container);
 
-        if (!status && chunk.streamIdentifier() != currentStreamIdentifier) {
-            status = Container::StreamIdentifierMismatch(
-                chunk.streamIdentifier(),
-                currentStreamIdentifier,
-                ChunkHeader::toPosition(chunk.fileIndex())
-            );
-        }
+    // A partly filled last chunk is written again as the start of the run so that frequent flushes don't leave a
+    // trail of small chunks behind.
 
-        if (!status && chunk.chunkOffset() != startingOffset) {
-            status = Container::OffsetMismatch(
-                chunk.chunkOffset(),
-                startingOffset,
-                ChunkHeader::toPosition(chunk.fileIndex())
-            );
-        }
+    std::vector<std::uint8_t> reopened;
+    reopenLastChunk(container, reopened);
 
-        if (!status) {
-            areasToRelease.push_back(ContainerArea(startingIndex, ChunkHeader::toFileIndex(chunk.chunkSize())));
-            ++pos;
-        }
-    }
+    unsigned reopenedCount = static_cast<unsigned>(reopened.size());
+    pendingExtent.insert(pendingExtent.begin(), reopened.begin(), reopened.end());
 
-    if (!status) {
-        for (std::vector<ContainerArea>::iterator it=areasToRelease.begin(),end=areasToRelease.end() ; it!=end ; ++it) {
-            container->newFreeSpaceArea(it->startingIndex(), it->areaSize(), true);
-        }
+    bool               allowExtended = container.supportsExtendedChunks();
+    unsigned           pendingCount  = static_cast<unsigned>(pendingExtent.size());
+    unsigned long long runOffset     = currentStoredSize() - reopenedCount;
 
-        bool success = container->flushFreeSpace();
-        if (!success) {
-            status = container->lastStatus();
-        }
-    }
+    // Determine the space needed by the run.  Large chunks are used where possible and the last chunk is sized to fit
+    // the remaining data.
 
-    if (!status) {
-        bool success = container->fileErased(currentName);
-        (void) success;
-        assert(success);
+    ChunkHeader::FileIndex areaSize  = 0;
+    unsigned               remaining = pendingCount;
 
-        container->setLastStatus(status);
+    while (remaining > 0) {
+        unsigned chunkSize = StreamDataChunk::preferredChunkSize(remaining, allowExtended);
+        unsigned capacity  = StreamDataChunk::payloadCapacity(container, chunkSize);
 
-        container.reset();
-        currentContainer.reset();
-    } else {
-        if (container) {
-            container->setLastStatus(status);
+        if (capacity >= remaining) {
+            chunkSize = StreamDataChunk::chunkSizeForPayload(container, remaining);
+            capacity  = remaining;
         }
-    }
 
-    return status;
-}
+        areaSize  += ChunkHeader::toFileIndex(chunkSize);
+        remaining -= capacity;
+    }
 
+    FreeSpace runArea;
+    if (reopenedCount > 0) {
+        runArea = growLastChunk(container, areaSize, areaSize);
+    }
 
-Container::Status VirtualFileImpl::rename(const std::string& newName) {
-    Container::Status status;
+    bool inPlace = runArea.isInvalid() && runArea.areaSize() > 0;
 
-    std::shared_ptr<ContainerImpl> container = currentContainer.lock();
-    if (!container) {
-        status = Container::ContainerUnavailable();
+    if (runArea.isValid() || inPlace) {
+        // The last chunk grows or is rewritten in place.
+    } else if (reservedArea.areaSize() >= areaSize) {
+        runArea = reserveChunkArea(container, lastKnownFileIndex(), areaSize, areaSize);
+    } else if (areaSize > 0) {
+        runArea = container.reserveLargestFreeSpaceArea(lastKnownFileIndex(), areaSize);
     }
 
-    std::string oldName = currentName;
+    unsigned written = 0;
+    while (!status && written < pendingCount) {
+        unsigned long long availableBytes = ChunkHeader::toPosition(runArea.areaSize());
+        unsigned           chunkSize      = StreamDataChunk::preferredChunkSize(pendingCount - written, allowExtended);
 
-    if (!status && oldName != newName) {
-        if (startChunkIndex != ChunkHeader::invalidFileIndex) {
-            StreamStartChunk chunk(currentContainer, startChunkIndex, newName, currentStreamIdentifier);
-            status = chunk.save();
+        if (availableBytes < chunkSize) {
+            chunkSize = static_cast<unsigned>(availableBytes);
         }
 
+        StreamDataChunk chunk(container, runArea.startingIndex(), currentStreamIdentifier, runOffset + written);
+
+        chunk.setChunkSize(chunkSize);
+        chunk.addScatterGatherListSegment(pendingExtent.data() + written, pendingCount - written);
+
+        status = chunk.save();
+
         if (!status) {
-            currentName = newName;
+            ChunkHeader::FileIndex usedSize   = ChunkHeader::toFileIndex(chunk.chunkSize());
+            unsigned               extentSize = chunk.scatterGatherListSegment(0).processedCount();
 
-            bool success = currentContainer.lock()->fileRenamed(oldName, newName);
-            (void) success;
-            assert(success);
+            runArea.reduceBy(usedSize, FreeSpace::Side::FROM_FRONT);
+            if (runArea.isInvalid() && !inPlace) {
+                reservedArea.reduceBy(usedSize, ContainerArea::Side::FROM_FRONT);
+            }
+
+            if (written == 0 && reopenedCount > 0) {
+                assert(extentSize >= reopenedCount);
+                releaseReopenedChunk(container, chunk.fileIndex());
+            }
+
+            addChunkLocation(chunk.fileIndex(), usedSize, chunk.chunkOffset(), extentSize, false);
+            written += extentSize;
         }
     }
 
-    if (container) {
-        container->setLastStatus(status);
+    if (runArea.isValid()) {
+        container.releaseReservation(runArea);
+    } else if (inPlace && runArea.areaSize() > 0 && written >= reopenedCount) {
+        container.newFreeSpaceArea(runArea, true);
+    }
+
+    if (written < reopenedCount) {
+        // The reopened chunk is still in place so the copy of its payload is discarded.
+        written = reopenedCount;
+    } else {
+        lastChunkReopenable = true;
     }
 
+    pendingExtent.erase(pendingExtent.begin(), pendingExtent.begin() + written);
+
     return status;
 }
 
 
-void VirtualFileImpl::addChunkLocation(
-        ChunkHeader::FileIndex startingIndex,
-        unsigned long long     baseOffset,
-        unsigned               payloadSize
+Container::Status VirtualFileImpl::writeSharedExtent(
+        ContainerImpl&         container,
+        unsigned long long     offset,
+        const std::uint8_t*    data,
+        ChunkHeader::FileIndex nearIndex
     ) {
-    ChunkMap::iterator pos = chunkMap.find(baseOffset);
+    Container::Status status;
 
-    if (pos != chunkMap.end()) {
-        pos->second = ChunkMapData(startingIndex, payloadSize);
-    } else {
-        chunkMap.insert(ChunkMapPair(baseOffset, ChunkMapData(startingIndex, payloadSize)));
-    }
-}
+    ChunkHeader::FileIndex sharedIndex;
+    status = container.acquireSharedChunk(data, nearIndex, &sharedIndex);
 
+    if (!status) {
+        std::uint8_t reference[StreamDataChunk::sharedReferenceSizeBytes];
+        StreamDataChunk::encodeSharedReference(reference, ContainerImpl::sharedExtentSize, sharedIndex);
 
-Container::Status VirtualFileImpl::writeStreamStartIfNeeded() {
-    Container::Status status;
+        FreeSpace reservedFreeSpace = reserveChunkArea(
+            container,
+            nearIndex,
+            ChunkHeader::toFileIndex(ChunkHeader::minimumChunkSize),
+            ChunkHeader::toFileIndex(ChunkHeader::minimumChunkSize)
+        );
 
-    if (startChunkIndex == ChunkHeader::invalidFileIndex) {
-        StreamStartChunk chunk(currentContainer, 0, currentName, currentStreamIdentifier);
+        StreamDataChunk chunk(container, reservedFreeSpace.startingIndex(), currentStreamIdentifier, offset);
 
-        std::shared_ptr<ContainerImpl> container = currentContainer.lock();
-        FreeSpace reservedFreeSpace = container->reserveFreeSpaceArea(0, ChunkHeader::toFileIndex(chunk.chunkSize()));
-        chunk.setFileIndex(reservedFreeSpace.startingIndex());
+        chunk.setChunkSize(static_cast<unsigned>(ChunkHeader::toPosition(reservedFreeSpace.areaSize())));
+        chunk.setCompressedExtent(true);
+        chunk.addScatterGatherListSegment(reference, StreamDataChunk::sharedReferenceSizeBytes);
 
         status = chunk.save();
 
         if (!status) {
-            reservedFreeSpace.reduceBy(ChunkHeader::toFileIndex(chunk.chunkSize()), FreeSpace::Side::FROM_FRONT);
-            container->releaseReservation(reservedFreeSpace);
-
-            startChunkIndex = chunk.fileIndex();
+            releaseChunkArea(container, reservedFreeSpace, chunk.chunkSize());
+
+            addChunkLocation(
+                chunk.fileIndex(),
+                ChunkHeader::toFileIndex(chunk.chunkSize()),
+                offset,
+                ContainerImpl::sharedExtentSize,
+                false,
+                sharedIndex
+            );
+        } else {
+            container.releaseSharedChunk(sharedIndex);
         }
     }
 
@@ -1039,48 +3398,78 @@ Container::Status VirtualFileImpl::writeStreamStartIfNeeded() {
 }
 
 
-Container::Status VirtualFileImpl::flushChunkBuffer() {
+Container::Status VirtualFileImpl::relocateExtent(
+        ContainerImpl&      container,
+        ChunkMap::iterator  pos,
+        const std::uint8_t* data,
+        unsigned            count
+    ) {
     Container::Status status;
 
-    StreamDataChunk chunk(
-        currentContainer,
-        currentChunk->second.startingIndex(),
-        currentStreamIdentifier,
-        currentChunk->first
-    );
+    ChunkHeader::FileIndex startingIndex  = pos->second.startingIndex();
+    ChunkHeader::FileIndex sharedIndex    = pos->second.sharedIndex();
+    unsigned long long     startingOffset = pos->first;
+
+    StreamDataChunk oldChunk(container, startingIndex, currentStreamIdentifier, startingOffset);
+    status = oldChunk.loadHeader(true);
+
+    if (!status && oldChunk.streamIdentifier() != currentStreamIdentifier) {
+        status = Container::StreamIdentifierMismatch(
+            oldChunk.streamIdentifier(),
+            currentStreamIdentifier,
+            ChunkHeader::toPosition(oldChunk.fileIndex())
+        );
+    }
+
+    if (!status && oldChunk.chunkOffset() != startingOffset) {
+        status = Container::OffsetMismatch(
+            oldChunk.chunkOffset(),
+            startingOffset,
+            ChunkHeader::toPosition(oldChunk.fileIndex())
+        );
+    }
 
-    chunk.setChunkSize(ChunkHeader::maximumChunkSize); // The save method will automatically right-size the chunk.
-    chunk.addScatterGatherListSegment(chunkBuffer, currentChunk->second.payloadSize());
+    // The new extents are written before the old extent is released.  The first new extent replaces the old extent
+    // in the chunk map.
+
+    unsigned written = 0;
+    while (!status && written < count) {
+        unsigned bytesWritten;
+        status = writeExtent(
+            container,
+            startingOffset + written,
+            data + written,
+            count - written,
+            startingIndex,
+            &bytesWritten
+        );
 
-    status = chunk.save();
+        written += bytesWritten;
+    }
 
     if (!status) {
-        chunkBufferFlushNeeded = false;
+        container.newFreeSpaceArea(startingIndex, ChunkHeader::toFileIndex(oldChunk.chunkSize()), true);
+
+        if (sharedIndex != ChunkHeader::invalidFileIndex) {
+            container.releaseSharedChunk(sharedIndex);
+        }
     }
 
     return status;
 }
 
 
-Container::Status VirtualFileImpl::loadChunkIntoBuffer() {
+Container::Status VirtualFileImpl::pinChunkPayload(
+        ContainerImpl&                       container,
+        ChunkMap::const_iterator             pos,
+        std::shared_ptr<const std::uint8_t>* payload
+    ) {
     Container::Status status;
 
-    StreamDataChunk chunk(
-        currentContainer,
-        currentChunk->second.startingIndex(),
-        currentStreamIdentifier,
-        currentChunk->first
-    );
-
-    chunk.setChunkSize(ChunkHeader::maximumChunkSize); // The save method will automatically right-size the chunk.
-
-    if (chunkBuffer == nullptr) {
-        chunkBuffer = new std::uint8_t[chunkBufferSize];
-    }
-
-    chunk.addScatterGatherListSegment(chunkBuffer, currentChunk->second.payloadSize());
+    payload->reset();
 
-    status = chunk.load(true);
+    StreamDataChunk chunk(container, pos->second.startingIndex(), currentStreamIdentifier, pos->first);
+    status = chunk.loadHeader(true);
 
     if (!status && chunk.streamIdentifier() != currentStreamIdentifier) {
         status = Container::StreamIdentifierMismatch(
@@ -1090,26 +3479,95 @@ Container::Status VirtualFileImpl::loadChunkIntoBuffer() {
         );
     }
 
-    if (!status && chunk.chunkOffset() != currentChunk->first) {
-        status = Container::OffsetMismatch(
-            chunk.chunkOffset(),
-            currentChunk->first,
-            ChunkHeader::toPosition(chunk.fileIndex())
-        );
+    if (!status && chunk.chunkOffset() != pos->first) {
+        status = Container::OffsetMismatch(chunk.chunkOffset(), pos->first, ChunkHeader::toPosition(chunk.fileIndex()));
     }
 
-    if (!status && chunk.scatterGatherListSegment(0).processedCount() != currentChunk->second.payloadSize()) {
+    if (!status && chunk.payloadSize() != pos->second.payloadSize()) {
         status = Container::PayloadSizeMismatch(
-            chunk.scatterGatherListSegment(0).processedCount(),
-            currentChunk->second.payloadSize(),
+            chunk.payloadSize(),
+            pos->second.payloadSize(),
             ChunkHeader::toPosition(chunk.fileIndex())
         );
     }
 
+    if (!status) {
+        std::shared_ptr<const std::uint8_t> pinned = container.pin(chunk.payloadPosition(), chunk.payloadSize());
+
+        if (pinned) {
+            // The CRC is checked against the pinned data so verification does not require a copy.
+            chunk.addScatterGatherListSegment(const_cast<std::uint8_t*>(pinned.get()), chunk.payloadSize());
+            status = container.verifyChunk(chunk);
+
+            if (!status) {
+                *payload = pinned;
+            }
+        }
+    }
+
+    return status;
+}
+
+
+Container::Status VirtualFileImpl::copyIntoView(unsigned count, Container::VirtualFile::View& view) {
+    std::shared_ptr<std::uint8_t> buffer(new std::uint8_t[count], std::default_delete<std::uint8_t[]>());
+
+    Container::Status status = read(buffer.get(), count);
+    if (status.success() && Container::ReadSuccessful(status).bytesRead() == count) {
+        view.append(buffer, count);
+        status = Container::NoStatus();
+    }
+
     return status;
 }
 
 
+void VirtualFileImpl::advanceBuffers(
+        const Container::VirtualFile::WriteBuffer* buffers,
+        unsigned                                   numberBuffers,
+        unsigned                                   count,
+        unsigned*                                  bufferIndex,
+        unsigned*                                  bufferOffset
+    ) {
+    unsigned index  = *bufferIndex;
+    unsigned offset = *bufferOffset;
+
+    while (index < numberBuffers && (count > 0 || offset == buffers[index].second)) {
+        unsigned remainingInBuffer = buffers[index].second - offset;
+
+        if (count < remainingInBuffer) {
+            offset += count;
+            count   = 0;
+        } else {
+            count  -= remainingInBuffer;
+            offset  = 0;
+            ++index;
+        }
+    }
+
+    assert(count == 0);
+
+    *bufferIndex  = index;
+    *bufferOffset = offset;
+}
+
+
+void VirtualFileImpl::reserveChunkBuffer(unsigned requiredSize) {
+    if (requiredSize < chunkBufferSize) {
+        requiredSize = chunkBufferSize;
+    }
+
+    if (chunkBufferCapacity < requiredSize) {
+        if (chunkBuffer != nullptr) {
+            delete[] chunkBuffer;
+        }
+
+        chunkBuffer         = new std::uint8_t[requiredSize];
+        chunkBufferCapacity = requiredSize;
+    }
+}
+
+
 unsigned long long VirtualFileImpl::currentStoredSize() {
     unsigned long long storedSize;
 
@@ -1144,3 +3602,4 @@ ChunkHeader::FileIndex VirtualFileImpl::lastKnownFileIndex() {
 
     return lastFileIndex;
 }
+
@@ -29,9 +29,11 @@
 #include <memory>
 #include <string>
 #include <map>
+#include <list>
 #include <vector>
 
 #include "container_status.h"
+#include "container_virtual_file.h"
 #include "stream_start_chunk.h"
 #include "stream_data_chunk.h"
 #include "container_impl.h"
@@ -67,13 +69,6 @@ class VirtualFileImpl {
 
         virtual ~VirtualFileImpl();
 
-        /**
-         * Constructor
-         *
-         * \param[in] streamStartChunk The chunk that is used to start the stream.
-         */
-        VirtualFileImpl(std::shared_ptr<StreamStartChunk> streamStartChunk);
-
         /**
          * Method that returns the name of this virtual file.
          *
@@ -155,6 +150,35 @@ class VirtualFileImpl {
          */
         Container::Status read(std::uint8_t* buffer, unsigned desiredCount);
 
+        /**
+         * Method that reads a specified number of bytes of data from the container, if available, into a read-only
+         * view.  Uncompressed chunks are referenced in place when the container supports pinning.  Other data is
+         * copied into memory owned by the view.
+         *
+         * \param[in]     desiredCount The number of bytes that should be read, if possible.
+         *
+         * \param[in,out] view         The view to receive the data.
+         *
+         * \return Returns the status from the read operation.  On success an instance of \ref Container::ReadSuccessful
+         *         is returned.
+         */
+        Container::Status readView(unsigned desiredCount, Container::VirtualFile::View& view);
+
+        /**
+         * Method that reads data from a specified offset in the virtual file.  The file position and the chunk buffer
+         * are left untouched.
+         *
+         * \param[in] offset       The offset of the first byte to be read.
+         *
+         * \param[in] buffer       The buffer to receive the data.
+         *
+         * \param[in] desiredCount The number of bytes that should be read, if possible.
+         *
+         * \return Returns the status from the read operation.  On success an instance of \ref Container::ReadSuccessful
+         *         is returned.
+         */
+        Container::Status readAt(unsigned long long offset, std::uint8_t* buffer, unsigned desiredCount);
+
         /**
          * Method that writes a specified number of bytes of data.  You can use this method either during
          * random access or when streaming data to a virtual file in a container.
@@ -168,6 +192,22 @@ class VirtualFileImpl {
          */
         Container::Status write(const std::uint8_t* buffer, unsigned desiredCount);
 
+        /**
+         * Method that writes data at a specified offset in the virtual file.  The file position is left untouched and
+         * the chunk buffer is neither flushed nor reloaded.
+         *
+         * \param[in] offset The offset of the first byte to be written.  The offset can not be past the end of the
+         *                   file.
+         *
+         * \param[in] buffer The buffer holding the data to write.
+         *
+         * \param[in] count  The number of bytes to be written.
+         *
+         * \return Returns the status from the write operation.  On success an instance of
+         *         \ref Container::WriteSuccessful is returned.
+         */
+        Container::Status writeAt(unsigned long long offset, const std::uint8_t* buffer, unsigned count);
+
         /**
          * Method that appends a specified number of bytes of data to the end of the virtual file.
          *
@@ -180,13 +220,81 @@ class VirtualFileImpl {
          */
         Container::Status append(const std::uint8_t* buffer, unsigned count);
 
+        /**
+         * Method that reads data into a list of buffers.  Buffers are filled in order.
+         *
+         * \param[in] buffers       The buffers to receive the data.
+         *
+         * \param[in] numberBuffers The number of buffers.
+         *
+         * \return Returns the status from the read operation.  On success an instance of \ref Container::ReadSuccessful
+         *         is returned.
+         */
+        Container::Status readv(const Container::VirtualFile::ReadBuffer* buffers, unsigned numberBuffers);
+
+        /**
+         * Method that writes data held in a list of buffers.  Data past the end of the file is gathered directly into
+         * new chunks.
+         *
+         * \param[in] buffers       The buffers holding the data to write.
+         *
+         * \param[in] numberBuffers The number of buffers.
+         *
+         * \return Returns the status from the write operation.  On success an instance of
+         *         \ref Container::WriteSuccessful is returned.
+         */
+        Container::Status writev(const Container::VirtualFile::WriteBuffer* buffers, unsigned numberBuffers);
+
+        /**
+         * Method that writes data held in a buffer, taking ownership of the buffer.
+         *
+         * \param[in] buffer The buffer holding the data to write.  The buffer is left empty.
+         *
+         * \return Returns the status from the write operation.  On success an instance of
+         *         \ref Container::WriteSuccessful is returned.
+         */
+        Container::Status write(std::vector<std::uint8_t>&& buffer);
+
+        /**
+         * Method that appends data held in a list of buffers to the end of the virtual file.
+         *
+         * \param[in] buffers       The buffers holding the data to write.
+         *
+         * \param[in] numberBuffers The number of buffers.
+         *
+         * \return Returns the status from the write operation.  On success an instance of
+         *         \ref Container::WriteSuccessful is returned.
+         */
+        Container::Status appendv(const Container::VirtualFile::WriteBuffer* buffers, unsigned numberBuffers);
+
+        /**
+         * Method that reserves a contiguous area of the container for data appended to this file.  Any previous
+         * reservation is released.  Unused space is released when the file is flushed.
+         *
+         * \param[in] expectedSize The expected number of bytes to be appended.  A value of 0 releases the current
+         *                         reservation.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status reserve(unsigned long long expectedSize);
+
+        /**
+         * Method that returns the unused space remaining in the file's reserved area.
+         *
+         * \return Returns the remaining reserved space, in bytes.
+         */
+        unsigned long long bytesReserved() const;
+
         /**
          * Method that truncates the file at the current position.  All data after the current position will be
          * discarded.
          *
+         * \param[in] verify If true, each discarded chunk is read back and checked before its space is released.  If
+         *                   false, the chunk map is trusted and no chunks are read.
+         *
          * \return Returns the status from the truncation operation.
          */
-        Container::Status truncate();
+        Container::Status truncate(bool verify = false);
 
         /**
          * Method that flushes any pending write data to the media.
@@ -195,13 +303,34 @@ class VirtualFileImpl {
          */
         Container::Status flush();
 
+        /**
+         * Method that writes any pending write data to the media and releases the memory used to hold it.  Unlike
+         * \ref VirtualFileImpl::flush, space reserved for the file is kept.  The method is used by the container to
+         * keep buffered data within the container's write buffer budget.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status releaseBuffers();
+
         /**
          * Method that deletes this file.  This virtual file object will no longer be valid after calling this
          * method.
          *
+         * \param[in] verify      If true, each chunk is read back and checked before its space is released.  If false,
+         *                        the chunk map is trusted.
+         *
+         * \param[in] updateMedia If true, the released space is marked on the media immediately.  If false, the
+         *                        released space is marked when the container is flushed.
+         *
          * \return Returns the status from the erase operation.
          */
-        Container::Status erase();
+        Container::Status erase(bool verify, bool updateMedia);
+
+        /**
+         * Method that disconnects this virtual file from its container without writing anything to the container.
+         * Buffered data is discarded.  The method is used when the container is cleared.
+         */
+        void detach();
 
         /**
          * Method that renames this file.
@@ -212,6 +341,66 @@ class VirtualFileImpl {
          */
         Container::Status rename(const std::string& newName);
 
+        /**
+         * Method that selects how data written to this file is compressed.
+         *
+         * \param[in] newCompression The new compression setting.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status setCompression(Container::VirtualFile::Compression newCompression);
+
+        /**
+         * Method that returns the current compression setting.
+         *
+         * \return Returns the current compression setting.
+         */
+        Container::VirtualFile::Compression compression() const;
+
+        /**
+         * Method that sets the maximum number of bytes of modified chunk data held in the write cache.
+         *
+         * \param[in] newSize The new write cache size, in bytes.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status setWriteCacheSize(unsigned long long newSize);
+
+        /**
+         * Method that returns the maximum number of bytes of modified chunk data held in the write cache.
+         *
+         * \return Returns the write cache size, in bytes.
+         */
+        unsigned long long writeCacheSize() const;
+
+        /**
+         * Method that sets the maximum number of decoded chunks held in the read cache.
+         *
+         * \param[in] numberChunks The new read cache size, in chunks.
+         */
+        void setReadCacheSize(unsigned numberChunks);
+
+        /**
+         * Method that returns the maximum number of decoded chunks held in the read cache.
+         *
+         * \return Returns the read cache size, in chunks.
+         */
+        unsigned readCacheSize() const;
+
+        /**
+         * Method that returns the number of chunk loads satisfied by the read cache.
+         *
+         * \return Returns the number of read cache hits.
+         */
+        unsigned long long readCacheHits() const;
+
+        /**
+         * Method that returns the number of chunk loads that required access to the media.
+         *
+         * \return Returns the number of read cache misses.
+         */
+        unsigned long long readCacheMisses() const;
+
         /**
          * Method you can overload to receive data from the streaming API.  Note that, to avoid multiple instances
          * incorrectly operating on the same data, only the instance that was instantiated by
@@ -239,14 +428,29 @@ class VirtualFileImpl {
          *
          * \param[in] startingIndex The zero based file index where the chunk can be found.
          *
+         * \param[in] areaSize      The size of the chunk in the container, in file index counts.
+         *
          * \param[in] baseOffset    The zero based byte offset into the virtual file tied to the chunk.
          *
-         * \param[in] payloadSize   The size of the chunk's payload, in bytes.
+         * \param[in] payloadSize   The size of the chunk's payload, in bytes.  For compressed extents, this is the
+         *                          size of the payload after decompression.
+         *
+         * \param[in] compressed    If true, the chunk holds a compressed extent.
+         *
+         * \param[in] sharedIndex   The file index of the shared chunk holding the payload or
+         *                          \ref ChunkHeader::invalidFileIndex if the chunk holds the payload.
+         *
+         * \param[in] inlined       If true, the payload is held inline in the stream start chunk.  The starting index
+         *                          and area size describe the stream start chunk.
          */
         void addChunkLocation(
             ChunkHeader::FileIndex startingIndex,
+            ChunkHeader::FileIndex areaSize,
             unsigned long long     baseOffset,
-            unsigned               payloadSize
+            unsigned               payloadSize,
+            bool                   compressed,
+            ChunkHeader::FileIndex sharedIndex = ChunkHeader::invalidFileIndex,
+            bool                   inlined = false
         );
 
     private:
@@ -256,10 +460,27 @@ class VirtualFileImpl {
         static constexpr unsigned tailBufferSize = 4096;
 
         /**
-         * Value used to indicate the size of the chunk storage buffer.
+         * Value used to indicate the minimum size of the chunk storage buffer.  The buffer will grow as needed to hold
+         * extended chunks.
          */
         static constexpr unsigned chunkBufferSize = 4096;
 
+        /**
+         * Value used to indicate the smallest extent we attempt to compress.  Smaller extents are always stored
+         * uncompressed.
+         */
+        static constexpr unsigned minimumCompressedExtentSize = 128;
+
+        /**
+         * Value used to indicate the default size of the write cache, in bytes.
+         */
+        static constexpr unsigned long long defaultWriteCacheSize = 256 * 1024;
+
+        /**
+         * Value used to indicate the default size of the read cache, in chunks.
+         */
+        static constexpr unsigned defaultReadCacheSize = 4;
+
         /**
          * Typedef used to track chunks of data associated with this virtual file.
          */
@@ -270,27 +491,601 @@ class VirtualFileImpl {
          */
         typedef std::pair<unsigned long long, ChunkMapData> ChunkMapPair;
 
+        /**
+         * Typedef used to hold modified chunk payloads pending write, by byte offset.
+         */
+        typedef std::map<unsigned long long, std::vector<std::uint8_t>> WriteCache;
+
+        /**
+         * Typedef used to hold decoded chunk payloads, by byte offset.  Entries are ordered from most recently used to
+         * least recently used.
+         */
+        typedef std::list<std::pair<unsigned long long, std::vector<std::uint8_t>>> ReadCache;
+
         /**
          * Method that writes the stream start chunk, if needed.  Called by other methods that modify the container to
          * make certain that the stream start chunk exists.
          *
+         * \param[in] container The container holding this virtual file.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status writeStreamStartIfNeeded(ContainerImpl& container);
+
+        /**
+         * Method that determines if the buffered data should be stored inline in the stream start chunk.  Data is
+         * stored inline when the container supports inline payloads, no space is reserved for the file, and the entire
+         * file fits in the stream start chunk.
+         *
+         * \param[in] container The container holding this virtual file.
+         *
+         * \return Returns true if the buffered data should be stored inline.
+         */
+        bool inlinePayloadFits(ContainerImpl& container);
+
+        /**
+         * Method that writes the entire contents of this file inline in the stream start chunk.  The buffered data is
+         * consumed.
+         *
+         * \param[in] container The container holding this virtual file.
+         *
          * \return Returns the status from the operation.
          */
-        Container::Status writeStreamStartIfNeeded();
+        Container::Status writeInlinePayload(ContainerImpl& container);
+
+        /**
+         * Method that moves an inline payload into a stream data chunk.  This method must be called before data chunks
+         * are written so that an inline payload never coexists with data chunks.  The method does nothing if the file
+         * has no inline payload.
+         *
+         * \param[in] container The container holding this virtual file.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status spillInlinePayload(ContainerImpl& container);
+
+        /**
+         * Method that writes the stream start chunk with a given name and inline payload.  The chunk is rewritten in
+         * place when the payload fits, grown into adjacent free space when possible, and relocated otherwise.
+         *
+         * \param[in] container       The container holding this virtual file.
+         *
+         * \param[in] virtualFilename The name to record in the stream start chunk.
+         *
+         * \param[in] payload         The inline payload.  The value is ignored if the count is zero.
+         *
+         * \param[in] count           The size of the inline payload, in bytes.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status saveStreamStart(
+            ContainerImpl&      container,
+            const std::string&  virtualFilename,
+            const std::uint8_t* payload,
+            unsigned            count
+        );
 
         /**
          * Method that flushes the chunk buffer to the media.
          *
+         * \param[in] container The container holding this virtual file.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status flushChunkBuffer(ContainerImpl& container);
+
+        /**
+         * Method that moves a modified chunk out of the chunk buffer.  The chunk is placed in the write cache, if the
+         * write cache is enabled, or written to the media.  The write cache is flushed if it becomes full.
+         *
+         * \param[in] container The container holding this virtual file.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status evictChunkBuffer(ContainerImpl& container);
+
+        /**
+         * Method that writes all chunks in the write cache to the media.  Chunks are written in container order.
+         *
+         * \param[in] container The container holding this virtual file.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status flushWriteCache(ContainerImpl& container);
+
+        /**
+         * Method that writes a modified chunk payload to the media.  Uncompressed chunks are updated in place.
+         * Compressed and shared extents are relocated.
+         *
+         * \param[in] container The container holding this virtual file.
+         *
+         * \param[in] pos       Iterator to the chunk map entry for the chunk.
+         *
+         * \param[in] data      The new payload.  The payload must be the size recorded in the chunk map.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status saveExtent(ContainerImpl& container, ChunkMap::iterator pos, const std::uint8_t* data);
+
+        /**
+         * Method that overwrites part of an uncompressed, unshared chunk in place.  Only the modified bytes and the
+         * chunk header are written.  The bytes being replaced are taken from the chunk buffer or the read cache when
+         * available and are read from the media otherwise.  The chunk buffer and read cache are kept coherent.  The
+         * chunk buffer must not hold unwritten changes to the chunk.
+         *
+         * \param[in] container The container holding this virtual file.
+         *
+         * \param[in] pos       Iterator to the chunk map entry for the chunk.
+         *
+         * \param[in] offset    The offset into the chunk payload of the first byte to be overwritten.
+         *
+         * \param[in] data      The new data.
+         *
+         * \param[in] count     The number of bytes to be overwritten.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status patchExtent(
+            ContainerImpl&      container,
+            ChunkMap::iterator  pos,
+            unsigned            offset,
+            const std::uint8_t* data,
+            unsigned            count
+        );
+
+        /**
+         * Method that loads a chunk into the chunk buffer.  A chunk held in the write cache is moved into the chunk
+         * buffer.
+         *
+         * \param[in] container The container holding this virtual file.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status loadChunkIntoBuffer(ContainerImpl& container);
+
+        /**
+         * Method that reserves space for a new chunk.  Space is taken from the front of the file's reserved area when
+         * the reserved area is large enough and is returned as an invalid free space area.  Otherwise space is
+         * reserved from the container.
+         *
+         * \param[in] container   The container holding this virtual file.
+         *
+         * \param[in] nearIndex   The file index that the chunk should be placed near.
+         *
+         * \param[in] minimumSize The minimum acceptable area size, in file index counts.
+         *
+         * \param[in] desiredSize The desired area size, in file index counts.
+         *
+         * \return Returns the reserved space.
+         */
+        FreeSpace reserveChunkArea(
+            ContainerImpl&         container,
+            ChunkHeader::FileIndex nearIndex,
+            ChunkHeader::FileIndex minimumSize,
+            ChunkHeader::FileIndex desiredSize
+        );
+
+        /**
+         * Method that releases the unused portion of space obtained from \ref VirtualFileImpl::reserveChunkArea once
+         * the chunk has been written.
+         *
+         * \param[in]     container The container holding this virtual file.
+         *
+         * \param[in,out] area      The space holding the chunk.
+         *
+         * \param[in]     chunkSize The size of the written chunk, in bytes.
+         */
+        void releaseChunkArea(ContainerImpl& container, FreeSpace& area, unsigned chunkSize);
+
+        /**
+         * Method that loads the last chunk of the file so that it can be rewritten together with the data that
+         * follows it.  Files that are flushed frequently would otherwise be stored as many small chunks.  Only a
+         * partly filled, uncompressed and unshared chunk with no changes held in memory is reopened, and only if it
+         * was not written by an append.  A chunk that can not be loaded is left as-is.
+         *
+         * \param[in]  container The container holding this virtual file.
+         *
+         * \param[out] payload   Vector to receive the chunk payload.  The vector is left empty if the last chunk is not
+         *                       reopened.
+         */
+        void reopenLastChunk(ContainerImpl& container, std::vector<std::uint8_t>& payload);
+
+        /**
+         * Method that finds space for the last chunk of the file to grow in place.  The free space that directly
+         * follows the last chunk is reserved and the reservation is extended back over the chunk so it can be used
+         * like any other reservation.  If the chunk can't grow but the required size still fits, the chunk's own
+         * space is returned as an invalid free space area.
+         *
+         * \param[in] container    The container holding this virtual file.
+         *
+         * \param[in] requiredSize The area size needed to hold the data, including the last chunk, in file index
+         *                         counts.
+         *
+         * \param[in] desiredSize  The desired area size, including the last chunk, in file index counts.
+         *
+         * \return Returns the space for the chunk.  An empty, invalid free space area is returned if the last chunk
+         *         can not hold the data in place.
+         */
+        FreeSpace growLastChunk(
+            ContainerImpl&         container,
+            ChunkHeader::FileIndex requiredSize,
+            ChunkHeader::FileIndex desiredSize
+        );
+
+        /**
+         * Method that reserves space for a chunk written from the tail of the file.  When the last chunk was
+         * reopened, the chunk grows or is rewritten in place if possible.  Otherwise a larger area is reserved
+         * elsewhere.
+         *
+         * \param[in] container     The container holding this virtual file.
+         *
+         * \param[in] reopenedBytes The number of payload bytes reopened from the last chunk.  A value of 0 indicates
+         *                          that no chunk was reopened and the chunk follows the last chunk.
+         *
+         * \param[in] payloadBytes  The number of payload bytes waiting to be written, including reopened bytes.
+         *
+         * \param[in] desiredSize   The desired area size, in file index counts.
+         *
+         * \return Returns the reserved space.
+         */
+        FreeSpace reserveReopenedChunkArea(
+            ContainerImpl&         container,
+            unsigned               reopenedBytes,
+            unsigned long long     payloadBytes,
+            ChunkHeader::FileIndex desiredSize
+        );
+
+        /**
+         * Method that releases the unused portion of space obtained from
+         * \ref VirtualFileImpl::reserveReopenedChunkArea once a chunk replacing the reopened last chunk has been
+         * written.  The method must be called before the chunk map is updated.
+         *
+         * \param[in]     container The container holding this virtual file.
+         *
+         * \param[in,out] area      The space holding the chunk.
+         *
+         * \param[in]     chunkSize The size of the written chunk, in bytes.
+         */
+        void releaseReopenedChunkArea(ContainerImpl& container, FreeSpace& area, unsigned chunkSize);
+
+        /**
+         * Method that releases the space holding a reopened chunk if its replacement was written elsewhere.  The
+         * method must be called before the chunk map is updated.
+         *
+         * \param[in] container        The container holding this virtual file.
+         *
+         * \param[in] replacementIndex The file index of the chunk that replaces the reopened chunk.
+         */
+        void releaseReopenedChunk(ContainerImpl& container, ChunkHeader::FileIndex replacementIndex);
+
+        /**
+         * Method that returns the unused portion of the file's reserved area to the container.
+         *
+         * \param[in] container The container holding this virtual file.
+         */
+        void releaseReservedArea(ContainerImpl& container);
+
+        /**
+         * Method that determines the container areas used by the data chunks starting at a given entry in the chunk
+         * map.  Chunks that are adjacent in the container are reported as a single area.
+         *
+         * \param[in]  container The container holding this virtual file.
+         *
+         * \param[in]  pos       Iterator to the first chunk to be included.
+         *
+         * \param[in]  verify    If true, each chunk is loaded and checked against the chunk map.  If false, the areas
+         *                       are taken from the chunk map without reading the container.
+         *
+         * \param[out] areas     Vector that will receive the container areas.
+         *
          * \return Returns the status from the operation.
          */
-        Container::Status flushChunkBuffer();
+        Container::Status collectChunkAreas(
+            ContainerImpl&              container,
+            ChunkMap::iterator          pos,
+            bool                        verify,
+            std::vector<ContainerArea>& areas
+        );
+
+        /**
+         * Method that determines if data appended to this file should be compressed.
+         *
+         * \param[in] container The container holding this virtual file.
+         *
+         * \return Returns true if data should be written as compressed extents.
+         */
+        bool compressionActive(ContainerImpl& container) const;
+
+        /**
+         * Method that determines if data appended to this file should be staged as pending extents rather than held
+         * in the tail buffer.
+         *
+         * \param[in] container The container holding this virtual file.
+         *
+         * \return Returns true if data should be staged as pending extents.
+         */
+        bool stagingActive(ContainerImpl& container) const;
 
         /**
-         * Method that loads a chunk into the chunk buffer.
+         * Method that determines if data appended to this file should be held in memory and only assigned container
+         * space when written.
+         *
+         * \param[in] container The container holding this virtual file.
+         *
+         * \return Returns true if container space for appended data should be allocated when the data is written.
+         */
+        bool delayedAllocationActive(ContainerImpl& container) const;
+
+        /**
+         * Method that writes a single extent to the container.  The extent is compressed if compression is active
+         * and the data compresses well.  Otherwise the data is written uncompressed.  Either way, only a leading
+         * portion of the data may be written.
+         *
+         * \param[in]  container    The container holding this virtual file.
+         *
+         * \param[in]  offset       The offset into the virtual file of the first byte of data.
+         *
+         * \param[in]  data         The data to be written.
+         *
+         * \param[in]  count        The number of bytes of data.  The value must not exceed
+         *                          \ref CompressionEngine::maximumBlockSize.
+         *
+         * \param[in]  nearIndex    The file index that the new chunk should be placed near.
+         *
+         * \param[out] bytesWritten The number of bytes of data written.
          *
          * \return Returns the status from the operation.
          */
-        Container::Status loadChunkIntoBuffer();
+        Container::Status writeExtent(
+            ContainerImpl&         container,
+            unsigned long long     offset,
+            const std::uint8_t*    data,
+            unsigned               count,
+            ChunkHeader::FileIndex nearIndex,
+            unsigned*              bytesWritten
+        );
+
+        /**
+         * Method that writes pending uncompressed data to the container as extents.
+         *
+         * \param[in] container The container holding this virtual file.
+         *
+         * \param[in] all       If true, all pending data is written.  If false, only full extents are written.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status flushPendingExtent(ContainerImpl& container, bool all);
+
+        /**
+         * Method that writes all pending data to a single contiguous area of the container.  The area is taken from
+         * the largest free space region that can hold the data, or from the end of the container.
+         *
+         * \param[in] container The container holding this virtual file.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status writeDelayedExtent(ContainerImpl& container);
+
+        /**
+         * Method that writes all buffered data to the container.
+         *
+         * \param[in] container The container holding this virtual file.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status writeBufferedData(ContainerImpl& container);
+
+        /**
+         * Method that reports the amount of data this file holds pending write to the container.
+         *
+         * \param[in] container The container holding this virtual file.
+         */
+        void reportBufferedBytes(ContainerImpl& container);
+
+        /**
+         * Method that reports the amount of data this file holds pending write and then writes data held by the
+         * container's virtual files if the container's write buffer budget is exceeded.
+         *
+         * \param[in] container The container holding this virtual file.
+         *
+         * \param[in] status    The status of the operation that changed the buffered data.
+         *
+         * \return Returns the status of the operation, or the status from writing buffered data if the operation
+         *         succeeded and buffered data could not be written.
+         */
+        Container::Status applyWriteBufferBudget(ContainerImpl& container, const Container::Status& status);
+
+        /**
+         * Method that writes a full extent as a reference to a shared chunk.
+         *
+         * \param[in] container The container holding this virtual file.
+         *
+         * \param[in] offset    The offset into the virtual file of the first byte of data.
+         *
+         * \param[in] data      The extent data.  The extent must be \ref ContainerImpl::sharedExtentSize bytes in
+         *                      length.
+         *
+         * \param[in] nearIndex The file index that the new chunks should be placed near.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status writeSharedExtent(
+            ContainerImpl&         container,
+            unsigned long long     offset,
+            const std::uint8_t*    data,
+            ChunkHeader::FileIndex nearIndex
+        );
+
+        /**
+         * Method that replaces a compressed or shared extent with new data.  The new data is written as one or more
+         * new extents and the space used by the old extent is released.
+         *
+         * \param[in] container The container holding this virtual file.
+         *
+         * \param[in] pos       Iterator to the chunk map entry for the extent to be replaced.
+         *
+         * \param[in] data      The new extent data.
+         *
+         * \param[in] count     The number of bytes of new extent data.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status relocateExtent(
+            ContainerImpl&      container,
+            ChunkMap::iterator  pos,
+            const std::uint8_t* data,
+            unsigned            count
+        );
+
+        /**
+         * Method that loads the payload of a chunk into a buffer.  Compressed extents are decompressed and shared
+         * extents are loaded from their shared chunk.  Chunks held in the write or read caches are copied from the
+         * cache.  Chunks loaded from the media are added to the read cache.
+         *
+         * \param[in] container   The container holding this virtual file.
+         *
+         * \param[in] pos         Iterator to the chunk map entry for the chunk.
+         *
+         * \param[in] destination The buffer to receive the payload.  The buffer must hold the payload size recorded
+         *                        in the chunk map.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status loadExtent(ContainerImpl& container, ChunkMap::const_iterator pos, std::uint8_t* destination);
+
+        /**
+         * Method that loads the payload of a chunk from the media into a buffer.
+         *
+         * \param[in] container   The container holding this virtual file.
+         *
+         * \param[in] pos         Iterator to the chunk map entry for the chunk.
+         *
+         * \param[in] destination The buffer to receive the payload.  The buffer must hold the payload size recorded
+         *                        in the chunk map.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status loadExtentFromContainer(
+            ContainerImpl&           container,
+            ChunkMap::const_iterator pos,
+            std::uint8_t*            destination
+        );
+
+        /**
+         * Method that loads an inline payload from the stream start chunk.
+         *
+         * \param[in] container   The container holding this virtual file.
+         *
+         * \param[in] pos         Iterator to the chunk map entry for the inline payload.
+         *
+         * \param[in] destination The buffer to receive the payload.  The buffer must hold the payload size recorded
+         *                        in the chunk map.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status loadInlinePayload(
+            ContainerImpl&           container,
+            ChunkMap::const_iterator pos,
+            std::uint8_t*            destination
+        );
+
+        /**
+         * Method that determines if the read cache holds a chunk.
+         *
+         * \param[in] offset The byte offset of the chunk.
+         *
+         * \return Returns true if the chunk is in the read cache.
+         */
+        bool readCacheContains(unsigned long long offset) const;
+
+        /**
+         * Method that copies a chunk from the read cache, updating the cache statistics.  The chunk becomes the most
+         * recently used entry.
+         *
+         * \param[in] offset      The byte offset of the chunk.
+         *
+         * \param[in] destination The buffer to receive the payload.
+         *
+         * \return Returns true if the chunk was found.  Returns false if the chunk is not in the read cache.
+         */
+        bool loadFromReadCache(unsigned long long offset, std::uint8_t* destination);
+
+        /**
+         * Method that adds a chunk to the read cache, discarding the least recently used entry if the cache is full.
+         *
+         * \param[in] offset The byte offset of the chunk.
+         *
+         * \param[in] data   The decoded chunk payload.
+         *
+         * \param[in] count  The size of the payload, in bytes.
+         */
+        void addToReadCache(unsigned long long offset, const std::uint8_t* data, unsigned count);
+
+        /**
+         * Method that removes a chunk from the read cache.  Called when a chunk is modified or moved.
+         *
+         * \param[in] offset The byte offset of the chunk.
+         */
+        void invalidateReadCache(unsigned long long offset);
+
+        /**
+         * Method that pins the payload of an uncompressed chunk in the container's data store.  The chunk header is
+         * checked and the payload is verified before the payload is returned.
+         *
+         * \param[in]  container The container holding this virtual file.
+         *
+         * \param[in]  pos       Iterator to the chunk map entry for the chunk.
+         *
+         * \param[out] payload   Location to receive a pointer to the first payload byte.  A null pointer is returned if
+         *                       the payload can not be pinned.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status pinChunkPayload(
+            ContainerImpl&                       container,
+            ChunkMap::const_iterator             pos,
+            std::shared_ptr<const std::uint8_t>* payload
+        );
+
+        /**
+         * Method that copies data into memory owned by a view.  Data is read from the current position.
+         *
+         * \param[in]     count The number of bytes to copy.
+         *
+         * \param[in,out] view  The view to receive the data.
+         *
+         * \return Returns the status from the operation.
+         */
+        Container::Status copyIntoView(unsigned count, Container::VirtualFile::View& view);
+
+        /**
+         * Method that advances a position in a list of buffers.  Empty buffers at the new position are skipped.
+         *
+         * \param[in]     buffers       The list of buffers.
+         *
+         * \param[in]     numberBuffers The number of buffers.
+         *
+         * \param[in]     count         The number of bytes to advance by.
+         *
+         * \param[in,out] bufferIndex   The index of the current buffer.
+         *
+         * \param[in,out] bufferOffset  The offset into the current buffer.
+         */
+        static void advanceBuffers(
+            const Container::VirtualFile::WriteBuffer* buffers,
+            unsigned                                   numberBuffers,
+            unsigned                                   count,
+            unsigned*                                  bufferIndex,
+            unsigned*                                  bufferOffset
+        );
+
+        /**
+         * Method that makes certain the chunk buffer can hold a specified number of bytes.  Existing buffer contents
+         * are not preserved if the buffer must be grown.
+         *
+         * \param[in] requiredSize The required size of the chunk buffer, in bytes.
+         */
+        void reserveChunkBuffer(unsigned requiredSize);
 
         /**
          * Method that determines the current stored size based on the chunk map.
@@ -327,6 +1122,11 @@ class VirtualFileImpl {
          */
         ChunkHeader::FileIndex startChunkIndex;
 
+        /**
+         * The size of the file start chunk, in file index counts.
+         */
+        ChunkHeader::FileIndex startChunkSize;
+
         /**
          * Map of chunks actively stored in the container, by byte offset.
          */
@@ -342,20 +1142,106 @@ class VirtualFileImpl {
          */
         std::uint8_t* chunkBuffer;
 
+        /**
+         * The current allocated size of the chunk buffer, in bytes.
+         */
+        unsigned chunkBufferCapacity;
+
         /**
          * Flag that indicates if the local buffer needs to be flushed.
          */
         bool chunkBufferFlushNeeded;
 
+        /**
+         * The file offset just past the last in-place patch.  A write starting here is treated as sequential and is
+         * gathered in the chunk buffer rather than patched.
+         */
+        unsigned long long lastPatchEnd;
+
+        /**
+         * Flag indicating that the last chunk of the file may be reopened.  Chunks written by appends are sized to the
+         * free space they're placed in and are never reopened.  Chunks written when the tail buffer is flushed are.
+         */
+        bool lastChunkReopenable;
+
+        /**
+         * Modified chunk payloads waiting to be written to the media.  The chunk in the chunk buffer is never held in
+         * the write cache.
+         */
+        WriteCache writeCache;
+
+        /**
+         * The number of bytes of payload data held in the write cache.
+         */
+        unsigned long long writeCacheBytes;
+
+        /**
+         * The maximum number of bytes of payload data to hold in the write cache.
+         */
+        unsigned long long maximumWriteCacheBytes;
+
+        /**
+         * The number of buffered bytes last reported to the container.
+         */
+        unsigned long long reportedBufferedBytes;
+
+        /**
+         * Contiguous area of the container reserved for data appended to this file.  Chunks are placed at the front of
+         * the area.  The area is not tracked by the container's free space map until released.
+         */
+        ContainerArea reservedArea;
+
+        /**
+         * Decoded chunk payloads that match the media, most recently used first.
+         */
+        ReadCache readCache;
+
+        /**
+         * The maximum number of chunks to hold in the read cache.
+         */
+        unsigned maximumReadCacheEntries;
+
+        /**
+         * The number of chunk loads satisfied by the read cache.
+         */
+        unsigned long long readCacheHitCount;
+
+        /**
+         * The number of chunk loads that required access to the media.
+         */
+        unsigned long long readCacheMissCount;
+
         /**
          * Ring buffer used to hold partial chunks of data at the end of the file.
          */
         RingBuffer<std::uint8_t, tailBufferSize> tailBuffer;
 
+        /**
+         * The CRC of the data in the tail buffer, calculated with an initial value of 0 as the data is copied into the
+         * tail buffer.
+         */
+        ChunkHeader::RunningCrc tailBufferCrc;
+
+        /**
+         * Flag indicating that the tail buffer CRC reflects the current tail buffer contents.
+         */
+        bool tailBufferCrcValid;
+
         /**
          * The the current offset into the file.  Value represents the offset just past the end of the local buffer.
          */
         unsigned long long currentPosition;
+
+        /**
+         * The current compression setting.
+         */
+        Container::VirtualFile::Compression currentCompression;
+
+        /**
+         * Buffer holding uncompressed data at the end of the file that has not yet been written as an extent.  Used
+         * in place of the tail buffer while compression or delayed allocation is active.
+         */
+        std::vector<std::uint8_t> pendingExtent;
 };
 
 #endif
@@ -32,6 +32,9 @@ HEADERS = test_status.h \
           test_free_space_tracker.h \
           test_ring_buffer.h \
           test_chunk_map_data.h \
+          test_shared_chunk_data.h \
+          test_crc_engine.h \
+          test_compression_engine.h \
           test_chunk_header.h \
           test_chunk.h \
           test_fill_chunk.h \
@@ -52,6 +55,9 @@ SOURCES = test_status.cpp \
           test_free_space_tracker.cpp \
           test_ring_buffer.cpp \
           test_chunk_map_data.cpp \
+          test_shared_chunk_data.cpp \
+          test_crc_engine.cpp \
+          test_compression_engine.cpp \
           test_chunk_header.cpp \
           test_chunk.cpp \
           test_fill_chunk.cpp \
@@ -42,13 +42,13 @@
 class ChunkWrapper:public Chunk {
     public:
         ChunkWrapper(
-            std::weak_ptr<ContainerImpl> container,
+            ContainerImpl&               container,
             FileIndex                    fileIndex,
             unsigned                     additionalHeaderSizeBytes = 0
         );
 
         ChunkWrapper(
-            std::weak_ptr<ContainerImpl> container,
+            ContainerImpl&               container,
             FileIndex                    fileIndex,
             std::uint8_t*                rawData,
             unsigned                     rawDataLengthBytes
@@ -67,7 +67,7 @@ class ChunkWrapper:public Chunk {
 
 
 ChunkWrapper::ChunkWrapper(
-        std::weak_ptr<ContainerImpl> container,
+        ContainerImpl&               container,
         FileIndex                    fileIndex,
         unsigned                     additionalHeaderSizeBytes
     ):Chunk(
@@ -78,7 +78,7 @@ ChunkWrapper::ChunkWrapper(
 
 
 ChunkWrapper::ChunkWrapper(
-        std::weak_ptr<ContainerImpl> container,
+        ContainerImpl&               container,
         FileIndex                    fileIndex,
         std::uint8_t*                rawData,
         unsigned                     rawDataLengthBytes
@@ -122,7 +122,7 @@ void TestChunk::testSaveLoadMethods() {
     Container::Status status = container.open();
     QVERIFY(!status);
 
-    ChunkWrapper chunk1(dynamic_cast<Container::Container&>(container).impl, 0, 124);
+    ChunkWrapper chunk1(*dynamic_cast<Container::Container&>(container).impl, 0, 124);
 
     chunk1.setType(Chunk::Type::STREAM_START_CHUNK);
     chunk1.setNumberValidBytes(124);
@@ -135,7 +135,7 @@ void TestChunk::testSaveLoadMethods() {
     status = chunk1.save();
     QVERIFY(status.success());
 
-    ChunkWrapper chunk2(dynamic_cast<Container::Container&>(container).impl, 0, 124);
+    ChunkWrapper chunk2(*dynamic_cast<Container::Container&>(container).impl, 0, 124);
     status = chunk2.load(true); // Include common header during load.
     QVERIFY(status.success());
 
@@ -147,3 +147,74 @@ void TestChunk::testSaveLoadMethods() {
         QVERIFY(chunk1.additionalHeader()[i] == chunk2.additionalHeader()[i]);
     }
 }
+
+
+void TestChunk::testTailPadding() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+    std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+
+    Container::MemoryContainer container("Inesonic, LLC./nAleph");
+
+    Container::Status status = container.open(containerBuffer);
+    QVERIFY(!status);
+
+    Chunk::FileIndex fileIndex = Chunk::toFileIndex(containerBuffer->size());
+    ChunkWrapper     chunk(*dynamic_cast<Container::Container&>(container).impl, fileIndex, 64);
+
+    chunk.setType(Chunk::Type::STREAM_START_CHUNK);
+    chunk.setNumberValidBytes(68, true);
+    QVERIFY(chunk.chunkSize() > chunk.numberValidBytes());
+
+    unsigned long long chunkStart = Chunk::toPosition(fileIndex);
+    unsigned long long chunkEnd   = chunkStart + chunk.chunkSize();
+    unsigned long long tailStart  = chunkStart + 4 + chunk.numberValidBytes();
+
+    // Tails are padded with zeros.
+
+    status = chunk.save();
+    QVERIFY(!status);
+    QVERIFY(containerBuffer->size() == chunkEnd);
+
+    for (unsigned long long i=tailStart ; i<chunkEnd ; ++i) {
+        QVERIFY(containerBuffer->at(i) == 0);
+    }
+
+    // Padding-free writes leave space already in the container untouched.
+
+    for (unsigned long long i=tailStart ; i<chunkEnd ; ++i) {
+        containerBuffer->at(i) = 0xA5;
+    }
+
+    container.setPaddingFreeWrites();
+    QVERIFY(container.paddingFreeWrites());
+
+    status = chunk.save();
+    QVERIFY(!status);
+    QVERIFY(containerBuffer->size() == chunkEnd);
+
+    for (unsigned long long i=tailStart ; i<chunkEnd ; ++i) {
+        QVERIFY(containerBuffer->at(i) == 0xA5);
+    }
+
+    // Padding-free writes still extend the container to the end of the chunk.
+
+    containerBuffer->resize(tailStart + 8);
+
+    status = chunk.save();
+    QVERIFY(!status);
+    QVERIFY(containerBuffer->size() == chunkEnd);
+
+    for (unsigned long long i=tailStart ; i<tailStart + 8 ; ++i) {
+        QVERIFY(containerBuffer->at(i) == 0xA5);
+    }
+
+    for (unsigned long long i=tailStart + 8 ; i<chunkEnd ; ++i) {
+        QVERIFY(containerBuffer->at(i) == 0);
+    }
+
+    ChunkWrapper loadedChunk(*dynamic_cast<Container::Container&>(container).impl, fileIndex, 64);
+    status = loadedChunk.load(true);
+    QVERIFY(status.success());
+    QVERIFY(loadedChunk.checkCrc());
+    QVERIFY(loadedChunk.chunkSize() == chunk.chunkSize());
+}
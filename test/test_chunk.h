@@ -31,6 +31,8 @@ class TestChunk:public QObject {
 
     private slots:
         void testSaveLoadMethods();
+
+        void testTailPadding();
 };
 
 #endif
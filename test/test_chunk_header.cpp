@@ -24,6 +24,7 @@
 #include <QtTest/QtTest>
 
 #include <cstdint>
+#include <cstring>
 #include <random>
 
 #include <chunk_header.h>
@@ -46,10 +47,16 @@ class ChunkHeaderWrapper:public ChunkHeader {
 
         const std::uint8_t* fullHeader() const;
 
+        unsigned fullHeaderSizeBytes() const;
+
+        std::uint8_t* additionalHeader() const;
+
         void setType(ChunkHeader::Type newType);
 
         unsigned setNumberValidBytes(unsigned newValidByteCount, bool canChangeChunkSize = false);
 
+        unsigned setBestFitSize(unsigned availableSpace, bool allowExtended);
+
         ChunkHeader::RunningCrc initializeCrc() const;
 
         static ChunkHeader::RunningCrc calculateCrc(
@@ -85,6 +92,16 @@ const std::uint8_t* ChunkHeaderWrapper::fullHeader() const {
 }
 
 
+unsigned ChunkHeaderWrapper::fullHeaderSizeBytes() const {
+    return ChunkHeader::fullHeaderSizeBytes();
+}
+
+
+std::uint8_t* ChunkHeaderWrapper::additionalHeader() const {
+    return ChunkHeader::additionalHeader();
+}
+
+
 void ChunkHeaderWrapper::setType(ChunkHeader::Type newType) {
     ChunkHeader::setType(newType);
 }
@@ -95,6 +112,11 @@ unsigned ChunkHeaderWrapper::setNumberValidBytes(unsigned newValidByteCount, boo
 }
 
 
+unsigned ChunkHeaderWrapper::setBestFitSize(unsigned availableSpace, bool allowExtended) {
+    return ChunkHeader::setBestFitSize(availableSpace, allowExtended);
+}
+
+
 ChunkHeader::RunningCrc ChunkHeaderWrapper::initializeCrc() const {
     return ChunkHeader::initializeCrc();
 }
@@ -345,3 +367,98 @@ void TestChunkHeader::testCrcCalculation() {
         checkData[index+2] ^= b2;
     }
 }
+
+
+void TestChunkHeader::testExtendedChunks() {
+    ChunkHeaderWrapper chunkHeader(4);
+    chunkHeader.setType(ChunkHeader::Type::STREAM_DATA_CHUNK);
+
+    std::uint8_t* additional = chunkHeader.additionalHeader();
+    additional[0] = 0x12;
+    additional[1] = 0x34;
+    additional[2] = 0x56;
+    additional[3] = 0x78;
+
+    // Standard chunks must never grow into extended chunks.
+
+    QVERIFY(chunkHeader.setBestFitSize(ChunkHeader::maximumExtendedChunkSize, false) == 4096);
+    QVERIFY(!chunkHeader.isExtended());
+    QVERIFY(chunkHeader.setNumberValidBytes(100000, true) == 4092);
+    QVERIFY(chunkHeader.chunkSize() == 4096);
+
+    // Switch to an extended chunk and confirm the additional header follows the extended header.
+
+    QVERIFY(chunkHeader.setBestFitSize(3 * ChunkHeader::maximumExtendedChunkSize, true) == (1 << 20));
+    QVERIFY(chunkHeader.isExtended());
+    QVERIFY(chunkHeader.type() == ChunkHeader::Type::STREAM_DATA_CHUNK);
+    QVERIFY(chunkHeader.chunkSize() == (1 << 20));
+    QVERIFY(chunkHeader.numberValidBytes() == (1 << 20) - 8);
+    QVERIFY(chunkHeader.fullHeaderSizeBytes() == 12);
+
+    additional = chunkHeader.additionalHeader();
+    QVERIFY(additional[0] == 0x12 && additional[1] == 0x34 && additional[2] == 0x56 && additional[3] == 0x78);
+
+    QVERIFY(chunkHeader.setBestFitSize(12000, true) == 8192);
+    QVERIFY(chunkHeader.isExtended());
+    QVERIFY(chunkHeader.chunkSize() == 8192);
+
+    QVERIFY(chunkHeader.setBestFitSize(ChunkHeader::maximumExtendedChunkSize, true) == (1 << 20));
+
+    // Right-size the chunk for a range of payloads.
+
+    for (unsigned p2=5 ; p2<=20 ; ++p2) {
+        unsigned validBytes = (1 << p2) - (p2 <= 12 ? 4 : 8);
+
+        QVERIFY(chunkHeader.setNumberValidBytes(validBytes) == validBytes);
+        QVERIFY(chunkHeader.chunkSize() == (1U << p2));
+        QVERIFY(chunkHeader.numberValidBytes() == validBytes);
+        QVERIFY(chunkHeader.isExtended() == (p2 > 12));
+        QVERIFY(chunkHeader.type() == ChunkHeader::Type::STREAM_DATA_CHUNK);
+
+        additional = chunkHeader.additionalHeader();
+        QVERIFY(additional[0] == 0x12 && additional[1] == 0x34 && additional[2] == 0x56 && additional[3] == 0x78);
+
+        chunkHeader.setBestFitSize(ChunkHeader::maximumExtendedChunkSize, true);
+    }
+
+    // Payloads just over a standard chunk must use the smallest extended chunk.
+
+    QVERIFY(chunkHeader.setNumberValidBytes(4093) == 4093);
+    QVERIFY(chunkHeader.isExtended());
+    QVERIFY(chunkHeader.chunkSize() == 8192);
+
+    // Chunks can not grow beyond their current size.
+
+    QVERIFY(chunkHeader.setNumberValidBytes(300001) == 8184);
+    QVERIFY(chunkHeader.chunkSize() == 8192);
+
+    // Confirm that the header survives a round trip through raw storage.
+
+    chunkHeader.setBestFitSize(ChunkHeader::maximumExtendedChunkSize, true);
+    QVERIFY(chunkHeader.setNumberValidBytes(300001) == 300001);
+    QVERIFY(chunkHeader.chunkSize() == (1 << 19));
+
+    std::uint8_t rawHeader[12];
+    std::memcpy(rawHeader, chunkHeader.fullHeader(), 12);
+
+    ChunkHeaderWrapper restoredHeader(rawHeader, 4);
+    QVERIFY(restoredHeader.isExtended());
+    QVERIFY(restoredHeader.chunkSize() == (1 << 19));
+    QVERIFY(restoredHeader.fullHeaderSizeBytes() == 12);
+
+    // The extended header must be covered by the CRC.
+
+    ChunkHeader::RunningCrc crc1 = chunkHeader.initializeCrc();
+    chunkHeader.setNumberValidBytes(300002);
+    ChunkHeader::RunningCrc crc2 = chunkHeader.initializeCrc();
+
+    QVERIFY(crc1 != crc2);
+
+    // Standard chunks can never be mistaken for extended chunks.
+
+    ChunkHeaderWrapper standardHeader;
+    for (unsigned i=0 ; i<=4092 ; ++i) {
+        standardHeader.setNumberValidBytes(i, true);
+        QVERIFY(!standardHeader.isExtended());
+    }
+}
@@ -40,6 +40,8 @@ class TestChunkHeader:public QObject {
 
         void testCrcCalculation();
 
+        void testExtendedChunks();
+
     private:
         static constexpr unsigned crcPayloadSize           = 4092;
         static constexpr long     crcPolynomial            = 0x18005;
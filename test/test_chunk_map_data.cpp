@@ -28,18 +28,20 @@
 #include "test_chunk_map_data.h"
 
 void TestChunkMapData::testConstructorsDestructors() {
-    ChunkMapData data1(1, 2);
+    ChunkMapData data1(1, 6, 2);
     QVERIFY(data1.startingIndex() == 1);
+    QVERIFY(data1.areaSize() == 6);
     QVERIFY(data1.payloadSize() == 2);
 
     ChunkMapData data2(data1);
     QVERIFY(data2.startingIndex() == 1);
+    QVERIFY(data2.areaSize() == 6);
     QVERIFY(data2.payloadSize() == 2);
 }
 
 
 void TestChunkMapData::testAccessors() {
-    ChunkMapData data(1, 2);
+    ChunkMapData data(1, 6, 2);
 
     data.setStartingIndex(3);
     QVERIFY(data.startingIndex() == 3);
@@ -48,19 +50,41 @@ void TestChunkMapData::testAccessors() {
     data.setPayloadSize(4);
     QVERIFY(data.startingIndex() == 3);
     QVERIFY(data.payloadSize() == 4);
+
+    data.setAreaSize(7);
+    QVERIFY(data.areaSize() == 7);
+    QVERIFY(data.startingIndex() == 3);
+    QVERIFY(data.payloadSize() == 4);
+
+    QVERIFY(!data.shared());
+    QVERIFY(data.sharedIndex() == ChunkHeader::invalidFileIndex);
+
+    data.setSharedIndex(5);
+    QVERIFY(data.shared());
+    QVERIFY(data.sharedIndex() == 5);
+    QVERIFY(data.startingIndex() == 3);
+    QVERIFY(data.payloadSize() == 4);
+
+    QVERIFY(!data.inlined());
+
+    data.setInlined(true);
+    QVERIFY(data.inlined());
+    QVERIFY(data.startingIndex() == 3);
+    QVERIFY(data.payloadSize() == 4);
 }
 
 
 void TestChunkMapData::testAssignmentOperator() {
-    ChunkMapData data1(1, 2);
+    ChunkMapData data1(1, 6, 2);
     QVERIFY(data1.startingIndex() == 1);
     QVERIFY(data1.payloadSize() == 2);
 
-    ChunkMapData data2(3, 4);
+    ChunkMapData data2(3, 8, 4);
     QVERIFY(data2.startingIndex() == 3);
     QVERIFY(data2.payloadSize() == 4);
 
     data2 = data1;
     QVERIFY(data2.startingIndex() == 1);
+    QVERIFY(data2.areaSize() == 6);
     QVERIFY(data2.payloadSize() == 2);
 }
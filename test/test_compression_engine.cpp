@@ -0,0 +1,249 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements tests of the CompressionEngine class.
+***********************************************************************************************************************/
+
+#include <QDebug>
+#include <QtTest/QtTest>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <random>
+
+#include <compression_engine.h>
+
+#include "test_compression_engine.h"
+
+static const CompressionEngine::Level allLevels[] = {
+    CompressionEngine::Level::FAST,
+    CompressionEngine::Level::HIGH_RATIO
+};
+
+/**
+ * Function that generates text-like data that compresses well.
+ *
+ * \param[in] rng    The random number generator to use.
+ *
+ * \param[in] length The number of bytes to generate.
+ *
+ * \return Returns the generated data.
+ */
+static std::vector<std::uint8_t> generateText(std::mt19937& rng, unsigned length) {
+    static const char* const words[] = {
+        "container ", "virtual ", "file ", "chunk ", "stream ", "the ", "of ", "data ", "and ", "extent ",
+        "compressed ", "payload ", "header ", "offset ", "index ", "\n"
+    };
+
+    std::uniform_int_distribution<> wordGenerator(0, sizeof(words) / sizeof(words[0]) - 1);
+    std::vector<std::uint8_t>       result;
+
+    while (result.size() < length) {
+        const char* word = words[wordGenerator(rng)];
+        result.insert(result.end(), word, word + std::strlen(word));
+    }
+
+    result.resize(length);
+    return result;
+}
+
+/***********************************************************************************************************************
+ * TestCompressionEngine
+ */
+
+void TestCompressionEngine::testRoundTrip() {
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> lengthGenerator(0, CompressionEngine::maximumBlockSize);
+
+    CompressionEngine engine;
+
+    for (unsigned i=0 ; i<numberRandomTests ; ++i) {
+        unsigned length = lengthGenerator(rng);
+        if (i == 0) {
+            length = 0;
+        } else if (i == 1) {
+            length = CompressionEngine::maximumBlockSize;
+        }
+
+        std::vector<std::uint8_t> source = generateText(rng, length);
+
+        // Text data never expands so a destination the size of the source is always sufficient.
+        std::vector<std::uint8_t> block(length + CompressionEngine::blockHeaderSizeBytes + 16);
+        std::vector<std::uint8_t> result(length + 1);
+
+        for (CompressionEngine::Level level : allLevels) {
+            unsigned consumed;
+            unsigned blockLength = engine.compress(
+                level,
+                source.data(),
+                length,
+                block.data(),
+                static_cast<unsigned>(block.size()),
+                &consumed
+            );
+
+            QVERIFY(blockLength >= CompressionEngine::blockHeaderSizeBytes);
+            QVERIFY(consumed == length);
+            QVERIFY(CompressionEngine::decompressedSize(block.data(), blockLength) == length);
+
+            if (length > 1000) {
+                QVERIFY(blockLength < length / 2);
+            }
+
+            QVERIFY(CompressionEngine::decompress(block.data(), blockLength, result.data(), length));
+            QVERIFY(std::memcmp(result.data(), source.data(), length) == 0);
+        }
+    }
+}
+
+
+void TestCompressionEngine::testLimitedDestination() {
+    std::mt19937 rng;
+
+    CompressionEngine         engine;
+    std::vector<std::uint8_t> source = generateText(rng, CompressionEngine::maximumBlockSize);
+    std::vector<std::uint8_t> result(CompressionEngine::maximumBlockSize);
+
+    for (CompressionEngine::Level level : allLevels) {
+        unsigned                  fullConsumed;
+        std::vector<std::uint8_t> block(CompressionEngine::maximumBlockSize);
+        unsigned                  fullLength = engine.compress(
+            level,
+            source.data(),
+            static_cast<unsigned>(source.size()),
+            block.data(),
+            static_cast<unsigned>(block.size()),
+            &fullConsumed
+        );
+
+        QVERIFY(fullConsumed == source.size());
+
+        // Blocks limited to a fraction of the full block length must hold a proportional amount of the source.
+
+        unsigned step = fullLength / 7;
+        for (unsigned capacity=CompressionEngine::blockHeaderSizeBytes+1 ; capacity<fullLength ; capacity+=step) {
+            unsigned consumed;
+            unsigned blockLength = engine.compress(
+                level,
+                source.data(),
+                static_cast<unsigned>(source.size()),
+                block.data(),
+                capacity,
+                &consumed
+            );
+
+            QVERIFY(blockLength <= capacity);
+            QVERIFY(consumed < source.size());
+            QVERIFY(CompressionEngine::decompressedSize(block.data(), blockLength) == consumed);
+            QVERIFY(CompressionEngine::decompress(block.data(), blockLength, result.data(), consumed));
+            QVERIFY(std::memcmp(result.data(), source.data(), consumed) == 0);
+
+            if (capacity > fullLength / 2) {
+                QVERIFY(consumed > source.size() / 4);
+            }
+        }
+
+        unsigned consumed;
+        QVERIFY(engine.compress(level, source.data(), 100, block.data(), 2, &consumed) == 0);
+        QVERIFY(consumed == 0);
+    }
+}
+
+
+void TestCompressionEngine::testIncompressibleData() {
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+
+    CompressionEngine         engine;
+    std::vector<std::uint8_t> source(CompressionEngine::maximumBlockSize);
+    std::vector<std::uint8_t> block(CompressionEngine::maximumBlockSize);
+    std::vector<std::uint8_t> result(CompressionEngine::maximumBlockSize);
+
+    for (unsigned i=0 ; i<source.size() ; ++i) {
+        source[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+    }
+
+    for (CompressionEngine::Level level : allLevels) {
+        // Random data can't be compressed so a block limited to 7/8 of the source can't hold all of the source.
+
+        unsigned consumed;
+        unsigned capacity    = static_cast<unsigned>(source.size() - source.size() / 8);
+        unsigned blockLength = engine.compress(
+            level,
+            source.data(),
+            static_cast<unsigned>(source.size()),
+            block.data(),
+            capacity,
+            &consumed
+        );
+
+        QVERIFY(blockLength <= capacity);
+        QVERIFY(consumed < source.size());
+        QVERIFY(consumed > capacity / 2);
+        QVERIFY(CompressionEngine::decompress(block.data(), blockLength, result.data(), consumed));
+        QVERIFY(std::memcmp(result.data(), source.data(), consumed) == 0);
+    }
+}
+
+
+void TestCompressionEngine::testCorruptBlocks() {
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+
+    CompressionEngine         engine;
+    std::vector<std::uint8_t> source = generateText(rng, 20000);
+    std::vector<std::uint8_t> block(source.size());
+    std::vector<std::uint8_t> result(source.size());
+
+    unsigned consumed;
+    unsigned blockLength = engine.compress(
+        CompressionEngine::Level::FAST,
+        source.data(),
+        static_cast<unsigned>(source.size()),
+        block.data(),
+        static_cast<unsigned>(block.size()),
+        &consumed
+    );
+
+    QVERIFY(consumed == source.size());
+
+    // Truncated blocks and blocks claiming more data than the destination can hold must be rejected.
+
+    QVERIFY(!CompressionEngine::decompress(block.data(), blockLength - 1, result.data(), consumed));
+    QVERIFY(!CompressionEngine::decompress(block.data(), 2, result.data(), consumed));
+    QVERIFY(!CompressionEngine::decompress(block.data(), blockLength, result.data(), consumed - 1));
+
+    // Corrupted blocks must never write outside the destination.  The result is allowed to be either accepted or
+    // rejected.
+
+    std::uniform_int_distribution<> positionGenerator(CompressionEngine::blockHeaderSizeBytes, blockLength - 1);
+    std::vector<std::uint8_t>       guarded(source.size() + 64, 0xA5);
+
+    for (unsigned i=0 ; i<1000 ; ++i) {
+        std::vector<std::uint8_t> corrupted = block;
+        corrupted[positionGenerator(rng)] = static_cast<std::uint8_t>(byteGenerator(rng));
+
+        CompressionEngine::decompress(corrupted.data(), blockLength, guarded.data(), consumed);
+
+        for (unsigned j=consumed ; j<guarded.size() ; ++j) {
+            QVERIFY(guarded[j] == 0xA5);
+        }
+    }
+}
@@ -111,3 +111,334 @@ void TestContainerBase::testContainerApi() {
 
     QVERIFY(containerSize() == 64);
 }
+
+
+void TestContainerBase::testEraseFilesAndClear() {
+    std::uint8_t buffer[bufferSizeInBytes];
+
+    std::shared_ptr<Container::Container> writeContainer = allocateContainer("Inesonic, LLC.\nAleph Test");
+
+    Container::Status status = openContainer(writeContainer, true);
+    QVERIFY(status.success());
+
+    for (unsigned fileIndex=0 ; fileIndex<numberVirtualFiles ; ++fileIndex) {
+        std::stringstream stream;
+        stream << "test" << fileIndex << ".dat";
+
+        std::shared_ptr<Container::VirtualFile> vf = writeContainer->newVirtualFile(stream.str());
+        QVERIFY(vf);
+
+        for (unsigned i=0 ; i<bufferSizeInBytes ; ++i) {
+            buffer[i] = static_cast<std::uint8_t>((i + fileIndex) % 251);
+        }
+
+        unsigned long bytesRemaining = totalBytesAcrossFiles / numberVirtualFiles;
+        while (bytesRemaining > 0) {
+            unsigned count = bytesRemaining > bufferSizeInBytes ? bufferSizeInBytes : bytesRemaining;
+            status = vf->append(buffer, count);
+            QVERIFY(status.success());
+
+            bytesRemaining -= count;
+        }
+    }
+
+    status = closeContainer(writeContainer);
+    QVERIFY(!status);
+
+    unsigned long long fullSize = containerSize();
+    QVERIFY(fullSize > totalBytesAcrossFiles);
+
+    // Erase a group of files.  Unknown names are ignored.
+
+    std::shared_ptr<Container::Container> eraseContainer = allocateContainer("Inesonic, LLC.\nAleph Test");
+
+    status = openContainer(eraseContainer, false);
+    QVERIFY(status.success());
+
+    std::vector<std::string> names = { "test0.dat", "test2.dat", "missing.dat" };
+    status = eraseContainer->eraseFiles(names);
+    QVERIFY(!status);
+
+    QVERIFY(!eraseContainer->virtualFile("test0.dat"));
+    QVERIFY(!eraseContainer->virtualFile("test2.dat"));
+
+    status = closeContainer(eraseContainer);
+    QVERIFY(!status);
+
+    QVERIFY(containerSize() <= fullSize);
+
+    std::shared_ptr<Container::Container> readContainer = allocateContainer("Inesonic, LLC.\nAleph Test");
+
+    status = openContainer(readContainer, false);
+    QVERIFY(status.success());
+
+    Container::Container::DirectoryMap directory = readContainer->directory();
+    QVERIFY(directory.size() == 2);
+
+    for (unsigned fileIndex=1 ; fileIndex<numberVirtualFiles ; fileIndex+=2) {
+        std::stringstream stream;
+        stream << "test" << fileIndex << ".dat";
+
+        Container::Container::DirectoryMap::iterator pos = directory.find(stream.str());
+        QVERIFY(pos != directory.end());
+
+        std::shared_ptr<Container::VirtualFile> vf = pos->second;
+        QVERIFY(vf->size() == totalBytesAcrossFiles / numberVirtualFiles);
+
+        status = vf->read(buffer, bufferSizeInBytes);
+        QVERIFY(status.success());
+
+        for (unsigned i=0 ; i<bufferSizeInBytes ; ++i) {
+            QVERIFY(buffer[i] == static_cast<std::uint8_t>((i + fileIndex) % 251));
+        }
+    }
+
+    // Clear the container.  Files obtained before the clear can no longer be used.
+
+    std::shared_ptr<Container::VirtualFile> oldFile = directory.begin()->second;
+    directory.clear();
+
+    status = readContainer->clear();
+    QVERIFY(!status);
+
+    QVERIFY(oldFile->size() < 0);
+    QVERIFY(readContainer->directory().empty());
+    QVERIFY(containerSize() == 64);
+
+    std::shared_ptr<Container::VirtualFile> vf = readContainer->newVirtualFile("test0.dat");
+    QVERIFY(vf);
+
+    status = vf->append(buffer, bufferSizeInBytes);
+    QVERIFY(status.success());
+
+    status = closeContainer(readContainer);
+    QVERIFY(!status);
+
+    QVERIFY(containerSize() > bufferSizeInBytes);
+    QVERIFY(containerSize() < 2 * bufferSizeInBytes);
+
+    std::shared_ptr<Container::Container> finalContainer = allocateContainer("Inesonic, LLC.\nAleph Test");
+
+    status = openContainer(finalContainer, false);
+    QVERIFY(status.success());
+
+    directory = finalContainer->directory();
+    QVERIFY(directory.size() == 1);
+    QVERIFY(directory.find("test0.dat") != directory.end());
+
+    status = closeContainer(finalContainer);
+    QVERIFY(!status);
+}
+
+
+void TestContainerBase::testBulkIngest() {
+    std::uint8_t buffer[bufferSizeInBytes];
+
+    std::vector<std::uint8_t> data(largeIngestFileSize);
+    for (unsigned i=0 ; i<largeIngestFileSize ; ++i) {
+        data[i] = static_cast<std::uint8_t>((7 * i) % 251);
+    }
+
+    std::shared_ptr<Container::Container> writeContainer = allocateContainer("Inesonic, LLC.\nAleph Test");
+
+    Container::Status status = openContainer(writeContainer, true);
+    QVERIFY(status.success());
+
+    status = writeContainer->ingestFile("early.dat", data.data(), 100);
+    QVERIFY(status.errorCode() == Container::IngestSessionError::reportedErrorCode);
+
+    status = writeContainer->beginIngest();
+    QVERIFY(!status);
+    QVERIFY(writeContainer->ingestActive());
+
+    status = writeContainer->beginIngest();
+    QVERIFY(status.errorCode() == Container::IngestSessionError::reportedErrorCode);
+
+    // File sizes vary from empty files to files spanning several staging buffers.  Each file starts at a different
+    // point in the data so that misplaced chunks are detected.
+
+    for (unsigned fileIndex=0 ; fileIndex<numberIngestFiles ; ++fileIndex) {
+        std::stringstream stream;
+        stream << "ingest" << fileIndex << ".dat";
+
+        status = writeContainer->ingestFile(stream.str(), data.data() + fileIndex, ingestFileSize(fileIndex));
+        QVERIFY(!status);
+
+        if (fileIndex == numberIngestFiles / 3) {
+            // Files written normally during the session are placed after the data already staged.
+
+            std::shared_ptr<Container::VirtualFile> vf = writeContainer->newVirtualFile("normal.dat");
+            QVERIFY(vf);
+
+            status = vf->append(data.data(), bufferSizeInBytes);
+            QVERIFY(status.success());
+
+            status = vf->flush();
+            QVERIFY(!status);
+        }
+    }
+
+    status = writeContainer->ingestFile("ingest0.dat", data.data(), 100);
+    QVERIFY(status.failure());
+
+    QVERIFY(!writeContainer->virtualFile("ingest0.dat"));
+    QVERIFY(!writeContainer->newVirtualFile("ingest1.dat"));
+
+    status = writeContainer->commitIngest();
+    QVERIFY(!status);
+    QVERIFY(!writeContainer->ingestActive());
+
+    QVERIFY(writeContainer->directory().size() == numberIngestFiles + 1);
+
+    status = closeContainer(writeContainer);
+    QVERIFY(!status);
+
+    unsigned long long ingestedSize = containerSize();
+
+    // Verify the contents after re-opening the container.  An aborted session must leave the container unchanged.
+
+    std::shared_ptr<Container::Container> readContainer = allocateContainer("Inesonic, LLC.\nAleph Test");
+
+    status = openContainer(readContainer, false);
+    QVERIFY(status.success());
+
+    Container::Container::DirectoryMap directory = readContainer->directory();
+    QVERIFY(directory.size() == numberIngestFiles + 1);
+
+    for (unsigned fileIndex=0 ; fileIndex<numberIngestFiles ; ++fileIndex) {
+        std::stringstream stream;
+        stream << "ingest" << fileIndex << ".dat";
+
+        Container::Container::DirectoryMap::iterator pos = directory.find(stream.str());
+        QVERIFY(pos != directory.end());
+
+        std::shared_ptr<Container::VirtualFile> vf = pos->second;
+
+        unsigned fileSize = ingestFileSize(fileIndex);
+        QVERIFY(vf->size() == fileSize);
+
+        unsigned long long offset = 0;
+        while (offset < fileSize) {
+            unsigned count = fileSize - offset > bufferSizeInBytes ? bufferSizeInBytes : fileSize - offset;
+
+            status = vf->read(buffer, count);
+            QVERIFY(status.success());
+            QVERIFY(Container::ReadSuccessful(status).bytesRead() == count);
+            QVERIFY(std::memcmp(buffer, data.data() + fileIndex + offset, count) == 0);
+
+            offset += count;
+        }
+    }
+
+    std::shared_ptr<Container::VirtualFile> normalFile = readContainer->virtualFile("normal.dat");
+    QVERIFY(normalFile);
+    QVERIFY(normalFile->size() == bufferSizeInBytes);
+
+    status = normalFile->read(buffer, bufferSizeInBytes);
+    QVERIFY(status.success());
+    QVERIFY(std::memcmp(buffer, data.data(), bufferSizeInBytes) == 0);
+
+    status = readContainer->beginIngest();
+    QVERIFY(!status);
+
+    for (unsigned fileIndex=0 ; fileIndex<numberVirtualFiles ; ++fileIndex) {
+        std::stringstream stream;
+        stream << "aborted" << fileIndex << ".dat";
+
+        status = readContainer->ingestFile(stream.str(), data.data(), largeIngestFileSize / (fileIndex + 1));
+        QVERIFY(!status);
+    }
+
+    status = readContainer->abortIngest();
+    QVERIFY(!status);
+
+    QVERIFY(!readContainer->virtualFile("aborted0.dat"));
+
+    status = closeContainer(readContainer);
+    QVERIFY(!status);
+
+    QVERIFY(containerSize() == ingestedSize);
+}
+
+
+void TestContainerBase::testIngestAfterErase() {
+    std::uint8_t buffer[bufferSizeInBytes];
+
+    std::vector<std::uint8_t> data(bufferSizeInBytes);
+    for (unsigned i=0 ; i<bufferSizeInBytes ; ++i) {
+        data[i] = static_cast<std::uint8_t>((11 * i) % 253);
+    }
+
+    std::shared_ptr<Container::Container> writeContainer = allocateContainer("Inesonic, LLC.\nAleph Test");
+
+    Container::Status status = openContainer(writeContainer, true);
+    QVERIFY(status.success());
+
+    // Erasing a file with a large reservation leaves free space past the end of the container.
+
+    std::shared_ptr<Container::VirtualFile> reserved = writeContainer->newVirtualFile("reserved.dat");
+    QVERIFY(reserved);
+
+    status = reserved->reserve(352620);
+    QVERIFY(!status);
+
+    status = reserved->erase(true);
+    QVERIFY(!status);
+
+    std::shared_ptr<Container::VirtualFile> normal = writeContainer->newVirtualFile("normal.dat");
+    QVERIFY(normal);
+
+    status = writeContainer->beginIngest();
+    QVERIFY(!status);
+
+    status = writeContainer->ingestFile("small.dat", data.data(), 63);
+    QVERIFY(!status);
+
+    status = writeContainer->ingestFile("large.dat", data.data() + 1, bufferSizeInBytes - 1);
+    QVERIFY(!status);
+
+    status = writeContainer->commitIngest();
+    QVERIFY(!status);
+
+    status = normal->append(data.data() + 2, 1000);
+    QVERIFY(status.success());
+
+    status = closeContainer(writeContainer);
+    QVERIFY(!status);
+
+    std::shared_ptr<Container::Container> readContainer = allocateContainer("Inesonic, LLC.\nAleph Test");
+
+    status = openContainer(readContainer, false);
+    QVERIFY(status.success());
+    QVERIFY(readContainer->directory().size() == 3);
+
+    const char* names[3] = { "small.dat", "large.dat", "normal.dat" };
+    unsigned    sizes[3] = { 63, bufferSizeInBytes - 1, 1000 };
+
+    for (unsigned fileIndex=0 ; fileIndex<3 ; ++fileIndex) {
+        std::shared_ptr<Container::VirtualFile> vf = readContainer->virtualFile(names[fileIndex]);
+        QVERIFY(vf);
+        QVERIFY(vf->size() == sizes[fileIndex]);
+
+        status = vf->read(buffer, sizes[fileIndex]);
+        QVERIFY(status.success());
+        QVERIFY(Container::ReadSuccessful(status).bytesRead() == sizes[fileIndex]);
+        QVERIFY(std::memcmp(buffer, data.data() + fileIndex, sizes[fileIndex]) == 0);
+    }
+
+    status = closeContainer(readContainer);
+    QVERIFY(!status);
+}
+
+
+unsigned TestContainerBase::ingestFileSize(unsigned fileIndex) {
+    unsigned result;
+
+    if (fileIndex == numberIngestFiles / 2) {
+        result = largeIngestFileSize - fileIndex;
+    } else {
+        result = (fileIndex * 97) % 5000;
+    }
+
+    return result;
+}
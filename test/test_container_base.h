@@ -81,10 +81,36 @@ class TestContainerBase:public QObject {
          */
         void testContainerApi();
 
+        /**
+         * Method that tests erasing groups of files and clearing the container.
+         */
+        void testEraseFilesAndClear();
+
+        /**
+         * Method that tests bulk ingest sessions.
+         */
+        void testBulkIngest();
+
+        /**
+         * Method that tests bulk ingest sessions mixed with space reservation and erasure.
+         */
+        void testIngestAfterErase();
+
     private:
+        /**
+         * Method that returns the size of each file added by the bulk ingest test.
+         *
+         * \param[in] fileIndex The index of the file.
+         *
+         * \return Returns the file size, in bytes.
+         */
+        static unsigned ingestFileSize(unsigned fileIndex);
+
         static constexpr unsigned bufferSizeInBytes     = 65536;
         static constexpr unsigned numberVirtualFiles    = 4;
         static constexpr unsigned totalBytesAcrossFiles = 1024 * 1024;
+        static constexpr unsigned numberIngestFiles     = 300;
+        static constexpr unsigned largeIngestFileSize   = 5 * 1024 * 1024 / 2 + 13;
 };
 
 #endif
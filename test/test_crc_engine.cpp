@@ -0,0 +1,299 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements tests of the CrcEngine class.
+***********************************************************************************************************************/
+
+#include <QDebug>
+#include <QtTest/QtTest>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <random>
+
+#include <crc_engine.h>
+
+#include "test_crc_engine.h"
+
+static const CrcEngine::Implementation allImplementations[] = {
+    CrcEngine::Implementation::BYTEWISE,
+    CrcEngine::Implementation::SLICE_BY_8,
+    CrcEngine::Implementation::SLICE_BY_16,
+    CrcEngine::Implementation::CARRY_LESS_MULTIPLY
+};
+
+/**
+ * Bit-at-a-time reference for the 64-bit CRC.
+ *
+ * \param[in] currentCrc The current running CRC value.
+ *
+ * \param[in] data       Pointer to the data to be added to the CRC.
+ *
+ * \param[in] dataLength The length of the data, in bytes.
+ *
+ * \return Returns the updated running CRC value.
+ */
+static CrcEngine::RunningCrc64 referenceCrc64(
+        CrcEngine::RunningCrc64 currentCrc,
+        const std::uint8_t*     data,
+        unsigned                dataLength
+    ) {
+    for (unsigned i=0 ; i<dataLength ; ++i) {
+        for (unsigned bit=0 ; bit<8 ; ++bit) {
+            bool carry = (currentCrc & 0x8000000000000000ULL) != 0;
+            currentCrc = (currentCrc << 1) | ((data[i] >> (7 - bit)) & 1);
+
+            if (carry) {
+                currentCrc ^= 0x42F0E1EBA9EA3693ULL;
+            }
+        }
+    }
+
+    return currentCrc;
+}
+
+/***********************************************************************************************************************
+ * TestCrcEngine
+ */
+
+void TestCrcEngine::testImplementationSelection() {
+    QVERIFY(CrcEngine::isSupported(CrcEngine::Implementation::BYTEWISE));
+    QVERIFY(CrcEngine::isSupported(CrcEngine::Implementation::SLICE_BY_8));
+    QVERIFY(CrcEngine::isSupported(CrcEngine::Implementation::SLICE_BY_16));
+    QVERIFY(CrcEngine::isSupported(CrcEngine::implementation()));
+
+    if (!CrcEngine::isSupported(CrcEngine::Implementation::CARRY_LESS_MULTIPLY)) {
+        qDebug() << "Carry-less multiply CRC implementation not supported on this processor.";
+    }
+}
+
+
+void TestCrcEngine::testShortBuffers() {
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+
+    std::uint8_t buffer[maximumShortBufferLength + 16];
+    for (unsigned i=0 ; i<maximumShortBufferLength + 16 ; ++i) {
+        buffer[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+    }
+
+    for (unsigned alignment=0 ; alignment<16 ; ++alignment) {
+        for (unsigned length=0 ; length<=maximumShortBufferLength ; ++length) {
+            CrcEngine::RunningCrc seed     = static_cast<CrcEngine::RunningCrc>(byteGenerator(rng) << 8 | length);
+            CrcEngine::RunningCrc expected = CrcEngine::calculate(
+                CrcEngine::Implementation::BYTEWISE,
+                seed,
+                buffer + alignment,
+                length
+            );
+
+            for (CrcEngine::Implementation implementation : allImplementations) {
+                QVERIFY(CrcEngine::calculate(implementation, seed, buffer + alignment, length) == expected);
+            }
+
+            QVERIFY(CrcEngine::calculate(seed, buffer + alignment, length) == expected);
+        }
+    }
+}
+
+
+void TestCrcEngine::testRandomBuffers() {
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+    std::uniform_int_distribution<> offsetGenerator(0, randomBufferLength - 1);
+
+    std::vector<std::uint8_t> buffer(randomBufferLength);
+    for (unsigned i=0 ; i<randomBufferLength ; ++i) {
+        buffer[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+    }
+
+    // Include a full pass over the buffer.  The final two tests use buffers of all zeros and all ones.
+
+    QVERIFY(
+           CrcEngine::calculate(0, buffer.data(), randomBufferLength)
+        == CrcEngine::calculate(CrcEngine::Implementation::BYTEWISE, 0, buffer.data(), randomBufferLength)
+    );
+
+    for (unsigned i=0 ; i<numberRandomTests ; ++i) {
+        unsigned offset = offsetGenerator(rng);
+        unsigned length = offsetGenerator(rng) % (randomBufferLength - offset);
+
+        if (i == numberRandomTests - 2) {
+            std::memset(buffer.data() + offset, 0x00, length);
+        } else if (i == numberRandomTests - 1) {
+            std::memset(buffer.data() + offset, 0xFF, length);
+        }
+
+        CrcEngine::RunningCrc seed     = static_cast<CrcEngine::RunningCrc>(offsetGenerator(rng));
+        CrcEngine::RunningCrc expected = CrcEngine::calculate(
+            CrcEngine::Implementation::BYTEWISE,
+            seed,
+            buffer.data() + offset,
+            length
+        );
+
+        for (CrcEngine::Implementation implementation : allImplementations) {
+            QVERIFY(CrcEngine::calculate(implementation, seed, buffer.data() + offset, length) == expected);
+        }
+    }
+}
+
+
+void TestCrcEngine::testCopyAndCalculate() {
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+    std::uniform_int_distribution<> lengthGenerator(0, 3 * 4096 + 17);
+
+    std::vector<std::uint8_t> source(3 * 4096 + 17);
+    for (unsigned i=0 ; i<source.size() ; ++i) {
+        source[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+    }
+
+    for (unsigned i=0 ; i<100 ; ++i) {
+        unsigned                  length = lengthGenerator(rng);
+        std::vector<std::uint8_t> destination(source.size(), 0);
+
+        CrcEngine::RunningCrc seed     = static_cast<CrcEngine::RunningCrc>(byteGenerator(rng));
+        CrcEngine::RunningCrc expected = CrcEngine::calculate(
+            CrcEngine::Implementation::BYTEWISE,
+            seed,
+            source.data(),
+            length
+        );
+
+        CrcEngine::RunningCrc measured = CrcEngine::copyAndCalculate(seed, destination.data(), source.data(), length);
+
+        QVERIFY(measured == expected);
+        QVERIFY(std::memcmp(destination.data(), source.data(), length) == 0);
+
+        for (unsigned j=length ; j<destination.size() ; ++j) {
+            QVERIFY(destination[j] == 0);
+        }
+    }
+}
+
+
+void TestCrcEngine::testCombine() {
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+    std::uniform_int_distribution<> lengthGenerator(0, 10000);
+
+    std::vector<std::uint8_t> buffer(20000);
+    for (unsigned i=0 ; i<buffer.size() ; ++i) {
+        buffer[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+    }
+
+    for (unsigned i=0 ; i<1000 ; ++i) {
+        unsigned leadingLength  = lengthGenerator(rng);
+        unsigned trailingLength = lengthGenerator(rng);
+
+        CrcEngine::RunningCrc seed        = static_cast<CrcEngine::RunningCrc>(byteGenerator(rng) << 8);
+        CrcEngine::RunningCrc expected    = CrcEngine::calculate(seed, buffer.data(), leadingLength + trailingLength);
+        CrcEngine::RunningCrc leadingCrc  = CrcEngine::calculate(seed, buffer.data(), leadingLength);
+        CrcEngine::RunningCrc trailingCrc = CrcEngine::calculate(0, buffer.data() + leadingLength, trailingLength);
+
+        QVERIFY(CrcEngine::combine(leadingCrc, trailingCrc, trailingLength) == expected);
+    }
+}
+
+
+void TestCrcEngine::testCombine64() {
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+    std::uniform_int_distribution<> lengthGenerator(0, 10000);
+
+    std::vector<std::uint8_t> buffer(20000);
+    for (unsigned i=0 ; i<buffer.size() ; ++i) {
+        buffer[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+    }
+
+    for (unsigned i=0 ; i<1000 ; ++i) {
+        unsigned leadingLength  = lengthGenerator(rng);
+        unsigned trailingLength = lengthGenerator(rng);
+
+        unsigned                totalLength = leadingLength + trailingLength;
+        CrcEngine::RunningCrc64 seed        = static_cast<CrcEngine::RunningCrc64>(byteGenerator(rng)) << 56;
+        CrcEngine::RunningCrc64 expected    = CrcEngine::calculate64(seed, buffer.data(), totalLength);
+        CrcEngine::RunningCrc64 leadingCrc  = CrcEngine::calculate64(seed, buffer.data(), leadingLength);
+        CrcEngine::RunningCrc64 trailingCrc = CrcEngine::calculate64(0, buffer.data() + leadingLength, trailingLength);
+
+        QVERIFY(CrcEngine::combine64(leadingCrc, trailingCrc, trailingLength) == expected);
+    }
+}
+
+
+void TestCrcEngine::testCrc64() {
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+    std::uniform_int_distribution<> offsetGenerator(0, randomBufferLength - 1);
+
+    std::vector<std::uint8_t> buffer(randomBufferLength);
+    for (unsigned i=0 ; i<randomBufferLength ; ++i) {
+        buffer[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+    }
+
+    for (unsigned alignment=0 ; alignment<16 ; ++alignment) {
+        for (unsigned length=0 ; length<=maximumShortBufferLength ; ++length) {
+            CrcEngine::RunningCrc64 seed     = static_cast<CrcEngine::RunningCrc64>(byteGenerator(rng)) << 56 | length;
+            CrcEngine::RunningCrc64 expected = referenceCrc64(seed, buffer.data() + alignment, length);
+
+            for (CrcEngine::Implementation implementation : allImplementations) {
+                QVERIFY(CrcEngine::calculate64(implementation, seed, buffer.data() + alignment, length) == expected);
+            }
+
+            QVERIFY(CrcEngine::calculate64(seed, buffer.data() + alignment, length) == expected);
+        }
+    }
+
+    QVERIFY(
+           CrcEngine::calculate64(0, buffer.data(), randomBufferLength)
+        == CrcEngine::calculate64(CrcEngine::Implementation::BYTEWISE, 0, buffer.data(), randomBufferLength)
+    );
+
+    for (unsigned i=0 ; i<numberRandomTests / 10 ; ++i) {
+        unsigned offset = offsetGenerator(rng);
+        unsigned length = offsetGenerator(rng) % (randomBufferLength - offset);
+        unsigned split  = length / 3;
+
+        CrcEngine::RunningCrc64 seed     = static_cast<CrcEngine::RunningCrc64>(offsetGenerator(rng)) << 40;
+        CrcEngine::RunningCrc64 expected = CrcEngine::calculate64(
+            CrcEngine::Implementation::BYTEWISE,
+            seed,
+            buffer.data() + offset,
+            length
+        );
+
+        for (CrcEngine::Implementation implementation : allImplementations) {
+            QVERIFY(CrcEngine::calculate64(implementation, seed, buffer.data() + offset, length) == expected);
+
+            CrcEngine::RunningCrc64 leading = CrcEngine::calculate64(
+                implementation,
+                seed,
+                buffer.data() + offset,
+                split
+            );
+
+            QVERIFY(
+                   CrcEngine::calculate64(implementation, leading, buffer.data() + offset + split, length - split)
+                == expected
+            );
+        }
+    }
+}
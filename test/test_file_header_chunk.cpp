@@ -43,12 +43,12 @@
 class FileHeaderChunkWrapper:public FileHeaderChunk {
     public:
         FileHeaderChunkWrapper(
-            std::weak_ptr<ContainerImpl> container,
+            ContainerImpl&               container,
             FileIndex                    fileIndex,
             const std::string&           identifier);
 
         FileHeaderChunkWrapper(
-            std::weak_ptr<ContainerImpl> container,
+            ContainerImpl&               container,
             FileIndex                    fileIndex,
             std::uint8_t                 commonHeader[Chunk::minimumChunkHeaderSizeBytes]
         );
@@ -62,7 +62,7 @@ class FileHeaderChunkWrapper:public FileHeaderChunk {
 
 
 FileHeaderChunkWrapper::FileHeaderChunkWrapper(
-        std::weak_ptr<ContainerImpl> container,
+        ContainerImpl&               container,
         FileIndex                    fileIndex,
         const std::string&           identifier
     ):FileHeaderChunk(
@@ -73,7 +73,7 @@ FileHeaderChunkWrapper::FileHeaderChunkWrapper(
 
 
 FileHeaderChunkWrapper::FileHeaderChunkWrapper(
-        std::weak_ptr<ContainerImpl> container,
+        ContainerImpl&               container,
         FileIndex                    fileIndex,
         std::uint8_t                 commonHeader[Chunk::minimumChunkHeaderSizeBytes]
     ):FileHeaderChunk(
@@ -102,7 +102,7 @@ unsigned FileHeaderChunkWrapper::additionalHeaderSizeBytes() const {
 void TestFileHeaderChunk::testAccessors() {
     Container::MemoryContainer container("Inesonic, LLC./nAleph");
     FileHeaderChunkWrapper chunk(
-        dynamic_cast<Container::Container&>(container).impl,
+        *dynamic_cast<Container::Container&>(container).impl,
         0,
         "Inesonic, LLC.\nAleph"
     );
@@ -119,7 +119,7 @@ void TestFileHeaderChunk::testSaveLoadMethods() {
     QVERIFY(!status);
 
     FileHeaderChunkWrapper chunk1(
-        dynamic_cast<Container::Container&>(container).impl,
+        *dynamic_cast<Container::Container&>(container).impl,
         0,
         "Inesonic, LLC.\nAleph"
     );
@@ -128,7 +128,7 @@ void TestFileHeaderChunk::testSaveLoadMethods() {
     QVERIFY(status.success());
 
     FileHeaderChunkWrapper chunk2(
-        dynamic_cast<Container::Container&>(container).impl,
+        *dynamic_cast<Container::Container&>(container).impl,
         0,
         "Inesonic, LLC.\nAleph"
     );
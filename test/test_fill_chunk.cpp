@@ -41,10 +41,10 @@
 
 class FillChunkWrapper:public FillChunk {
     public:
-        FillChunkWrapper(std::weak_ptr<ContainerImpl> container, FileIndex fileIndex, unsigned availableSpace = 0);
+        FillChunkWrapper(ContainerImpl& container, FileIndex fileIndex, unsigned availableSpace = 0);
 
         FillChunkWrapper(
-            std::weak_ptr<ContainerImpl> container,
+            ContainerImpl&               container,
             FileIndex                    fileIndex,
             std::uint8_t                 commonHeader[Chunk::minimumChunkHeaderSizeBytes]
         );
@@ -58,7 +58,7 @@ class FillChunkWrapper:public FillChunk {
 
 
 FillChunkWrapper::FillChunkWrapper(
-       std::weak_ptr<ContainerImpl> container,
+       ContainerImpl&               container,
        FileIndex                    fileIndex,
        unsigned                     availableSpace
    ):FillChunk(
@@ -69,7 +69,7 @@ FillChunkWrapper::FillChunkWrapper(
 
 
 FillChunkWrapper::FillChunkWrapper(
-        std::weak_ptr<ContainerImpl> container,
+        ContainerImpl&               container,
         FileIndex                    fileIndex,
         std::uint8_t                 commonHeader[Chunk::minimumChunkHeaderSizeBytes]
     ):FillChunk(
@@ -97,40 +97,40 @@ unsigned FillChunkWrapper::additionalHeaderSizeBytes() const {
 
 void TestFillChunk::testConstructors() {
     Container::MemoryContainer container("Inesonic, LLC./nAleph");
-    FillChunkWrapper chunk1(dynamic_cast<Container::Container&>(container).impl, 0);
+    FillChunkWrapper chunk1(*dynamic_cast<Container::Container&>(container).impl, 0);
     QVERIFY(chunk1.fillSpaceBytes() == 32);
 
     for (unsigned i=0 ; i<7 ; ++i) {
         unsigned expectedSize = 1 << (i + 5);
 
-        FillChunkWrapper chunk2(dynamic_cast<Container::Container&>(container).impl, 0, expectedSize - 1);
+        FillChunkWrapper chunk2(*dynamic_cast<Container::Container&>(container).impl, 0, expectedSize - 1);
         if (i == 0) {
             QVERIFY(chunk2.fillSpaceBytes() == 32);
         } else {
             QVERIFY(chunk2.fillSpaceBytes() == expectedSize / 2);
         }
 
-        FillChunkWrapper chunk3(dynamic_cast<Container::Container&>(container).impl, 0, expectedSize);
+        FillChunkWrapper chunk3(*dynamic_cast<Container::Container&>(container).impl, 0, expectedSize);
         QVERIFY(chunk3.fillSpaceBytes() == expectedSize);
 
-        FillChunkWrapper chunk4(dynamic_cast<Container::Container&>(container).impl, 0, expectedSize + 1);
+        FillChunkWrapper chunk4(*dynamic_cast<Container::Container&>(container).impl, 0, expectedSize + 1);
         QVERIFY(chunk4.fillSpaceBytes() == expectedSize);
     }
 
-    FillChunkWrapper chunk6(dynamic_cast<Container::Container&>(container).impl, 0, 8191);
+    FillChunkWrapper chunk6(*dynamic_cast<Container::Container&>(container).impl, 0, 8191);
     QVERIFY(chunk6.fillSpaceBytes() == 4096);
 
-    FillChunkWrapper chunk7(dynamic_cast<Container::Container&>(container).impl, 0, 8192);
+    FillChunkWrapper chunk7(*dynamic_cast<Container::Container&>(container).impl, 0, 8192);
     QVERIFY(chunk7.fillSpaceBytes() == 4096);
 
-    FillChunkWrapper chunk8(dynamic_cast<Container::Container&>(container).impl, 0, 16384);
+    FillChunkWrapper chunk8(*dynamic_cast<Container::Container&>(container).impl, 0, 16384);
     QVERIFY(chunk8.fillSpaceBytes() == 4096);
 }
 
 
 void TestFillChunk::testAccessors() {
     Container::MemoryContainer container("Inesonic, LLC./nAleph");
-    FillChunkWrapper chunk(dynamic_cast<Container::Container&>(container).impl, 0);
+    FillChunkWrapper chunk(*dynamic_cast<Container::Container&>(container).impl, 0);
     QVERIFY(chunk.fillSpaceBytes() == 32);
 
     for (unsigned i=0 ; i<7 ; ++i) {
@@ -167,12 +167,12 @@ void TestFillChunk::testSaveLoadMethods() {
     Container::Status status = container.open();
     QVERIFY(!status);
 
-    FillChunkWrapper chunk1(dynamic_cast<Container::Container&>(container).impl, 0);
+    FillChunkWrapper chunk1(*dynamic_cast<Container::Container&>(container).impl, 0);
 
     status = chunk1.save();
     QVERIFY(status.success());
 
-    FillChunkWrapper chunk2(dynamic_cast<Container::Container&>(container).impl, 0);
+    FillChunkWrapper chunk2(*dynamic_cast<Container::Container&>(container).impl, 0);
     status = chunk2.load(true);
     QVERIFY(status.success());
 
@@ -486,3 +486,75 @@ void TestFreeSpaceTracker::testReserveAndReleaseFreeSpaceArea() {
     QVERIFY(tracker.numberReservations() == 0);
     QVERIFY(tracker.numberFreeSpaceRegions() == 6);
 }
+
+
+void TestFreeSpaceTracker::testReserveLargestFreeSpaceArea() {
+    FreeSpaceTrackerWrapper tracker(ChunkHeader::toPosition(110));
+
+    //                                                                                                     1         1
+    // 0         1         2         3         4         5         6         7         8         9         0         1
+    // 012345678901234567890123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+    //           aaaaaaaaaa                    bbbbbbbbbbbbbbbbbbbb          cccccccccccccccc
+
+    tracker.newFreeSpaceArea(10, 10);
+    tracker.newFreeSpaceArea(40, 20);
+    tracker.newFreeSpaceArea(70, 16);
+
+    // **************************************************************
+    // Reserve from the largest region even though an earlier region would fit.
+
+    FreeSpace reserved(tracker.reserveLargestFreeSpaceArea(0, 8));
+    QVERIFY(reserved.startingIndex() == 40);
+    QVERIFY(reserved.areaSize() == 8);
+    QVERIFY(tracker.numberReservations() == 1);
+    QVERIFY(tracker.numberFreeSpaceRegions() == 4);
+
+    // And release
+
+    tracker.releaseReservation(reserved);
+
+    QVERIFY(tracker.numberReservations() == 0);
+    QVERIFY(tracker.numberFreeSpaceRegions() == 3);
+
+    // **************************************************************
+    // Only the portion of a region at or after the starting index is considered.
+
+    reserved = tracker.reserveLargestFreeSpaceArea(50, 8);
+    QVERIFY(reserved.startingIndex() == 70);
+    QVERIFY(reserved.areaSize() == 8);
+    QVERIFY(tracker.numberReservations() == 1);
+
+    tracker.releaseReservation(reserved);
+
+    QVERIFY(tracker.numberReservations() == 0);
+    QVERIFY(tracker.numberFreeSpaceRegions() == 3);
+
+    reserved = tracker.reserveLargestFreeSpaceArea(45, 12);
+    QVERIFY(reserved.startingIndex() == 70);
+    QVERIFY(reserved.areaSize() == 12);
+
+    tracker.releaseReservation(reserved);
+
+    reserved = tracker.reserveLargestFreeSpaceArea(42, 17);
+    QVERIFY(reserved.startingIndex() == 42);
+    QVERIFY(reserved.areaSize() == 17);
+    QVERIFY(tracker.numberFreeSpaceRegions() == 5);
+
+    tracker.releaseReservation(reserved);
+
+    QVERIFY(tracker.numberReservations() == 0);
+    QVERIFY(tracker.numberFreeSpaceRegions() == 3);
+
+    // **************************************************************
+    // Reserve from end of file when no region is large enough.
+
+    reserved = tracker.reserveLargestFreeSpaceArea(0, 30);
+    QVERIFY(reserved.startingIndex() == 110);
+    QVERIFY(reserved.areaSize() == 30);
+    QVERIFY(tracker.numberReservations() == 1);
+
+    tracker.releaseReservation(reserved);
+
+    QVERIFY(tracker.numberReservations() == 0);
+    QVERIFY(tracker.numberFreeSpaceRegions() == 3);
+}
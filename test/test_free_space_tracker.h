@@ -33,6 +33,8 @@ class TestFreeSpaceTracker:public QObject {
         void testNewFreeSpaceArea();
 
         void testReserveAndReleaseFreeSpaceArea();
+
+        void testReserveLargestFreeSpaceArea();
 };
 
 #endif
@@ -30,6 +30,9 @@
 #include "test_free_space_tracker.h"
 #include "test_ring_buffer.h"
 #include "test_chunk_map_data.h"
+#include "test_shared_chunk_data.h"
+#include "test_crc_engine.h"
+#include "test_compression_engine.h"
 #include "test_chunk_header.h"
 #include "test_chunk.h"
 #include "test_fill_chunk.h"
@@ -56,6 +59,9 @@ int main(int argumentCount, char** argumentValues) {
     TEST(TestFreeSpaceTracker);
     TEST(TestRingBuffer);
     TEST(TestChunkMapData);
+    TEST(TestSharedChunkData);
+    TEST(TestCrcEngine);
+    TEST(TestCompressionEngine);
     TEST(TestChunkHeader);
     TEST(TestChunk);
     TEST(TestFillChunk);
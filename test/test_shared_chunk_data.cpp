@@ -0,0 +1,87 @@
+/*-*-c++-*-*************************************************************************************************************
+* Copyright 2016 - 2022 Inesonic, LLC.
+*
+* MIT License:
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+*   documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+*   rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+*   permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+*   Software.
+*   
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+*   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+*   OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+*   OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+********************************************************************************************************************//**
+* \file
+*
+* This file implements tests of the SharedChunkData class.
+***********************************************************************************************************************/
+
+#include <QDebug>
+#include <QtTest/QtTest>
+
+#include <shared_chunk_data.h>
+
+#include "test_shared_chunk_data.h"
+
+void TestSharedChunkData::testConstructorsDestructors() {
+    SharedChunkData data1;
+    QVERIFY(data1.hash() == 0);
+    QVERIFY(data1.chunkSize() == 0);
+    QVERIFY(data1.referenceCount() == 0);
+
+    SharedChunkData data2(0x123456789ABCDEF0ULL, 2, 3);
+    QVERIFY(data2.hash() == 0x123456789ABCDEF0ULL);
+    QVERIFY(data2.chunkSize() == 2);
+    QVERIFY(data2.referenceCount() == 3);
+
+    SharedChunkData data3(data2);
+    QVERIFY(data3.hash() == 0x123456789ABCDEF0ULL);
+    QVERIFY(data3.chunkSize() == 2);
+    QVERIFY(data3.referenceCount() == 3);
+}
+
+
+void TestSharedChunkData::testAccessors() {
+    SharedChunkData data(1, 2, 3);
+
+    data.setHash(4);
+    QVERIFY(data.hash() == 4);
+    QVERIFY(data.chunkSize() == 2);
+    QVERIFY(data.referenceCount() == 3);
+
+    data.setChunkSize(5);
+    QVERIFY(data.hash() == 4);
+    QVERIFY(data.chunkSize() == 5);
+    QVERIFY(data.referenceCount() == 3);
+}
+
+
+void TestSharedChunkData::testReferenceCounting() {
+    SharedChunkData data(1, 2);
+    QVERIFY(data.referenceCount() == 0);
+
+    data.addReference();
+    data.addReference();
+    QVERIFY(data.referenceCount() == 2);
+
+    QVERIFY(data.removeReference());
+    QVERIFY(data.referenceCount() == 1);
+
+    QVERIFY(!data.removeReference());
+    QVERIFY(data.referenceCount() == 0);
+}
+
+
+void TestSharedChunkData::testAssignmentOperator() {
+    SharedChunkData data1(1, 2, 3);
+    SharedChunkData data2(4, 5, 6);
+
+    data2 = data1;
+    QVERIFY(data2.hash() == 1);
+    QVERIFY(data2.chunkSize() == 2);
+    QVERIFY(data2.referenceCount() == 3);
+}
@@ -198,3 +198,41 @@ void TestStatus::testAssignmentOperator() {
     QVERIFY(status1.statusClass() == Container::Status::Class::FILESYSTEM_ERROR);
     QVERIFY(status1.description() == "Error description");
 }
+
+
+void TestStatus::testSharedPimplStatus() {
+    Container::ReadSuccessful  readStatus(1234);
+    Container::WriteSuccessful writeStatus(5678);
+
+    QVERIFY( readStatus.informationAvailable());
+    QVERIFY( readStatus.success());
+    QVERIFY(!readStatus.failure());
+
+    QVERIFY(readStatus.bytesRead() == 1234);
+    QVERIFY(readStatus.errorCode() == Container::ReadSuccessful::reportedErrorCode);
+    QVERIFY(readStatus.statusClass() == Container::Status::Class::FILESYSTEM_STATUS);
+    QVERIFY(readStatus.description() == "Read successful, 1234 transferred");
+
+    QVERIFY(writeStatus.bytesWritten() == 5678);
+    QVERIFY(writeStatus.description() == "Write successful, 5678 transferred");
+
+    // Values must follow the instance through copies and assignments.
+    Container::Status status = readStatus;
+    QVERIFY(Container::ReadSuccessful(status).bytesRead() == 1234);
+
+    status = writeStatus;
+    QVERIFY(Container::WriteSuccessful(status).bytesWritten() == 5678);
+
+    status = Container::ChunkCrcError(0x123456789ULL);
+    QVERIFY( status.failure());
+    QVERIFY(status.errorCode() == Container::ChunkCrcError::reportedErrorCode);
+    QVERIFY(Container::ChunkCrcError(status).filePosition() == 0x123456789ULL);
+
+    status = Container::ContainerUnavailable();
+    QVERIFY( status.failure());
+    QVERIFY(status.errorCode() == Container::ContainerUnavailable::reportedErrorCode);
+    QVERIFY(status.description() == "Container object unavailable");
+
+    status = Container::NoStatus();
+    QVERIFY(!status);
+}
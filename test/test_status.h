@@ -35,6 +35,8 @@ class TestStatus:public QObject {
         void testAccessors();
 
         void testAssignmentOperator();
+
+        void testSharedPimplStatus();
 };
 
 #endif
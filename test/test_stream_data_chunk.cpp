@@ -24,6 +24,8 @@
 #include <QtTest/QtTest>
 
 #include <random>
+#include <vector>
+#include <new>
 
 #include <cstdint>
 #include <cstdlib>
@@ -36,17 +38,92 @@
 #include <container_memory_container.h>
 #include <container_container_private.h> // temporary
 #include <container_impl.h>
+#include <crc_engine.h>
 #include <stream_data_chunk.h>
 
 #include "test_stream_data_chunk.h"
 
+/***********************************************************************************************************************
+ * Allocation counting
+ */
+
+/**
+ * Count of heap allocations made while an \ref AllocationCountingScope is active.  Used to verify that the chunk hot
+ * paths do not allocate.
+ */
+static unsigned long allocationCount = 0;
+
+/**
+ * The number of active \ref AllocationCountingScope instances.  Allocations made elsewhere in the test program are not
+ * counted.
+ */
+static unsigned activeCountingScopes = 0;
+
+/**
+ * Class that enables allocation counting for its lifetime.
+ */
+class AllocationCountingScope {
+    public:
+        AllocationCountingScope() {
+            ++activeCountingScopes;
+        }
+
+        ~AllocationCountingScope() {
+            --activeCountingScopes;
+        }
+};
+
+
+static void* countedAllocation(std::size_t size) {
+    if (activeCountingScopes > 0) {
+        ++allocationCount;
+    }
+
+    void* result = std::malloc(size > 0 ? size : 1);
+    if (result == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    return result;
+}
+
+
+void* operator new(std::size_t size) {
+    return countedAllocation(size);
+}
+
+
+void* operator new[](std::size_t size) {
+    return countedAllocation(size);
+}
+
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
 /***********************************************************************************************************************
  * TestStreamDataChunk
  */
 
 void TestStreamDataChunk::testAccessors() {
     Container::MemoryContainer container("Inesonic, LLC.\nAleph");
-    StreamDataChunk chunk(dynamic_cast<Container::Container&>(container).impl, 0, 0, 1024);
+    StreamDataChunk chunk(*dynamic_cast<Container::Container&>(container).impl, 0, 0, 1024);
 
     QVERIFY(chunk.streamIdentifier() == 0);
     QVERIFY(chunk.chunkOffset() == 1024);
@@ -71,7 +148,7 @@ void TestStreamDataChunk::testChunkSizeMethod() {
     }
 
     for (unsigned chunkP2=0 ; chunkP2<=7 ; ++chunkP2) {
-        StreamDataChunk chunk(dynamic_cast<Container::Container&>(container).impl, 0, 0, 1024);
+        StreamDataChunk chunk(*dynamic_cast<Container::Container&>(container).impl, 0, 0, 1024);
 
         unsigned requestedSize       = ChunkHeader::toChunkSize(chunkP2);
         unsigned expectedPayloadSize = requestedSize - 14;
@@ -97,7 +174,7 @@ void TestStreamDataChunk::testScatterGatherListMethods() {
     }
 
     Container::MemoryContainer container("Inesonic, LLC.\nAleph");
-    StreamDataChunk chunk(dynamic_cast<Container::Container&>(container).impl, 0, 0, 1024);
+    StreamDataChunk chunk(*dynamic_cast<Container::Container&>(container).impl, 0, 0, 1024);
 
     unsigned actualChunkSize = chunk.setChunkSize(2049);
     QVERIFY(actualChunkSize == 2048);
@@ -140,6 +217,12 @@ void TestStreamDataChunk::testScatterGatherListMethods() {
     QVERIFY(chunk.scatterGatherListSegment(6) == segment7);
     QVERIFY(chunk.scatterGatherListSegment(7) == segment8);
 
+    // The list is full so further segments are refused.
+
+    QVERIFY(chunk.addScatterGatherListSegment(segment1) == 0);
+    QVERIFY(chunk.scatterGatherListSize() == 8);
+    QVERIFY(chunk.scatterGatherListSegment(7) == segment8);
+
     chunk.clearScatterGatherList();
     QVERIFY(chunk.scatterGatherListSize() == 0);
 
@@ -168,7 +251,7 @@ void TestStreamDataChunk::testCrcCalculationMethods() {
     Container::Status status = container.open();
     QVERIFY(!status);
 
-    StreamDataChunk chunk(dynamic_cast<Container::Container&>(container).impl, 0, 0, 0);
+    StreamDataChunk chunk(*dynamic_cast<Container::Container&>(container).impl, 0, 0, 0);
 
     unsigned actualChunkSize = chunk.setChunkSize(2048);
     QVERIFY(actualChunkSize == 2048);
@@ -215,7 +298,7 @@ void TestStreamDataChunk::testCrcCalculationMethods() {
 
         std::memset(buffer, 0, bufferSize);
 
-        StreamDataChunk chunk(dynamic_cast<Container::Container&>(container).impl, 0, 0, 0);
+        StreamDataChunk chunk(*dynamic_cast<Container::Container&>(container).impl, 0, 0, 0);
 
         ScatterGatherListSegment segment(buffer, bufferSize);
         chunk.addScatterGatherListSegment(segment);
@@ -243,3 +326,114 @@ void TestStreamDataChunk::testCrcCalculationMethods() {
 void TestStreamDataChunk::testSaveLoadMethods() {
     // Tested by the TestStreamDataChunk::testCrcCalculationMethods method.
 }
+
+
+void TestStreamDataChunk::testLeadingPayloadCrc() {
+    unsigned      bufferSize = 3000;
+    std::uint8_t* buffer     = new std::uint8_t[bufferSize];
+
+    for (unsigned i=0 ; i<bufferSize ; ++i) {
+        buffer[i] = static_cast<std::uint8_t>((i * 37) ^ (i >> 3));
+    }
+
+    Container::MemoryContainer container("Inesonic, LLC.\nAleph");
+    Container::Status status = container.open();
+    QVERIFY(!status);
+
+    for (unsigned leadingLength=0 ; leadingLength<=bufferSize ; leadingLength+=100) {
+        for (unsigned chunkSize=256 ; chunkSize<=4096 ; chunkSize*=4) {
+            StreamDataChunk referenceChunk(*dynamic_cast<Container::Container&>(container).impl, 0, 0, 0);
+            referenceChunk.setChunkSize(chunkSize);
+            referenceChunk.addScatterGatherListSegment(buffer, 1000);
+            referenceChunk.addScatterGatherListSegment(buffer + 1000, bufferSize - 1000);
+
+            status = referenceChunk.save();
+            QVERIFY(!status);
+
+            StreamDataChunk chunk(*dynamic_cast<Container::Container&>(container).impl, 0, 0, 0);
+            chunk.setChunkSize(chunkSize);
+            chunk.addScatterGatherListSegment(buffer, 1000);
+            chunk.addScatterGatherListSegment(buffer + 1000, bufferSize - 1000);
+            chunk.setLeadingPayloadCrc(CrcEngine::calculate(0, buffer, leadingLength), leadingLength);
+
+            status = chunk.save();
+            QVERIFY(!status);
+
+            QVERIFY(chunk.chunkSize() == referenceChunk.chunkSize());
+            QVERIFY(chunk.crc() == referenceChunk.crc());
+        }
+    }
+
+    delete[] buffer;
+}
+
+
+void TestStreamDataChunk::testAllocationFree() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+    std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+
+    Container::MemoryContainer container("Inesonic, LLC.\nAleph");
+    Container::Status status = container.open(containerBuffer);
+    QVERIFY(!status);
+
+    ContainerImpl&   containerImpl = *dynamic_cast<Container::Container&>(container).impl;
+    Chunk::FileIndex fileIndex     = Chunk::toFileIndex(containerBuffer->size());
+
+    std::vector<std::uint8_t> payload(allocationTestChunkSize);
+    std::vector<std::uint8_t> readBuffer(allocationTestChunkSize);
+
+    for (unsigned i=0 ; i<allocationTestChunkSize ; ++i) {
+        payload[i] = static_cast<std::uint8_t>(i * 7);
+    }
+
+    // Write the chunk once so that the steady-state writes below overwrite existing space in the container.
+
+    {
+        StreamDataChunk chunk(containerImpl, fileIndex, 1, 0);
+        chunk.setChunkSize(allocationTestChunkSize);
+        chunk.addScatterGatherListSegment(payload.data(), allocationTestChunkSize);
+
+        status = chunk.save();
+        QVERIFY(!status);
+    }
+
+    unsigned long chunkAllocations = 0;
+    unsigned long ioAllocations    = 0;
+
+    AllocationCountingScope countingScope;
+
+    QBENCHMARK {
+        for (unsigned i=0 ; i<numberAllocationTestChunks ; ++i) {
+            unsigned long startingCount = allocationCount;
+
+            StreamDataChunk writeChunk(containerImpl, fileIndex, 1, 0);
+            writeChunk.setChunkSize(allocationTestChunkSize);
+            writeChunk.addScatterGatherListSegment(payload.data(), allocationTestChunkSize);
+
+            StreamDataChunk readChunk(containerImpl, fileIndex, 1, 0);
+            readChunk.setChunkSize(ChunkHeader::maximumExtendedChunkSize);
+            readChunk.addScatterGatherListSegment(readBuffer.data(), allocationTestChunkSize);
+
+            chunkAllocations += allocationCount - startingCount;
+            startingCount     = allocationCount;
+
+            status = writeChunk.save();
+            QVERIFY(!status);
+
+            status = readChunk.load(true);
+            QVERIFY(!status);
+
+            ioAllocations += allocationCount - startingCount;
+            startingCount  = allocationCount;
+
+            QVERIFY(readChunk.checkCrc());
+            QVERIFY(readChunk.payloadSize() == writeChunk.payloadSize());
+            QVERIFY(std::memcmp(payload.data(), readBuffer.data(), readChunk.payloadSize()) == 0);
+
+            chunkAllocations += allocationCount - startingCount;
+        }
+    }
+
+    QVERIFY(chunkAllocations == 0);
+    QVERIFY(ioAllocations == 0);
+}
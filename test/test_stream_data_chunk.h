@@ -35,10 +35,14 @@ class TestStreamDataChunk:public QObject {
         void testScatterGatherListMethods();
         void testCrcCalculationMethods();
         void testSaveLoadMethods();
+        void testLeadingPayloadCrc();
+        void testAllocationFree();
 
     private:
-        static constexpr unsigned polynomialOrder          = 16;
-        static constexpr unsigned numberCrcMungeIterations = 1000;
+        static constexpr unsigned polynomialOrder            = 16;
+        static constexpr unsigned numberCrcMungeIterations   = 1000;
+        static constexpr unsigned allocationTestChunkSize    = 4096;
+        static constexpr unsigned numberAllocationTestChunks = 1000;
 };
 
 #endif
@@ -24,6 +24,8 @@
 #include <QtTest/QtTest>
 
 #include <cstdint>
+#include <cstring>
+#include <string>
 
 #define LIBCONTAINER_TEST // Makes the implementation accessible from the public API.
 
@@ -43,7 +45,7 @@ void TestStreamStartChunk::testAccessors() {
     Container::MemoryContainer container("Inesonic, LLC./nAleph");
 
     StreamStartChunk chunk(
-        dynamic_cast<Container::Container&>(container).impl,
+        *dynamic_cast<Container::Container&>(container).impl,
         0,
         "test_file.dat",
         1
@@ -70,7 +72,7 @@ void TestStreamStartChunk::testSaveLoadMethods() {
     QVERIFY(!status);
 
     StreamStartChunk chunk1(
-        dynamic_cast<Container::Container&>(container).impl,
+        *dynamic_cast<Container::Container&>(container).impl,
         0,
         "test_file.dat",
         1
@@ -80,7 +82,7 @@ void TestStreamStartChunk::testSaveLoadMethods() {
     QVERIFY(status.success());
 
     StreamStartChunk chunk2(
-        dynamic_cast<Container::Container&>(container).impl,
+        *dynamic_cast<Container::Container&>(container).impl,
         0,
         "bad.dat",
         2
@@ -93,3 +95,62 @@ void TestStreamStartChunk::testSaveLoadMethods() {
     QVERIFY(chunk2.isLast() == false);
     QVERIFY(chunk2.virtualFilename() == "test_file.dat");
 }
+
+
+void TestStreamStartChunk::testInlinePayload() {
+    Container::MemoryContainer container("Inesonic, LLC./nAleph");
+    Container::Status status = container.open();
+    QVERIFY(!status);
+
+    std::uint8_t payload[StreamStartChunk::maximumInlinePayloadSize];
+    for (unsigned i=0 ; i<StreamStartChunk::maximumInlinePayloadSize ; ++i) {
+        payload[i] = static_cast<std::uint8_t>(i * 7 + 3);
+    }
+
+    StreamStartChunk chunk1(*dynamic_cast<Container::Container&>(container).impl, 0, "tiny.txt", 1);
+    QVERIFY(!chunk1.holdsInlinePayload());
+    QVERIFY(chunk1.inlinePayloadSize() == 0);
+    QVERIFY(chunk1.chunkSize() == 128);
+
+    // The payload follows the name so a tiny file fits in the smallest chunk.
+
+    StreamStartChunk chunk2(*dynamic_cast<Container::Container&>(container).impl, 0, "tiny.txt", 1, 10);
+    chunk2.setInlinePayload(payload);
+
+    QVERIFY(chunk2.holdsInlinePayload());
+    QVERIFY(chunk2.inlinePayloadSize() == 10);
+    QVERIFY(chunk2.chunkSize() == 32);
+    QVERIFY(chunk2.virtualFilename() == "tiny.txt");
+
+    status = chunk2.save();
+    QVERIFY(status.success());
+
+    StreamStartChunk chunk3(*dynamic_cast<Container::Container&>(container).impl, 0, "tiny.txt", 2, 10);
+
+    status = chunk3.load(true);
+    QVERIFY(status.success());
+
+    QVERIFY(chunk3.streamIdentifier() == 1);
+    QVERIFY(chunk3.holdsInlinePayload());
+    QVERIFY(chunk3.virtualFilename() == "tiny.txt");
+    QVERIFY(chunk3.inlinePayloadSize() == 10);
+    QVERIFY(std::memcmp(chunk3.inlinePayload(), payload, 10) == 0);
+    QVERIFY(chunk3.checkCrc());
+
+    std::string longName(200, 'x');
+
+    StreamStartChunk chunk4(
+        *dynamic_cast<Container::Container&>(container).impl,
+        0,
+        longName,
+        3,
+        StreamStartChunk::maximumInlinePayloadSize
+    );
+
+    chunk4.setInlinePayload(payload);
+
+    QVERIFY(chunk4.chunkSize() == 512);
+    QVERIFY(chunk4.virtualFilename() == longName.substr(0, StreamStartChunk::maximumVirtualFilenameLength));
+    QVERIFY(chunk4.inlinePayloadSize() == StreamStartChunk::maximumInlinePayloadSize);
+    QVERIFY(std::memcmp(chunk4.inlinePayload(), payload, StreamStartChunk::maximumInlinePayloadSize) == 0);
+}
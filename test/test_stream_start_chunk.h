@@ -32,6 +32,7 @@ class TestStreamStartChunk:public QObject {
     private slots:
         void testAccessors();
         void testSaveLoadMethods();
+        void testInlinePayload();
 };
 
 #endif
@@ -28,7 +28,9 @@
 #include <vector>
 #include <memory>
 #include <sstream>
+#include <string>
 #include <random>
+#include <algorithm>
 
 #include <container_status.h>
 #include <container_container.h>
@@ -765,3 +767,2715 @@ void TestVirtualFile::testStreamRead() {
         }
     }
 }
+
+
+void TestVirtualFile::testForEachFile() {
+    Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+    Container::Status status = container.open();
+    QVERIFY(status.success());
+
+    for (unsigned i=0 ; i<numberVirtualFiles ; ++i) {
+        std::stringstream aStream;
+        aStream << "a/test" << i << ".dat";
+        QVERIFY(container.newVirtualFile(aStream.str()));
+
+        std::stringstream bStream;
+        bStream << "b/test" << i << ".dat";
+        QVERIFY(container.newVirtualFile(bStream.str()));
+    }
+
+    // Visit every file.
+
+    std::vector<std::string> names;
+    status = container.forEachFile(
+        [&](const std::string& name, const std::shared_ptr<Container::VirtualFile>& vf) {
+            names.push_back(name);
+            return vf->name() == name;
+        }
+    );
+
+    QVERIFY(!status);
+    QVERIFY(names.size() == 2 * numberVirtualFiles);
+    QVERIFY(names.front() == "a/test0.dat");
+    QVERIFY(names.back() == "b/test3.dat");
+
+    // Visit a prefix range, stopping early.
+
+    names.clear();
+    status = container.forEachFile(
+        [&](const std::string& name, const std::shared_ptr<Container::VirtualFile>&) {
+            names.push_back(name);
+            return names.size() < 2;
+        },
+        "b/"
+    );
+
+    QVERIFY(!status);
+    QVERIFY(names.size() == 2);
+    QVERIFY(names.at(0) == "b/test0.dat");
+    QVERIFY(names.at(1) == "b/test1.dat");
+
+    // Erase and rename files while visiting.  Erased files must not be visited and renamed files must be visited
+    // under their new name.
+
+    names.clear();
+    status = container.forEachFile(
+        [&](const std::string& name, const std::shared_ptr<Container::VirtualFile>& vf) {
+            names.push_back(name);
+
+            Container::Status visitStatus;
+            if (name == "a/test0.dat") {
+                visitStatus = vf->erase();
+                if (!visitStatus) {
+                    visitStatus = container.virtualFile("a/test1.dat")->erase();
+                }
+            } else if (name == "a/test2.dat") {
+                visitStatus = vf->rename("a/test9.dat");
+            }
+
+            return !visitStatus;
+        },
+        "a/"
+    );
+
+    QVERIFY(!status);
+    QVERIFY(names.size() == 4);
+    QVERIFY(names.at(0) == "a/test0.dat");
+    QVERIFY(names.at(1) == "a/test2.dat");
+    QVERIFY(names.at(2) == "a/test3.dat");
+    QVERIFY(names.at(3) == "a/test9.dat");
+
+    QVERIFY(!container.virtualFile("a/test0.dat"));
+    QVERIFY(!container.virtualFile("a/test2.dat"));
+    QVERIFY(container.virtualFile("a/test9.dat"));
+    QVERIFY(container.directory().size() == 2 * numberVirtualFiles - 2);
+}
+
+
+void TestVirtualFile::testLazyDirectory() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+    std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+
+    std::uint8_t buffer[bufferSizeInBytes];
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(status.success());
+
+        for (unsigned i=0 ; i<numberVirtualFiles ; ++i) {
+            std::stringstream stream;
+            stream << "test" << i << ".dat";
+
+            std::shared_ptr<Container::VirtualFile> vf = container.newVirtualFile(stream.str());
+            std::memset(buffer, static_cast<int>(i), bufferSizeInBytes);
+
+            status = vf->write(buffer, bufferSizeInBytes - i);
+            QVERIFY(status.success());
+            QVERIFY(Container::WriteSuccessful(status).bytesWritten() == bufferSizeInBytes - i);
+        }
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        // Files found in the container must not be re-created under the same name.
+
+        QVERIFY(!container.newVirtualFile("test1.dat"));
+
+        // A new file must receive a stream identifier that does not collide with any file found in the container.
+
+        std::shared_ptr<Container::VirtualFile> newFile = container.newVirtualFile("new.dat");
+        QVERIFY(newFile);
+
+        std::memset(buffer, 0x55, bufferSizeInBytes);
+        status = newFile->write(buffer, bufferSizeInBytes);
+        QVERIFY(status.success());
+
+        std::shared_ptr<Container::VirtualFile> vf = container.virtualFile("test2.dat");
+        QVERIFY(vf);
+        QVERIFY(vf->name() == "test2.dat");
+        QVERIFY(vf->size() == bufferSizeInBytes - 2);
+
+        status = vf->read(buffer, bufferSizeInBytes - 2);
+        QVERIFY(status.success());
+        QVERIFY(Container::ReadSuccessful(status).bytesRead() == bufferSizeInBytes - 2);
+
+        for (unsigned i=0 ; i<bufferSizeInBytes - 2 ; ++i) {
+            QVERIFY(buffer[i] == 2);
+        }
+
+        QVERIFY(container.virtualFile("test2.dat") == vf);
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        Container::MemoryContainer::DirectoryMap directory = container.directory();
+        QVERIFY(directory.size() == numberVirtualFiles + 1);
+
+        for (unsigned i=0 ; i<numberVirtualFiles ; ++i) {
+            std::stringstream stream;
+            stream << "test" << i << ".dat";
+
+            Container::Container::DirectoryMap::iterator pos = directory.find(stream.str());
+            QVERIFY(pos != directory.end());
+            QVERIFY(pos->second->size() == bufferSizeInBytes - i);
+        }
+
+        std::shared_ptr<Container::VirtualFile> newFile = container.virtualFile("new.dat");
+        QVERIFY(newFile);
+        QVERIFY(newFile->size() == bufferSizeInBytes);
+
+        status = newFile->read(buffer, bufferSizeInBytes);
+        QVERIFY(status.success());
+        QVERIFY(Container::ReadSuccessful(status).bytesRead() == bufferSizeInBytes);
+
+        for (unsigned i=0 ; i<bufferSizeInBytes ; ++i) {
+            QVERIFY(buffer[i] == 0x55);
+        }
+    }
+}
+
+
+void TestVirtualFile::testExtendedChunks() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+    std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+
+    std::vector<std::uint8_t> data(extendedFileSizeInBytes);
+    std::vector<std::uint8_t> buffer(extendedFileSizeInBytes);
+
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+
+    for (unsigned i=0 ; i<extendedFileSizeInBytes ; ++i) {
+        data[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(status.success());
+        QVERIFY(container.minorVersion() == Container::Container::containerMinorVersion);
+
+        std::shared_ptr<Container::VirtualFile> vf = container.newVirtualFile("large.dat");
+        status = vf->append(data.data(), extendedFileSizeInBytes);
+        QVERIFY(status.success());
+        QVERIFY(Container::WriteSuccessful(status).bytesWritten() == extendedFileSizeInBytes);
+
+        status = container.close();
+        QVERIFY(!status);
+
+        // Extended chunks should keep the per-chunk overhead well below the overhead of 4K chunks.
+
+        QVERIFY(containerBuffer->size() < extendedFileSizeInBytes + extendedFileSizeInBytes / 256);
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        std::shared_ptr<Container::VirtualFile> vf = container.virtualFile("large.dat");
+        QVERIFY(vf);
+        QVERIFY(vf->size() == extendedFileSizeInBytes);
+
+        status = vf->read(buffer.data(), extendedFileSizeInBytes);
+        QVERIFY(status.success());
+        QVERIFY(Container::ReadSuccessful(status).bytesRead() == extendedFileSizeInBytes);
+        QVERIFY(buffer == data);
+
+        // Overwrite a region spanning chunk boundaries and a small region inside a single extended chunk.
+
+        std::uniform_int_distribution<> positionGenerator(0, extendedFileSizeInBytes - bufferSizeInBytes);
+        for (unsigned i=0 ; i<16 ; ++i) {
+            unsigned position = positionGenerator(rng);
+            unsigned length   = (i % 2) ? bufferSizeInBytes : 17;
+
+            for (unsigned j=0 ; j<length ; ++j) {
+                data[position + j] = static_cast<std::uint8_t>(byteGenerator(rng));
+            }
+
+            status = vf->setPosition(position);
+            QVERIFY(!status);
+
+            status = vf->write(data.data() + position, length);
+            QVERIFY(status.success());
+            QVERIFY(Container::WriteSuccessful(status).bytesWritten() == length);
+        }
+
+        // Truncate inside an extended chunk.
+
+        data.resize(extendedFileSizeInBytes - 700000);
+
+        status = vf->setPosition(data.size());
+        QVERIFY(!status);
+
+        status = vf->truncate();
+        QVERIFY(!status);
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    {
+        ContainerWrapper container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        status = container.streamRead();
+        QVERIFY(!status);
+
+        ContainerWrapper::DirectoryMap directory = container.directory();
+        QVERIFY(directory.size() == 1);
+
+        std::shared_ptr<VirtualFileWrapper> vf = std::dynamic_pointer_cast<VirtualFileWrapper>(
+            directory.at("large.dat")
+        );
+
+        QVERIFY(vf->dataBuffer() == data);
+    }
+}
+
+
+void TestVirtualFile::testCrcVerification() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+    std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+
+    std::vector<std::uint8_t> data(extendedFileSizeInBytes);
+    std::vector<std::uint8_t> buffer(extendedFileSizeInBytes);
+
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+
+    for (unsigned i=0 ; i<extendedFileSizeInBytes ; ++i) {
+        data[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(status.success());
+
+        std::shared_ptr<Container::VirtualFile> vf = container.newVirtualFile("crc.dat");
+        status = vf->append(data.data(), extendedFileSizeInBytes);
+        QVERIFY(status.success());
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    // Locate a byte near the end of the file so that the corrupted chunk is not the first chunk read.
+
+    const std::uint8_t* pattern       = data.data() + extendedFileSizeInBytes - 1000;
+    MemoryBuffer::iterator patternPos = std::search(
+        containerBuffer->begin(),
+        containerBuffer->end(),
+        pattern,
+        pattern + 64
+    );
+
+    QVERIFY(patternPos != containerBuffer->end());
+    std::uint8_t& corruptedByte = *(patternPos + 32);
+    corruptedByte ^= 0x10;
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+        QVERIFY(container.crcVerification() == Container::Container::CrcVerification::ALWAYS);
+
+        std::shared_ptr<Container::VirtualFile> vf = container.virtualFile("crc.dat");
+
+        status = vf->read(buffer.data(), bufferSizeInBytes);
+        QVERIFY(status.success());
+        QVERIFY(Container::ReadSuccessful(status).bytesRead() == bufferSizeInBytes);
+
+        status = vf->setPosition(0);
+        QVERIFY(!status);
+
+        status = vf->read(buffer.data(), extendedFileSizeInBytes);
+        QVERIFY(status.errorCode() == Container::ChunkCrcError::reportedErrorCode);
+        QVERIFY(Container::ChunkCrcError(status).filePosition() < containerBuffer->size());
+
+        container.setCrcVerification(Container::Container::CrcVerification::OFF);
+
+        status = vf->setPosition(0);
+        QVERIFY(!status);
+
+        status = vf->read(buffer.data(), extendedFileSizeInBytes);
+        QVERIFY(status.success());
+        QVERIFY(Container::ReadSuccessful(status).bytesRead() == extendedFileSizeInBytes);
+        QVERIFY(buffer != data);
+
+        // Only the first chunk read is checked when sampling with a large interval.
+
+        container.setCrcVerification(Container::Container::CrcVerification::SAMPLED, 1000);
+
+        status = vf->setPosition(0);
+        QVERIFY(!status);
+
+        status = vf->read(buffer.data(), extendedFileSizeInBytes);
+        QVERIFY(status.success());
+        QVERIFY(Container::ReadSuccessful(status).bytesRead() == extendedFileSizeInBytes);
+
+        container.setCrcVerification(Container::Container::CrcVerification::SAMPLED, 1);
+
+        status = vf->setPosition(0);
+        QVERIFY(!status);
+
+        status = vf->read(buffer.data(), extendedFileSizeInBytes);
+        QVERIFY(status.errorCode() == Container::ChunkCrcError::reportedErrorCode);
+    }
+
+    {
+        ContainerWrapper container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        status = container.streamRead();
+        QVERIFY(status.errorCode() == Container::ChunkCrcError::reportedErrorCode);
+    }
+
+    corruptedByte ^= 0x10;
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        container.setCrcVerification(Container::Container::CrcVerification::FIRST_TOUCH);
+        QVERIFY(container.crcVerification() == Container::Container::CrcVerification::FIRST_TOUCH);
+
+        std::shared_ptr<Container::VirtualFile> vf = container.virtualFile("crc.dat");
+
+        status = vf->read(buffer.data(), extendedFileSizeInBytes);
+        QVERIFY(status.success());
+        QVERIFY(Container::ReadSuccessful(status).bytesRead() == extendedFileSizeInBytes);
+        QVERIFY(buffer == data);
+
+        // Chunks that have already been verified are not checked again.
+
+        corruptedByte ^= 0x10;
+
+        status = vf->setPosition(0);
+        QVERIFY(!status);
+
+        status = vf->read(buffer.data(), extendedFileSizeInBytes);
+        QVERIFY(status.success());
+        QVERIFY(Container::ReadSuccessful(status).bytesRead() == extendedFileSizeInBytes);
+
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        container.setCrcVerification(Container::Container::CrcVerification::FIRST_TOUCH);
+
+        std::shared_ptr<Container::VirtualFile> vf = container.virtualFile("crc.dat");
+
+        status = vf->read(buffer.data(), extendedFileSizeInBytes);
+        QVERIFY(status.errorCode() == Container::ChunkCrcError::reportedErrorCode);
+    }
+
+    // A chunk that is rewritten must be verified again.
+
+    containerBuffer = std::make_shared<MemoryBuffer>();
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(status.success());
+
+        container.setCrcVerification(Container::Container::CrcVerification::FIRST_TOUCH);
+
+        std::shared_ptr<Container::VirtualFile> vf = container.newVirtualFile("rewrite.dat");
+        vf->setReadCacheSize(0);
+
+        status = vf->append(data.data(), 3 * bufferSizeInBytes);
+        QVERIFY(status.success());
+
+        status = vf->flush();
+        QVERIFY(!status);
+
+        status = vf->setPosition(0);
+        QVERIFY(!status);
+
+        status = vf->read(buffer.data(), 3 * bufferSizeInBytes);
+        QVERIFY(status.success());
+        QVERIFY(Container::ReadSuccessful(status).bytesRead() == 3 * bufferSizeInBytes);
+
+        for (unsigned i=0 ; i<1000 ; ++i) {
+            data[i] ^= 0xFF;
+        }
+
+        status = vf->setPosition(0);
+        QVERIFY(!status);
+
+        status = vf->write(data.data(), 1000);
+        QVERIFY(status.success());
+
+        status = vf->flush();
+        QVERIFY(!status);
+
+        MemoryBuffer::iterator rewrittenPos = std::search(
+            containerBuffer->begin(),
+            containerBuffer->end(),
+            data.data() + 100,
+            data.data() + 164
+        );
+
+        QVERIFY(rewrittenPos != containerBuffer->end());
+        *rewrittenPos ^= 0x10;
+
+        status = vf->setPosition(2 * bufferSizeInBytes);
+        QVERIFY(!status);
+
+        status = vf->read(buffer.data(), 1000);
+        QVERIFY(status.success());
+
+        status = vf->setPosition(0);
+        QVERIFY(!status);
+
+        status = vf->read(buffer.data(), 1000);
+        QVERIFY(status.errorCode() == Container::ChunkCrcError::reportedErrorCode);
+    }
+}
+
+
+void TestVirtualFile::testPayloadChecksums() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+    std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+
+    std::vector<std::uint8_t> data(extendedFileSizeInBytes);
+    std::vector<std::uint8_t> buffer(extendedFileSizeInBytes);
+
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+
+    for (unsigned i=0 ; i<extendedFileSizeInBytes ; ++i) {
+        data[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+        container.setChunkChecksum(Container::Container::ChunkChecksum::CRC64);
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(status.success());
+        QVERIFY(container.chunkChecksum() == Container::Container::ChunkChecksum::CRC64);
+        QVERIFY(container.minorVersion() == Container::Container::containerMinorVersion);
+
+        std::shared_ptr<Container::VirtualFile> vf = container.newVirtualFile("checksum.dat");
+        status = vf->append(data.data(), 1000);
+        QVERIFY(status.success());
+
+        status = vf->append(data.data() + 1000, extendedFileSizeInBytes - 1000);
+        QVERIFY(status.success());
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+        QVERIFY(container.chunkChecksum() == Container::Container::ChunkChecksum::CRC64);
+
+        std::shared_ptr<Container::VirtualFile> vf = container.virtualFile("checksum.dat");
+        QVERIFY(vf->size() == extendedFileSizeInBytes);
+
+        status = vf->read(buffer.data(), extendedFileSizeInBytes);
+        QVERIFY(status.success());
+        QVERIFY(Container::ReadSuccessful(status).bytesRead() == extendedFileSizeInBytes);
+        QVERIFY(buffer == data);
+    }
+
+    const std::uint8_t* pattern       = data.data() + extendedFileSizeInBytes - 1000;
+    MemoryBuffer::iterator patternPos = std::search(
+        containerBuffer->begin(),
+        containerBuffer->end(),
+        pattern,
+        pattern + 64
+    );
+
+    QVERIFY(patternPos != containerBuffer->end());
+    *(patternPos + 32) ^= 0x10;
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        std::shared_ptr<Container::VirtualFile> vf = container.virtualFile("checksum.dat");
+
+        status = vf->read(buffer.data(), extendedFileSizeInBytes);
+        QVERIFY(status.errorCode() == Container::ChunkCrcError::reportedErrorCode);
+    }
+
+    {
+        std::shared_ptr<MemoryBuffer> defaultBuffer = std::make_shared<MemoryBuffer>();
+        Container::MemoryContainer    container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(defaultBuffer);
+        QVERIFY(status.success());
+        QVERIFY(container.chunkChecksum() == Container::Container::ChunkChecksum::CRC16);
+    }
+}
+
+
+void TestVirtualFile::testCompression() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+    std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+    std::shared_ptr<MemoryBuffer> plainBuffer     = std::make_shared<MemoryBuffer>();
+
+    static const char* const words[] = {
+        "container ", "virtual ", "file ", "chunk ", "stream ", "the ", "of ", "data ", "and ", "extent\n"
+    };
+
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+    std::uniform_int_distribution<> wordGenerator(0, sizeof(words) / sizeof(words[0]) - 1);
+    std::uniform_int_distribution<> lengthGenerator(1, bufferSizeInBytes);
+
+    std::vector<std::uint8_t> data;
+    while (data.size() < compressedFileSizeInBytes) {
+        const char* word = words[wordGenerator(rng)];
+        data.insert(data.end(), word, word + std::strlen(word));
+    }
+
+    data.resize(compressedFileSizeInBytes);
+
+    std::vector<std::uint8_t> buffer(compressedFileSizeInBytes);
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+        Container::MemoryContainer plainContainer("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(status.success());
+
+        status = plainContainer.open(plainBuffer);
+        QVERIFY(status.success());
+
+        std::shared_ptr<Container::VirtualFile> vf      = container.newVirtualFile("compressed.dat");
+        std::shared_ptr<Container::VirtualFile> plainVf = plainContainer.newVirtualFile("compressed.dat");
+
+        QVERIFY(vf->compression() == Container::VirtualFile::Compression::NONE);
+
+        status = vf->setCompression(Container::VirtualFile::Compression::FAST);
+        QVERIFY(!status);
+        QVERIFY(vf->compression() == Container::VirtualFile::Compression::FAST);
+
+        unsigned offset = 0;
+        while (offset < compressedFileSizeInBytes) {
+            unsigned length = lengthGenerator(rng);
+            if (length > compressedFileSizeInBytes - offset) {
+                length = compressedFileSizeInBytes - offset;
+            }
+
+            status = vf->append(data.data() + offset, length);
+            QVERIFY(status.success());
+
+            status = plainVf->append(data.data() + offset, length);
+            QVERIFY(status.success());
+
+            offset += length;
+        }
+
+        // Pending data must be visible before it's flushed.
+
+        QVERIFY(vf->size() == compressedFileSizeInBytes);
+
+        status = vf->setPosition(0);
+        QVERIFY(!status);
+
+        status = vf->read(buffer.data(), compressedFileSizeInBytes);
+        QVERIFY(status.success());
+        QVERIFY(buffer == data);
+
+        status = container.close();
+        QVERIFY(!status);
+
+        status = plainContainer.close();
+        QVERIFY(!status);
+    }
+
+    QVERIFY(containerBuffer->size() < 2 * plainBuffer->size() / 3);
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        std::shared_ptr<Container::VirtualFile> vf = container.virtualFile("compressed.dat");
+        QVERIFY(vf->size() == compressedFileSizeInBytes);
+
+        status = vf->read(buffer.data(), compressedFileSizeInBytes);
+        QVERIFY(status.success());
+        QVERIFY(Container::ReadSuccessful(status).bytesRead() == compressedFileSizeInBytes);
+        QVERIFY(buffer == data);
+
+        // Random reads must work across extent boundaries.
+
+        std::uniform_int_distribution<> offsetGenerator(0, compressedFileSizeInBytes - 1);
+        for (unsigned i=0 ; i<numberCompressedReadTests ; ++i) {
+            unsigned offset = offsetGenerator(rng);
+            unsigned length = lengthGenerator(rng) % 100000;
+            if (length > compressedFileSizeInBytes - offset) {
+                length = compressedFileSizeInBytes - offset;
+            }
+
+            status = vf->setPosition(offset);
+            QVERIFY(!status);
+
+            status = vf->read(buffer.data(), length);
+            QVERIFY(status.success());
+            QVERIFY(Container::ReadSuccessful(status).bytesRead() == length);
+            QVERIFY(std::memcmp(buffer.data(), data.data() + offset, length) == 0);
+        }
+
+        // Overwrite data spanning several extents with data that doesn't compress.
+
+        status = vf->setCompression(Container::VirtualFile::Compression::HIGH_RATIO);
+        QVERIFY(!status);
+
+        unsigned overwriteOffset = 65536 - 1000;
+        unsigned overwriteLength = 3 * 65536;
+        for (unsigned i=0 ; i<overwriteLength ; ++i) {
+            data[overwriteOffset + i] = static_cast<std::uint8_t>(byteGenerator(rng));
+        }
+
+        status = vf->setPosition(overwriteOffset);
+        QVERIFY(!status);
+
+        status = vf->write(data.data() + overwriteOffset, overwriteLength);
+        QVERIFY(status.success());
+
+        status = vf->setPosition(0);
+        QVERIFY(!status);
+
+        status = vf->read(buffer.data(), compressedFileSizeInBytes);
+        QVERIFY(status.success());
+        QVERIFY(buffer == data);
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    unsigned truncatedSize = 300000 + 17;
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        std::shared_ptr<Container::VirtualFile> vf = container.virtualFile("compressed.dat");
+
+        status = vf->read(buffer.data(), compressedFileSizeInBytes);
+        QVERIFY(status.success());
+        QVERIFY(buffer == data);
+
+        status = vf->setPosition(truncatedSize);
+        QVERIFY(!status);
+
+        status = vf->truncate();
+        QVERIFY(!status);
+        QVERIFY(vf->size() == truncatedSize);
+
+        data.resize(truncatedSize);
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    {
+        ContainerWrapper container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        status = container.streamRead();
+        QVERIFY(!status);
+
+        ContainerWrapper::DirectoryMap directory = container.directory();
+        QVERIFY(directory.size() == 1);
+
+        std::shared_ptr<VirtualFileWrapper> vf = std::dynamic_pointer_cast<VirtualFileWrapper>(
+            directory.begin()->second
+        );
+
+        QVERIFY(vf->dataBuffer() == data);
+    }
+
+    {
+        // Data that does not compress is stored as-is.
+
+        std::shared_ptr<MemoryBuffer> randomBuffer = std::make_shared<MemoryBuffer>();
+        Container::MemoryContainer    container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(randomBuffer);
+        QVERIFY(!status);
+
+        for (unsigned i=0 ; i<compressedFileSizeInBytes ; ++i) {
+            buffer[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+        }
+
+        std::shared_ptr<Container::VirtualFile> vf = container.newVirtualFile("random.dat");
+
+        status = vf->setCompression(Container::VirtualFile::Compression::FAST);
+        QVERIFY(!status);
+
+        status = vf->append(buffer.data(), compressedFileSizeInBytes);
+        QVERIFY(status.success());
+
+        status = vf->flush();
+        QVERIFY(!status);
+
+        std::vector<std::uint8_t> readBuffer(compressedFileSizeInBytes);
+
+        status = vf->setPosition(0);
+        QVERIFY(!status);
+
+        status = vf->read(readBuffer.data(), compressedFileSizeInBytes);
+        QVERIFY(status.success());
+        QVERIFY(readBuffer == buffer);
+        QVERIFY(randomBuffer->size() < compressedFileSizeInBytes + compressedFileSizeInBytes / 16);
+    }
+}
+
+
+void TestVirtualFile::testDeduplication() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+    std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+    std::shared_ptr<MemoryBuffer> plainBuffer     = std::make_shared<MemoryBuffer>();
+
+    static const char* const names[] = { "first.dat", "second.dat", "third.dat" };
+    static constexpr unsigned numberFiles = sizeof(names) / sizeof(names[0]);
+
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+    std::uniform_int_distribution<> lengthGenerator(1, bufferSizeInBytes);
+
+    std::vector<std::vector<std::uint8_t>> data(numberFiles);
+
+    data[0].resize(deduplicatedFileSizeInBytes);
+    for (unsigned i=0 ; i<deduplicatedFileSizeInBytes ; ++i) {
+        data[0][i] = static_cast<std::uint8_t>(byteGenerator(rng));
+    }
+
+    // The third file differs from the first file by a single byte in the middle of the file.
+
+    data[1] = data[0];
+    data[2] = data[0];
+    data[2][3 * 65472 + 100] ^= 0x5A;
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+        Container::MemoryContainer plainContainer("Inesonic, LLC.\nAleph Test");
+
+        QVERIFY(!container.deduplication());
+        container.setDeduplication();
+        QVERIFY(container.deduplication());
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(status.success());
+
+        status = plainContainer.open(plainBuffer);
+        QVERIFY(status.success());
+
+        for (unsigned fileIndex=0 ; fileIndex<numberFiles ; ++fileIndex) {
+            std::shared_ptr<Container::VirtualFile> vf      = container.newVirtualFile(names[fileIndex]);
+            std::shared_ptr<Container::VirtualFile> plainVf = plainContainer.newVirtualFile(names[fileIndex]);
+
+            const std::vector<std::uint8_t>& fileData = data[fileIndex];
+
+            unsigned offset = 0;
+            while (offset < deduplicatedFileSizeInBytes) {
+                unsigned length = lengthGenerator(rng);
+                if (length > deduplicatedFileSizeInBytes - offset) {
+                    length = deduplicatedFileSizeInBytes - offset;
+                }
+
+                status = vf->append(fileData.data() + offset, length);
+                QVERIFY(status.success());
+
+                status = plainVf->append(fileData.data() + offset, length);
+                QVERIFY(status.success());
+
+                offset += length;
+            }
+
+            QVERIFY(vf->size() == deduplicatedFileSizeInBytes);
+
+            std::vector<std::uint8_t> buffer(deduplicatedFileSizeInBytes);
+
+            status = vf->setPosition(0);
+            QVERIFY(!status);
+
+            status = vf->read(buffer.data(), deduplicatedFileSizeInBytes);
+            QVERIFY(status.success());
+            QVERIFY(buffer == fileData);
+        }
+
+        status = container.close();
+        QVERIFY(!status);
+
+        status = plainContainer.close();
+        QVERIFY(!status);
+    }
+
+    // Only one of the six full extents in the third file differs from the first file so the container should hold
+    // little more than one copy of the data.
+
+    QVERIFY(containerBuffer->size() < plainBuffer->size() / 2);
+
+    {
+        ContainerWrapper container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        status = container.streamRead();
+        QVERIFY(!status);
+
+        ContainerWrapper::DirectoryMap directory = container.directory();
+        QVERIFY(directory.size() == numberFiles);
+
+        for (unsigned fileIndex=0 ; fileIndex<numberFiles ; ++fileIndex) {
+            ContainerWrapper::DirectoryMap::iterator pos = directory.find(names[fileIndex]);
+            QVERIFY(pos != directory.end());
+
+            std::shared_ptr<VirtualFileWrapper> vf = std::dynamic_pointer_cast<VirtualFileWrapper>(pos->second);
+            QVERIFY(vf->dataBuffer() == data[fileIndex]);
+        }
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+        container.setDeduplication();
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        for (unsigned fileIndex=0 ; fileIndex<numberFiles ; ++fileIndex) {
+            std::shared_ptr<Container::VirtualFile> vf = container.virtualFile(names[fileIndex]);
+            QVERIFY(vf->size() == deduplicatedFileSizeInBytes);
+
+            std::vector<std::uint8_t> buffer(deduplicatedFileSizeInBytes);
+
+            status = vf->read(buffer.data(), deduplicatedFileSizeInBytes);
+            QVERIFY(status.success());
+            QVERIFY(buffer == data[fileIndex]);
+        }
+
+        // Modifying a shared extent must not change the other files that reference it.
+
+        unsigned overwriteOffset = 65472 - 1000;
+        unsigned overwriteLength = 2 * 65472;
+        for (unsigned i=0 ; i<overwriteLength ; ++i) {
+            data[1][overwriteOffset + i] = static_cast<std::uint8_t>(byteGenerator(rng));
+        }
+
+        std::shared_ptr<Container::VirtualFile> second = container.virtualFile(names[1]);
+
+        status = second->setPosition(overwriteOffset);
+        QVERIFY(!status);
+
+        status = second->write(data[1].data() + overwriteOffset, overwriteLength);
+        QVERIFY(status.success());
+
+        // Truncating a file in the middle of a shared extent.
+
+        unsigned truncatedSize = 2 * 65472 + 17;
+
+        std::shared_ptr<Container::VirtualFile> third = container.virtualFile(names[2]);
+
+        status = third->setPosition(truncatedSize);
+        QVERIFY(!status);
+
+        status = third->truncate();
+        QVERIFY(!status);
+        QVERIFY(third->size() == truncatedSize);
+
+        data[2].resize(truncatedSize);
+
+        std::shared_ptr<Container::VirtualFile> first = container.virtualFile(names[0]);
+
+        status = first->erase();
+        QVERIFY(!status);
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    {
+        // The remaining files must be intact and erasing them must release every shared chunk.
+
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        for (unsigned fileIndex=1 ; fileIndex<numberFiles ; ++fileIndex) {
+            std::shared_ptr<Container::VirtualFile> vf = container.virtualFile(names[fileIndex]);
+
+            std::vector<std::uint8_t> buffer(vf->size());
+
+            status = vf->read(buffer.data(), static_cast<unsigned>(buffer.size()));
+            QVERIFY(status.success());
+            QVERIFY(buffer == data[fileIndex]);
+
+            status = vf->erase();
+            QVERIFY(!status);
+        }
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    QVERIFY(containerBuffer->size() < 65536);
+}
+
+
+void TestVirtualFile::testReadView() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+    std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+    std::uniform_int_distribution<> lengthGenerator(1, bufferSizeInBytes);
+    std::uniform_int_distribution<> offsetGenerator(0, readViewFileSizeInBytes - 1);
+
+    std::vector<std::uint8_t> data(readViewFileSizeInBytes);
+    for (unsigned i=0 ; i<readViewFileSizeInBytes ; ++i) {
+        data[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+    }
+
+    std::vector<std::uint8_t> compressibleData(readViewFileSizeInBytes);
+    for (unsigned i=0 ; i<readViewFileSizeInBytes ; ++i) {
+        compressibleData[i] = static_cast<std::uint8_t>('a' + (i / 7) % 13);
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        std::shared_ptr<Container::VirtualFile> vf           = container.newVirtualFile("plain.dat");
+        std::shared_ptr<Container::VirtualFile> compressedVf = container.newVirtualFile("compressed.dat");
+
+        status = compressedVf->setCompression(Container::VirtualFile::Compression::FAST);
+        QVERIFY(!status);
+
+        status = vf->append(data.data(), readViewFileSizeInBytes);
+        QVERIFY(status.success());
+
+        status = compressedVf->append(compressibleData.data(), readViewFileSizeInBytes);
+        QVERIFY(status.success());
+
+        // Data still held in the write cache must be copied into the view.
+
+        status = vf->setPosition(0);
+        QVERIFY(!status);
+
+        Container::VirtualFile::View view;
+        status = vf->readView(readViewFileSizeInBytes, view);
+        QVERIFY(status.success());
+        QVERIFY(Container::ReadSuccessful(status).bytesRead() == readViewFileSizeInBytes);
+        QVERIFY(view.size() == readViewFileSizeInBytes);
+
+        std::vector<std::uint8_t> received;
+        for (unsigned i=0 ; i<view.numberSpans() ; ++i) {
+            received.insert(received.end(), view.spanData(i), view.spanData(i) + view.spanLength(i));
+        }
+
+        QVERIFY(received == data);
+        QVERIFY(vf->position() == readViewFileSizeInBytes);
+
+        view.release();
+        QVERIFY(view.numberSpans() == 0);
+        QVERIFY(view.size() == 0);
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        std::shared_ptr<Container::VirtualFile> vf           = container.virtualFile("plain.dat");
+        std::shared_ptr<Container::VirtualFile> compressedVf = container.virtualFile("compressed.dat");
+
+        const std::uint8_t* containerStart = containerBuffer->data();
+        const std::uint8_t* containerEnd   = containerStart + containerBuffer->size();
+
+        unsigned numberPinnedSpans = 0;
+        for (unsigned testNumber=0 ; testNumber<numberReadViewTests ; ++testNumber) {
+            unsigned offset = offsetGenerator(rng);
+            unsigned length = lengthGenerator(rng);
+
+            unsigned remaining      = readViewFileSizeInBytes - offset;
+            unsigned expectedLength = length < remaining ? length : remaining;
+
+            std::shared_ptr<Container::VirtualFile> file     = (testNumber % 2) == 0 ? vf : compressedVf;
+            const std::vector<std::uint8_t>&        expected = (testNumber % 2) == 0 ? data : compressibleData;
+
+            status = file->setPosition(offset);
+            QVERIFY(!status);
+
+            Container::VirtualFile::View view;
+            status = file->readView(length, view);
+            QVERIFY(status.success());
+            QVERIFY(Container::ReadSuccessful(status).bytesRead() == expectedLength);
+            QVERIFY(view.size() == expectedLength);
+            QVERIFY(file->position() == offset + expectedLength);
+
+            // Copies of the view keep the spans pinned after the original is released.
+
+            Container::VirtualFile::View copy = view;
+            view.release();
+
+            unsigned long long viewOffset = offset;
+            for (unsigned i=0 ; i<copy.numberSpans() ; ++i) {
+                const std::uint8_t* spanData   = copy.spanData(i);
+                unsigned            spanLength = copy.spanLength(i);
+
+                QVERIFY(std::memcmp(spanData, expected.data() + viewOffset, spanLength) == 0);
+
+                if (spanData >= containerStart && spanData + spanLength <= containerEnd) {
+                    ++numberPinnedSpans;
+                }
+
+                viewOffset += spanLength;
+            }
+
+            QVERIFY(viewOffset == offset + expectedLength);
+            QVERIFY(copy.spanData(copy.numberSpans()) == nullptr);
+            QVERIFY(copy.spanLength(copy.numberSpans()) == 0);
+        }
+
+        QVERIFY(numberPinnedSpans > 0);
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+}
+
+
+void TestVirtualFile::testVectoredReadWrite() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+    std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+    std::uniform_int_distribution<> countGenerator(1, maximumNumberVectoredBuffers);
+    std::uniform_int_distribution<> smallLengthGenerator(0, 300);
+    std::uniform_int_distribution<> largeLengthGenerator(0, 3 * bufferSizeInBytes);
+    std::uniform_int_distribution<> offsetGenerator(0, vectoredFileSizeInBytes - 1);
+
+    std::vector<std::uint8_t> data(vectoredFileSizeInBytes);
+    for (unsigned i=0 ; i<vectoredFileSizeInBytes ; ++i) {
+        data[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+    }
+
+    std::vector<std::uint8_t> compressibleData(vectoredFileSizeInBytes);
+    for (unsigned i=0 ; i<vectoredFileSizeInBytes ; ++i) {
+        compressibleData[i] = static_cast<std::uint8_t>('A' + (i / 5) % 17);
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        std::shared_ptr<Container::VirtualFile> vf           = container.newVirtualFile("vectored.dat");
+        std::shared_ptr<Container::VirtualFile> compressedVf = container.newVirtualFile("owned.dat");
+
+        // Write the file as lists of mostly small fragments with an occasional large fragment.
+
+        std::vector<Container::VirtualFile::WriteBuffer> writeBuffers;
+
+        unsigned offset = 0;
+        while (offset < vectoredFileSizeInBytes) {
+            unsigned numberBuffers = countGenerator(rng);
+
+            writeBuffers.clear();
+            unsigned batchOffset = offset;
+            for (unsigned i=0 ; i<numberBuffers && batchOffset < vectoredFileSizeInBytes ; ++i) {
+                unsigned length = (i % 5) == 4 ? largeLengthGenerator(rng) : smallLengthGenerator(rng);
+                if (length > vectoredFileSizeInBytes - batchOffset) {
+                    length = vectoredFileSizeInBytes - batchOffset;
+                }
+
+                writeBuffers.push_back(Container::VirtualFile::WriteBuffer(data.data() + batchOffset, length));
+                batchOffset += length;
+            }
+
+            status = vf->writev(writeBuffers.data(), static_cast<unsigned>(writeBuffers.size()));
+            QVERIFY(status.success());
+            QVERIFY(Container::WriteSuccessful(status).bytesWritten() == batchOffset - offset);
+            QVERIFY(vf->position() == batchOffset);
+
+            offset = batchOffset;
+        }
+
+        QVERIFY(vf->size() == vectoredFileSizeInBytes);
+
+        // Hand buffers to a compressed file.  The buffers are consumed by the write.
+
+        status = compressedVf->setCompression(Container::VirtualFile::Compression::FAST);
+        QVERIFY(!status);
+
+        offset = 0;
+        while (offset < vectoredFileSizeInBytes) {
+            unsigned length = largeLengthGenerator(rng);
+            if (length > vectoredFileSizeInBytes - offset) {
+                length = vectoredFileSizeInBytes - offset;
+            }
+
+            std::vector<std::uint8_t> buffer(
+                compressibleData.begin() + offset,
+                compressibleData.begin() + offset + length
+            );
+
+            status = compressedVf->write(std::move(buffer));
+            QVERIFY(status.success());
+            QVERIFY(Container::WriteSuccessful(status).bytesWritten() == length);
+            QVERIFY(buffer.empty());
+
+            offset += length;
+        }
+
+        QVERIFY(compressedVf->size() == vectoredFileSizeInBytes);
+
+        // Overwrite ranges that may extend past the end of the file.
+
+        for (unsigned testNumber=0 ; testNumber<numberRandomWriteReadTests ; ++testNumber) {
+            unsigned start         = offsetGenerator(rng);
+            unsigned numberBuffers = countGenerator(rng);
+
+            writeBuffers.clear();
+            std::vector<std::uint8_t> newData;
+            for (unsigned i=0 ; i<numberBuffers ; ++i) {
+                unsigned length = (i % 5) == 4 ? largeLengthGenerator(rng) / 8 : smallLengthGenerator(rng);
+                newData.resize(newData.size() + length);
+            }
+
+            for (unsigned i=0 ; i<newData.size() ; ++i) {
+                newData[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+            }
+
+            std::uniform_int_distribution<> splitGenerator(0, static_cast<int>(newData.size()));
+            std::vector<unsigned>           splits;
+            for (unsigned i=1 ; i<numberBuffers ; ++i) {
+                splits.push_back(splitGenerator(rng));
+            }
+
+            splits.push_back(0);
+            splits.push_back(static_cast<unsigned>(newData.size()));
+            std::sort(splits.begin(), splits.end());
+
+            for (unsigned i=1 ; i<splits.size() ; ++i) {
+                writeBuffers.push_back(
+                    Container::VirtualFile::WriteBuffer(newData.data() + splits[i - 1], splits[i] - splits[i - 1])
+                );
+            }
+
+            status = vf->setPosition(start);
+            QVERIFY(!status);
+
+            status = vf->writev(writeBuffers.data(), static_cast<unsigned>(writeBuffers.size()));
+            QVERIFY(status.success());
+            QVERIFY(Container::WriteSuccessful(status).bytesWritten() == newData.size());
+
+            if (start + newData.size() > data.size()) {
+                data.resize(start + newData.size());
+            }
+
+            std::copy(newData.begin(), newData.end(), data.begin() + start);
+            QVERIFY(vf->size() == static_cast<long long>(data.size()));
+        }
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        std::shared_ptr<Container::VirtualFile> vf           = container.virtualFile("vectored.dat");
+        std::shared_ptr<Container::VirtualFile> compressedVf = container.virtualFile("owned.dat");
+
+        QVERIFY(vf->size() == static_cast<long long>(data.size()));
+        QVERIFY(compressedVf->size() == vectoredFileSizeInBytes);
+
+        std::vector<std::uint8_t> received(data.size());
+
+        for (unsigned testNumber=0 ; testNumber<numberRandomWriteReadTests ; ++testNumber) {
+            bool                                    compressed = (testNumber % 2) != 0;
+            std::shared_ptr<Container::VirtualFile> file       = compressed ? compressedVf : vf;
+            const std::vector<std::uint8_t>&        expected   = compressed ? compressibleData : data;
+
+            unsigned start         = offsetGenerator(rng);
+            unsigned numberBuffers = countGenerator(rng);
+
+            std::vector<Container::VirtualFile::ReadBuffer> readBuffers;
+            unsigned                                        requested = 0;
+            for (unsigned i=0 ; i<numberBuffers ; ++i) {
+                unsigned length = (i % 5) == 4 ? largeLengthGenerator(rng) : smallLengthGenerator(rng);
+                if (requested + length > received.size()) {
+                    length = static_cast<unsigned>(received.size()) - requested;
+                }
+
+                readBuffers.push_back(Container::VirtualFile::ReadBuffer(received.data() + requested, length));
+                requested += length;
+            }
+
+            unsigned expectedCount = static_cast<unsigned>(
+                requested < expected.size() - start ? requested : expected.size() - start
+            );
+
+            status = file->setPosition(start);
+            QVERIFY(!status);
+
+            status = file->readv(readBuffers.data(), static_cast<unsigned>(readBuffers.size()));
+            QVERIFY(status.success());
+            QVERIFY(Container::ReadSuccessful(status).bytesRead() == expectedCount);
+            QVERIFY(std::memcmp(received.data(), expected.data() + start, expectedCount) == 0);
+            QVERIFY(file->position() == start + expectedCount);
+        }
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+}
+
+
+void TestVirtualFile::testPositionalReadWrite() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+    std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+    std::uniform_int_distribution<> lengthGenerator(0, bufferSizeInBytes / 4);
+    std::uniform_int_distribution<> operationGenerator(0, 2);
+
+    std::vector<std::uint8_t> data[2];
+    for (unsigned i=0 ; i<positionalFileSizeInBytes ; ++i) {
+        data[0].push_back(static_cast<std::uint8_t>(byteGenerator(rng)));
+        data[1].push_back(static_cast<std::uint8_t>('a' + (i / 3) % 11));
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        std::shared_ptr<Container::VirtualFile> files[2] = {
+            container.newVirtualFile("positional.dat"),
+            container.newVirtualFile("compressed.dat")
+        };
+
+        status = files[1]->setCompression(Container::VirtualFile::Compression::FAST);
+        QVERIFY(!status);
+
+        for (unsigned fileIndex=0 ; fileIndex<2 ; ++fileIndex) {
+            status = files[fileIndex]->write(data[fileIndex].data(), positionalFileSizeInBytes);
+            QVERIFY(status.success());
+
+            status = files[fileIndex]->setPosition(positionalFileSizeInBytes / 2);
+            QVERIFY(!status);
+        }
+
+        std::vector<std::uint8_t> buffer;
+
+        for (unsigned testNumber=0 ; testNumber<numberPositionalTests ; ++testNumber) {
+            unsigned                                 fileIndex = testNumber % 2;
+            std::shared_ptr<Container::VirtualFile>& vf        = files[fileIndex];
+            std::vector<std::uint8_t>&               expected  = data[fileIndex];
+
+            if (testNumber == numberPositionalTests / 2) {
+                status = vf->flush();
+                QVERIFY(!status);
+            }
+
+            std::uniform_int_distribution<unsigned long long> offsetGenerator(0, expected.size());
+
+            unsigned long long position  = static_cast<unsigned long long>(vf->position());
+            unsigned long long offset    = offsetGenerator(rng);
+            unsigned           length    = lengthGenerator(rng);
+            unsigned           operation = operationGenerator(rng);
+
+            if (operation == 0) {
+                unsigned long long remaining     = expected.size() - offset;
+                unsigned           expectedCount = static_cast<unsigned>(length < remaining ? length : remaining);
+
+                buffer.resize(length);
+                status = vf->readAt(offset, buffer.data(), length);
+                QVERIFY(status.success());
+                QVERIFY(Container::ReadSuccessful(status).bytesRead() == expectedCount);
+                QVERIFY(std::memcmp(buffer.data(), expected.data() + offset, expectedCount) == 0);
+            } else if (operation == 1) {
+                buffer.resize(length);
+                for (unsigned i=0 ; i<length ; ++i) {
+                    buffer[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+                }
+
+                status = vf->writeAt(offset, buffer.data(), length);
+                QVERIFY(status.success());
+                QVERIFY(Container::WriteSuccessful(status).bytesWritten() == length);
+
+                if (offset + length > expected.size()) {
+                    expected.resize(offset + length);
+                }
+
+                std::copy(buffer.begin(), buffer.end(), expected.begin() + offset);
+                QVERIFY(vf->size() == static_cast<long long>(expected.size()));
+            } else {
+                // Reads through the file position must see the positional writes.
+
+                unsigned long long remaining     = expected.size() - position;
+                unsigned           expectedCount = static_cast<unsigned>(length < remaining ? length : remaining);
+
+                buffer.resize(length);
+                status = vf->read(buffer.data(), length);
+                QVERIFY(status.success());
+                QVERIFY(Container::ReadSuccessful(status).bytesRead() == expectedCount);
+                QVERIFY(std::memcmp(buffer.data(), expected.data() + position, expectedCount) == 0);
+
+                position += expectedCount;
+                if (position == expected.size()) {
+                    position = expected.size() / 3;
+
+                    status = vf->setPosition(position);
+                    QVERIFY(!status);
+                }
+            }
+
+            QVERIFY(static_cast<unsigned long long>(vf->position()) == position);
+        }
+
+        unsigned long long fileSize = data[0].size();
+
+        status = files[0]->writeAt(fileSize + 1, buffer.data(), 1);
+        QVERIFY(!status.success());
+
+        status = files[0]->readAt(fileSize + 1, buffer.data(), 1);
+        QVERIFY(!status.success());
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        const char* names[2] = { "positional.dat", "compressed.dat" };
+        for (unsigned fileIndex=0 ; fileIndex<2 ; ++fileIndex) {
+            std::shared_ptr<Container::VirtualFile> vf = container.virtualFile(names[fileIndex]);
+            QVERIFY(vf->size() == static_cast<long long>(data[fileIndex].size()));
+
+            std::vector<std::uint8_t> received(data[fileIndex].size());
+            status = vf->readAt(0, received.data(), static_cast<unsigned>(received.size()));
+            QVERIFY(status.success());
+            QVERIFY(received == data[fileIndex]);
+            QVERIFY(vf->position() == 0);
+        }
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+}
+
+
+void TestVirtualFile::testWriteCache() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+    std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+
+    std::mt19937                                      rng;
+    std::uniform_int_distribution<>                   byteGenerator(0, 255);
+    std::uniform_int_distribution<>                   lengthGenerator(1, 64);
+    std::uniform_int_distribution<unsigned long long> offsetGenerator(0, writeCacheFileSizeInBytes - 64);
+
+    std::vector<std::uint8_t> data[2];
+    for (unsigned i=0 ; i<writeCacheFileSizeInBytes ; ++i) {
+        data[0].push_back(static_cast<std::uint8_t>(byteGenerator(rng)));
+        data[1].push_back(static_cast<std::uint8_t>('a' + (i / 5) % 13));
+    }
+
+    const char* names[2] = { "cached.dat", "compressed.dat" };
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        std::shared_ptr<Container::VirtualFile> files[2] = {
+            container.newVirtualFile(names[0]),
+            container.newVirtualFile(names[1])
+        };
+
+        status = files[1]->setCompression(Container::VirtualFile::Compression::FAST);
+        QVERIFY(!status);
+
+        for (unsigned fileIndex=0 ; fileIndex<2 ; ++fileIndex) {
+            QVERIFY(files[fileIndex]->writeCacheSize() > 0);
+
+            status = files[fileIndex]->setWriteCacheSize(2 * writeCacheFileSizeInBytes);
+            QVERIFY(!status);
+
+            status = files[fileIndex]->write(data[fileIndex].data(), writeCacheFileSizeInBytes);
+            QVERIFY(status.success());
+
+            status = files[fileIndex]->flush();
+            QVERIFY(!status);
+        }
+
+        // Small updates scattered across the files should be held in memory until the files are flushed.
+
+        MemoryBuffer snapshot = *containerBuffer;
+
+        std::vector<std::uint8_t> buffer;
+        for (unsigned testNumber=0 ; testNumber<numberWriteCacheTests ; ++testNumber) {
+            unsigned                                 fileIndex = testNumber % 2;
+            std::shared_ptr<Container::VirtualFile>& vf        = files[fileIndex];
+            std::vector<std::uint8_t>&               expected  = data[fileIndex];
+
+            unsigned long long offset = offsetGenerator(rng);
+            unsigned           length = lengthGenerator(rng);
+
+            buffer.resize(length);
+            for (unsigned i=0 ; i<length ; ++i) {
+                buffer[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+            }
+
+            if (testNumber % 3 == 0) {
+                status = vf->writeAt(offset, buffer.data(), length);
+                QVERIFY(status.success());
+            } else {
+                status = vf->setPosition(offset);
+                QVERIFY(!status);
+
+                status = vf->write(buffer.data(), length);
+                QVERIFY(status.success());
+            }
+
+            std::copy(buffer.begin(), buffer.end(), expected.begin() + offset);
+
+            offset = offsetGenerator(rng);
+            status = vf->readAt(offset, buffer.data(), length);
+            QVERIFY(status.success());
+            QVERIFY(std::memcmp(buffer.data(), expected.data() + offset, length) == 0);
+        }
+
+        QVERIFY(*containerBuffer == snapshot);
+        QVERIFY(files[0]->bytesInWriteCache() > 0);
+        QVERIFY(files[1]->bytesInWriteCache() > 0);
+
+        // Shrink the caches, forcing the cached data to the container, then continue with the cache disabled and
+        // with a cache small enough to fill.
+
+        for (unsigned fileIndex=0 ; fileIndex<2 ; ++fileIndex) {
+            status = files[fileIndex]->setWriteCacheSize(0);
+            QVERIFY(!status);
+        }
+
+        QVERIFY(*containerBuffer != snapshot);
+
+        for (unsigned testNumber=0 ; testNumber<numberWriteCacheTests ; ++testNumber) {
+            unsigned                                 fileIndex = testNumber % 2;
+            std::shared_ptr<Container::VirtualFile>& vf        = files[fileIndex];
+            std::vector<std::uint8_t>&               expected  = data[fileIndex];
+
+            if (testNumber == numberWriteCacheTests / 2) {
+                for (unsigned i=0 ; i<2 ; ++i) {
+                    status = files[i]->setWriteCacheSize(64 * 1024);
+                    QVERIFY(!status);
+                }
+            }
+
+            unsigned long long offset = offsetGenerator(rng);
+            unsigned           length = lengthGenerator(rng);
+
+            buffer.resize(length);
+            for (unsigned i=0 ; i<length ; ++i) {
+                buffer[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+            }
+
+            status = vf->setPosition(offset);
+            QVERIFY(!status);
+
+            status = vf->write(buffer.data(), length);
+            QVERIFY(status.success());
+
+            std::copy(buffer.begin(), buffer.end(), expected.begin() + offset);
+        }
+
+        for (unsigned fileIndex=0 ; fileIndex<2 ; ++fileIndex) {
+            std::vector<std::uint8_t> received(writeCacheFileSizeInBytes);
+
+            status = files[fileIndex]->setPosition(0);
+            QVERIFY(!status);
+
+            status = files[fileIndex]->read(received.data(), writeCacheFileSizeInBytes);
+            QVERIFY(status.success());
+            QVERIFY(received == data[fileIndex]);
+
+            status = files[fileIndex]->flush();
+            QVERIFY(!status);
+            QVERIFY(files[fileIndex]->bytesInWriteCache() == 0);
+        }
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        for (unsigned fileIndex=0 ; fileIndex<2 ; ++fileIndex) {
+            std::shared_ptr<Container::VirtualFile> vf = container.virtualFile(names[fileIndex]);
+            QVERIFY(vf->size() == static_cast<long long>(data[fileIndex].size()));
+
+            std::vector<std::uint8_t> received(data[fileIndex].size());
+            status = vf->read(received.data(), static_cast<unsigned>(received.size()));
+            QVERIFY(status.success());
+            QVERIFY(received == data[fileIndex]);
+        }
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+}
+
+
+void TestVirtualFile::testReadCache() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+    std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+
+    std::vector<std::uint8_t> data[2];
+    for (unsigned i=0 ; i<readCacheFileSizeInBytes ; ++i) {
+        data[0].push_back(static_cast<std::uint8_t>(byteGenerator(rng)));
+        data[1].push_back(static_cast<std::uint8_t>('a' + (i / 7) % 17));
+    }
+
+    // Regions are more than a maximum sized chunk apart so each region is held in a different chunk.
+    const unsigned long long regionOffsets[] = { 100, readCacheFileSizeInBytes / 2, readCacheFileSizeInBytes - 50 };
+    const unsigned           numberRegions   = sizeof(regionOffsets) / sizeof(regionOffsets[0]);
+    const unsigned           recordSize      = 16;
+
+    const char* names[2] = { "records.dat", "compressed.dat" };
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        for (unsigned fileIndex=0 ; fileIndex<2 ; ++fileIndex) {
+            std::shared_ptr<Container::VirtualFile> vf       = container.newVirtualFile(names[fileIndex]);
+            std::vector<std::uint8_t>&               expected = data[fileIndex];
+
+            QVERIFY(vf->readCacheSize() > 0);
+
+            if (fileIndex == 1) {
+                status = vf->setCompression(Container::VirtualFile::Compression::FAST);
+                QVERIFY(!status);
+            }
+
+            status = vf->write(expected.data(), readCacheFileSizeInBytes);
+            QVERIFY(status.success());
+
+            status = vf->flush();
+            QVERIFY(!status);
+
+            std::uint8_t buffer[recordSize];
+
+            // Without the read cache, every hop between regions reloads a chunk.
+
+            vf->setReadCacheSize(0);
+
+            unsigned long long hits   = vf->readCacheHits();
+            unsigned long long misses = vf->readCacheMisses();
+
+            for (unsigned round=0 ; round<numberReadCacheRounds ; ++round) {
+                for (unsigned region=0 ; region<numberRegions ; ++region) {
+                    status = vf->setPosition(regionOffsets[region]);
+                    QVERIFY(!status);
+
+                    status = vf->read(buffer, recordSize);
+                    QVERIFY(status.success());
+                    QVERIFY(std::memcmp(buffer, expected.data() + regionOffsets[region], recordSize) == 0);
+                }
+            }
+
+            QVERIFY(vf->readCacheHits() == hits);
+            QVERIFY(vf->readCacheMisses() - misses >= numberRegions * (numberReadCacheRounds - 1));
+
+            // With the read cache, each chunk is loaded once.
+
+            vf->setReadCacheSize(numberRegions + 1);
+
+            hits   = vf->readCacheHits();
+            misses = vf->readCacheMisses();
+
+            for (unsigned round=0 ; round<numberReadCacheRounds ; ++round) {
+                for (unsigned region=0 ; region<numberRegions ; ++region) {
+                    status = vf->setPosition(regionOffsets[region]);
+                    QVERIFY(!status);
+
+                    status = vf->read(buffer, recordSize);
+                    QVERIFY(status.success());
+                    QVERIFY(std::memcmp(buffer, expected.data() + regionOffsets[region], recordSize) == 0);
+                }
+            }
+
+            QVERIFY(vf->readCacheMisses() - misses <= numberRegions);
+            QVERIFY(vf->readCacheHits() - hits >= numberRegions * (numberReadCacheRounds - 1));
+
+            // Updates to cached chunks must be visible to later reads, before and after the file is flushed.
+
+            for (unsigned region=0 ; region<numberRegions ; ++region) {
+                for (unsigned i=0 ; i<recordSize ; ++i) {
+                    buffer[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+                }
+
+                if (region % 2 == 0) {
+                    status = vf->writeAt(regionOffsets[region], buffer, recordSize);
+                    QVERIFY(status.success());
+                } else {
+                    status = vf->setPosition(regionOffsets[region]);
+                    QVERIFY(!status);
+
+                    status = vf->write(buffer, recordSize);
+                    QVERIFY(status.success());
+                }
+
+                std::copy(buffer, buffer + recordSize, expected.begin() + regionOffsets[region]);
+            }
+
+            for (unsigned pass=0 ; pass<2 ; ++pass) {
+                for (unsigned region=0 ; region<numberRegions ; ++region) {
+                    status = vf->setPosition(regionOffsets[region]);
+                    QVERIFY(!status);
+
+                    status = vf->read(buffer, recordSize);
+                    QVERIFY(status.success());
+                    QVERIFY(std::memcmp(buffer, expected.data() + regionOffsets[region], recordSize) == 0);
+
+                    status = vf->readAt(regionOffsets[region], buffer, recordSize);
+                    QVERIFY(status.success());
+                    QVERIFY(std::memcmp(buffer, expected.data() + regionOffsets[region], recordSize) == 0);
+                }
+
+                status = vf->flush();
+                QVERIFY(!status);
+            }
+        }
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        for (unsigned fileIndex=0 ; fileIndex<2 ; ++fileIndex) {
+            std::shared_ptr<Container::VirtualFile> vf = container.virtualFile(names[fileIndex]);
+
+            std::vector<std::uint8_t> received(data[fileIndex].size());
+            status = vf->read(received.data(), static_cast<unsigned>(received.size()));
+            QVERIFY(status.success());
+            QVERIFY(received == data[fileIndex]);
+        }
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+}
+
+
+void TestVirtualFile::testReserve() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+    std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+
+    std::vector<std::uint8_t> data[2];
+    for (unsigned fileIndex=0 ; fileIndex<2 ; ++fileIndex) {
+        for (unsigned i=0 ; i<reservedFileSizeInBytes ; ++i) {
+            data[fileIndex].push_back(static_cast<std::uint8_t>(byteGenerator(rng)));
+        }
+    }
+
+    const char* names[2] = { "first.dat", "second.dat" };
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        std::shared_ptr<Container::VirtualFile> files[2] = {
+            container.newVirtualFile(names[0], reservedFileSizeInBytes),
+            container.newVirtualFile(names[1])
+        };
+
+        QVERIFY(files[0]->bytesReserved() >= reservedFileSizeInBytes);
+        QVERIFY(files[1]->bytesReserved() == 0);
+
+        status = files[1]->reserve(reservedFileSizeInBytes);
+        QVERIFY(!status);
+        QVERIFY(files[1]->bytesReserved() >= reservedFileSizeInBytes);
+
+        // The reserved space is part of the container before any data is written.
+        QVERIFY(containerBuffer->size() >= 2 * reservedFileSizeInBytes);
+
+        unsigned long long initiallyReserved = files[0]->bytesReserved();
+
+        // Write the files at the same time, in small pieces.
+
+        unsigned written = 0;
+        while (written < reservedFileSizeInBytes) {
+            unsigned remaining = reservedFileSizeInBytes - written;
+            unsigned count     = remaining < reservedWriteSizeInBytes ? remaining : reservedWriteSizeInBytes;
+
+            for (unsigned fileIndex=0 ; fileIndex<2 ; ++fileIndex) {
+                status = files[fileIndex]->write(data[fileIndex].data() + written, count);
+                QVERIFY(status.success());
+            }
+
+            written += count;
+        }
+
+        QVERIFY(files[0]->bytesReserved() < initiallyReserved);
+
+        for (unsigned fileIndex=0 ; fileIndex<2 ; ++fileIndex) {
+            status = files[fileIndex]->flush();
+            QVERIFY(!status);
+            QVERIFY(files[fileIndex]->bytesReserved() == 0);
+        }
+
+        // Each file's chunks should sit together in the container.  Locate the first and last bytes of each file's
+        // payload.  Chunk headers may split the very last bytes so we step back until we find an unbroken run.
+
+        const unsigned searchLength = 16;
+        for (unsigned fileIndex=0 ; fileIndex<2 ; ++fileIndex) {
+            const std::vector<std::uint8_t>& expected = data[fileIndex];
+
+            MemoryBuffer::const_iterator first = std::search(
+                containerBuffer->begin(),
+                containerBuffer->end(),
+                expected.begin(),
+                expected.begin() + searchLength
+            );
+
+            MemoryBuffer::const_iterator last      = containerBuffer->end();
+            unsigned                     windowEnd = reservedFileSizeInBytes;
+            while (last == containerBuffer->end() && windowEnd >= 2 * searchLength) {
+                last = std::search(
+                    containerBuffer->begin(),
+                    containerBuffer->end(),
+                    expected.begin() + windowEnd - searchLength,
+                    expected.begin() + windowEnd
+                );
+
+                windowEnd -= searchLength;
+            }
+
+            QVERIFY(first != containerBuffer->end());
+            QVERIFY(last != containerBuffer->end());
+            QVERIFY(last > first);
+            QVERIFY(static_cast<unsigned>(last - first) < reservedFileSizeInBytes + reservedFileSizeInBytes / 8);
+        }
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        for (unsigned fileIndex=0 ; fileIndex<2 ; ++fileIndex) {
+            std::shared_ptr<Container::VirtualFile> vf = container.virtualFile(names[fileIndex]);
+            QVERIFY(vf->size() == static_cast<long long>(reservedFileSizeInBytes));
+
+            std::vector<std::uint8_t> received(reservedFileSizeInBytes);
+            status = vf->read(received.data(), reservedFileSizeInBytes);
+            QVERIFY(status.success());
+            QVERIFY(received == data[fileIndex]);
+        }
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+}
+
+
+void TestVirtualFile::testDelayedAllocation() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+    std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+
+    std::vector<std::uint8_t> data[2];
+    for (unsigned fileIndex=0 ; fileIndex<2 ; ++fileIndex) {
+        for (unsigned i=0 ; i<delayedFileSizeInBytes ; ++i) {
+            data[fileIndex].push_back(static_cast<std::uint8_t>(byteGenerator(rng)));
+        }
+    }
+
+    const char* names[2] = { "first.dat", "second.dat" };
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        std::shared_ptr<Container::VirtualFile> files[2] = {
+            container.newVirtualFile(names[0]),
+            container.newVirtualFile(names[1])
+        };
+
+        // Append to both files at the same time, in small pieces.  The data fits in the write cache so nothing should
+        // be written to the container until the files are flushed.
+
+        unsigned written = 0;
+        while (written < delayedFileSizeInBytes) {
+            unsigned remaining = delayedFileSizeInBytes - written;
+            unsigned count     = remaining < delayedWriteSizeInBytes ? remaining : delayedWriteSizeInBytes;
+
+            for (unsigned fileIndex=0 ; fileIndex<2 ; ++fileIndex) {
+                status = files[fileIndex]->append(data[fileIndex].data() + written, count);
+                QVERIFY(status.success());
+            }
+
+            written += count;
+        }
+
+        unsigned long long unflushedContainerSize = containerBuffer->size();
+
+        for (unsigned fileIndex=0 ; fileIndex<2 ; ++fileIndex) {
+            QVERIFY(files[fileIndex]->size() == static_cast<long long>(delayedFileSizeInBytes));
+            QVERIFY(files[fileIndex]->bytesInWriteCache() == delayedFileSizeInBytes);
+        }
+
+        QVERIFY(unflushedContainerSize < delayedFileSizeInBytes);
+
+        // Pending data must read back before it is written.
+
+        std::vector<std::uint8_t> received(delayedWriteSizeInBytes);
+        status = files[1]->readAt(delayedFileSizeInBytes / 2, received.data(), delayedWriteSizeInBytes);
+        QVERIFY(status.success());
+        QVERIFY(std::memcmp(received.data(), data[1].data() + delayedFileSizeInBytes / 2, received.size()) == 0);
+
+        for (unsigned fileIndex=0 ; fileIndex<2 ; ++fileIndex) {
+            status = files[fileIndex]->flush();
+            QVERIFY(!status);
+            QVERIFY(files[fileIndex]->bytesInWriteCache() == 0);
+        }
+
+        // Each file should have been written as a single run.
+
+        const unsigned searchLength = 16;
+        for (unsigned fileIndex=0 ; fileIndex<2 ; ++fileIndex) {
+            const std::vector<std::uint8_t>& expected = data[fileIndex];
+
+            MemoryBuffer::const_iterator first = std::search(
+                containerBuffer->begin(),
+                containerBuffer->end(),
+                expected.begin(),
+                expected.begin() + searchLength
+            );
+
+            MemoryBuffer::const_iterator last      = containerBuffer->end();
+            unsigned                     windowEnd = delayedFileSizeInBytes;
+            while (last == containerBuffer->end() && windowEnd >= 2 * searchLength) {
+                last = std::search(
+                    containerBuffer->begin(),
+                    containerBuffer->end(),
+                    expected.begin() + windowEnd - searchLength,
+                    expected.begin() + windowEnd
+                );
+
+                windowEnd -= searchLength;
+            }
+
+            QVERIFY(first != containerBuffer->end());
+            QVERIFY(last != containerBuffer->end());
+            QVERIFY(last > first);
+            QVERIFY(static_cast<unsigned>(last - first) < delayedFileSizeInBytes + delayedFileSizeInBytes / 16);
+        }
+
+        // Appends larger than the write cache are written as they arrive.
+
+        status = files[0]->setWriteCacheSize(8 * 1024);
+        QVERIFY(!status);
+
+        status = files[0]->append(data[1].data(), delayedFileSizeInBytes);
+        QVERIFY(status.success());
+        QVERIFY(files[0]->bytesInWriteCache() < 8 * 1024);
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        std::vector<std::uint8_t> expected[2] = { data[0], data[1] };
+        expected[0].insert(expected[0].end(), data[1].begin(), data[1].end());
+
+        for (unsigned fileIndex=0 ; fileIndex<2 ; ++fileIndex) {
+            std::shared_ptr<Container::VirtualFile> vf = container.virtualFile(names[fileIndex]);
+            QVERIFY(vf->size() == static_cast<long long>(expected[fileIndex].size()));
+
+            std::vector<std::uint8_t> received(expected[fileIndex].size());
+            status = vf->read(received.data(), static_cast<unsigned>(received.size()));
+            QVERIFY(status.success());
+            QVERIFY(received == expected[fileIndex]);
+        }
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+}
+
+
+void TestVirtualFile::testWriteBufferBudget() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+    std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+
+    std::vector<std::vector<std::uint8_t>> data(numberBudgetFiles);
+    for (unsigned fileIndex=0 ; fileIndex<numberBudgetFiles ; ++fileIndex) {
+        for (unsigned i=0 ; i<budgetFileSizeInBytes ; ++i) {
+            data[fileIndex].push_back(static_cast<std::uint8_t>(byteGenerator(rng)));
+        }
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        QVERIFY(container.writeBufferBudget() == Container::Container::defaultWriteBufferBudget);
+        QVERIFY(container.bufferedBytes() == 0);
+
+        status = container.setWriteBufferBudget(writeBufferBudgetInBytes);
+        QVERIFY(!status);
+        QVERIFY(container.writeBufferBudget() == writeBufferBudgetInBytes);
+
+        std::vector<std::shared_ptr<Container::VirtualFile>> files;
+        for (unsigned fileIndex=0 ; fileIndex<numberBudgetFiles ; ++fileIndex) {
+            files.push_back(container.newVirtualFile("file" + std::to_string(fileIndex) + ".dat"));
+        }
+
+        // Append to every file in turn.  Each file would happily hold all of its data so the budget alone must keep
+        // the total in check.
+
+        unsigned long long peakBufferedBytes = 0;
+        unsigned           written           = 0;
+        while (written < budgetFileSizeInBytes) {
+            unsigned remaining = budgetFileSizeInBytes - written;
+            unsigned count     = remaining < budgetWriteSizeInBytes ? remaining : budgetWriteSizeInBytes;
+
+            for (unsigned fileIndex=0 ; fileIndex<numberBudgetFiles ; ++fileIndex) {
+                status = files[fileIndex]->append(data[fileIndex].data() + written, count);
+                QVERIFY(status.success());
+                QVERIFY(container.bufferedBytes() <= writeBufferBudgetInBytes);
+
+                if (container.bufferedBytes() > peakBufferedBytes) {
+                    peakBufferedBytes = container.bufferedBytes();
+                }
+            }
+
+            written += count;
+        }
+
+        QVERIFY(peakBufferedBytes > writeBufferBudgetInBytes / 2);
+
+        unsigned long long cachedBytes = 0;
+        for (unsigned fileIndex=0 ; fileIndex<numberBudgetFiles ; ++fileIndex) {
+            QVERIFY(files[fileIndex]->size() == static_cast<long long>(budgetFileSizeInBytes));
+            cachedBytes += files[fileIndex]->bytesInWriteCache();
+        }
+
+        QVERIFY(cachedBytes == container.bufferedBytes());
+
+        // Lowering the budget flushes immediately.
+
+        status = container.setWriteBufferBudget(writeBufferBudgetInBytes / 4);
+        QVERIFY(!status);
+        QVERIFY(container.bufferedBytes() <= writeBufferBudgetInBytes / 4);
+
+        for (unsigned fileIndex=0 ; fileIndex<numberBudgetFiles ; ++fileIndex) {
+            status = files[fileIndex]->flush();
+            QVERIFY(!status);
+        }
+
+        QVERIFY(container.bufferedBytes() == 0);
+
+        files.clear();
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        for (unsigned fileIndex=0 ; fileIndex<numberBudgetFiles ; ++fileIndex) {
+            std::string                             name = "file" + std::to_string(fileIndex) + ".dat";
+            std::shared_ptr<Container::VirtualFile> vf   = container.virtualFile(name);
+            QVERIFY(vf->size() == static_cast<long long>(budgetFileSizeInBytes));
+
+            std::vector<std::uint8_t> received(budgetFileSizeInBytes);
+            status = vf->read(received.data(), budgetFileSizeInBytes);
+            QVERIFY(status.success());
+            QVERIFY(received == data[fileIndex]);
+        }
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+}
+
+
+void TestVirtualFile::testMetadataOnlyErase() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+    std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+
+    std::vector<std::vector<std::uint8_t>> data(numberEraseFiles);
+    for (unsigned fileIndex=0 ; fileIndex<numberEraseFiles ; ++fileIndex) {
+        for (unsigned i=0 ; i<eraseFileSizeInBytes ; ++i) {
+            data[fileIndex].push_back(static_cast<std::uint8_t>(byteGenerator(rng)));
+        }
+    }
+
+    const char* names[numberEraseFiles] = { "erased.dat", "verified.dat", "truncated.dat", "checked.dat" };
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        std::shared_ptr<Container::VirtualFile> files[numberEraseFiles];
+        for (unsigned fileIndex=0 ; fileIndex<numberEraseFiles ; ++fileIndex) {
+            files[fileIndex] = container.newVirtualFile(names[fileIndex]);
+
+            status = files[fileIndex]->append(data[fileIndex].data(), eraseFileSizeInBytes);
+            QVERIFY(status.success());
+
+            status = files[fileIndex]->flush();
+            QVERIFY(!status);
+        }
+
+        // An erase without verification should not touch the media until the container is closed.
+
+        MemoryBuffer snapshot = *containerBuffer;
+
+        status = files[0]->erase();
+        QVERIFY(!status);
+        QVERIFY(*containerBuffer == snapshot);
+
+        status = files[1]->erase(true);
+        QVERIFY(!status);
+        QVERIFY(*containerBuffer != snapshot);
+
+        status = files[2]->setPosition(eraseFileSizeInBytes / 3);
+        QVERIFY(!status);
+
+        status = files[2]->truncate();
+        QVERIFY(!status);
+        QVERIFY(files[2]->size() == static_cast<long long>(eraseFileSizeInBytes / 3));
+
+        status = files[3]->setPosition(eraseFileSizeInBytes / 5);
+        QVERIFY(!status);
+
+        status = files[3]->truncate(true);
+        QVERIFY(!status);
+        QVERIFY(files[3]->size() == static_cast<long long>(eraseFileSizeInBytes / 5));
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    unsigned long long containerSize = containerBuffer->size();
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        Container::Container::DirectoryMap directory = container.directory();
+        QVERIFY(directory.size() == 2);
+        QVERIFY(directory.find(names[0]) == directory.end());
+        QVERIFY(directory.find(names[1]) == directory.end());
+
+        unsigned expectedSizes[2] = { eraseFileSizeInBytes / 3, eraseFileSizeInBytes / 5 };
+        for (unsigned fileIndex=2 ; fileIndex<numberEraseFiles ; ++fileIndex) {
+            std::shared_ptr<Container::VirtualFile> vf           = container.virtualFile(names[fileIndex]);
+            unsigned                                expectedSize = expectedSizes[fileIndex - 2];
+
+            QVERIFY(vf->size() == static_cast<long long>(expectedSize));
+
+            std::vector<std::uint8_t> received(expectedSize);
+            status = vf->read(received.data(), expectedSize);
+            QVERIFY(status.success());
+            QVERIFY(std::memcmp(received.data(), data[fileIndex].data(), expectedSize) == 0);
+        }
+
+        // The released space should be reused.
+
+        std::shared_ptr<Container::VirtualFile> vf = container.newVirtualFile(names[0]);
+
+        status = vf->append(data[0].data(), eraseFileSizeInBytes);
+        QVERIFY(status.success());
+
+        status = container.close();
+        QVERIFY(!status);
+
+        QVERIFY(containerBuffer->size() == containerSize);
+    }
+}
+
+
+void TestVirtualFile::testPartialOverwrite() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+    std::uniform_int_distribution<> lengthGenerator(1, 100);
+    std::uniform_int_distribution<> offsetGenerator(0, partialOverwriteFileSizeInBytes - 100);
+    std::uniform_int_distribution<> modeGenerator(0, 3);
+
+    const Container::Container::ChunkChecksum checksums[] = {
+        Container::Container::ChunkChecksum::CRC16,
+        Container::Container::ChunkChecksum::CRC64
+    };
+
+    for (Container::Container::ChunkChecksum checksum : checksums) {
+        std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+
+        std::vector<std::uint8_t> data(partialOverwriteFileSizeInBytes);
+        std::vector<std::uint8_t> buffer(partialOverwriteFileSizeInBytes);
+
+        for (unsigned i=0 ; i<partialOverwriteFileSizeInBytes ; ++i) {
+            data[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+        }
+
+        {
+            Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+            container.setChunkChecksum(checksum);
+
+            Container::Status status = container.open(containerBuffer);
+            QVERIFY(status.success());
+
+            std::shared_ptr<Container::VirtualFile> vf = container.newVirtualFile("overwrite.dat");
+            status = vf->append(data.data(), partialOverwriteFileSizeInBytes);
+            QVERIFY(status.success());
+
+            status = container.close();
+            QVERIFY(!status);
+        }
+
+        std::size_t containerSize = containerBuffer->size();
+
+        {
+            Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+            Container::Status status = container.open(containerBuffer);
+            QVERIFY(!status);
+            QVERIFY(container.crcVerification() == Container::Container::CrcVerification::ALWAYS);
+
+            std::shared_ptr<Container::VirtualFile> vf = container.virtualFile("overwrite.dat");
+
+            status = vf->setWriteCacheSize(0);
+            QVERIFY(!status);
+
+            std::vector<std::uint8_t> update(100);
+
+            for (unsigned test=0 ; test<numberPartialOverwriteTests ; ++test) {
+                unsigned offset = static_cast<unsigned>(offsetGenerator(rng));
+                unsigned length = static_cast<unsigned>(lengthGenerator(rng));
+                unsigned mode   = static_cast<unsigned>(modeGenerator(rng));
+
+                for (unsigned i=0 ; i<length ; ++i) {
+                    update[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+                }
+
+                if (mode == 0) {
+                    // Read the region first so the old bytes are held in memory.
+
+                    status = vf->readAt(offset, buffer.data(), length);
+                    QVERIFY(status.success());
+                    QVERIFY(std::memcmp(buffer.data(), data.data() + offset, length) == 0);
+                }
+
+                if (mode <= 1) {
+                    status = vf->setPosition(offset);
+                    QVERIFY(!status);
+
+                    status = vf->write(update.data(), length);
+                } else {
+                    status = vf->writeAt(offset, update.data(), length);
+                }
+
+                QVERIFY(status.success());
+                QVERIFY(Container::WriteSuccessful(status).bytesWritten() == length);
+
+                std::memcpy(data.data() + offset, update.data(), length);
+
+                if (mode == 3) {
+                    status = vf->readAt(offset, buffer.data(), length);
+                    QVERIFY(status.success());
+                    QVERIFY(std::memcmp(buffer.data(), data.data() + offset, length) == 0);
+                }
+            }
+
+            status = vf->setPosition(0);
+            QVERIFY(!status);
+
+            status = vf->read(buffer.data(), partialOverwriteFileSizeInBytes);
+            QVERIFY(status.success());
+            QVERIFY(Container::ReadSuccessful(status).bytesRead() == partialOverwriteFileSizeInBytes);
+            QVERIFY(buffer == data);
+
+            status = container.close();
+            QVERIFY(!status);
+        }
+
+        // Patched chunks stay where they are.
+        QVERIFY(containerBuffer->size() == containerSize);
+
+        {
+            Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+            Container::Status status = container.open(containerBuffer);
+            QVERIFY(!status);
+            QVERIFY(container.chunkChecksum() == checksum);
+
+            std::shared_ptr<Container::VirtualFile> vf = container.virtualFile("overwrite.dat");
+
+            status = vf->read(buffer.data(), partialOverwriteFileSizeInBytes);
+            QVERIFY(status.success());
+            QVERIFY(Container::ReadSuccessful(status).bytesRead() == partialOverwriteFileSizeInBytes);
+            QVERIFY(buffer == data);
+        }
+    }
+}
+
+
+void TestVirtualFile::testFrequentFlush() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+    std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+
+    unsigned fileSize = numberFlushedAppends * flushedAppendSizeInBytes;
+
+    std::vector<std::vector<std::uint8_t>> data(numberFlushedFiles);
+    for (unsigned fileIndex=0 ; fileIndex<numberFlushedFiles ; ++fileIndex) {
+        for (unsigned i=0 ; i<fileSize ; ++i) {
+            data[fileIndex].push_back(static_cast<std::uint8_t>(byteGenerator(rng)));
+        }
+    }
+
+    const char* names[numberFlushedFiles] = { "log1.txt", "log2.txt" };
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        std::shared_ptr<Container::VirtualFile> files[numberFlushedFiles];
+        for (unsigned fileIndex=0 ; fileIndex<numberFlushedFiles ; ++fileIndex) {
+            files[fileIndex] = container.newVirtualFile(names[fileIndex]);
+            QVERIFY(files[fileIndex]);
+        }
+
+        // The first file grows in place at the end of the container.  Interleaving the second file forces chunks to
+        // be rewritten elsewhere.
+
+        for (unsigned i=0 ; i<numberFlushedAppends ; ++i) {
+            unsigned numberActiveFiles = i < numberFlushedAppends / 2 ? 1 : numberFlushedFiles;
+
+            for (unsigned fileIndex=0 ; fileIndex<numberActiveFiles ; ++fileIndex) {
+                unsigned offset = (fileIndex == 0 ? i : i - numberFlushedAppends / 2) * flushedAppendSizeInBytes;
+
+                status = files[fileIndex]->append(data[fileIndex].data() + offset, flushedAppendSizeInBytes);
+                QVERIFY(status.success());
+
+                status = files[fileIndex]->flush();
+                QVERIFY(!status);
+
+                std::vector<std::uint8_t> buffer(offset + flushedAppendSizeInBytes);
+
+                status = files[fileIndex]->setPosition(0);
+                QVERIFY(!status);
+
+                status = files[fileIndex]->read(buffer.data(), static_cast<unsigned>(buffer.size()));
+                QVERIFY(status.success());
+                QVERIFY(Container::ReadSuccessful(status).bytesRead() == buffer.size());
+                QVERIFY(std::equal(buffer.begin(), buffer.end(), data[fileIndex].begin()));
+            }
+        }
+
+        for (unsigned i=numberFlushedAppends/2 ; i<numberFlushedAppends ; ++i) {
+            status = files[1]->append(data[1].data() + i * flushedAppendSizeInBytes, flushedAppendSizeInBytes);
+            QVERIFY(status.success());
+
+            status = files[1]->flush();
+            QVERIFY(!status);
+        }
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    // Each flush would otherwise leave a chunk of at least 32 bytes holding 7 bytes of data.
+    QVERIFY(containerBuffer->size() < 2 * numberFlushedFiles * fileSize);
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        for (unsigned fileIndex=0 ; fileIndex<numberFlushedFiles ; ++fileIndex) {
+            std::shared_ptr<Container::VirtualFile> vf = container.virtualFile(names[fileIndex]);
+            QVERIFY(vf->size() == fileSize);
+
+            std::vector<std::uint8_t> buffer(fileSize);
+
+            status = vf->read(buffer.data(), fileSize);
+            QVERIFY(status.success());
+            QVERIFY(Container::ReadSuccessful(status).bytesRead() == fileSize);
+            QVERIFY(buffer == data[fileIndex]);
+        }
+    }
+}
+
+
+void TestVirtualFile::testInlinePayload() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+    std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+    std::uniform_int_distribution<> sizeGenerator(1, maximumInlineFileSizeInBytes);
+
+    std::vector<std::string>               names;
+    std::vector<std::vector<std::uint8_t>> data(numberInlineFiles);
+
+    for (unsigned fileIndex=0 ; fileIndex<numberInlineFiles ; ++fileIndex) {
+        names.push_back("small" + std::to_string(fileIndex) + ".txt");
+
+        unsigned fileSize = static_cast<unsigned>(sizeGenerator(rng));
+        for (unsigned i=0 ; i<fileSize ; ++i) {
+            data[fileIndex].push_back(static_cast<std::uint8_t>(byteGenerator(rng)));
+        }
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        for (unsigned fileIndex=0 ; fileIndex<numberInlineFiles ; ++fileIndex) {
+            std::shared_ptr<Container::VirtualFile> vf = container.newVirtualFile(names[fileIndex]);
+            QVERIFY(vf);
+
+            unsigned fileSize = static_cast<unsigned>(data[fileIndex].size());
+
+            status = vf->write(data[fileIndex].data(), fileSize);
+            QVERIFY(status.success());
+
+            status = vf->flush();
+            QVERIFY(!status);
+        }
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    // Each file would otherwise use a 128 byte stream start chunk plus a data chunk of up to 512 bytes.
+    QVERIFY(containerBuffer->size() < numberInlineFiles * (maximumInlineFileSizeInBytes + 128) * 3 / 4);
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        for (unsigned fileIndex=0 ; fileIndex<numberInlineFiles ; ++fileIndex) {
+            std::shared_ptr<Container::VirtualFile> vf = container.virtualFile(names[fileIndex]);
+            QVERIFY(vf);
+            QVERIFY(vf->size() == static_cast<long long>(data[fileIndex].size()));
+
+            std::vector<std::uint8_t> buffer(data[fileIndex].size());
+
+            status = vf->read(buffer.data(), static_cast<unsigned>(buffer.size()));
+            QVERIFY(status.success());
+            QVERIFY(Container::ReadSuccessful(status).bytesRead() == buffer.size());
+            QVERIFY(buffer == data[fileIndex]);
+        }
+
+        // Overwrite part of the first file, rename the second, truncate the third, erase the fourth and grow the fifth
+        // past the inline limit.
+
+        std::shared_ptr<Container::VirtualFile> vf = container.virtualFile(names[0]);
+        for (unsigned i=0 ; i<data[0].size() / 2 ; ++i) {
+            data[0][i] = static_cast<std::uint8_t>(byteGenerator(rng));
+        }
+
+        status = vf->setPosition(0);
+        QVERIFY(!status);
+
+        status = vf->write(data[0].data(), static_cast<unsigned>(data[0].size() / 2));
+        QVERIFY(status.success());
+
+        vf = container.virtualFile(names[1]);
+        vf->rename("renamed.txt");
+        names[1] = "renamed.txt";
+
+        vf = container.virtualFile(names[2]);
+        data[2].resize(data[2].size() / 2);
+
+        status = vf->setPosition(data[2].size());
+        QVERIFY(!status);
+
+        status = vf->truncate();
+        QVERIFY(!status);
+
+        vf = container.virtualFile(names[3]);
+        status = vf->erase();
+        QVERIFY(!status);
+
+        vf = container.virtualFile(names[4]);
+        while (data[4].size() < 4 * maximumInlineFileSizeInBytes) {
+            data[4].push_back(static_cast<std::uint8_t>(byteGenerator(rng)));
+        }
+
+        unsigned storedSize = static_cast<unsigned>(vf->size());
+
+        status = vf->setPosition(storedSize);
+        QVERIFY(!status);
+
+        status = vf->write(data[4].data() + storedSize, static_cast<unsigned>(data[4].size()) - storedSize);
+        QVERIFY(status.success());
+
+        status = vf->flush();
+        QVERIFY(!status);
+
+        // The stream start chunk must still precede the data chunks after a rename to a much longer name.
+
+        names[4] = std::string(100, 'x') + ".txt";
+        vf->rename(names[4]);
+
+        status = container.close();
+        QVERIFY(!status);
+    }
+
+    {
+        Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+        Container::Status status = container.open(containerBuffer);
+        QVERIFY(!status);
+
+        QVERIFY(!container.virtualFile(names[3]));
+
+        for (unsigned fileIndex=0 ; fileIndex<numberInlineFiles ; ++fileIndex) {
+            if (fileIndex != 3) {
+                std::shared_ptr<Container::VirtualFile> vf = container.virtualFile(names[fileIndex]);
+                QVERIFY(vf);
+                QVERIFY(vf->size() == static_cast<long long>(data[fileIndex].size()));
+
+                std::vector<std::uint8_t> buffer(data[fileIndex].size());
+
+                status = vf->read(buffer.data(), static_cast<unsigned>(buffer.size()));
+                QVERIFY(status.success());
+                QVERIFY(Container::ReadSuccessful(status).bytesRead() == buffer.size());
+                QVERIFY(buffer == data[fileIndex]);
+            }
+        }
+    }
+}
+
+
+void TestVirtualFile::testInlinePayloadSpill() {
+    typedef Container::MemoryContainer::MemoryBuffer MemoryBuffer;
+
+    std::mt19937                    rng;
+    std::uniform_int_distribution<> byteGenerator(0, 255);
+
+    std::vector<std::uint8_t> data(inlineSpillFileSizeInBytes);
+    for (unsigned i=0 ; i<data.size() ; ++i) {
+        data[i] = static_cast<std::uint8_t>(byteGenerator(rng));
+    }
+
+    // An inline payload that is cached, modified, and then moved into a data chunk must not be read back from the
+    // stale cache entry.
+
+    unsigned long long writeCacheSizes[] = { 0, 4096, 100000 };
+
+    for (unsigned variant=0 ; variant<6 ; ++variant) {
+        std::shared_ptr<MemoryBuffer> containerBuffer = std::make_shared<MemoryBuffer>();
+        std::vector<std::uint8_t>     expected(data.begin(), data.begin() + 200);
+
+        {
+            Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+            Container::Status status = container.open(containerBuffer);
+            QVERIFY(!status);
+
+            std::shared_ptr<Container::VirtualFile> vf = container.newVirtualFile("spill.dat");
+
+            status = vf->setWriteCacheSize(writeCacheSizes[variant % 3]);
+            QVERIFY(!status);
+
+            if (variant >= 3) {
+                status = vf->setCompression(Container::VirtualFile::Compression::FAST);
+                QVERIFY(!status);
+            }
+
+            status = vf->write(expected.data(), static_cast<unsigned>(expected.size()));
+            QVERIFY(status.success());
+
+            status = vf->flush();
+            QVERIFY(!status);
+
+            std::vector<std::uint8_t> buffer(data.size());
+
+            status = vf->setPosition(0);
+            QVERIFY(!status);
+
+            status = vf->read(buffer.data(), static_cast<unsigned>(expected.size()));
+            QVERIFY(status.success());
+            QVERIFY(std::memcmp(buffer.data(), expected.data(), expected.size()) == 0);
+
+            for (unsigned i=10 ; i<60 ; ++i) {
+                expected[i] ^= 0xFF;
+            }
+
+            status = vf->setPosition(10);
+            QVERIFY(!status);
+
+            status = vf->write(expected.data() + 10, 50);
+            QVERIFY(status.success());
+
+            expected.insert(expected.end(), data.begin() + 200, data.end());
+
+            status = vf->setPosition(200);
+            QVERIFY(!status);
+
+            status = vf->write(expected.data() + 200, static_cast<unsigned>(expected.size()) - 200);
+            QVERIFY(status.success());
+
+            status = vf->setPosition(0);
+            QVERIFY(!status);
+
+            status = vf->read(buffer.data(), static_cast<unsigned>(expected.size()));
+            QVERIFY(status.success());
+            QVERIFY(Container::ReadSuccessful(status).bytesRead() == expected.size());
+            QVERIFY(std::memcmp(buffer.data(), expected.data(), expected.size()) == 0);
+
+            status = container.close();
+            QVERIFY(!status);
+        }
+
+        {
+            Container::MemoryContainer container("Inesonic, LLC.\nAleph Test");
+
+            Container::Status status = container.open(containerBuffer);
+            QVERIFY(!status);
+
+            std::shared_ptr<Container::VirtualFile> vf = container.virtualFile("spill.dat");
+            QVERIFY(vf);
+            QVERIFY(vf->size() == static_cast<long long>(expected.size()));
+
+            std::vector<std::uint8_t> buffer(expected.size());
+
+            status = vf->read(buffer.data(), static_cast<unsigned>(buffer.size()));
+            QVERIFY(status.success());
+            QVERIFY(buffer == expected);
+        }
+    }
+}
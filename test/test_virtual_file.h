@@ -44,6 +44,42 @@ class TestVirtualFile:public QObject {
 
         void testStreamRead();
 
+        void testForEachFile();
+
+        void testLazyDirectory();
+
+        void testExtendedChunks();
+
+        void testCrcVerification();
+
+        void testPayloadChecksums();
+
+        void testCompression();
+
+        void testDeduplication();
+
+        void testReadView();
+
+        void testVectoredReadWrite();
+
+        void testPositionalReadWrite();
+
+        void testWriteCache();
+
+        void testReadCache();
+
+        void testReserve();
+
+        void testDelayedAllocation();
+
+        void testWriteBufferBudget();
+
+        void testMetadataOnlyErase();
+        void testPartialOverwrite();
+        void testFrequentFlush();
+        void testInlinePayload();
+        void testInlinePayloadSpill();
+
     private:
         static constexpr unsigned      bufferSizeInBytes                        = 65536;
         static constexpr unsigned long sequentialFileSizeInBytes                = 128 * 1024 * 1024;
@@ -52,6 +88,38 @@ class TestVirtualFile:public QObject {
         static constexpr unsigned      numberVirtualFiles                       = 4;
         static constexpr unsigned      numberOpenCloseEraseAndRandomAccessTests = 10;
         static constexpr unsigned      numberTruncateTests                      = 10000;
+        static constexpr unsigned      extendedFileSizeInBytes                  = 3 * 1024 * 1024 + 12345;
+        static constexpr unsigned      compressedFileSizeInBytes                = 1024 * 1024 + 4321;
+        static constexpr unsigned      numberCompressedReadTests                = 200;
+        static constexpr unsigned      deduplicatedFileSizeInBytes              = 6 * 65472 + 1234;
+        static constexpr unsigned      readViewFileSizeInBytes                  = 1024 * 1024 + 777;
+        static constexpr unsigned      numberReadViewTests                      = 200;
+        static constexpr unsigned      vectoredFileSizeInBytes                  = 2 * 1024 * 1024 + 99;
+        static constexpr unsigned      maximumNumberVectoredBuffers             = 24;
+        static constexpr unsigned      positionalFileSizeInBytes                = 512 * 1024 + 5;
+        static constexpr unsigned      numberPositionalTests                    = 1000;
+        static constexpr unsigned      writeCacheFileSizeInBytes                = 1024 * 1024 + 17;
+        static constexpr unsigned      numberWriteCacheTests                    = 400;
+        static constexpr unsigned      readCacheFileSizeInBytes                 = 3 * 1024 * 1024 + 100;
+        static constexpr unsigned      numberReadCacheRounds                    = 200;
+        static constexpr unsigned      reservedFileSizeInBytes                  = 256 * 1024 + 11;
+        static constexpr unsigned      reservedWriteSizeInBytes                 = 3000;
+        static constexpr unsigned      delayedFileSizeInBytes                   = 200 * 1024 + 17;
+        static constexpr unsigned      delayedWriteSizeInBytes                  = 1500;
+        static constexpr unsigned      numberBudgetFiles                        = 64;
+        static constexpr unsigned      budgetFileSizeInBytes                    = 100 * 1024 + 3;
+        static constexpr unsigned      budgetWriteSizeInBytes                   = 1700;
+        static constexpr unsigned      writeBufferBudgetInBytes                 = 1024 * 1024;
+        static constexpr unsigned      numberEraseFiles                         = 4;
+        static constexpr unsigned      eraseFileSizeInBytes                     = 300 * 1024 + 29;
+        static constexpr unsigned      partialOverwriteFileSizeInBytes          = 512 * 1024 + 41;
+        static constexpr unsigned      numberPartialOverwriteTests              = 1000;
+        static constexpr unsigned      numberFlushedFiles                       = 2;
+        static constexpr unsigned      numberFlushedAppends                     = 2000;
+        static constexpr unsigned      flushedAppendSizeInBytes                 = 7;
+        static constexpr unsigned      numberInlineFiles                        = 200;
+        static constexpr unsigned      maximumInlineFileSizeInBytes             = 384;
+        static constexpr unsigned      inlineSpillFileSizeInBytes               = 16384;
 };
 
 #endif